@@ -46,33 +46,59 @@ oboe::DataCallbackResult FullDuplexAnalyzer::onBothStreamsReadyFloat(
                                    outputFloat, outputStride, numOutputFrames);
 
     // Save data for later analysis or for writing to a WAVE file.
-    if (mRecording != nullptr) {
-        float buffer[2];
-        int numBoth = std::min(numInputFrames, numOutputFrames);
+    // Count this callback as a user before loading the recorder, see setDiskRecorder().
+    mDiskRecorderUsers.fetch_add(1);
+    BackgroundWaveRecorder *diskRecorder = mDiskRecorder.load();
+    if (mRecording != nullptr || diskRecorder != nullptr) {
+        // Interleave the selected output and input channels a block at a time.
+        float frames[kRecordBlockFrames * 2];
+        int32_t numFrames = 0;
+        int numTotal = std::max(numInputFrames, numOutputFrames);
         // Offset to the selected channels that we are analyzing.
         inputFloat += getLoopbackProcessor()->getInputChannel();
         outputFloat += getLoopbackProcessor()->getOutputChannel();
-        for (int i = 0; i < numBoth; i++) {
-            buffer[0] = *outputFloat;
-            outputFloat += outputStride;
-            buffer[1] = *inputFloat;
-            inputFloat += inputStride;
-            mRecording->write(buffer, 1);
-        }
         // Handle mismatch in numFrames.
         const float gapMarker = -0.9f; // Recognizable value so we can tell underruns from DSP gaps.
-        buffer[0] = gapMarker; // gap in output
-        for (int i = numBoth; i < numInputFrames; i++) {
-            buffer[1] = *inputFloat;
-            inputFloat += inputStride;
-            mRecording->write(buffer, 1);
-        }
-        buffer[1] = gapMarker; // gap in input
-        for (int i = numBoth; i < numOutputFrames; i++) {
-            buffer[0] = *outputFloat;
-            outputFloat += outputStride;
-            mRecording->write(buffer, 1);
+        for (int i = 0; i < numTotal; i++) {
+            if (i < numOutputFrames) {
+                frames[numFrames * 2] = *outputFloat;
+                outputFloat += outputStride;
+            } else {
+                frames[numFrames * 2] = gapMarker; // gap in output
+            }
+            if (i < numInputFrames) {
+                frames[(numFrames * 2) + 1] = *inputFloat;
+                inputFloat += inputStride;
+            } else {
+                frames[(numFrames * 2) + 1] = gapMarker; // gap in input
+            }
+            if (++numFrames == kRecordBlockFrames) {
+                record(diskRecorder, frames, numFrames);
+                numFrames = 0;
+            }
         }
+        record(diskRecorder, frames, numFrames);
     }
+    mDiskRecorderUsers.fetch_sub(1);
     return oboe::DataCallbackResult::Continue;
 };
+
+void FullDuplexAnalyzer::setDiskRecorder(BackgroundWaveRecorder *recorder) {
+    mDiskRecorder.store(recorder);
+    // A callback that loaded the previous recorder incremented mDiskRecorderUsers first,
+    // so once the count is zero no callback can still be writing to it.
+    while (mDiskRecorderUsers.load() > 0) {
+        usleep(kDiskRecorderPollMicros);
+    }
+}
+
+void FullDuplexAnalyzer::record(BackgroundWaveRecorder *diskRecorder,
+                                const float *frames, int32_t numFrames) {
+    if (numFrames == 0) return;
+    if (mRecording != nullptr) {
+        mRecording->write(frames, numFrames);
+    }
+    if (diskRecorder != nullptr) {
+        diskRecorder->write(frames, numFrames);
+    }
+}
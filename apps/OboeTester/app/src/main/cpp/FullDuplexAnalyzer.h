@@ -24,6 +24,7 @@
 #include "analyzer/LatencyAnalyzer.h"
 #include "FullDuplexStreamWithConversion.h"
 #include "MultiChannelRecording.h"
+#include "util/BackgroundWaveRecorder.h"
 
 class FullDuplexAnalyzer : public FullDuplexStreamWithConversion {
 public:
@@ -52,6 +53,14 @@ public:
         mRecording = recording;
     }
 
+    /**
+     * Also stream the output and input to a file while the test runs.
+     * This may be called while the streams are running. Pass nullptr to stop.
+     * When this returns the callback is no longer using the previous recorder,
+     * so that recorder can be stopped.
+     */
+    void setDiskRecorder(BackgroundWaveRecorder *recorder);
+
     bool isWriteReadDeltaValid() {
         return mWriteReadDeltaValid;
     }
@@ -61,7 +70,15 @@ public:
     }
 
 private:
+    void record(BackgroundWaveRecorder *diskRecorder, const float *frames, int32_t numFrames);
+
+    static constexpr int32_t kRecordBlockFrames = 256;
+    static constexpr int32_t kDiskRecorderPollMicros = 1000;
+
     MultiChannelRecording  *mRecording = nullptr;
+    std::atomic<BackgroundWaveRecorder *> mDiskRecorder{nullptr};
+    // Nonzero while a callback may be using a recorder it loaded from mDiskRecorder.
+    std::atomic<int32_t>   mDiskRecorderUsers{0};
 
     LoopbackProcessor * const mLoopbackProcessor;
 
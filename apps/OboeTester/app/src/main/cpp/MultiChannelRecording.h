@@ -101,7 +101,7 @@ public:
      * @param numFrames
      * @return number of frames actually written.
      */
-    int32_t write(float *buffer, int32_t numFrames) {
+    int32_t write(const float *buffer, int32_t numFrames) {
         int32_t framesLeft = numFrames;
         while (framesLeft > 0) {
             int32_t indexFrame = getWriteIndex();
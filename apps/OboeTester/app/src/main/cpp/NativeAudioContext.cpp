@@ -20,8 +20,10 @@
 // We could not trigger the race condition without adding these get calls and the sleeps.
 #define DEBUG_CLOSE_RACE 0
 
+// Set to 0 to use the older EncodedRandomLatencyAnalyzer for single latency measurements.
+#define USE_WHITE_NOISE_ANALYZER 1
+
 #include <chrono>
-#include <fstream>
 #include <iostream>
 #if DEBUG_CLOSE_RACE
 #include <thread>
@@ -47,24 +49,6 @@ static oboe::AudioApi convertNativeApiToAudioApi(int nativeApi) {
     }
 }
 
-class MyOboeOutputStream : public WaveFileOutputStream {
-public:
-    void write(uint8_t b) override {
-        mData.push_back(b);
-    }
-
-    int32_t length() {
-        return (int32_t) mData.size();
-    }
-
-    uint8_t *getData() {
-        return mData.data();
-    }
-
-private:
-    std::vector<uint8_t> mData;
-};
-
 bool ActivityContext::mUseCallback = true;
 bool ActivityContext::mUsePartialDataCallback = false;
 int  ActivityContext::callbackSize = 0;
@@ -336,31 +320,38 @@ int32_t  ActivityContext::saveWaveFile(const char *filename) {
         LOGW("ActivityContext::saveWaveFile(%s) but no frames!", filename);
         return -2;
     }
-    MyOboeOutputStream outStream;
+    FILE *file = fopen(filename, "wb");
+    if (file == nullptr) {
+        LOGW("ActivityContext::saveWaveFile(%s) could not open the file!", filename);
+        return -3;
+    }
+    WaveFileStdioStream outStream(file);
     WaveFileWriter writer(&outStream);
     // You must setup the format before the first write().
     writer.setFrameRate(mSampleRate);
     writer.setSamplesPerFrame(mRecording->getChannelCount());
     writer.setBitsPerSample(24);
     writer.setFrameCount(mRecording->getSizeInFrames());
-    std::vector<float> buffer(mRecording->getChannelCount());
+    constexpr int32_t kFramesPerRead = 1024;
+    std::vector<float> buffer(kFramesPerRead * mRecording->getChannelCount());
     // Read samples from start to finish.
     mRecording->rewind();
-    for (int32_t frameIndex = 0; frameIndex < mRecording->getSizeInFrames(); frameIndex++) {
-        mRecording->read(buffer.data(), 1 /* numFrames */);
-        for (int32_t i = 0; i < mRecording->getChannelCount(); i++) {
-            writer.write(buffer[i]);
-        }
+    int32_t framesLeft = mRecording->getSizeInFrames();
+    while (framesLeft > 0) {
+        int32_t framesRead = mRecording->read(buffer.data(),
+                                              std::min(framesLeft, kFramesPerRead));
+        if (framesRead <= 0) break;
+        writer.write(buffer.data(), framesRead * mRecording->getChannelCount());
+        framesLeft -= framesRead;
     }
     writer.close();
+    fclose(file);
 
-    if (outStream.length() > 0) {
-        auto myfile = std::ofstream(filename, std::ios::out | std::ios::binary);
-        myfile.write((char *) outStream.getData(), outStream.length());
-        myfile.close();
+    if (outStream.hasFailed()) {
+        LOGW("ActivityContext::saveWaveFile(%s) write failed!", filename);
+        return -4;
     }
-
-    return outStream.length();
+    return (int32_t) outStream.length();
 }
 
 double ActivityContext::getTimestampLatency(int32_t streamIndex) {
@@ -809,6 +800,40 @@ void ActivityFullDuplex::configureBuilder(bool isInput, oboe::AudioStreamBuilder
     }
 }
 
+int32_t ActivityFullDuplex::startDiskRecording(const char *filename) {
+    FullDuplexAnalyzer *analyzer = getFullDuplexAnalyzer();
+    if (analyzer == nullptr || mSampleRate <= 0) {
+        LOGW("ActivityFullDuplex::startDiskRecording(%s) but no streams!", filename);
+        return -1;
+    }
+    if (mDiskRecorder == nullptr) {
+        mDiskRecorder = std::make_unique<BackgroundWaveRecorder>(2, // output and input
+                SECONDS_DISK_FIFO * mSampleRate);
+    } else if (mDiskRecorder->isRunning()) {
+        return -2;
+    }
+    int32_t result = mDiskRecorder->start(filename, mSampleRate);
+    if (result == 0) {
+        analyzer->setDiskRecorder(mDiskRecorder.get());
+    }
+    return result;
+}
+
+int64_t ActivityFullDuplex::stopDiskRecording() {
+    if (mDiskRecorder == nullptr) {
+        return -1;
+    }
+    FullDuplexAnalyzer *analyzer = getFullDuplexAnalyzer();
+    if (analyzer != nullptr) {
+        analyzer->setDiskRecorder(nullptr);
+    }
+    int64_t result = mDiskRecorder->stop();
+    LOGI("ActivityFullDuplex::stopDiskRecording() wrote %lld frames, dropped %lld",
+         (long long) mDiskRecorder->getFramesWritten(),
+         (long long) mDiskRecorder->getOverrunFrames());
+    return result;
+}
+
 // ======================================================================= ActivityEcho
 void ActivityEcho::configureBuilder(bool isInput, oboe::AudioStreamBuilder &builder) {
     ActivityFullDuplex::configureBuilder(isInput, builder);
@@ -832,6 +857,30 @@ void ActivityEcho::finishOpen(bool isInput, std::shared_ptr<oboe::AudioStream> &
 }
 
 // ======================================================================= ActivityRoundTripLatency
+void ActivityRoundTripLatency::createLatencyAnalyzer() {
+    if (mStreamingEnabled) {
+        // Measures repeatedly in bounded memory.
+        mLatencyAnalyzer = std::make_unique<StreamingLatencyAnalyzer>();
+    } else {
+#if USE_WHITE_NOISE_ANALYZER
+        // New analyzer that uses a short pattern of white noise bursts.
+        mLatencyAnalyzer = std::make_unique<WhiteNoiseLatencyAnalyzer>();
+#else
+        // Old analyzer based on encoded random bits.
+        mLatencyAnalyzer = std::make_unique<EncodedRandomLatencyAnalyzer>();
+#endif
+    }
+    mLatencyAnalyzer->setup();
+}
+
+void ActivityRoundTripLatency::setStreamingEnabled(bool enabled) {
+    if (enabled == mStreamingEnabled) return;
+    mStreamingEnabled = enabled;
+    // The FullDuplexAnalyzer points to the old analyzer so make a new one when opening.
+    mFullDuplexLatency.reset();
+    createLatencyAnalyzer();
+}
+
 void ActivityRoundTripLatency::configureBuilder(bool isInput, oboe::AudioStreamBuilder &builder) {
     ActivityFullDuplex::configureBuilder(isInput, builder);
 
@@ -888,11 +937,37 @@ jdouble ActivityRoundTripLatency::measureTimestampLatency() {
 }
 
 // ======================================================================= ActivityGlitches
+void ActivityGlitches::setMultiChannelMask(uint32_t channelMask) {
+    if (channelMask == mMultiChannelMask) return;
+    mMultiChannelMask = channelMask;
+    mMultiChannelAnalyzer.setChannelMask(channelMask);
+    // The FullDuplexAnalyzer points to the old analyzer so make a new one when opening.
+    mFullDuplexGlitches.reset();
+}
+
+int32_t ActivityGlitches::getState() {
+    if (!isMultiChannelEnabled()) {
+        return mGlitchAnalyzer.getState();
+    }
+    // Report the states of GlitchActivity.java, LOCKED once every channel has locked.
+    constexpr int32_t kStateWaitingForLock = 3;
+    constexpr int32_t kStateLocked = 4;
+    for (int32_t index = 0; index < mMultiChannelAnalyzer.getNumChannels(); index++) {
+        if (!mMultiChannelAnalyzer.getChannelResult(index).locked) {
+            return kStateWaitingForLock;
+        }
+    }
+    return kStateLocked;
+}
+
 void ActivityGlitches::configureBuilder(bool isInput, oboe::AudioStreamBuilder &builder) {
     ActivityFullDuplex::configureBuilder(isInput, builder);
 
     if (mFullDuplexGlitches.get() == nullptr) {
-        mFullDuplexGlitches = std::make_unique<FullDuplexAnalyzer>(&mGlitchAnalyzer);
+        LoopbackProcessor *processor = isMultiChannelEnabled()
+                ? static_cast<LoopbackProcessor *>(&mMultiChannelAnalyzer)
+                : static_cast<LoopbackProcessor *>(&mGlitchAnalyzer);
+        mFullDuplexGlitches = std::make_unique<FullDuplexAnalyzer>(processor);
     }
     if (!isInput) {
         // only output uses a callback, input is polled
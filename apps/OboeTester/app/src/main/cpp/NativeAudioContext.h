@@ -54,6 +54,8 @@
 #include "analyzer/GlitchAnalyzer.h"
 #include "analyzer/DataPathAnalyzer.h"
 #include "analyzer/FrequencyAnalyzer.h"
+#include "analyzer/MultiChannelAnalyzer.h"
+#include "analyzer/StreamingLatencyAnalyzer.h"
 #include "InputStreamCallbackAnalyzer.h"
 #include "MultiChannelRecording.h"
 #include "NoisePulseGenerator.h"
@@ -78,6 +80,7 @@
 
 
 #define SECONDS_TO_RECORD        10
+#define SECONDS_DISK_FIFO        2
 
 /**
  * Abstract base class that corresponds to a test at the Java level.
@@ -325,6 +328,21 @@ public:
 
     virtual int32_t saveWaveFile(const char *filename);
 
+    /**
+     * Stream the recording to a WAV file while the test runs.
+     * @return 0 or a negative error
+     */
+    virtual int32_t startDiskRecording(const char *filename) {
+        return -1;
+    }
+
+    /**
+     * @return size of the WAV file in bytes or a negative error
+     */
+    virtual int64_t stopDiskRecording() {
+        return -1;
+    }
+
     virtual void setMinimumFramesBeforeRead(int32_t numFrames) {}
 
     static bool   mUseCallback;
@@ -602,6 +620,10 @@ public:
 
     virtual FullDuplexAnalyzer *getFullDuplexAnalyzer() = 0;
 
+    int32_t startDiskRecording(const char *filename) override;
+
+    int64_t stopDiskRecording() override;
+
     int32_t getResetCount() {
         auto analyzer = getFullDuplexAnalyzer();
         if (analyzer == nullptr) {
@@ -619,6 +641,10 @@ protected:
         mRecording = std::make_unique<MultiChannelRecording>(2, // output and input
                                                              SECONDS_TO_RECORD * mSampleRate);
     }
+
+private:
+    // Not freed when recording stops because the callback may still be using it.
+    std::unique_ptr<BackgroundWaveRecorder> mDiskRecorder{};
 };
 
 /**
@@ -660,18 +686,20 @@ private:
 class ActivityRoundTripLatency : public ActivityFullDuplex {
 public:
     ActivityRoundTripLatency() {
-#define USE_WHITE_NOISE_ANALYZER 1
-#if USE_WHITE_NOISE_ANALYZER
-        // New analyzer that uses a short pattern of white noise bursts.
-        mLatencyAnalyzer = std::make_unique<WhiteNoiseLatencyAnalyzer>();
-#else
-        // Old analyzer based on encoded random bits.
-        mLatencyAnalyzer = std::make_unique<EncodedRandomLatencyAnalyzer>();
-#endif
-        mLatencyAnalyzer->setup();
+        createLatencyAnalyzer();
     }
     virtual ~ActivityRoundTripLatency() = default;
 
+    /**
+     * Measure once per period, for as long as the streams run, instead of once per test.
+     * This uses StreamingLatencyAnalyzer. Only call this while the streams are closed.
+     */
+    void setStreamingEnabled(bool enabled);
+
+    bool isStreamingEnabled() const {
+        return mStreamingEnabled;
+    }
+
     oboe::Result startStreams() override {
         mAnalyzerLaunched = false;
         return mFullDuplexLatency->start();
@@ -692,6 +720,9 @@ public:
     }
 
     bool isAnalyzerDone() override {
+        if (mStreamingEnabled) {
+            return false; // runs until the streams are stopped
+        }
         if (!mAnalyzerLaunched) {
             mAnalyzerLaunched = launchAnalysisIfReady();
         }
@@ -723,10 +754,13 @@ protected:
     void finishOpen(bool isInput, std::shared_ptr<oboe::AudioStream> &oboeStream) override;
 
 private:
+    void createLatencyAnalyzer();
+
     std::unique_ptr<FullDuplexAnalyzer>   mFullDuplexLatency{};
 
     std::unique_ptr<LatencyAnalyzer>  mLatencyAnalyzer;
     bool                              mAnalyzerLaunched = false;
+    bool                              mStreamingEnabled = false;
 };
 
 /**
@@ -745,15 +779,37 @@ public:
         return &mGlitchAnalyzer;
     }
 
-    int32_t getState() override {
-        return getGlitchAnalyzer()->getState();
+    /**
+     * Check every channel in the mask at the same time with MultiChannelAnalyzer,
+     * instead of one channel with GlitchAnalyzer. Pass 0 to use GlitchAnalyzer.
+     * Only call this while the streams are closed.
+     */
+    void setMultiChannelMask(uint32_t channelMask);
+
+    bool isMultiChannelEnabled() const {
+        return mMultiChannelMask != 0;
+    }
+
+    MultiChannelAnalyzer *getMultiChannelAnalyzer() {
+        return &mMultiChannelAnalyzer;
     }
 
+    int32_t getGlitchCount() {
+        return isMultiChannelEnabled() ? mMultiChannelAnalyzer.getGlitchCount()
+                                       : mGlitchAnalyzer.getGlitchCount();
+    }
+
+    int32_t getState() override;
+
     int32_t getResult() override {
-        return getGlitchAnalyzer()->getResult();
+        return isMultiChannelEnabled() ? mMultiChannelAnalyzer.getResult()
+                                       : mGlitchAnalyzer.getResult();
     }
 
     bool isAnalyzerDone() override {
+        if (isMultiChannelEnabled()) {
+            return false; // runs until the streams are stopped
+        }
         return mGlitchAnalyzer.isDone();
     }
 
@@ -767,6 +823,8 @@ protected:
 private:
     std::unique_ptr<FullDuplexAnalyzer>   mFullDuplexGlitches{};
     GlitchAnalyzer  mGlitchAnalyzer;
+    MultiChannelAnalyzer  mMultiChannelAnalyzer;
+    uint32_t        mMultiChannelMask = 0;
 };
 
 /**
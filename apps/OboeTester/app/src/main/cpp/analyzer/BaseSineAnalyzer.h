@@ -109,6 +109,32 @@ public:
         }
     }
 
+    // Advance a phase by numFrames increments and wrap it to between -PI and +PI.
+    static double advancePhase(double phase, double increment, int32_t numFrames) {
+        phase += increment * numFrames;
+        return phase - (2.0 * M_PI) * floor((phase + M_PI) / (2.0 * M_PI));
+    }
+
+    /**
+     * Fill arrays with the sin() and cos() of a phase that advances by a fixed increment.
+     * This uses a recursive oscillator, so sin() and cos() are only called once per block.
+     * The error after kBlockFrames rotations is far below float resolution.
+     */
+    static void generateSineCosine(double phase, double increment, int32_t numFrames,
+                                   double *sinOut, double *cosOut) {
+        const double sinIncrement = sin(increment);
+        const double cosIncrement = cos(increment);
+        double sinPhase = sin(phase);
+        double cosPhase = cos(phase);
+        for (int32_t i = 0; i < numFrames; i++) {
+            sinOut[i] = sinPhase;
+            cosOut[i] = cosPhase;
+            const double nextSin = (sinPhase * cosIncrement) + (cosPhase * sinIncrement);
+            cosPhase = (cosPhase * cosIncrement) - (sinPhase * sinIncrement);
+            sinPhase = nextSin;
+        }
+    }
+
     void incrementMultiTonePhases() {
         for (size_t i = 0; i < mMultiTonePhases.size(); i++) {
             mMultiTonePhases[i] += mMultiTonePhaseIncrements[i];
@@ -172,6 +198,35 @@ public:
         return RESULT_OK;
     }
 
+    /**
+     * Generate a block of output frames.
+     * The steady sine wave is generated a block at a time. Other signals use processOutputFrame().
+     */
+    result_code processOutputFrames(float *outputData, int channelCount, int numFrames) {
+        if (mSignalType != Sine || !isOutputEnabled()) {
+            for (int i = 0; i < numFrames; i++) {
+                processOutputFrame(outputData, channelCount);
+                outputData += channelCount;
+            }
+            return RESULT_OK;
+        }
+        while (numFrames > 0) {
+            const int32_t framesToDo = std::min(numFrames, kBlockFrames);
+            generateSineCosine(mOutputPhase, mPhaseIncrement, framesToDo, mBlockSin, mBlockCos);
+            mOutputPhase = advancePhase(mOutputPhase, mPhaseIncrement, framesToDo);
+            for (int32_t frame = 0; frame < framesToDo; frame++) {
+                float output = (mBlockSin[frame] * mOutputAmplitude)
+                        + (mWhiteNoise.nextRandomDouble() * getNoiseAmplitude());
+                for (int i = 0; i < channelCount; i++) {
+                    outputData[i] = (i == getOutputChannel()) ? output : 0.0f;
+                }
+                outputData += channelCount;
+            }
+            numFrames -= framesToDo;
+        }
+        return RESULT_OK;
+    }
+
     /**
      * Calculate the magnitude of the component of the input signal
      * that matches the analysis frequency.
@@ -221,22 +276,30 @@ public:
         mFramesAccumulated++;
         // Must be a multiple of the period or the calculation will not be accurate.
         if (mFramesAccumulated == mSinePeriod) {
-            const double coefficient = 0.1;
-            double magnitude = calculateMagnitudePhase(&mPhaseOffset);
-
-            ALOGD("%s(), magnitude = %f, phaseOffset = %f\n", __func__,
-                  magnitude, mPhaseOffset);
-            if (mPhaseOffset != kPhaseInvalid) {
-                // One pole averaging filter for magnitude.
-                setMagnitude((mMagnitude * (1.0 - coefficient)) + (magnitude * coefficient));
-            }
-            resetAccumulator();
+            updateMagnitudePhase();
             return true;
         } else {
             return false;
         }
     }
 
+    /**
+     * Called when a full sine period has been accumulated.
+     * Updates mPhaseOffset and the averaged magnitude, then resets the accumulator.
+     */
+    void updateMagnitudePhase() {
+        const double coefficient = 0.1;
+        double magnitude = calculateMagnitudePhase(&mPhaseOffset);
+
+        ALOGD("%s(), magnitude = %f, phaseOffset = %f\n", __func__,
+              magnitude, mPhaseOffset);
+        if (mPhaseOffset != kPhaseInvalid) {
+            // One pole averaging filter for magnitude.
+            setMagnitude((mMagnitude * (1.0 - coefficient)) + (magnitude * coefficient));
+        }
+        resetAccumulator();
+    }
+
     // reset the sine wave detector
     virtual void resetAccumulator() {
         mFramesAccumulated = 0;
@@ -283,6 +346,9 @@ protected:
     // Multi-tone constants
     static constexpr double sMultiToneFrequencies[] = {401.0, 601.0, 1009.0, 1409.0, 2203.0};
 
+    // Maximum number of frames generated or analyzed together.
+    static constexpr int32_t kBlockFrames = 256;
+
     SignalType mSignalType = Sine;
     int32_t mFrameCounter = 0;
 
@@ -324,6 +390,10 @@ protected:
 
     InfiniteRecording<float> mInfiniteRecording;
 
+    // Oscillator output for one block.
+    double  mBlockSin[kBlockFrames];
+    double  mBlockCos[kBlockFrames];
+
 private:
     float   mTolerance = 0.10; // scaled from 0.0 to 1.0
 
@@ -17,7 +17,6 @@
 #include "DataPathAnalyzer.h"
 #include <sstream>
 #include <iomanip>
-#include "fft.h"
 
 double DataPathAnalyzer::calculatePhaseError(double p1, double p2) {
     double diff = p1 - p2;
@@ -48,12 +47,11 @@ BaseSineAnalyzer::result_code DataPathAnalyzer::processInputFrame(const float *f
                 report << "Chirp analysis (peak frequency per window):\n";
 
                 std::vector<double> peakFreqs;
+                mFftData.resize(mFftBufferSize);
                 for (int i = 0; i + mSpectrogramWindowSize <= mFftBufferSize; i += mSpectrogramHopSize) {
-                    CVector fftInput(mSpectrogramWindowSize);
-                    for (int j = 0; j < mSpectrogramWindowSize; j++) {
-                        fftInput[j] = Complex(mFftBuffer[i + j], 0);
-                    }
-                    fft(fftInput);
+                    std::copy(mFftBuffer.begin() + i, mFftBuffer.begin() + i + mSpectrogramWindowSize,
+                              mFftData.begin());
+                    mSpectrogramFft.forward(mFftData.data());
 
                     double maxMag = 0;
                     int peakBin = 0;
@@ -69,7 +67,8 @@ BaseSineAnalyzer::result_code DataPathAnalyzer::processInputFrame(const float *f
                     int endBin = std::min(mSpectrogramWindowSize / 2, expectedBin + searchRadius);
 
                     for (int k = startBin; k < endBin; k++) {
-                        double mag = std::abs(fftInput[k]);
+                        double mag = RealFft<double>::magnitude(mFftData.data(),
+                                                                mSpectrogramWindowSize, k);
                         if (mag > maxMag) {
                             maxMag = mag;
                             peakBin = k;
@@ -110,11 +109,8 @@ BaseSineAnalyzer::result_code DataPathAnalyzer::processInputFrame(const float *f
             mFftBuffer[mFftBufferIndex++] = sample;
             if (mFftBufferIndex >= mFftBufferSize) {
                 // Perform FFT
-                CVector fftInput(mFftBufferSize);
-                for (int i = 0; i < mFftBufferSize; i++) {
-                    fftInput[i] = Complex(mFftBuffer[i], 0);
-                }
-                fft(fftInput);
+                mFftData.assign(mFftBuffer.begin(), mFftBuffer.end());
+                mFft.forward(mFftData.data());
 
                 // Analyze FFT output
                 double signalPower = 0;
@@ -127,7 +123,7 @@ BaseSineAnalyzer::result_code DataPathAnalyzer::processInputFrame(const float *f
                 }
 
                 for (int i = 1; i < mFftBufferSize / 2; i++) {
-                    double power = std::norm(fftInput[i]);
+                    double power = RealFft<double>::power(mFftData.data(), mFftBufferSize, i);
                     bool isSignal = false;
                     for (int j = 0; j < numTones; j++) {
                         if (i >= bins[j] - 1 && i <= bins[j] + 1) {
@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include "BaseSineAnalyzer.h"
+#include "RealFft.h"
 
 class DataPathAnalyzer : public BaseSineAnalyzer {
 public:
@@ -52,6 +53,8 @@ private:
     // For multi-tone analysis
     std::vector<float> mFftBuffer;
     int mFftBufferSize = 4096;
+    RealFft<double> mFft{mFftBufferSize};
+    std::vector<double> mFftData; // transformed in place, shared with the chirp analysis
     int mFftBufferIndex = 0;
     long mFftBufferStartFrame = 0;
     std::string mDistortionReport;
@@ -60,6 +63,7 @@ private:
     // For chirp analysis
     std::vector<float> mSpectrogramBuffer;
     int mSpectrogramWindowSize = 1024;
+    RealFft<double> mSpectrogramFft{mSpectrogramWindowSize};
     int mSpectrogramHopSize = 512;
 
     // For analysis result
@@ -30,6 +30,7 @@ FrequencyAnalyzer::FrequencyAnalyzer() : LoopbackProcessor() {
     mInputBuffer.resize(WINDOW_SIZE);
     mAverageBuffer.resize(WINDOW_SIZE / 2);
     mFftThreadInput.resize(WINDOW_SIZE);
+    mFftThreadMagnitudes.resize(WINDOW_SIZE / 2);
 
     mInputBufferIndex = 0;
     mFramesAccumulated = 0;
@@ -99,8 +100,7 @@ LoopbackProcessor::result_code FrequencyAnalyzer::processInputFrame(const float*
         // Set data for FFT thread
         std::lock_guard<std::mutex> lock(mFftThreadLock);
         for (int i = 0; i < WINDOW_SIZE; i++) {
-            double windowed = mInputBuffer[i] * mWindow[i];
-            mFftThreadInput[i] = Complex(windowed, 0);
+            mFftThreadInput[i] = mInputBuffer[i] * mWindow[i];
         }
         mFftThreadFlag = FFT_THREAD_READY;
         mFftThreadCond.notify_one();
@@ -119,21 +119,20 @@ void FrequencyAnalyzer::fftThreadFunction() {
         mFftThreadCond.wait(lock, [&] () { return mFftThreadFlag != FFT_THREAD_WAITTING;});
 
         if (mFftThreadFlag == FFT_THREAD_READY) {
-            fft(mFftThreadInput);
+            mFft.forward(mFftThreadInput.data());
             // Accumulate magnitude
-            std::vector<double> currentMagnitudes(WINDOW_SIZE / 2);
             for (int i = 0; i < WINDOW_SIZE / 2; i++) {
-                double mag;
+                double mag = RealFft<double>::magnitude(mFftThreadInput.data(), WINDOW_SIZE, i);
                 if (mSignalType == 1) { // Sine
-                    mag = 2.0 * std::abs(mFftThreadInput[i]) / mWindowSum;
+                    mag = 2.0 * mag / mWindowSum;
                 } else {
-                    mag = 4.0 * std::abs(mFftThreadInput[i]) / std::sqrt(mIncoherentPower);
+                    mag = 4.0 * mag / std::sqrt(mIncoherentPower);
                 }
                 if (mag < 1e-9) mag = 1e-9; // to prevent log(0)
-                currentMagnitudes[i] = mag;
+                mFftThreadMagnitudes[i] = mag;
             }
-            mAverageBuffer.accumulate(currentMagnitudes.data(),
-                                      currentMagnitudes.size());
+            mAverageBuffer.accumulate(mFftThreadMagnitudes.data(),
+                                      mFftThreadMagnitudes.size());
             mFramesAccumulated += WINDOW_SIZE;
             if (mFramesAccumulated >= mMeasurementWindowFrames) {
                 LOGD("Fft thread is exporting the result");
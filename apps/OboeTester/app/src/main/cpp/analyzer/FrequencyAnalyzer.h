@@ -26,7 +26,7 @@
 #include "LatencyAnalyzer.h"
 #include "PseudoRandom.h"
 #include "AverageBuffer.h"
-#include "fft.h"
+#include "RealFft.h"
 
 /**
  * Analyze frequency response by playing a stimulus and measuring the input.
@@ -83,7 +83,9 @@ private:
     std::unique_ptr<std::thread> mFftThread;
     std::condition_variable mFftThreadCond;
     int mFftThreadFlag;
-    CVector mFftThreadInput;
+    std::vector<double> mFftThreadInput; // transformed in place
+    std::vector<double> mFftThreadMagnitudes;
+    RealFft<double> mFft{WINDOW_SIZE};
 
     void fftThreadFunction();
     void joinFftThread();
@@ -124,164 +124,45 @@ public:
         ALOGD("st = %d, #gl = %3d,", mState, mGlitchCount);
     }
 
+    /**
+     * Until the sine wave starts, the output depends on the input state frame by frame.
+     * After that the input and output are independent, so whole blocks are processed.
+     */
+    void process(const float *inputData, int inputChannelCount, int numInputFrames,
+                 float *outputData, int outputChannelCount, int numOutputFrames) override {
+        if (mState == STATE_IDLE) {
+            BaseSineAnalyzer::process(inputData, inputChannelCount, numInputFrames,
+                                      outputData, outputChannelCount, numOutputFrames);
+            return;
+        }
+        processInputFrames(inputData, inputChannelCount, numInputFrames);
+        processOutputFrames(outputData, outputChannelCount, numOutputFrames);
+    }
+
     /**
      * @param frameData contains microphone data with sine signal feedback
      * @param channelCount
      */
-    result_code processInputFrame(const float *frameData, int /* channelCount */) override {
-        result_code result = RESULT_OK;
-
-        float sample = frameData[getInputChannel()];
+    result_code processInputFrame(const float *frameData, int channelCount) override {
+        return processInputFrames(frameData, channelCount, 1);
+    }
 
-        // Force a periodic glitch to test the detector!
-        if (mForceGlitchDurationFrames > 0) {
-            if (mForceGlitchCounter == 0) {
-                ALOGE("%s: finish a glitch!!", __func__);
-                mForceGlitchCounter = kForceGlitchPeriod;
-            } else if (mForceGlitchCounter <= mForceGlitchDurationFrames) {
-                // Force an abrupt offset.
-                sample += (sample > 0.0) ? -kForceGlitchOffset : kForceGlitchOffset;
+    /**
+     * Analyze a block of input. This gives the same result as one frame at a time.
+     * @param inputData contains microphone data with sine signal feedback
+     * @param channelCount
+     * @param numFrames
+     */
+    result_code processInputFrames(const float *inputData, int channelCount, int numFrames) {
+        result_code result = RESULT_OK;
+        while (numFrames > 0) {
+            const int32_t framesToDo = std::min(numFrames, kBlockFrames);
+            if (processInputBlock(inputData, channelCount, framesToDo) != RESULT_OK) {
+                result = ERROR_GLITCHES;
             }
-            --mForceGlitchCounter;
+            inputData += framesToDo * channelCount;
+            numFrames -= framesToDo;
         }
-
-        float peak = mPeakFollower.process(sample);
-        mInfiniteRecording.write(sample);
-
-        mStateFrameCounters[mState]++; // count how many frames we are in each state
-
-        switch (mState) {
-            case STATE_IDLE:
-                mDownCounter--;
-                if (mDownCounter <= 0) {
-                    mState = STATE_IMMUNE;
-                    mDownCounter = IMMUNE_FRAME_COUNT;
-                    mInputPhase = 0.0; // prevent spike at start
-                    mOutputPhase = 0.0;
-                    resetAccumulator();
-                }
-                break;
-
-            case STATE_IMMUNE:
-                mDownCounter--;
-                if (mDownCounter <= 0) {
-                    mState = STATE_WAITING_FOR_SIGNAL;
-                }
-                break;
-
-            case STATE_WAITING_FOR_SIGNAL:
-                if (peak > mThreshold) {
-                    mState = STATE_WAITING_FOR_LOCK;
-                    //ALOGD("%5d: switch to STATE_WAITING_FOR_LOCK", mFrameCounter);
-                    resetAccumulator();
-                }
-                break;
-
-            case STATE_WAITING_FOR_LOCK:
-                mSinAccumulator += static_cast<double>(sample) * sinf(mInputPhase);
-                mCosAccumulator += static_cast<double>(sample) * cosf(mInputPhase);
-                mFramesAccumulated++;
-                // Must be a multiple of the period or the calculation will not be accurate.
-                if (mFramesAccumulated == mSinePeriod * PERIODS_NEEDED_FOR_LOCK) {
-                    double magnitude = calculateMagnitudePhase(&mPhaseOffset);
-                    if (mPhaseOffset != kPhaseInvalid) {
-                        setMagnitude(magnitude);
-                        ALOGD("%s() mag = %f, mPhaseOffset = %f",
-                              __func__, magnitude, mPhaseOffset);
-                        if (mMagnitude > mThreshold) {
-                            if (fabs(mPhaseOffset) < kMaxPhaseError) {
-                                mState = STATE_LOCKED;
-                                mConsecutiveBadFrames = 0;
-//                            ALOGD("%5d: switch to STATE_LOCKED", mFrameCounter);
-                            }
-                            // Adjust mInputPhase to match measured phase
-                            mInputPhase += mPhaseOffset;
-                        }
-                    }
-                    resetAccumulator();
-                }
-                incrementInputPhase();
-                break;
-
-            case STATE_LOCKED: {
-                // Predict next sine value
-                double predicted = sinf(mInputPhase) * mMagnitude;
-                double diff = predicted - sample;
-                double absDiff = fabs(diff);
-                mMaxGlitchDelta = std::max(mMaxGlitchDelta, absDiff);
-                if (absDiff > mScaledTolerance) { // bad frame
-                    mConsecutiveBadFrames++;
-                    mConsecutiveGoodFrames = 0;
-                    LOGI("diff glitch frame #%d detected, absDiff = %g > %g",
-                         mConsecutiveBadFrames, absDiff, mScaledTolerance);
-                    if (mConsecutiveBadFrames > 0) {
-                        result = ERROR_GLITCHES;
-                        onGlitchStart();
-                    }
-                    resetAccumulator();
-                } else { // good frame
-                    mConsecutiveBadFrames = 0;
-                    mConsecutiveGoodFrames++;
-
-                    mSumSquareSignal += predicted * predicted;
-                    mSumSquareNoise += diff * diff;
-
-                    // Track incoming signal and slowly adjust magnitude to account
-                    // for drift in the DRC or AGC.
-                    // Must be a multiple of the period or the calculation will not be accurate.
-                    if (transformSample(sample)) {
-                        // Adjust phase to account for sample rate drift.
-                        mInputPhase += mPhaseOffset;
-
-                        mMeanSquareNoise = mSumSquareNoise * mInverseSinePeriod;
-                        mMeanSquareSignal = mSumSquareSignal * mInverseSinePeriod;
-                        mSumSquareNoise = 0.0;
-                        mSumSquareSignal = 0.0;
-
-                        if (fabs(mPhaseOffset) > kMaxPhaseError) {
-                            result = ERROR_GLITCHES;
-                            onGlitchStart();
-                            ALOGD("phase glitch detected, phaseOffset = %g", mPhaseOffset);
-                        } else if (mMagnitude < mThreshold) {
-                            result = ERROR_GLITCHES;
-                            onGlitchStart();
-                            ALOGD("magnitude glitch detected, mMagnitude = %g", mMagnitude);
-                        }
-                    }
-                }
-            } break;
-
-            case STATE_GLITCHING: {
-                // Predict next sine value
-                double predicted = sinf(mInputPhase) * mMagnitude;
-                double diff = predicted - sample;
-                double absDiff = fabs(diff);
-                mMaxGlitchDelta = std::max(mMaxGlitchDelta, absDiff);
-                if (absDiff > mScaledTolerance) { // bad frame
-                    mConsecutiveBadFrames++;
-                    mConsecutiveGoodFrames = 0;
-                    mGlitchLength++;
-                    if (mGlitchLength > maxMeasurableGlitchLength()) {
-                        onGlitchTerminated();
-                    }
-                } else { // good frame
-                    mConsecutiveBadFrames = 0;
-                    mConsecutiveGoodFrames++;
-                    // If we get a full sine period of good samples in a row then consider the glitch over.
-                    // We don't want to just consider a zero crossing the end of a glitch.
-                    if (mConsecutiveGoodFrames > mSinePeriod) {
-                        onGlitchEnd();
-                    }
-                }
-                incrementInputPhase();
-            } break;
-
-            case NUM_STATES: // not a real state
-                break;
-        }
-
-        mFrameCounter++;
-
         return result;
     }
 
@@ -289,10 +170,13 @@ public:
 
     bool isOutputEnabled() override { return mState != STATE_IDLE; }
 
-    void onGlitchStart() {
+    /**
+     * @param position number of samples recorded up to and including the first bad one
+     */
+    void onGlitchStart(int64_t position) {
         mState = STATE_GLITCHING;
         mGlitchLength = 1;
-        mLastGlitchPosition = mInfiniteRecording.getTotalWritten();
+        mLastGlitchPosition = position;
         ALOGD("%5d: STARTED a glitch # %d, pos = %5d",
               mFrameCounter, mGlitchCount, (int)mLastGlitchPosition);
         ALOGD("glitch mSinePeriod = %d", mSinePeriod);
@@ -384,6 +268,243 @@ private:
 
     static constexpr double kMaxPhaseError = M_PI * 0.05;
 
+    result_code processInputBlock(const float *inputData, int channelCount, int32_t numFrames) {
+        // Everything before the state machine does not depend on the state.
+        mBlockStartPosition = mInfiniteRecording.getTotalWritten();
+        for (int32_t i = 0; i < numFrames; i++) {
+            float sample = inputData[i * channelCount + getInputChannel()];
+
+            // Force a periodic glitch to test the detector!
+            if (mForceGlitchDurationFrames > 0) {
+                if (mForceGlitchCounter == 0) {
+                    ALOGE("%s: finish a glitch!!", __func__);
+                    mForceGlitchCounter = kForceGlitchPeriod;
+                } else if (mForceGlitchCounter <= mForceGlitchDurationFrames) {
+                    // Force an abrupt offset.
+                    sample += (sample > 0.0) ? -kForceGlitchOffset : kForceGlitchOffset;
+                }
+                --mForceGlitchCounter;
+            }
+
+            mBlockInput[i] = sample;
+            mBlockPeak[i] = mPeakFollower.process(sample);
+        }
+        mInfiniteRecording.write(mBlockInput, numFrames);
+
+        // Run the state machine over spans of frames that share a state.
+        result_code result = RESULT_OK;
+        int32_t frame = 0;
+        while (frame < numFrames) {
+            const sine_state_t state = mState;
+            const int32_t framesLeft = numFrames - frame;
+            int32_t framesDone = framesLeft;
+            switch (state) {
+                case STATE_IDLE:
+                    framesDone = std::min(framesLeft, std::max(1, mDownCounter));
+                    mDownCounter -= framesDone;
+                    if (mDownCounter <= 0) {
+                        mState = STATE_IMMUNE;
+                        mDownCounter = IMMUNE_FRAME_COUNT;
+                        mInputPhase = 0.0; // prevent spike at start
+                        mOutputPhase = 0.0;
+                        resetAccumulator();
+                    }
+                    break;
+
+                case STATE_IMMUNE:
+                    framesDone = std::min(framesLeft, std::max(1, mDownCounter));
+                    mDownCounter -= framesDone;
+                    if (mDownCounter <= 0) {
+                        mState = STATE_WAITING_FOR_SIGNAL;
+                    }
+                    break;
+
+                case STATE_WAITING_FOR_SIGNAL:
+                    for (int32_t i = 0; i < framesLeft; i++) {
+                        if (mBlockPeak[frame + i] > mThreshold) {
+                            mState = STATE_WAITING_FOR_LOCK;
+                            resetAccumulator();
+                            framesDone = i + 1;
+                            break;
+                        }
+                    }
+                    break;
+
+                case STATE_WAITING_FOR_LOCK:
+                    framesDone = waitForLock(frame, framesLeft);
+                    break;
+
+                case STATE_LOCKED:
+                    framesDone = trackLockedSine(frame, framesLeft);
+                    if (mState != STATE_LOCKED) {
+                        result = ERROR_GLITCHES;
+                    }
+                    break;
+
+                case STATE_GLITCHING:
+                    framesDone = trackGlitch(frame, framesLeft);
+                    break;
+
+                case NUM_STATES: // not a real state
+                    break;
+            }
+            mStateFrameCounters[state] += framesDone; // count how many frames we are in each state
+            mFrameCounter += framesDone;
+            frame += framesDone;
+        }
+        return result;
+    }
+
+    // Measure the magnitude and phase over PERIODS_NEEDED_FOR_LOCK periods.
+    int32_t waitForLock(int32_t frame, int32_t framesLeft) {
+        const int32_t framesNeeded = (mSinePeriod * PERIODS_NEEDED_FOR_LOCK) - mFramesAccumulated;
+        const int32_t framesDone = std::min(framesLeft, framesNeeded);
+        generateSineCosine(mInputPhase, mPhaseIncrement, framesDone, mBlockSin, mBlockCos);
+        const float *input = &mBlockInput[frame];
+        double sinSum = 0.0;
+        double cosSum = 0.0;
+        for (int32_t i = 0; i < framesDone; i++) {
+            sinSum += input[i] * mBlockSin[i];
+            cosSum += input[i] * mBlockCos[i];
+        }
+        mSinAccumulator += sinSum;
+        mCosAccumulator += cosSum;
+        mFramesAccumulated += framesDone;
+        mInputPhase = advancePhase(mInputPhase, mPhaseIncrement, framesDone);
+
+        // Must be a multiple of the period or the calculation will not be accurate.
+        if (mFramesAccumulated == mSinePeriod * PERIODS_NEEDED_FOR_LOCK) {
+            double magnitude = calculateMagnitudePhase(&mPhaseOffset);
+            if (mPhaseOffset != kPhaseInvalid) {
+                setMagnitude(magnitude);
+                ALOGD("%s() mag = %f, mPhaseOffset = %f",
+                      __func__, magnitude, mPhaseOffset);
+                if (mMagnitude > mThreshold) {
+                    if (fabs(mPhaseOffset) < kMaxPhaseError) {
+                        mState = STATE_LOCKED;
+                        mConsecutiveBadFrames = 0;
+                    }
+                    // Adjust mInputPhase to match measured phase
+                    mInputPhase += mPhaseOffset;
+                }
+            }
+            resetAccumulator();
+        }
+        return framesDone;
+    }
+
+    // Compare the input with the predicted sine, up to the end of the current sine period.
+    int32_t trackLockedSine(int32_t frame, int32_t framesLeft) {
+        const int32_t framesDone = std::min(framesLeft, mSinePeriod - mFramesAccumulated);
+        generateSineCosine(mInputPhase, mPhaseIncrement, framesDone, mBlockSin, mBlockCos);
+        const float *input = &mBlockInput[frame];
+
+        // Find the first bad frame, if any.
+        int32_t numGood = framesDone;
+        double maxDelta = mMaxGlitchDelta;
+        for (int32_t i = 0; i < framesDone; i++) {
+            const double absDiff = fabs((mBlockSin[i] * mMagnitude) - input[i]);
+            maxDelta = std::max(maxDelta, absDiff);
+            if (absDiff > mScaledTolerance) {
+                numGood = i;
+                break;
+            }
+        }
+        mMaxGlitchDelta = maxDelta;
+
+        // Accumulate the good frames.
+        double sumSquareSignal = 0.0;
+        double sumSquareNoise = 0.0;
+        double sinSum = 0.0;
+        double cosSum = 0.0;
+        for (int32_t i = 0; i < numGood; i++) {
+            const double predicted = mBlockSin[i] * mMagnitude;
+            const double diff = predicted - input[i];
+            sumSquareSignal += predicted * predicted;
+            sumSquareNoise += diff * diff;
+            sinSum += input[i] * mBlockSin[i];
+            cosSum += input[i] * mBlockCos[i];
+        }
+        mSumSquareSignal += sumSquareSignal;
+        mSumSquareNoise += sumSquareNoise;
+        mSinAccumulator += sinSum;
+        mCosAccumulator += cosSum;
+        mFramesAccumulated += numGood;
+        mInputPhase = advancePhase(mInputPhase, mPhaseIncrement, numGood);
+        if (numGood > 0) {
+            mConsecutiveBadFrames = 0;
+            mConsecutiveGoodFrames += numGood;
+        }
+
+        if (numGood < framesDone) { // bad frame
+            mConsecutiveBadFrames++;
+            mConsecutiveGoodFrames = 0;
+            LOGI("diff glitch frame #%d detected, absDiff = %g > %g",
+                 mConsecutiveBadFrames,
+                 fabs((mBlockSin[numGood] * mMagnitude) - input[numGood]), mScaledTolerance);
+            onGlitchStart(mBlockStartPosition + frame + numGood + 1);
+            resetAccumulator();
+            return numGood + 1;
+        }
+
+        // Track incoming signal and slowly adjust magnitude to account
+        // for drift in the DRC or AGC.
+        // Must be a multiple of the period or the calculation will not be accurate.
+        if (mFramesAccumulated == mSinePeriod) {
+            updateMagnitudePhase();
+            // Adjust phase to account for sample rate drift.
+            mInputPhase += mPhaseOffset;
+
+            mMeanSquareNoise = mSumSquareNoise * mInverseSinePeriod;
+            mMeanSquareSignal = mSumSquareSignal * mInverseSinePeriod;
+            mSumSquareNoise = 0.0;
+            mSumSquareSignal = 0.0;
+
+            if (fabs(mPhaseOffset) > kMaxPhaseError) {
+                onGlitchStart(mBlockStartPosition + frame + framesDone);
+                ALOGD("phase glitch detected, phaseOffset = %g", mPhaseOffset);
+            } else if (mMagnitude < mThreshold) {
+                onGlitchStart(mBlockStartPosition + frame + framesDone);
+                ALOGD("magnitude glitch detected, mMagnitude = %g", mMagnitude);
+            }
+        }
+        return framesDone;
+    }
+
+    // Wait for a full sine period of good frames, or give up.
+    int32_t trackGlitch(int32_t frame, int32_t framesLeft) {
+        generateSineCosine(mInputPhase, mPhaseIncrement, framesLeft, mBlockSin, mBlockCos);
+        const float *input = &mBlockInput[frame];
+        int32_t framesDone = framesLeft;
+        for (int32_t i = 0; i < framesLeft; i++) {
+            const double absDiff = fabs((mBlockSin[i] * mMagnitude) - input[i]);
+            mMaxGlitchDelta = std::max(mMaxGlitchDelta, absDiff);
+            if (absDiff > mScaledTolerance) { // bad frame
+                mConsecutiveBadFrames++;
+                mConsecutiveGoodFrames = 0;
+                mGlitchLength++;
+                if (mGlitchLength > maxMeasurableGlitchLength()) {
+                    onGlitchTerminated();
+                    framesDone = i + 1;
+                    break;
+                }
+            } else { // good frame
+                mConsecutiveBadFrames = 0;
+                mConsecutiveGoodFrames++;
+                // If we get a full sine period of good samples in a row then consider the glitch over.
+                // We don't want to just consider a zero crossing the end of a glitch.
+                if (mConsecutiveGoodFrames > mSinePeriod) {
+                    onGlitchEnd();
+                    framesDone = i + 1;
+                    break;
+                }
+            }
+        }
+        mInputPhase = advancePhase(mInputPhase, mPhaseIncrement, framesDone);
+        return framesDone;
+    }
+
+
     double  mThreshold = 0.005;
 
     int32_t mStateFrameCounters[NUM_STATES];
@@ -410,6 +531,11 @@ private:
     double  mMeanSquareNoise = 0.0;
 
     PeakDetector  mPeakFollower;
+
+    // Input for one block, with any forced glitch, and its peak envelope.
+    float         mBlockInput[kBlockFrames];
+    double        mBlockPeak[kBlockFrames];
+    int64_t       mBlockStartPosition = 0;
 };
 
 
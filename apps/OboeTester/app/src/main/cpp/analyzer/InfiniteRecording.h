@@ -17,6 +17,8 @@
 #ifndef OBOETESTER_INFINITE_RECORDING_H
 #define OBOETESTER_INFINITE_RECORDING_H
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <unistd.h>
 
@@ -56,6 +58,19 @@ public:
         mWritten++;
     }
 
+    // Write a block of samples. Readers see the new total once, after the whole block.
+    void write(const T *buffer, size_t count) {
+        const size_t position = mWritten.load();
+        count = std::min(count, mMaxSamples);
+        const size_t offset = position % mMaxSamples;
+        const size_t firstWriteSize = std::min(count, mMaxSamples - offset); // till end
+        std::copy(buffer, buffer + firstWriteSize, &mData[offset]);
+        if (firstWriteSize < count) {
+            std::copy(buffer + firstWriteSize, buffer + count, &mData[0]);
+        }
+        mWritten.store(position + count);
+    }
+
     int64_t getTotalWritten() {
         return mWritten.load();
     }
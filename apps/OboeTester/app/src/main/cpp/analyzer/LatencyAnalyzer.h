@@ -40,6 +40,7 @@
 #include "PeakDetector.h"
 #include "PseudoRandom.h"
 #include "RandomPulseGenerator.h"
+#include "RealFft.h"
 
 // This is used when the code is in not in Android.
 #ifndef ALOGD
@@ -50,7 +51,7 @@
 
 #define LOOPBACK_RESULT_TAG  "RESULT: "
 
-// Enable or disable the optimized latency calculation.
+// Enable or disable the FFT latency calculation.
 #define USE_FAST_LATENCY_CALCULATION 1
 
 static constexpr int32_t kDefaultSampleRate = 48000;
@@ -229,7 +230,9 @@ private:
 /**
   * Find latency using cross correlation in window of the recorded audio.
   * The stride is used to skip over samples and reduce the CPU load.
+  * Only used when USE_FAST_LATENCY_CALCULATION is 0, and as a reference by benchmarkLatency.
   */
+[[maybe_unused]]
 static int measureLatencyFromPulsePartial(AudioRecording &recorded,
                                           int32_t recordedOffset,
                                           int32_t recordedWindowSize,
@@ -293,37 +296,120 @@ static int measureLatencyFromPulsePartial(AudioRecording &recorded,
     return 0;
 }
 
+/**
+  * Find latency using cross correlation at every frame in a window of the recorded audio.
+  * This gives the same result as measureLatencyFromPulsePartial() with a stride of 1.
+  * But the sums of products for all the lags are calculated together using FFT
+  * overlap-save, so it takes O(N log N) instead of O(N * pulse.size()).
+  */
+static int measureLatencyFromPulseFft(AudioRecording &recorded,
+                                      int32_t recordedOffset,
+                                      int32_t recordedWindowSize,
+                                      AudioRecording &pulse,
+                                      LatencyReport *report) {
+    report->reset();
+
+    const int32_t pulseSize = pulse.size();
+    if (recordedOffset + recordedWindowSize + pulseSize > recorded.size()) {
+        ALOGE("%s() tried to correlate past end of recording, recordedOffset = %d frames\n",
+              __func__, recordedOffset);
+        return -3;
+    }
+
+    const int32_t numCorrelations = recordedWindowSize;
+    if (numCorrelations < 10) {
+        ALOGE("%s() recording too small = %d frames, numCorrelations = %d\n",
+              __func__, recorded.size(), numCorrelations);
+        return -1;
+    }
+
+    // Each block of fftSize recorded frames gives the correlations for
+    // fftSize - pulseSize + 1 lags that do not wrap around.
+    int32_t fftSize = 4;
+    while (fftSize < 2 * pulseSize) {
+        fftSize *= 2;
+    }
+    const int32_t lagsPerBlock = fftSize - pulseSize + 1;
+    RealFft<double> fft(fftSize);
+
+    std::vector<double> pulseSpectrum(fftSize, 0.0);
+    double pulseSumSquares = 0.0;
+    const float *pulseData = pulse.getData();
+    for (int32_t i = 0; i < pulseSize; i++) {
+        pulseSpectrum[i] = pulseData[i];
+        pulseSumSquares += pulseData[i] * pulseData[i];
+    }
+    fft.forward(pulseSpectrum.data());
+
+    // Sum of the squares of the recorded window at each lag, as a prefix sum.
+    const float *recordedData = &recorded.getData()[recordedOffset];
+    const int32_t numRecorded = numCorrelations + pulseSize;
+    std::vector<double> recordedSumSquares(numRecorded + 1);
+    recordedSumSquares[0] = 0.0;
+    for (int32_t i = 0; i < numRecorded; i++) {
+        recordedSumSquares[i + 1] = recordedSumSquares[i] + recordedData[i] * recordedData[i];
+    }
+
+    std::unique_ptr<float[]> correlations = std::make_unique<float[]>(numCorrelations);
+    std::vector<double> block(fftSize);
+    for (int32_t lag = 0; lag < numCorrelations; lag += lagsPerBlock) {
+        const int32_t numAvailable = std::min(fftSize, numRecorded - lag);
+        std::copy(recordedData + lag, recordedData + lag + numAvailable, block.begin());
+        std::fill(block.begin() + numAvailable, block.end(), 0.0);
+        fft.forward(block.data());
+
+        // Multiply by the conjugate of the pulse spectrum to correlate.
+        block[0] *= pulseSpectrum[0];
+        block[1] *= pulseSpectrum[1];
+        for (int32_t k = 2; k < fftSize; k += 2) {
+            const double re = block[k];
+            const double im = block[k + 1];
+            block[k] = re * pulseSpectrum[k] + im * pulseSpectrum[k + 1];
+            block[k + 1] = im * pulseSpectrum[k] - re * pulseSpectrum[k + 1];
+        }
+        fft.inverse(block.data());
+
+        const int32_t numLags = std::min(lagsPerBlock, numCorrelations - lag);
+        for (int32_t i = 0; i < numLags; i++) {
+            const int32_t index = lag + i;
+            const double sumSquares = recordedSumSquares[index + pulseSize]
+                                      - recordedSumSquares[index] + pulseSumSquares;
+            correlations[index] = (sumSquares >= 1.0e-9)
+                                  ? (float) (2.0 * block[i] / sumSquares)
+                                  : 0.0f;
+        }
+    }
+
+    // Find highest peak in correlation array.
+    float peakCorrelation = 0.0;
+    int32_t peakIndex = -1;
+    for (int32_t i = 0; i < numCorrelations; i++) {
+        float value = fabsf(correlations[i]);
+        if (value > peakCorrelation) {
+            peakCorrelation = value;
+            peakIndex = i;
+        }
+    }
+    if (peakIndex < 0) {
+        ALOGE("%s() no signal for correlation\n", __func__);
+        return -2;
+    }
+
+    report->latencyInFrames = recordedOffset + peakIndex;
+    report->correlation = peakCorrelation;
+
+    return 0;
+}
+
 #if USE_FAST_LATENCY_CALCULATION
 static int measureLatencyFromPulse(AudioRecording &recorded,
                                    AudioRecording &pulse,
                                    LatencyReport *report) {
-    const int32_t coarseStride = 16;
-    const int32_t fineWindowSize = coarseStride * 8;
-    const int32_t fineStride = 1;
-    LatencyReport courseReport;
-    courseReport.reset();
-    // Do a rough search, skipping over most of the samples.
-    int result = measureLatencyFromPulsePartial(recorded,
-                                                0, // recordedOffset,
-                                                recorded.size() - pulse.size(),
-                                                pulse,
-                                                &courseReport,
-                                                coarseStride);
-    if (result != 0) {
-        return result;
-    }
-    // Now do a fine resolution search near the coarse latency result.
-    int32_t maxRecordedOffset = recorded.size() - pulse.size() - fineWindowSize;
-    int32_t recordedOffset = courseReport.latencyInFrames - (fineWindowSize / 2);
-    recordedOffset = std::min(maxRecordedOffset, recordedOffset);
-    recordedOffset = std::max(0, recordedOffset);
-    result = measureLatencyFromPulsePartial(recorded,
-                                            recordedOffset,
-                                            fineWindowSize,
-                                            pulse,
-                                            report,
-                                            fineStride );
-    return result;
+    return measureLatencyFromPulseFft(recorded,
+                                      0,
+                                      recorded.size() - pulse.size(),
+                                      pulse,
+                                      report);
 }
 #else
 // TODO - When we are confident of the new code we can remove this old code.
@@ -367,8 +453,8 @@ public:
     virtual result_code processInputFrame(const float *frameData, int channelCount) = 0;
     virtual result_code processOutputFrame(float *frameData, int channelCount) = 0;
 
-    void process(const float *inputData, int inputChannelCount, int numInputFrames,
-                 float *outputData, int outputChannelCount, int numOutputFrames) {
+    virtual void process(const float *inputData, int inputChannelCount, int numInputFrames,
+                         float *outputData, int outputChannelCount, int numOutputFrames) {
         int numBoth = std::min(numInputFrames, numOutputFrames);
         // Process one frame at a time.
         for (int i = 0; i < numBoth; i++) {
@@ -0,0 +1,588 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYZER_MULTI_CHANNEL_ANALYZER_H
+#define ANALYZER_MULTI_CHANNEL_ANALYZER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "LatencyAnalyzer.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MULTI_CHANNEL_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MULTI_CHANNEL_USE_SSE2 1
+#endif
+
+/**
+ * Check every channel of a loopback at the same time.
+ *
+ * Each analyzed output channel plays its own sine tone. Every tone completes a whole number
+ * of cycles in an analysis window of sampleRate / 10 frames, rounded down, so the tones are
+ * orthogonal over a window at any sample rate. The tone frequencies follow from the window
+ * length, see getToneFrequency(). At the end of each window the input of each channel is
+ * fitted to all the tones. This gives the magnitude and phase of the channel's own tone and
+ * the crosstalk from every other channel. The fit from one window predicts the next window,
+ * frame by frame, and any frame that differs from the prediction by more than the tolerance
+ * is a glitch.
+ *
+ * Each channel also gets the checks of DataPathAnalyzer for a sine: the largest magnitude
+ * measured while the phase was stable, and the phase jitter between windows.
+ *
+ * Input channel N is expected to receive output channel N. The analysis is done a block at
+ * a time on structure-of-arrays buffers, one row per tone or channel, so the inner loops run
+ * over contiguous frames and vectorize.
+ *
+ * The results are written by the audio thread. A copy is published after every callback,
+ * and the getters read that copy, so they can be called from any thread.
+ */
+class MultiChannelAnalyzer : public LoopbackProcessor {
+public:
+
+    static constexpr int32_t kMaxChannels = 32;
+
+    struct ChannelResult {
+        bool    locked = false;
+        double  magnitude = 0.0;       // of the channel's own tone
+        double  maxResidual = 0.0;     // largest difference from the prediction when locked
+        double  phaseJitter = 0.0;     // mean phase change between windows, radians
+        int32_t glitchCount = 0;
+        double  crosstalkDB = -999.0;  // strongest other tone relative to the own tone
+        int32_t crosstalkSource = -1;  // channel that played the strongest other tone
+        double  maxMagnitude = 0.0;    // of the own tone, in windows with a stable phase
+        bool    dataPathValid = false; // passes the same checks as TestDataPathsActivity
+    };
+
+    /**
+     * Select the channels to play and analyze. Bit N selects channel N.
+     * Call before prepareToTest().
+     */
+    void setChannelMask(uint32_t channelMask) {
+        mChannelMask = channelMask;
+    }
+
+    uint32_t getChannelMask() const {
+        return mChannelMask;
+    }
+
+    void setTolerance(double tolerance) {
+        mTolerance = tolerance;
+    }
+
+    int32_t getNumChannels() const {
+        return (int32_t) mChannels.size();
+    }
+
+    // @return the channel number analyzed at an index, from 0 to getNumChannels() - 1
+    int32_t getChannel(int32_t index) const {
+        return mChannels[index];
+    }
+
+    // @return the results of a channel, by index, as of the last callback
+    ChannelResult getChannelResult(int32_t index) const {
+        std::lock_guard<std::mutex> lock(mPublishedResultsLock);
+        return mPublishedResults[index];
+    }
+
+    // @return frequency in Hz of the tone played on a channel, by index
+    double getToneFrequency(int32_t index) const {
+        return (double) mToneBins[index] * getSampleRate() / mWindowFrames;
+    }
+
+    // @return the glitches on all channels, as of the last callback
+    int32_t getGlitchCount() const {
+        std::lock_guard<std::mutex> lock(mPublishedResultsLock);
+        return countGlitches(mPublishedResults);
+    }
+
+    void reset() override {
+        LoopbackProcessor::reset();
+        mInputWindowFrame = 0;
+        mOutputWindowFrame = 0;
+        std::fill(mSumSin.begin(), mSumSin.end(), 0.0);
+        std::fill(mSumCos.begin(), mSumCos.end(), 0.0);
+        for (size_t i = 0; i < mResults.size(); i++) {
+            mResults[i] = ChannelResult();
+            mStates[i] = ChannelState();
+        }
+        std::lock_guard<std::mutex> lock(mPublishedResultsLock);
+        mPublishedResults = mResults;
+    }
+
+    void prepareToTest() override {
+        mChannels.clear();
+        for (int32_t channel = 0; channel < kMaxChannels; channel++) {
+            if (mChannelMask & (1u << channel)) {
+                mChannels.push_back(channel);
+            }
+        }
+        const int32_t numChannels = getNumChannels();
+        mWindowFrames = getSampleRate() / kWindowsPerSecond;
+        chooseToneBins(numChannels);
+        mSineTable.resize(mWindowFrames);
+        mCosineTable.resize(mWindowFrames);
+        for (int32_t step = 0; step < mWindowFrames; step++) {
+            const double phase = 2.0 * M_PI * step / mWindowFrames;
+            mSineTable[step] = (float) sin(phase);
+            mCosineTable[step] = (float) cos(phase);
+        }
+        mGoodFramesToEndGlitch = mWindowFrames / mToneBins[0]; // lowest tone period
+
+        mToneSin.assign(numChannels * kBlockFrames, 0.0f);
+        mToneCos.assign(numChannels * kBlockFrames, 0.0f);
+        mInput.assign(numChannels * kBlockFrames, 0.0f);
+        mPrediction.assign(kBlockFrames, 0.0f);
+        mSumSin.assign(numChannels * numChannels, 0.0);
+        mSumCos.assign(numChannels * numChannels, 0.0);
+        mModelSin.assign(numChannels * numChannels, 0.0f);
+        mModelCos.assign(numChannels * numChannels, 0.0f);
+        mModelTones.assign(numChannels * numChannels, 0);
+        mResults.assign(numChannels, ChannelResult());
+        mStates.assign(numChannels, ChannelState());
+        {
+            std::lock_guard<std::mutex> lock(mPublishedResultsLock);
+            mPublishedResults = mResults;
+        }
+        LoopbackProcessor::prepareToTest();
+    }
+
+    void process(const float *inputData, int inputChannelCount, int numInputFrames,
+                 float *outputData, int outputChannelCount, int numOutputFrames) override {
+        // The output does not depend on the analysis, so whole callbacks can be processed.
+        processInputFrames(inputData, inputChannelCount, numInputFrames);
+        processOutputFrames(outputData, outputChannelCount, numOutputFrames);
+    }
+
+    result_code processInputFrame(const float *frameData, int channelCount) override {
+        return processInputFrames(frameData, channelCount, 1);
+    }
+
+    result_code processOutputFrame(float *frameData, int channelCount) override {
+        return processOutputFrames(frameData, channelCount, 1);
+    }
+
+    result_code processInputFrames(const float *inputData, int channelCount, int numFrames) {
+        const int32_t glitchCount = countGlitches(mResults);
+        while (numFrames > 0) {
+            // Blocks never cross the end of a window.
+            const int32_t framesToDo = std::min({numFrames, kBlockFrames,
+                                                 mWindowFrames - mInputWindowFrame});
+            analyzeBlock(inputData, channelCount, framesToDo);
+            inputData += framesToDo * channelCount;
+            numFrames -= framesToDo;
+        }
+        publishResults();
+        return (countGlitches(mResults) > glitchCount) ? ERROR_GLITCHES : RESULT_OK;
+    }
+
+    result_code processOutputFrames(float *outputData, int channelCount, int numFrames) {
+        const int32_t numChannels = getNumChannels();
+        while (numFrames > 0) {
+            const int32_t framesToDo = std::min({numFrames, kBlockFrames,
+                                                 mWindowFrames - mOutputWindowFrame});
+            generateTones(mOutputWindowFrame, framesToDo, false);
+            for (int32_t frame = 0; frame < framesToDo; frame++) {
+                for (int i = 0; i < channelCount; i++) {
+                    outputData[frame * channelCount + i] = 0.0f;
+                }
+            }
+            for (int32_t index = 0; index < numChannels; index++) {
+                if (mChannels[index] >= channelCount) continue;
+                const float *tone = &mToneSin[index * kBlockFrames];
+                float *output = outputData + mChannels[index];
+                for (int32_t frame = 0; frame < framesToDo; frame++) {
+                    output[frame * channelCount] = tone[frame] * kOutputAmplitude;
+                }
+            }
+            mOutputWindowFrame = (mOutputWindowFrame + framesToDo) % mWindowFrames;
+            outputData += framesToDo * channelCount;
+            numFrames -= framesToDo;
+        }
+        return RESULT_OK;
+    }
+
+    std::string analyze() override {
+        std::stringstream report;
+        report << "MultiChannelAnalyzer ------------\n";
+        report << LOOPBACK_RESULT_TAG "channel.count      = " << std::setw(8)
+               << getNumChannels() << "\n";
+        std::vector<ChannelResult> results;
+        {
+            std::lock_guard<std::mutex> lock(mPublishedResultsLock);
+            results = mPublishedResults;
+        }
+        int32_t result = RESULT_OK;
+        for (int32_t index = 0; index < getNumChannels(); index++) {
+            const ChannelResult &channelResult = results[index];
+            const std::string prefix = std::string(LOOPBACK_RESULT_TAG "channel.")
+                                       + std::to_string(mChannels[index]) + ".";
+            report << prefix << "frequency    = " << std::setw(8)
+                   << getToneFrequency(index) << "\n";
+            report << prefix << "magnitude    = " << std::setw(8)
+                   << channelResult.magnitude << "\n";
+            report << prefix << "phase.jitter = " << std::setw(8)
+                   << channelResult.phaseJitter << "\n";
+            report << prefix << "glitch.count = " << std::setw(8)
+                   << channelResult.glitchCount << "\n";
+            report << prefix << "crosstalk.db = " << std::setw(8)
+                   << channelResult.crosstalkDB << "\n";
+            report << prefix << "crosstalk.source = " << std::setw(4)
+                   << channelResult.crosstalkSource << "\n";
+            report << prefix << "max.magnitude = " << std::setw(7)
+                   << channelResult.maxMagnitude << "\n";
+            report << prefix << "data.path.valid = " << std::setw(3)
+                   << (channelResult.dataPathValid ? 1 : 0) << "\n";
+            if (!channelResult.locked) {
+                report << "ERROR - channel " << mChannels[index]
+                       << " failed to lock on its sine tone.\n";
+                result = ERROR_NO_LOCK;
+            } else if (channelResult.glitchCount > 0 && result == RESULT_OK) {
+                result = ERROR_GLITCHES;
+            }
+        }
+        setResult(result);
+        return report.str();
+    }
+
+private:
+
+    struct ChannelState {
+        bool    predicting = false;
+        bool    inGlitch = false;
+        bool    windowHadGlitch = false;
+        int32_t goodFrames = 0;
+        int32_t numModelTones = 0;
+        int32_t numWindows = 0;        // clean windows in a row
+        int32_t phaseErrorCount = 0;
+        double  previousPhase = 0.0;
+        double  phaseErrorSum = 0.0;
+    };
+
+    static int32_t countGlitches(const std::vector<ChannelResult> &results) {
+        int32_t count = 0;
+        for (const ChannelResult &result : results) {
+            count += result.glitchCount;
+        }
+        return count;
+    }
+
+    /**
+     * Copy the results for the getters. This is called on the audio thread, so it does not
+     * wait for a reader. A skipped copy is made after the next callback.
+     */
+    void publishResults() {
+        std::unique_lock<std::mutex> lock(mPublishedResultsLock, std::try_to_lock);
+        if (lock.owns_lock()) {
+            // Same size as mResults, so this does not allocate.
+            std::copy(mResults.begin(), mResults.end(), mPublishedResults.begin());
+        }
+    }
+
+    // Pick tone bins that are spread out and are not harmonics of each other.
+    void chooseToneBins(int32_t numTones) {
+        mToneBins.clear();
+        int32_t bin = kFirstToneBin;
+        while ((int32_t) mToneBins.size() < numTones) {
+            bool isHarmonic = false;
+            for (int32_t accepted : mToneBins) {
+                if (bin == 2 * accepted || bin == 3 * accepted) {
+                    isHarmonic = true;
+                }
+            }
+            if (!isHarmonic) {
+                mToneBins.push_back(bin);
+            }
+            bin += kToneBinSpacing;
+        }
+    }
+
+    // Fill mToneSin and mToneCos, one row per tone, starting at a frame of the window.
+    void generateTones(int32_t windowFrame, int32_t numFrames, bool withCosine) {
+        for (int32_t tone = 0; tone < getNumChannels(); tone++) {
+            // Whole cycles per window, so a tone just steps through the table by its bin.
+            const int32_t bin = mToneBins[tone];
+            int32_t step = (int32_t) (((int64_t) windowFrame * bin) % mWindowFrames);
+            float *toneSin = &mToneSin[tone * kBlockFrames];
+            float *toneCos = &mToneCos[tone * kBlockFrames];
+            for (int32_t frame = 0; frame < numFrames; frame++) {
+                toneSin[frame] = mSineTable[step];
+                if (withCosine) {
+                    toneCos[frame] = mCosineTable[step];
+                }
+                step += bin;
+                if (step >= mWindowFrames) step -= mWindowFrames;
+            }
+        }
+    }
+
+    /**
+     * Correlate a signal with a sine and a cosine.
+     * This is the inner loop of the analysis, so it uses NEON or SSE when available.
+     */
+    static void correlate(const float *input, const float *toneSin, const float *toneCos,
+                          int32_t numFrames, float *sinSum, float *cosSum) {
+        float sinLanes[4] = {};
+        float cosLanes[4] = {};
+        int32_t frame = 0;
+#if MULTI_CHANNEL_USE_NEON
+        // Two sums for each so that the adds do not wait on each other.
+        float32x4_t sinAcc0 = vdupq_n_f32(0.0f);
+        float32x4_t sinAcc1 = vdupq_n_f32(0.0f);
+        float32x4_t cosAcc0 = vdupq_n_f32(0.0f);
+        float32x4_t cosAcc1 = vdupq_n_f32(0.0f);
+        for (; frame + 8 <= numFrames; frame += 8) {
+            float32x4_t x0 = vld1q_f32(input + frame);
+            float32x4_t x1 = vld1q_f32(input + frame + 4);
+            sinAcc0 = vmlaq_f32(sinAcc0, x0, vld1q_f32(toneSin + frame));
+            sinAcc1 = vmlaq_f32(sinAcc1, x1, vld1q_f32(toneSin + frame + 4));
+            cosAcc0 = vmlaq_f32(cosAcc0, x0, vld1q_f32(toneCos + frame));
+            cosAcc1 = vmlaq_f32(cosAcc1, x1, vld1q_f32(toneCos + frame + 4));
+        }
+        vst1q_f32(sinLanes, vaddq_f32(sinAcc0, sinAcc1));
+        vst1q_f32(cosLanes, vaddq_f32(cosAcc0, cosAcc1));
+#elif MULTI_CHANNEL_USE_SSE2
+        // Two sums for each so that the adds do not wait on each other.
+        __m128 sinAcc0 = _mm_setzero_ps();
+        __m128 sinAcc1 = _mm_setzero_ps();
+        __m128 cosAcc0 = _mm_setzero_ps();
+        __m128 cosAcc1 = _mm_setzero_ps();
+        for (; frame + 8 <= numFrames; frame += 8) {
+            __m128 x0 = _mm_loadu_ps(input + frame);
+            __m128 x1 = _mm_loadu_ps(input + frame + 4);
+            sinAcc0 = _mm_add_ps(sinAcc0, _mm_mul_ps(x0, _mm_loadu_ps(toneSin + frame)));
+            sinAcc1 = _mm_add_ps(sinAcc1, _mm_mul_ps(x1, _mm_loadu_ps(toneSin + frame + 4)));
+            cosAcc0 = _mm_add_ps(cosAcc0, _mm_mul_ps(x0, _mm_loadu_ps(toneCos + frame)));
+            cosAcc1 = _mm_add_ps(cosAcc1, _mm_mul_ps(x1, _mm_loadu_ps(toneCos + frame + 4)));
+        }
+        _mm_storeu_ps(sinLanes, _mm_add_ps(sinAcc0, sinAcc1));
+        _mm_storeu_ps(cosLanes, _mm_add_ps(cosAcc0, cosAcc1));
+#endif
+        for (; frame < numFrames; frame++) {
+            sinLanes[0] += input[frame] * toneSin[frame];
+            cosLanes[0] += input[frame] * toneCos[frame];
+        }
+        *sinSum = (sinLanes[0] + sinLanes[1]) + (sinLanes[2] + sinLanes[3]);
+        *cosSum = (cosLanes[0] + cosLanes[1]) + (cosLanes[2] + cosLanes[3]);
+    }
+
+    void analyzeBlock(const float *inputData, int channelCount, int32_t numFrames) {
+        const int32_t numChannels = getNumChannels();
+        generateTones(mInputWindowFrame, numFrames, true);
+
+        // Deinterleave the analyzed channels.
+        for (int32_t index = 0; index < numChannels; index++) {
+            float *input = &mInput[index * kBlockFrames];
+            const int32_t channel = mChannels[index];
+            if (channel >= channelCount) {
+                std::fill(input, input + numFrames, 0.0f);
+                continue;
+            }
+            for (int32_t frame = 0; frame < numFrames; frame++) {
+                input[frame] = inputData[frame * channelCount + channel];
+            }
+        }
+
+        for (int32_t index = 0; index < numChannels; index++) {
+            const float *input = &mInput[index * kBlockFrames];
+            if (mStates[index].predicting) {
+                detectGlitches(index, input, numFrames);
+            }
+            // Correlate with every tone.
+            for (int32_t tone = 0; tone < numChannels; tone++) {
+                float sinSum;
+                float cosSum;
+                correlate(input, &mToneSin[tone * kBlockFrames], &mToneCos[tone * kBlockFrames],
+                          numFrames, &sinSum, &cosSum);
+                mSumSin[index * numChannels + tone] += sinSum;
+                mSumCos[index * numChannels + tone] += cosSum;
+            }
+        }
+
+        mInputWindowFrame += numFrames;
+        if (mInputWindowFrame == mWindowFrames) {
+            finishWindow();
+            mInputWindowFrame = 0;
+        }
+    }
+
+    // Compare a channel with the prediction from the previous window.
+    void detectGlitches(int32_t index, const float *input, int32_t numFrames) {
+        const int32_t numChannels = getNumChannels();
+        float *prediction = mPrediction.data();
+        std::fill(prediction, prediction + numFrames, 0.0f);
+        for (int32_t i = 0; i < mStates[index].numModelTones; i++) {
+            const int32_t tone = mModelTones[index * numChannels + i];
+            const float a = mModelSin[index * numChannels + tone];
+            const float b = mModelCos[index * numChannels + tone];
+            const float *toneSin = &mToneSin[tone * kBlockFrames];
+            const float *toneCos = &mToneCos[tone * kBlockFrames];
+            for (int32_t frame = 0; frame < numFrames; frame++) {
+                prediction[frame] += (a * toneSin[frame]) + (b * toneCos[frame]);
+            }
+        }
+        for (int32_t frame = 0; frame < numFrames; frame++) {
+            prediction[frame] = fabsf(input[frame] - prediction[frame]);
+        }
+
+        ChannelResult &result = mResults[index];
+        ChannelState &state = mStates[index];
+        const float tolerance = (float) (mTolerance * result.magnitude);
+        float maxResidual = 0.0f;
+        for (int32_t frame = 0; frame < numFrames; frame++) {
+            const float residual = prediction[frame];
+            maxResidual = std::max(maxResidual, residual);
+            if (residual > tolerance) { // bad frame
+                if (!state.inGlitch) {
+                    state.inGlitch = true;
+                    result.glitchCount++;
+                }
+                state.windowHadGlitch = true;
+                state.goodFrames = 0;
+            } else if (state.inGlitch && ++state.goodFrames > mGoodFramesToEndGlitch) {
+                state.inGlitch = false;
+            }
+        }
+        result.maxResidual = std::max(result.maxResidual, (double) maxResidual);
+    }
+
+    // Fit each channel to all the tones, then update the predictions.
+    void finishWindow() {
+        const int32_t numChannels = getNumChannels();
+        const double scale = 2.0 / mWindowFrames;
+        for (int32_t index = 0; index < numChannels; index++) {
+            ChannelResult &result = mResults[index];
+            ChannelState &state = mStates[index];
+            double *sumSin = &mSumSin[index * numChannels];
+            double *sumCos = &mSumCos[index * numChannels];
+
+            const double ownSin = sumSin[index] * scale;
+            const double ownCos = sumCos[index] * scale;
+            const double magnitude = sqrt((ownSin * ownSin) + (ownCos * ownCos));
+            // A glitch in this window spoils the fit.
+            const bool usable = magnitude >= kMinMagnitude && !state.windowHadGlitch;
+            if (usable) {
+                double maxOther = 0.0;
+                int32_t source = -1;
+                // Only tones that could matter compared with the tolerance are predicted.
+                const double modelThreshold = kModelFraction * mTolerance * magnitude;
+                state.numModelTones = 0;
+                for (int32_t tone = 0; tone < numChannels; tone++) {
+                    const double other = scale * sqrt((sumSin[tone] * sumSin[tone])
+                                                      + (sumCos[tone] * sumCos[tone]));
+                    if (other >= modelThreshold) {
+                        mModelSin[index * numChannels + tone] = (float) (sumSin[tone] * scale);
+                        mModelCos[index * numChannels + tone] = (float) (sumCos[tone] * scale);
+                        mModelTones[index * numChannels + state.numModelTones++] = tone;
+                    }
+                    if (tone == index) continue;
+                    if (other > maxOther) {
+                        maxOther = other;
+                        source = mChannels[tone];
+                    }
+                }
+                result.crosstalkDB = (maxOther > 0.0)
+                                     ? 20.0 * log10(maxOther / magnitude) : -999.0;
+                result.crosstalkSource = source;
+
+                const double phase = atan2(ownCos, ownSin);
+                if (state.numWindows > 0) {
+                    double diff = phase - state.previousPhase;
+                    diff -= (2.0 * M_PI) * floor((diff + M_PI) / (2.0 * M_PI));
+                    state.phaseErrorSum += fabs(diff);
+                    state.phaseErrorCount++;
+                    result.phaseJitter = state.phaseErrorSum / state.phaseErrorCount;
+                    // Like DataPathAnalyzer, only trust the magnitude while the phase is stable.
+                    if (fabs(diff) < kDataPathPhaseTolerance) {
+                        result.maxMagnitude = std::max(result.maxMagnitude, magnitude);
+                    }
+                }
+                result.dataPathValid = result.maxMagnitude > kMinDataPathMagnitude
+                        && state.phaseErrorCount >= kMinDataPathPhaseCount
+                        && result.phaseJitter < kMaxDataPathJitter;
+                state.previousPhase = phase;
+                state.numWindows++;
+                // Predict once two clean windows agree, which skips a partly filled one.
+                state.predicting = state.numWindows > 1
+                        && fabs(magnitude - result.magnitude) < mTolerance * magnitude;
+                result.magnitude = magnitude;
+                result.locked = true;
+            } else {
+                // Skip a window, then predict from the next clean fit.
+                state.predicting = false;
+                state.inGlitch = false;
+                state.numWindows = 0;
+            }
+            state.windowHadGlitch = false;
+            std::fill(sumSin, sumSin + numChannels, 0.0);
+            std::fill(sumCos, sumCos + numChannels, 0.0);
+        }
+    }
+
+    static constexpr int32_t kWindowsPerSecond = 10;
+    static constexpr int32_t kFirstToneBin = 41;   // 410 Hz
+    static constexpr int32_t kToneBinSpacing = 3;  // 30 Hz
+    static constexpr int32_t kBlockFrames = 256;
+    static constexpr float   kOutputAmplitude = 0.5f;
+    static constexpr double  kMinMagnitude = 0.005;
+    static constexpr double  kModelFraction = 0.01; // of the tolerance
+    // Data path checks, the same as DataPathAnalyzer and TestDataPathsActivity.
+    static constexpr double  kDataPathPhaseTolerance = 2 * M_PI / 48;
+    static constexpr double  kMinDataPathMagnitude = 0.001;
+    static constexpr double  kMaxDataPathJitter = 0.1;
+    static constexpr int32_t kMinDataPathPhaseCount = 5;
+
+    uint32_t mChannelMask = 0x3;
+    double   mTolerance = 0.10; // scaled by the magnitude of each channel
+    std::vector<int32_t> mChannels;
+    std::vector<int32_t> mToneBins;
+    int32_t  mWindowFrames = kDefaultSampleRate / kWindowsPerSecond;
+    int32_t  mInputWindowFrame = 0;
+    int32_t  mOutputWindowFrame = 0;
+    int32_t  mGoodFramesToEndGlitch = 0;
+
+    // One cycle across a window.
+    std::vector<float>  mSineTable;
+    std::vector<float>  mCosineTable;
+
+    // Structure of arrays, one row of kBlockFrames per tone or channel.
+    std::vector<float>  mToneSin;
+    std::vector<float>  mToneCos;
+    std::vector<float>  mInput;
+    std::vector<float>  mPrediction;
+
+    // One row of numChannels tones per channel.
+    std::vector<double> mSumSin;
+    std::vector<double> mSumCos;
+    std::vector<float>  mModelSin;
+    std::vector<float>  mModelCos;
+    std::vector<int32_t> mModelTones; // tones with a significant model, first in each row
+
+    std::vector<ChannelResult> mResults;  // only used by the audio thread
+    std::vector<ChannelState>  mStates;
+
+    mutable std::mutex         mPublishedResultsLock;
+    std::vector<ChannelResult> mPublishedResults; // copy of mResults for other threads
+};
+
+#endif //ANALYZER_MULTI_CHANNEL_ANALYZER_H
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYZER_REAL_FFT_H
+#define ANALYZER_REAL_FFT_H
+
+#include <cstdint>
+#include <math.h>
+#include <utility>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define REAL_FFT_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define REAL_FFT_USE_SSE2 1
+#endif
+
+/**
+ * In-place FFT of real data, for float or double.
+ *
+ * A real transform of N points is done as a complex transform of N/2 points followed by a
+ * split step. The complex transform is an iterative radix-2 decimation in time with a
+ * precomputed bit reversal table and twiddle factors, and SIMD butterflies where available.
+ * All the tables are built by the constructor, so transforms never allocate and can be run
+ * repeatedly from any one thread.
+ *
+ * The spectrum is packed into the same N values as the input:
+ *   data[0] = Re X[0], data[1] = Re X[N/2], data[2k] = Re X[k], data[2k+1] = Im X[k]
+ * for 0 < k < N/2. The forward transform uses exp(-2 pi i k n / N) and is not scaled.
+ * inverse() undoes forward() exactly, it includes the 1/N.
+ */
+template <typename T>
+class RealFft {
+public:
+    /**
+     * @param size number of real points, a power of two of at least 4
+     */
+    explicit RealFft(int32_t size)
+            : mSize(size)
+            , mHalfSize(size / 2) {
+        // Twiddles for each stage of the complex transform, stage by stage so each is
+        // contiguous. The stage with span h uses exp(-pi i k / h) for 0 <= k < h.
+        mTwiddles.resize(2 * mHalfSize);
+        for (int32_t half = 1; half < mHalfSize; half *= 2) {
+            T *twiddles = &mTwiddles[2 * (half - 1)];
+            for (int32_t k = 0; k < half; k++) {
+                double angle = -M_PI * k / half;
+                twiddles[2 * k] = static_cast<T>(cos(angle));
+                twiddles[2 * k + 1] = static_cast<T>(sin(angle));
+            }
+        }
+
+        // Twiddles for the split step, exp(-2 pi i k / N) for 0 <= k <= N/4.
+        mSplitTwiddles.resize(2 * (mHalfSize / 2 + 1));
+        for (int32_t k = 0; k <= mHalfSize / 2; k++) {
+            double angle = -2.0 * M_PI * k / mSize;
+            mSplitTwiddles[2 * k] = static_cast<T>(cos(angle));
+            mSplitTwiddles[2 * k + 1] = static_cast<T>(sin(angle));
+        }
+
+        // Pairs of complex indices to swap for the bit reversed order.
+        int32_t numBits = 0;
+        while ((1 << numBits) < mHalfSize) numBits++;
+        for (int32_t i = 0; i < mHalfSize; i++) {
+            int32_t reversed = 0;
+            for (int32_t bit = 0; bit < numBits; bit++) {
+                reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+            }
+            if (i < reversed) {
+                mSwaps.push_back(i);
+                mSwaps.push_back(reversed);
+            }
+        }
+    }
+
+    int32_t size() const { return mSize; }
+
+    /**
+     * Replace size() real samples with their packed spectrum.
+     */
+    void forward(T *data) const {
+        transform(data);
+
+        // X[0] and X[N/2] are both real.
+        T re0 = data[0];
+        T im0 = data[1];
+        data[0] = re0 + im0;
+        data[1] = re0 - im0;
+
+        // Combine Z[k] and Z[M-k] into X[k] and X[M-k].
+        for (int32_t k = 1; k <= mHalfSize / 2; k++) {
+            const int32_t m = mHalfSize - k;
+            const T wr = mSplitTwiddles[2 * k];
+            const T wi = mSplitTwiddles[2 * k + 1];
+            const T zr = data[2 * k];
+            const T zi = data[2 * k + 1];
+            const T mr = data[2 * m];
+            const T mi = data[2 * m + 1];
+            // E = (Z[k] + conj(Z[M-k])) / 2, O = (Z[k] - conj(Z[M-k])) / 2i
+            const T er = static_cast<T>(0.5) * (zr + mr);
+            const T ei = static_cast<T>(0.5) * (zi - mi);
+            const T or_ = static_cast<T>(0.5) * (zi + mi);
+            const T oi = static_cast<T>(-0.5) * (zr - mr);
+            // X[k] = E + W O, X[M-k] = conj(E - W O)
+            const T tr = wr * or_ - wi * oi;
+            const T ti = wr * oi + wi * or_;
+            data[2 * k] = er + tr;
+            data[2 * k + 1] = ei + ti;
+            data[2 * m] = er - tr;
+            data[2 * m + 1] = ti - ei;
+        }
+    }
+
+    /**
+     * Replace a packed spectrum with size() real samples.
+     */
+    void inverse(T *data) const {
+        T x0 = data[0];
+        T xm = data[1];
+        data[0] = static_cast<T>(0.5) * (x0 + xm);
+        data[1] = static_cast<T>(0.5) * (x0 - xm);
+
+        for (int32_t k = 1; k <= mHalfSize / 2; k++) {
+            const int32_t m = mHalfSize - k;
+            const T wr = mSplitTwiddles[2 * k];
+            const T wi = mSplitTwiddles[2 * k + 1];
+            const T xr = data[2 * k];
+            const T xi = data[2 * k + 1];
+            const T mr = data[2 * m];
+            const T mi = data[2 * m + 1];
+            // E = (X[k] + conj(X[M-k])) / 2, W O = (X[k] - conj(X[M-k])) / 2
+            const T er = static_cast<T>(0.5) * (xr + mr);
+            const T ei = static_cast<T>(0.5) * (xi - mi);
+            const T tr = static_cast<T>(0.5) * (xr - mr);
+            const T ti = static_cast<T>(0.5) * (xi + mi);
+            // O = conj(W) (W O)
+            const T or_ = wr * tr + wi * ti;
+            const T oi = wr * ti - wi * tr;
+            // Z[k] = E + i O, Z[M-k] = conj(E) + i conj(O)
+            data[2 * k] = er - oi;
+            data[2 * k + 1] = ei + or_;
+            data[2 * m] = er + oi;
+            data[2 * m + 1] = or_ - ei;
+        }
+
+        // Inverse complex transform by conjugating before and after the forward one.
+        for (int32_t i = 1; i < mSize; i += 2) {
+            data[i] = -data[i];
+        }
+        transform(data);
+        const T scale = static_cast<T>(1.0) / mHalfSize;
+        for (int32_t i = 0; i < mSize; i += 2) {
+            data[i] *= scale;
+            data[i + 1] *= -scale;
+        }
+    }
+
+    /**
+     * @return the magnitude of bin k of a packed spectrum, for 0 <= k <= size() / 2
+     */
+    static T magnitude(const T *spectrum, int32_t size, int32_t k) {
+        return sqrt(power(spectrum, size, k));
+    }
+
+    /**
+     * @return the squared magnitude of bin k of a packed spectrum, for 0 <= k <= size() / 2
+     */
+    static T power(const T *spectrum, int32_t size, int32_t k) {
+        if (k == 0) return spectrum[0] * spectrum[0];
+        if (k == size / 2) return spectrum[1] * spectrum[1];
+        return spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+    }
+
+private:
+    // Complex FFT of mHalfSize interleaved points, in place.
+    void transform(T *data) const {
+        for (size_t i = 0; i < mSwaps.size(); i += 2) {
+            std::swap(data[2 * mSwaps[i]], data[2 * mSwaps[i + 1]]);
+            std::swap(data[2 * mSwaps[i] + 1], data[2 * mSwaps[i + 1] + 1]);
+        }
+        for (int32_t half = 1; half < mHalfSize; half *= 2) {
+            butterflies(data, half, &mTwiddles[2 * (half - 1)]);
+        }
+    }
+
+    // One stage of butterflies between points that are half apart.
+    void butterflies(T *data, int32_t half, const T *twiddles) const {
+        const int32_t span = 2 * half;
+        for (int32_t start = 0; start < mHalfSize; start += span) {
+            T *a = &data[2 * start];
+            T *b = &data[2 * (start + half)];
+            int32_t k = vectorButterflies(a, b, twiddles, half);
+            for (; k < half; k++) {
+                const T wr = twiddles[2 * k];
+                const T wi = twiddles[2 * k + 1];
+                const T br = b[2 * k] * wr - b[2 * k + 1] * wi;
+                const T bi = b[2 * k] * wi + b[2 * k + 1] * wr;
+                const T ar = a[2 * k];
+                const T ai = a[2 * k + 1];
+                a[2 * k] = ar + br;
+                a[2 * k + 1] = ai + bi;
+                b[2 * k] = ar - br;
+                b[2 * k + 1] = ai - bi;
+            }
+        }
+    }
+
+    // Vector butterflies for the start of a run. Returns how many were done.
+    static int32_t vectorButterflies(float *a, float *b, const float *twiddles, int32_t half) {
+        int32_t k = 0;
+#if REAL_FFT_USE_NEON
+        // 4 complex points at a time, split into real and imaginary vectors.
+        for (; k + 4 <= half; k += 4) {
+            float32x4x2_t va = vld2q_f32(a + 2 * k);
+            float32x4x2_t vb = vld2q_f32(b + 2 * k);
+            float32x4x2_t vw = vld2q_f32(twiddles + 2 * k);
+            float32x4_t br = vmlsq_f32(vmulq_f32(vb.val[0], vw.val[0]), vb.val[1], vw.val[1]);
+            float32x4_t bi = vmlaq_f32(vmulq_f32(vb.val[0], vw.val[1]), vb.val[1], vw.val[0]);
+            float32x4x2_t outA = {{vaddq_f32(va.val[0], br), vaddq_f32(va.val[1], bi)}};
+            float32x4x2_t outB = {{vsubq_f32(va.val[0], br), vsubq_f32(va.val[1], bi)}};
+            vst2q_f32(a + 2 * k, outA);
+            vst2q_f32(b + 2 * k, outB);
+        }
+#elif REAL_FFT_USE_SSE2
+        // 2 complex points at a time, interleaved.
+        const __m128 signs = _mm_set_ps(1.0f, -1.0f, 1.0f, -1.0f);
+        for (; k + 2 <= half; k += 2) {
+            __m128 va = _mm_loadu_ps(a + 2 * k);
+            __m128 vb = _mm_loadu_ps(b + 2 * k);
+            __m128 vw = _mm_loadu_ps(twiddles + 2 * k);
+            __m128 wr = _mm_shuffle_ps(vw, vw, _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 wi = _mm_shuffle_ps(vw, vw, _MM_SHUFFLE(3, 3, 1, 1));
+            __m128 swapped = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1));
+            // (br wr - bi wi, bi wr + br wi)
+            __m128 product = _mm_add_ps(_mm_mul_ps(vb, wr),
+                                        _mm_mul_ps(_mm_mul_ps(swapped, wi), signs));
+            _mm_storeu_ps(a + 2 * k, _mm_add_ps(va, product));
+            _mm_storeu_ps(b + 2 * k, _mm_sub_ps(va, product));
+        }
+#endif
+        return k;
+    }
+
+    static int32_t vectorButterflies(double *a, double *b, const double *twiddles, int32_t half) {
+        int32_t k = 0;
+#if REAL_FFT_USE_NEON && defined(__aarch64__)
+        for (; k + 2 <= half; k += 2) {
+            float64x2x2_t va = vld2q_f64(a + 2 * k);
+            float64x2x2_t vb = vld2q_f64(b + 2 * k);
+            float64x2x2_t vw = vld2q_f64(twiddles + 2 * k);
+            float64x2_t br = vmlsq_f64(vmulq_f64(vb.val[0], vw.val[0]), vb.val[1], vw.val[1]);
+            float64x2_t bi = vmlaq_f64(vmulq_f64(vb.val[0], vw.val[1]), vb.val[1], vw.val[0]);
+            float64x2x2_t outA = {{vaddq_f64(va.val[0], br), vaddq_f64(va.val[1], bi)}};
+            float64x2x2_t outB = {{vsubq_f64(va.val[0], br), vsubq_f64(va.val[1], bi)}};
+            vst2q_f64(a + 2 * k, outA);
+            vst2q_f64(b + 2 * k, outB);
+        }
+#elif REAL_FFT_USE_SSE2
+        // One complex point per vector.
+        const __m128d signs = _mm_set_pd(1.0, -1.0);
+        for (; k < half; k++) {
+            __m128d va = _mm_loadu_pd(a + 2 * k);
+            __m128d vb = _mm_loadu_pd(b + 2 * k);
+            __m128d wr = _mm_set1_pd(twiddles[2 * k]);
+            __m128d wi = _mm_set1_pd(twiddles[2 * k + 1]);
+            __m128d swapped = _mm_shuffle_pd(vb, vb, 1);
+            __m128d product = _mm_add_pd(_mm_mul_pd(vb, wr),
+                                         _mm_mul_pd(_mm_mul_pd(swapped, wi), signs));
+            _mm_storeu_pd(a + 2 * k, _mm_add_pd(va, product));
+            _mm_storeu_pd(b + 2 * k, _mm_sub_pd(va, product));
+        }
+#endif
+        return k;
+    }
+
+    const int32_t mSize;
+    const int32_t mHalfSize;
+    std::vector<T> mTwiddles;
+    std::vector<T> mSplitTwiddles;
+    std::vector<int32_t> mSwaps;
+};
+
+#endif //ANALYZER_REAL_FFT_H
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYZER_STREAMING_LATENCY_ANALYZER_H
+#define ANALYZER_STREAMING_LATENCY_ANALYZER_H
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include "LatencyAnalyzer.h"
+#include "RandomPulseGenerator.h"
+#include "RealFft.h"
+
+/**
+ * Measure latency continuously, for as long as the streams run.
+ *
+ * A short Manchester encoded pulse is played once per period, followed by enough silence
+ * for the longest latency. The input is run through a matched filter as it arrives.
+ * Blocks of input are correlated with the pulse using FFT overlap-save, so the cost per frame
+ * is small and constant and the memory does not grow with the length of the test.
+ *
+ * Each period gives one measurement: the lag of the correlation peak after the pulse was
+ * played. It is accepted if the correlation is at least getMinimumCorrelation().
+ * The latest, minimum, maximum and mean accepted latencies can be read from any thread.
+ */
+class StreamingLatencyAnalyzer : public LatencyAnalyzer {
+public:
+
+    void setup() override {
+        reset();
+    }
+
+    int getState() const override {
+        return mState;
+    }
+
+    void reset() override {
+        LoopbackProcessor::reset();
+        mState = STATE_MEASURE_BACKGROUND;
+        mBackgroundFrames = (int32_t) (getSampleRate() * kBackgroundMeasurementLengthSeconds);
+        mBackgroundSumSquare = 0.0;
+        mBackgroundRMS = 0.0;
+        mInputFrameCount = 0;
+        mOutputFrameCount = 0;
+
+        generatePulse();
+        mMaxLatencyFrames = getSampleRate() * kMaxLatencyMillis / kMillisPerSecond;
+        mPeriodFrames = mPulse.size() * 2 + mMaxLatencyFrames;
+
+        // Each block of mFftSize input frames gives the correlations for
+        // mFftSize - pulseSize + 1 lags. The rest of the block is kept for the next one.
+        mFftSize = 4;
+        while (mFftSize < 2 * mPulse.size()) {
+            mFftSize *= 2;
+        }
+        mLagsPerBlock = mFftSize - mPulse.size() + 1;
+        mFft = std::make_unique<RealFft<double>>(mFftSize);
+        mPulseSpectrum.assign(mFftSize, 0.0);
+        mPulseSumSquares = 0.0;
+        for (int32_t i = 0; i < mPulse.size(); i++) {
+            double sample = mPulse.getData()[i];
+            mPulseSpectrum[i] = sample;
+            mPulseSumSquares += sample * sample;
+        }
+        mFft->forward(mPulseSpectrum.data());
+        mBlock.assign(mFftSize, 0.0f);
+        mFftData.assign(mFftSize, 0.0);
+        mSumSquares.assign(mFftSize + 1, 0.0);
+        mBlockStartFrame = mBackgroundFrames;
+        mBlockSize = 0;
+
+        mCurrentPulse = -1;
+        resetPeak();
+        mLatencyFrames = 0;
+        mCorrelation = 0.0;
+        mSignalRMS = 0.0;
+        mNumMeasurements = 0;
+        mNumMissed = 0;
+        mMinLatencyFrames = std::numeric_limits<int32_t>::max();
+        mMaxMeasuredFrames = 0;
+        mSumLatencyFrames = 0;
+    }
+
+    result_code processInputFrame(const float *frameData, int /* channelCount */) override {
+        float input = frameData[getInputChannel()];
+        if (mState == STATE_MEASURE_BACKGROUND) {
+            mBackgroundSumSquare += static_cast<double>(input) * input;
+            if (++mInputFrameCount >= mBackgroundFrames) {
+                mBackgroundRMS = sqrt(mBackgroundSumSquare / mBackgroundFrames);
+                mState = STATE_RUNNING;
+            }
+            return RESULT_OK;
+        }
+
+        mInputFrameCount++;
+        mBlock[mBlockSize++] = input;
+        if (mBlockSize == mFftSize) {
+            correlateBlock();
+        }
+        return RESULT_OK;
+    }
+
+    result_code processOutputFrame(float *frameData, int channelCount) override {
+        float sample = 0.0f;
+        if (mOutputFrameCount >= mBackgroundFrames) {
+            int64_t offset = (mOutputFrameCount - mBackgroundFrames) % mPeriodFrames;
+            if (offset < mPulse.size()) {
+                sample = mPulse.getData()[offset];
+            }
+        }
+        mOutputFrameCount++;
+        for (int i = 0; i < channelCount; i++) {
+            frameData[i] = sample;
+        }
+        return RESULT_OK;
+    }
+
+    std::string analyze() override {
+        std::stringstream report;
+        report << "StreamingLatencyAnalyzer -----------\n";
+        report << LOOPBACK_RESULT_TAG "test.state             = "
+               << std::setw(8) << mState << "\n";
+        report << LOOPBACK_RESULT_TAG "background.rms         = "
+               << std::setw(8) << mBackgroundRMS << "\n";
+        report << LOOPBACK_RESULT_TAG "latency.measurements   = "
+               << std::setw(8) << getNumMeasurements() << "\n";
+        report << LOOPBACK_RESULT_TAG "latency.missed         = "
+               << std::setw(8) << getNumMissed() << "\n";
+        if (getNumMeasurements() > 0) {
+            const double framesToMillis = (double) kMillisPerSecond / getSampleRate();
+            report << LOOPBACK_RESULT_TAG "latency.frames         = "
+                   << std::setw(8) << getMeasuredLatency() << "\n";
+            report << LOOPBACK_RESULT_TAG "latency.msec           = "
+                   << std::setw(8) << getMeasuredLatency() * framesToMillis << "\n";
+            report << LOOPBACK_RESULT_TAG "latency.min.msec       = "
+                   << std::setw(8) << getMinLatency() * framesToMillis << "\n";
+            report << LOOPBACK_RESULT_TAG "latency.max.msec       = "
+                   << std::setw(8) << getMaxLatency() * framesToMillis << "\n";
+            report << LOOPBACK_RESULT_TAG "latency.mean.msec      = "
+                   << std::setw(8) << getMeanLatency() * framesToMillis << "\n";
+            report << LOOPBACK_RESULT_TAG "latency.correlation    = "
+                   << std::setw(8) << getMeasuredCorrelation() << "\n";
+        }
+        return report.str();
+    }
+
+    int32_t getProgress() const override {
+        return getNumMeasurements();
+    }
+
+    bool hasEnoughData() const override {
+        return getNumMeasurements() > 0;
+    }
+
+    // @return latency of the most recent accepted measurement, in frames
+    int32_t getMeasuredLatency() const override {
+        return mLatencyFrames.load();
+    }
+
+    double getMeasuredCorrelation() const override {
+        return mCorrelation.load();
+    }
+
+    double getBackgroundRMS() const override {
+        return mBackgroundRMS;
+    }
+
+    double getSignalRMS() const override {
+        return mSignalRMS.load();
+    }
+
+    int32_t getNumMeasurements() const {
+        return mNumMeasurements.load();
+    }
+
+    // @return number of periods where the correlation peak was too low
+    int32_t getNumMissed() const {
+        return mNumMissed.load();
+    }
+
+    int32_t getMinLatency() const {
+        return mMinLatencyFrames.load();
+    }
+
+    int32_t getMaxLatency() const {
+        return mMaxMeasuredFrames.load();
+    }
+
+    double getMeanLatency() const {
+        int32_t count = getNumMeasurements();
+        return (count > 0) ? (double) mSumLatencyFrames.load() / count : 0.0;
+    }
+
+    // @return frames between the start of one pulse and the next
+    int32_t getPeriodFrames() const {
+        return mPeriodFrames;
+    }
+
+    double getMinimumCorrelation() const {
+        return kMinimumCorrelation;
+    }
+
+private:
+
+    enum streaming_state {
+        STATE_MEASURE_BACKGROUND,
+        STATE_RUNNING,
+    };
+
+    void generatePulse() {
+        int32_t numPulseBits = getSampleRate() * kPulseLengthMillis
+                               / (kFramesPerEncodedBit * kMillisPerSecond);
+        int32_t pulseLength = numPulseBits * kFramesPerEncodedBit;
+        mPulse.allocate(pulseLength);
+        RandomPulseGenerator pulser(kFramesPerEncodedBit);
+        for (int i = 0; i < pulseLength; i++) {
+            mPulse.write(pulser.nextFloat() * mPulseAmplitude);
+        }
+    }
+
+    void resetPeak() {
+        mPeakCorrelation = 0.0;
+        mPeakLag = -1;
+        mPeakSumSquares = 0.0;
+    }
+
+    // Correlate a full block with the pulse, then keep the tail for the next block.
+    void correlateBlock() {
+        const int32_t pulseSize = mPulse.size();
+        mSumSquares[0] = 0.0;
+        for (int32_t i = 0; i < mFftSize; i++) {
+            double sample = mBlock[i];
+            mFftData[i] = sample;
+            mSumSquares[i + 1] = mSumSquares[i] + sample * sample;
+        }
+        mFft->forward(mFftData.data());
+        // Multiply by the conjugate of the pulse spectrum to correlate.
+        mFftData[0] *= mPulseSpectrum[0];
+        mFftData[1] *= mPulseSpectrum[1];
+        for (int32_t k = 2; k < mFftSize; k += 2) {
+            const double re = mFftData[k];
+            const double im = mFftData[k + 1];
+            mFftData[k] = re * mPulseSpectrum[k] + im * mPulseSpectrum[k + 1];
+            mFftData[k + 1] = im * mPulseSpectrum[k] - re * mPulseSpectrum[k + 1];
+        }
+        mFft->inverse(mFftData.data());
+
+        for (int32_t i = 0; i < mLagsPerBlock; i++) {
+            const double sumSquares = mSumSquares[i + pulseSize] - mSumSquares[i];
+            const double denominator = sumSquares + mPulseSumSquares;
+            const double correlation = (denominator >= 1.0e-9)
+                                       ? 2.0 * mFftData[i] / denominator : 0.0;
+            onCorrelation(mBlockStartFrame + i, correlation, sumSquares);
+        }
+
+        std::copy(mBlock.begin() + mLagsPerBlock, mBlock.end(), mBlock.begin());
+        mBlockSize = mFftSize - mLagsPerBlock;
+        mBlockStartFrame += mLagsPerBlock;
+    }
+
+    // Track the peak for the pulse whose window contains this lag.
+    void onCorrelation(int64_t frame, double correlation, double sumSquares) {
+        const int64_t sincePulses = frame - mBackgroundFrames;
+        const int64_t pulseIndex = sincePulses / mPeriodFrames;
+        const int32_t lag = (int32_t) (sincePulses - (pulseIndex * mPeriodFrames));
+        if (lag > mMaxLatencyFrames) {
+            if (mCurrentPulse == pulseIndex) {
+                finishPulse();
+            }
+            return;
+        }
+        mCurrentPulse = pulseIndex;
+        if (fabs(correlation) > mPeakCorrelation) {
+            mPeakCorrelation = fabs(correlation);
+            mPeakLag = lag;
+            mPeakSumSquares = sumSquares;
+        }
+    }
+
+    // Publish the peak found for the current pulse.
+    void finishPulse() {
+        mCurrentPulse = -1;
+        if (mPeakLag < 0 || mPeakCorrelation < kMinimumCorrelation) {
+            mNumMissed++;
+            resetPeak();
+            return;
+        }
+        mLatencyFrames.store(mPeakLag);
+        mCorrelation.store(mPeakCorrelation);
+        mSignalRMS.store(sqrt(mPeakSumSquares / mPulse.size()));
+        mMinLatencyFrames.store(std::min(mMinLatencyFrames.load(), mPeakLag));
+        mMaxMeasuredFrames.store(std::max(mMaxMeasuredFrames.load(), mPeakLag));
+        mSumLatencyFrames.store(mSumLatencyFrames.load() + mPeakLag);
+        mNumMeasurements++; // last, so readers see a complete measurement
+        resetPeak();
+    }
+
+    static constexpr int32_t kPulseLengthMillis = 50;
+    static constexpr int32_t kFramesPerEncodedBit = 8; // multiple of 2
+    static constexpr double  kBackgroundMeasurementLengthSeconds = 0.5;
+    static constexpr double  kMinimumCorrelation = 0.2;
+
+    streaming_state    mState = STATE_MEASURE_BACKGROUND;
+    AudioRecording     mPulse;
+    float              mPulseAmplitude = 0.5f;
+    int32_t            mBackgroundFrames = 0;
+    double             mBackgroundSumSquare = 0.0;
+    double             mBackgroundRMS = 0.0;
+    int32_t            mMaxLatencyFrames = 0;
+    int32_t            mPeriodFrames = 0;
+    int64_t            mInputFrameCount = 0;
+    int64_t            mOutputFrameCount = 0;
+
+    // Matched filter, all allocated by reset().
+    std::unique_ptr<RealFft<double>> mFft;
+    int32_t             mFftSize = 0;
+    int32_t             mLagsPerBlock = 0;
+    std::vector<double> mPulseSpectrum;
+    double              mPulseSumSquares = 0.0;
+    std::vector<float>  mBlock;
+    int32_t             mBlockSize = 0;
+    int64_t             mBlockStartFrame = 0;
+    std::vector<double> mFftData;
+    std::vector<double> mSumSquares;
+
+    // Peak of the pulse being measured, used only by the input thread.
+    int64_t            mCurrentPulse = -1;
+    double             mPeakCorrelation = 0.0;
+    int32_t            mPeakLag = -1;
+    double             mPeakSumSquares = 0.0;
+
+    // Results, written by the input thread and read by any thread.
+    std::atomic<int32_t>  mLatencyFrames{0};
+    std::atomic<double>   mCorrelation{0.0};
+    std::atomic<double>   mSignalRMS{0.0};
+    std::atomic<int32_t>  mNumMeasurements{0};
+    std::atomic<int32_t>  mNumMissed{0};
+    std::atomic<int32_t>  mMinLatencyFrames{0};
+    std::atomic<int32_t>  mMaxMeasuredFrames{0};
+    std::atomic<int64_t>  mSumLatencyFrames{0};
+};
+
+#endif // ANALYZER_STREAMING_LATENCY_ANALYZER_H
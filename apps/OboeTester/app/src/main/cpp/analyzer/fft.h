@@ -1,45 +0,0 @@
-/*
- * Copyright (C) 2025 The Android Open Source Project
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *      http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- */
-
-#pragma once
-
-#include <complex>
-#include <vector>
-
-using Complex = std::complex<double>;
-using CVector = std::vector<Complex>;
-
-// Radix-2 Cooley-Tukey FFT
-inline void fft(CVector &a) {
-    int n = a.size();
-    if (n <= 1) return;
-
-    CVector a0(n / 2), a1(n / 2);
-    for (int i = 0; 2 * i < n; i++) {
-        a0[i] = a[2 * i];
-        a1[i] = a[2 * i + 1];
-    }
-    fft(a0);
-    fft(a1);
-
-    const double ang = 2 * M_PI / n;
-    Complex w(1), wn(cos(ang), sin(ang));
-    for (int i = 0; 2 * i < n; i++) {
-        a[i] = a0[i] + w * a1[i];
-        a[i + n / 2] = a0[i] - w * a1[i];
-        w *= wn;
-    }
-}
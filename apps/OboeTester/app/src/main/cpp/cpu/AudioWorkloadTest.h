@@ -57,6 +57,9 @@ public:
         int64_t finishTimeNs;   // Timestamp (nanoseconds) when the callback finished
         int32_t xRunCount;      // Cumulative XRun (underrun/overrun) count at this point
         int32_t cpuIndex;       // CPU core index on which the callback executed
+        int32_t numRenderThreads; // Number of threads that rendered the synth, 0 if none
+        // Timing of each thread that rendered the synth. Thread 0 is the callback thread.
+        ParallelVoiceRenderer::WorkerStatus renderThreads[ParallelVoiceRenderer::kMaxWorkers];
     };
 
     /**
@@ -145,11 +148,14 @@ public:
      * @param adpfWorkloadIncreaseEnabled Whether to use ADPF setWorkloadIncrease() API.
      * @param hearWorkload If true, the synthesized audio will be audible; otherwise, it's processed
      * silently and a sine wave will be audible instead.
+     * @param numRenderThreads Number of threads that render the synth voices, including the
+     * callback thread. Between 1 and ParallelVoiceRenderer::kMaxWorkers.
      * @return 0 on success, or a negative Oboe error code on failure.
      */
     int32_t start(int32_t targetDurationMillis, int32_t numBursts, int32_t numVoices,
                   int32_t alternateNumVoices, int32_t alternatingPeriodMs, bool adpfEnabled,
-                  bool adpfWorkloadIncreaseEnabled, bool hearWorkload) {
+                  bool adpfWorkloadIncreaseEnabled, bool hearWorkload,
+                  int32_t numRenderThreads = 1) {
         std::lock_guard<std::mutex> lock(mStreamLock);
         if (!mStream) {
             LOGE("Error: Stream not open.");
@@ -159,6 +165,10 @@ public:
             LOGE("Error: Stream already started.");
             return static_cast<int32_t>(oboe::Result::ErrorUnavailable);
         }
+        if (mSynthWorkload && mSynthWorkload->setNumRenderThreads(numRenderThreads) != 0) {
+            LOGE("Error: Cannot render on %d threads.", numRenderThreads);
+            return static_cast<int32_t>(oboe::Result::ErrorOutOfRange);
+        }
         mTargetDurationMs = targetDurationMillis;
         mNumBursts = numBursts;
         mNumVoices = numVoices;
@@ -322,12 +332,12 @@ public:
 
         int lastVoices = mNumVoices;
         int currentVoices = mNumVoices;
+        int64_t timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+        if (mStartTimeMs == 0) {
+            mStartTimeMs = timeMs;
+        }
         if (mAlternatingPeriodMs > 0) {
-            int64_t timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-            if (mStartTimeMs == 0) {
-                mStartTimeMs = timeMs;
-            }
             if (((timeMs - mStartTimeMs) % (2 * mAlternatingPeriodMs)) >= mAlternatingPeriodMs) {
                 currentVoices = mAlternateNumVoices;
             }
@@ -343,6 +353,7 @@ public:
             }
         }
 
+        int32_t numRenderThreads = 0;
         auto floatData = static_cast<float *>(audioData);
         int channelCount = audioStream->getChannelCount();
 
@@ -364,6 +375,7 @@ public:
                 float *buffer = (audioStream->getChannelCount() == 2 && mHearWorkload)
                                 ? static_cast<float *>(audioData) : nullptr;
                 mSynthWorkload->renderStereo(buffer, numFrames);
+                numRenderThreads = mSynthWorkload->getNumRenderThreads();
             }
         }
 
@@ -378,6 +390,10 @@ public:
         status.finishTimeNs = finishTimeNs;
         status.xRunCount = mXRunCount - mPreviousXRunCount;
         status.cpuIndex = sched_getcpu();
+        status.numRenderThreads = numRenderThreads;
+        for (int32_t i = 0; i < numRenderThreads; i++) {
+            status.renderThreads[i] = mSynthWorkload->getRenderThreadStatus(i);
+        }
 
         {
             std::lock_guard<std::mutex> statisticsLock(mStatisticsLock);
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_VOICE_RENDERER_H
+#define PARALLEL_VOICE_RENDERER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common/OboeDebug.h"
+#include "../synth/Synthesizer.h"
+
+/**
+ * @class ParallelVoiceRenderer
+ * @brief Spreads the voices of a marksynth::Synthesizer across several threads in each callback.
+ *
+ * The thread that calls render() is worker 0. The other workers are helper threads that
+ * sleep on a semaphore between callbacks. Each worker starts with an equal share of the
+ * synthesizer's render tasks. When its share is finished it steals tasks that the other
+ * workers have not started yet.
+ *
+ * A helper that has not woken up by the time every task is taken is skipped for that
+ * callback. So a helper that is slow to be scheduled can only delay the callback by the
+ * task that it is working on.
+ *
+ * Example usage:
+ * start(4);
+ * in the callback: render(synth, buffer, numFrames); getWorkerStatus(i);
+ * stop();
+ */
+class ParallelVoiceRenderer {
+public:
+    static constexpr int32_t kMaxWorkers = 8;
+    // Larger buffers are rendered in several rounds.
+    static constexpr int32_t kMaxFramesPerRound = 1024;
+
+    /**
+     * @struct WorkerStatus
+     * @brief Timing of one worker during a call to render().
+     */
+    struct WorkerStatus {
+        int32_t beginOffsetNs;  // When the worker started, relative to the start of render()
+        int32_t durationNs;     // Time spent rendering, 0 if the worker was skipped
+        int32_t cpuIndex;       // CPU core the worker started on, -1 if it was skipped
+        int32_t numTasks;       // Number of tasks rendered, including stolen tasks
+        int32_t numStolen;      // Number of tasks taken from the share of another worker
+    };
+
+    ParallelVoiceRenderer() = default;
+
+    ~ParallelVoiceRenderer() {
+        stop();
+    }
+
+    /**
+     * @brief Starts the helper threads. This is not real-time safe.
+     * The helpers ask for SCHED_FIFO and fall back to an urgent audio nice level.
+     * @param numWorkers Number of threads that render, including the caller of render().
+     * @return 0 on success, -1 if numWorkers is out of range or already started.
+     */
+    int32_t start(int32_t numWorkers) {
+        if (numWorkers < 1 || numWorkers > kMaxWorkers || mNumWorkers > 0) {
+            LOGE("ParallelVoiceRenderer: cannot start %d workers", numWorkers);
+            return -1;
+        }
+        mRunning = true;
+        for (int32_t i = 0; i < numWorkers; i++) {
+            Worker &worker = mWorkers[i];
+            worker.buffer.assign(kMaxFramesPerRound * SAMPLES_PER_FRAME, 0.0f);
+            worker.state = kIdle;
+            sem_init(&worker.wakeup, 0, 0);
+        }
+        mNumWorkers = numWorkers;
+        for (int32_t i = 1; i < numWorkers; i++) {
+            mWorkers[i].thread = std::thread(&ParallelVoiceRenderer::runHelper, this, i);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Stops and joins the helper threads. This is not real-time safe.
+     */
+    void stop() {
+        if (mNumWorkers == 0) return;
+        mRunning = false;
+        for (int32_t i = 1; i < mNumWorkers; i++) {
+            sem_post(&mWorkers[i].wakeup);
+        }
+        for (int32_t i = 0; i < mNumWorkers; i++) {
+            Worker &worker = mWorkers[i];
+            if (worker.thread.joinable()) {
+                worker.thread.join();
+            }
+            sem_destroy(&worker.wakeup);
+        }
+        mNumWorkers = 0;
+    }
+
+    int32_t getNumWorkers() const {
+        return mNumWorkers;
+    }
+
+    /**
+     * @brief Renders the active voices of a synthesizer into a stereo buffer.
+     * Only call this from one thread at a time and only between start() and stop().
+     * Waking the helpers is the only system call.
+     * @param synth Its notes must not change during the call.
+     * @param output A stereo buffer, or nullptr to do the work and discard the result.
+     * @param numFrames Number of frames to render.
+     */
+    void render(marksynth::Synthesizer &synth, float *output, int32_t numFrames) {
+        const int64_t beginTimeNs = nowNs();
+        for (int32_t i = 0; i < mNumWorkers; i++) {
+            mWorkers[i].status = WorkerStatus{0, 0, -1, 0, 0};
+        }
+        mBeginTimeNs = beginTimeNs;
+        mSynth = &synth;
+        int32_t framesLeft = numFrames;
+        float *renderBuffer = output;
+        while (framesLeft > 0) {
+            int32_t framesThisTime = std::min(kMaxFramesPerRound, framesLeft);
+            renderRound(renderBuffer, framesThisTime);
+            framesLeft -= framesThisTime;
+            if (renderBuffer != nullptr) {
+                renderBuffer += framesThisTime * SAMPLES_PER_FRAME;
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the timing of one worker for the last call to render().
+     * Call this from the thread that calls render().
+     * @param workerIndex Between 0 and getNumWorkers() - 1. Worker 0 is the caller of render().
+     */
+    const WorkerStatus &getWorkerStatus(int32_t workerIndex) const {
+        return mWorkers[workerIndex].status;
+    }
+
+private:
+    enum State : int32_t {
+        kIdle,      // Waiting for work
+        kPending,   // Woken up for a round but not started
+        kRunning,   // Rendering its share or stealing
+        kDone,      // Finished the round
+        kSkipped,   // Did not start before the round ended
+    };
+
+    struct alignas(64) Worker {
+        std::atomic<int32_t> nextTask{0};
+        int32_t endTask = 0;
+        std::atomic<int32_t> state{kIdle};
+        int32_t roundTasks = 0;
+        sem_t wakeup;
+        std::thread thread;
+        std::vector<float> buffer;
+        WorkerStatus status{};
+    };
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void renderRound(float *output, int32_t numFrames) {
+        const int32_t numTasks = mSynth->getRenderTaskCount();
+        for (int32_t i = 0; i < mNumWorkers; i++) {
+            Worker &worker = mWorkers[i];
+            worker.nextTask.store(i * numTasks / mNumWorkers, std::memory_order_relaxed);
+            worker.endTask = (i + 1) * numTasks / mNumWorkers;
+            worker.roundTasks = 0;
+        }
+        mRoundFrames = numFrames;
+
+        // Publish the round, then wake the helpers.
+        for (int32_t i = 1; i < mNumWorkers; i++) {
+            mWorkers[i].state.store(kPending, std::memory_order_release);
+            sem_post(&mWorkers[i].wakeup);
+        }
+
+        // The caller renders straight into the output.
+        float *mix = (output != nullptr) ? output : mWorkers[0].buffer.data();
+        memset(mix, 0, numFrames * SAMPLES_PER_FRAME * sizeof(float));
+        renderTasks(0, mix);
+
+        // Every task has been taken. Wait for helpers that are still rendering.
+        for (int32_t i = 1; i < mNumWorkers; i++) {
+            Worker &worker = mWorkers[i];
+            int32_t expected = kPending;
+            if (worker.state.compare_exchange_strong(expected, kSkipped,
+                                                     std::memory_order_acq_rel)) {
+                continue;
+            }
+            while (worker.state.load(std::memory_order_acquire) != kDone) {
+                std::this_thread::yield();
+            }
+            if (output != nullptr && worker.roundTasks > 0) {
+                const float *buffer = worker.buffer.data();
+                for (int32_t n = 0; n < numFrames * SAMPLES_PER_FRAME; n++) {
+                    output[n] += buffer[n];
+                }
+            }
+        }
+    }
+
+    // Render this worker's share, then steal from the others.
+    void renderTasks(int32_t workerIndex, float *mix) {
+        Worker &self = mWorkers[workerIndex];
+        const int64_t startNs = nowNs();
+        if (self.status.cpuIndex < 0) {
+            self.status.beginOffsetNs = (int32_t) (startNs - mBeginTimeNs);
+            self.status.cpuIndex = sched_getcpu();
+        }
+        int32_t numStolen = 0;
+        for (int32_t offset = 0; offset < mNumWorkers; offset++) {
+            Worker &victim = mWorkers[(workerIndex + offset) % mNumWorkers];
+            int32_t task;
+            while ((task = victim.nextTask.fetch_add(1, std::memory_order_relaxed))
+                    < victim.endTask) {
+                if (self.roundTasks == 0 && mix != nullptr && workerIndex != 0) {
+                    memset(mix, 0, mRoundFrames * SAMPLES_PER_FRAME * sizeof(float));
+                }
+                mSynth->mixRenderTask(task, mix, mRoundFrames);
+                self.roundTasks++;
+                if (offset > 0) numStolen++;
+            }
+        }
+        self.status.numTasks += self.roundTasks;
+        self.status.numStolen += numStolen;
+        self.status.durationNs += (int32_t) (nowNs() - startNs);
+    }
+
+    void runHelper(int32_t workerIndex) {
+        setRealTimePriority(workerIndex);
+        Worker &self = mWorkers[workerIndex];
+        while (true) {
+            if (sem_wait(&self.wakeup) != 0) {
+                continue; // interrupted
+            }
+            if (!mRunning) break;
+            int32_t expected = kPending;
+            // Fails if the round ended without us or if this is a leftover wakeup.
+            if (self.state.compare_exchange_strong(expected, kRunning,
+                                                   std::memory_order_acq_rel)) {
+                renderTasks(workerIndex, self.buffer.data());
+                self.state.store(kDone, std::memory_order_release);
+            }
+        }
+    }
+
+    static void setRealTimePriority(int32_t workerIndex) {
+        sched_param param{};
+        param.sched_priority = kRealTimePriority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+            return;
+        }
+        if (setpriority(PRIO_PROCESS, gettid(), kUrgentAudioNice) != 0) {
+            LOGW("ParallelVoiceRenderer: worker %d could not raise its priority", workerIndex);
+        }
+    }
+
+    static constexpr int kRealTimePriority = 2; // What audioserver gives app callback threads
+    static constexpr int kUrgentAudioNice = -19; // ANDROID_PRIORITY_URGENT_AUDIO
+
+    Worker mWorkers[kMaxWorkers];
+    int32_t mNumWorkers = 0;
+    std::atomic<bool> mRunning{false};
+
+    // Set by the caller of render() before the helpers are woken.
+    marksynth::Synthesizer *mSynth = nullptr;
+    int32_t mRoundFrames = 0;
+    int64_t mBeginTimeNs = 0;
+};
+
+#endif // PARALLEL_VOICE_RENDERER_H
@@ -17,7 +17,9 @@
 #ifndef SYNTH_WORKLOAD_H
 #define SYNTH_WORKLOAD_H
 
+#include <memory>
 #include "../synth/Synthesizer.h"
+#include "ParallelVoiceRenderer.h"
 
 class SynthWorkload {
 public:
@@ -53,6 +55,41 @@ public:
         }
     }
 
+    /**
+     * Render the voices on a pool of threads, or on the calling thread only.
+     * Call this while nothing is rendering. It is not real-time safe.
+     * @param numThreads number of threads including the caller of renderStereo(),
+     *        or 0 to render without timing each thread
+     * @return 0 on success, -1 if numThreads is out of range
+     */
+    int32_t setNumRenderThreads(int32_t numThreads) {
+        mRenderer.reset();
+        if (numThreads == 0) {
+            return 0;
+        }
+        mRenderer = std::make_unique<ParallelVoiceRenderer>();
+        if (mRenderer->start(numThreads) != 0) {
+            mRenderer.reset();
+            return -1;
+        }
+        return 0;
+    }
+
+    /**
+     * @return the number of threads that render the voices, 0 if they are not being timed
+     */
+    int32_t getNumRenderThreads() const {
+        return mRenderer ? mRenderer->getNumWorkers() : 0;
+    }
+
+    /**
+     * Timing of one render thread for the last call to renderStereo().
+     * Thread 0 is the caller of renderStereo().
+     */
+    const ParallelVoiceRenderer::WorkerStatus &getRenderThreadStatus(int32_t threadIndex) const {
+        return mRenderer->getWorkerStatus(threadIndex);
+    }
+
     /**
      * Render the notes into a stereo buffer.
      * Passing a nullptr will cause the calculated results to be discarded.
@@ -61,7 +98,9 @@ public:
      * @param numFrames
      */
     void renderStereo(float *buffer, int numFrames) {
-        if (buffer == nullptr) {
+        if (mRenderer) {
+            mRenderer->render(mSynth, buffer, numFrames);
+        } else if (buffer == nullptr) {
             int framesLeft = numFrames;
             while (framesLeft > 0) {
                 int framesThisTime = std::min(kDummyBufferSizeInFrames, framesLeft);
@@ -77,6 +116,7 @@ public:
 
 private:
     marksynth::Synthesizer   mSynth;
+    std::unique_ptr<ParallelVoiceRenderer> mRenderer;
     static constexpr int     kDummyBufferSizeInFrames = 32;
     float                    mDummyStereoBuffer[kDummyBufferSizeInFrames * 2];
     double                   mPreviousWorkload = 1.0;
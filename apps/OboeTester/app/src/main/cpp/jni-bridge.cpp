@@ -824,6 +824,25 @@ Java_com_mobileer_oboetester_TestInputActivity_saveWaveFile(JNIEnv *env,
     return result;
 }
 
+// ==========================================================================
+JNIEXPORT jint JNICALL
+Java_com_mobileer_oboetester_TestInputActivity_startDiskRecording(JNIEnv *env,
+                                                                  jobject instance,
+                                                                  jstring fileName) {
+    const char *str = env->GetStringUTFChars(fileName, nullptr);
+    LOGD("startDiskRecording(%s)", str);
+    jint result = engine.getCurrentActivity()->startDiskRecording(str);
+    env->ReleaseStringUTFChars(fileName, str);
+    return result;
+}
+
+// ==========================================================================
+JNIEXPORT jlong JNICALL
+Java_com_mobileer_oboetester_TestInputActivity_stopDiskRecording(JNIEnv *env,
+                                                                 jobject instance) {
+    return engine.getCurrentActivity()->stopDiskRecording();
+}
+
 // ==========================================================================
 JNIEXPORT void JNICALL
 Java_com_mobileer_oboetester_TestInputActivity_setMinimumFramesBeforeRead(JNIEnv *env,
@@ -895,6 +914,23 @@ Java_com_mobileer_oboetester_RoundTripLatencyActivity_getSignalRMS(JNIEnv *env,
     return engine.mActivityRoundTripLatency.getLatencyAnalyzer()->getSignalRMS();
 }
 
+JNIEXPORT void JNICALL
+Java_com_mobileer_oboetester_RoundTripLatencyActivity_setStreamingLatencyEnabled(JNIEnv *env,
+                                                                               jobject instance,
+                                                                               jboolean enabled) {
+    engine.mActivityRoundTripLatency.setStreamingEnabled(enabled);
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_mobileer_oboetester_RoundTripLatencyActivity_getStreamingLatencyReport(JNIEnv *env,
+                                                                              jobject instance) {
+    if (!engine.mActivityRoundTripLatency.isStreamingEnabled()) {
+        return env->NewStringUTF("");
+    }
+    std::string report = engine.mActivityRoundTripLatency.getLatencyAnalyzer()->analyze();
+    return env->NewStringUTF(report.c_str());
+}
+
 JNIEXPORT jint JNICALL
 Java_com_mobileer_oboetester_AnalyzerActivity_getMeasuredResult(JNIEnv *env,
                                                                           jobject instance) {
@@ -928,7 +964,7 @@ Java_com_mobileer_oboetester_AnalyzerActivity_getResetCount(JNIEnv *env,
 JNIEXPORT jint JNICALL
 Java_com_mobileer_oboetester_GlitchActivity_getGlitchCount(JNIEnv *env,
                                                            jobject instance) {
-    return engine.mActivityGlitches.getGlitchAnalyzer()->getGlitchCount();
+    return engine.mActivityGlitches.getGlitchCount();
 }
 
 JNIEXPORT jint JNICALL
@@ -1139,6 +1175,7 @@ Java_com_mobileer_oboetester_GlitchActivity_setTolerance(JNIEnv *env,
     if (engine.mActivityGlitches.getGlitchAnalyzer()) {
         engine.mActivityGlitches.getGlitchAnalyzer()->setTolerance(tolerance);
     }
+    engine.mActivityGlitches.getMultiChannelAnalyzer()->setTolerance(tolerance);
 }
 
 JNIEXPORT void JNICALL
@@ -1174,6 +1211,23 @@ Java_com_mobileer_oboetester_GlitchActivity_setOutputChannelNative(JNIEnv *env,
     }
 }
 
+JNIEXPORT void JNICALL
+Java_com_mobileer_oboetester_GlitchActivity_setMultiChannelMaskNative(JNIEnv *env,
+                                                                      jobject instance,
+                                                                      jint channelMask) {
+    engine.mActivityGlitches.setMultiChannelMask((uint32_t) channelMask);
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_mobileer_oboetester_GlitchActivity_getMultiChannelReport(JNIEnv *env,
+                                                                  jobject instance) {
+    if (!engine.mActivityGlitches.isMultiChannelEnabled()) {
+        return env->NewStringUTF("");
+    }
+    std::string report = engine.mActivityGlitches.getMultiChannelAnalyzer()->analyze();
+    return env->NewStringUTF(report.c_str());
+}
+
 JNIEXPORT jint JNICALL
 Java_com_mobileer_oboetester_ManualGlitchActivity_getGlitch(JNIEnv *env, jobject instance,
                                                                       jfloatArray waveform_) {
@@ -1366,10 +1420,10 @@ JNIEXPORT jint JNICALL
 Java_com_mobileer_oboetester_AudioWorkloadTestActivity_start(JNIEnv *env, jobject thiz,
         jint targetDurationMs, jint numBursts, jint numVoices, jint numAlternateVoices,
         jint alternatingPeriodMs, jboolean adpfEnabled, jboolean adpfWorkloadIncreaseEnabled,
-        jboolean hearWorkload) {
+        jboolean hearWorkload, jint numRenderThreads) {
     return sAudioWorkload.start(targetDurationMs, numBursts, numVoices,
                                 numAlternateVoices, alternatingPeriodMs, adpfEnabled,
-                                adpfWorkloadIncreaseEnabled, hearWorkload);
+                                adpfWorkloadIncreaseEnabled, hearWorkload, numRenderThreads);
 }
 
 JNIEXPORT jint JNICALL
@@ -1441,7 +1495,8 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
         return JNI_ERR;
     }
 
-    g_callbackStatusConstructor = env->GetMethodID(g_callbackStatusClass, "<init>", "(IJJII)V");
+    g_callbackStatusConstructor = env->GetMethodID(g_callbackStatusClass, "<init>",
+                                                   "(IJJII[I[I[I)V");
     if (g_callbackStatusConstructor == nullptr) {
         LOGE("JNI_OnLoad: Could not find constructor for %s", callbackStatusClassName);
         if (env->ExceptionCheck()) env->ExceptionDescribe();
@@ -1585,6 +1640,28 @@ Java_com_mobileer_oboetester_AudioWorkloadTestActivity_getCallbackStatistics(JNI
     }
 
     for (const auto& status : cppCallbackStats) {
+        const jsize numThreads = status.numRenderThreads;
+        jint beginOffsets[ParallelVoiceRenderer::kMaxWorkers];
+        jint durations[ParallelVoiceRenderer::kMaxWorkers];
+        jint cpuIndices[ParallelVoiceRenderer::kMaxWorkers];
+        for (jsize i = 0; i < numThreads; i++) {
+            beginOffsets[i] = status.renderThreads[i].beginOffsetNs;
+            durations[i] = status.renderThreads[i].durationNs;
+            cpuIndices[i] = status.renderThreads[i].cpuIndex;
+        }
+        jintArray javaBeginOffsets = env->NewIntArray(numThreads);
+        jintArray javaDurations = env->NewIntArray(numThreads);
+        jintArray javaCpuIndices = env->NewIntArray(numThreads);
+        if (javaBeginOffsets == nullptr || javaDurations == nullptr || javaCpuIndices == nullptr) {
+            LOGE("Error: Could not create render thread arrays.");
+            if (env->ExceptionCheck()) env->ExceptionDescribe();
+            env->DeleteLocalRef(javaList);
+            return nullptr;
+        }
+        env->SetIntArrayRegion(javaBeginOffsets, 0, numThreads, beginOffsets);
+        env->SetIntArrayRegion(javaDurations, 0, numThreads, durations);
+        env->SetIntArrayRegion(javaCpuIndices, 0, numThreads, cpuIndices);
+
         jobject javaStatus = env->NewObject(
                 g_callbackStatusClass,
                 g_callbackStatusConstructor,
@@ -1592,8 +1669,14 @@ Java_com_mobileer_oboetester_AudioWorkloadTestActivity_getCallbackStatistics(JNI
                 (jlong)status.beginTimeNs,
                 (jlong)status.finishTimeNs,
                 (jint)status.xRunCount,
-                (jint)status.cpuIndex
+                (jint)status.cpuIndex,
+                javaBeginOffsets,
+                javaDurations,
+                javaCpuIndices
         );
+        env->DeleteLocalRef(javaBeginOffsets);
+        env->DeleteLocalRef(javaDurations);
+        env->DeleteLocalRef(javaCpuIndices);
         if (javaStatus == nullptr) {
             LOGE("Error: Could not create new CallbackStatus object.");
             if (env->ExceptionCheck()) env->ExceptionDescribe();
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNTHMARK_LANE_MATH_H
+#define SYNTHMARK_LANE_MATH_H
+
+#include <cstdint>
+#include <math.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SYNTHMARK_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SYNTHMARK_USE_SSE2 1
+#endif
+
+namespace marksynth {
+
+// Number of voices that are rendered together in one SIMD register.
+constexpr int kVoiceLanes = 4;
+
+#if SYNTHMARK_USE_NEON
+typedef float32x4_t lane_float_t;
+typedef uint32x4_t lane_mask_t;
+#elif SYNTHMARK_USE_SSE2
+typedef __m128 lane_float_t;
+typedef __m128 lane_mask_t;
+#else
+struct lane_float_t {
+    float v[kVoiceLanes];
+};
+struct lane_mask_t {
+    bool v[kVoiceLanes];
+};
+#endif
+
+/**
+ * Arithmetic on kVoiceLanes floats at a time, one float per voice.
+ * Uses NEON or SSE2 when available, otherwise plain loops that the compiler may vectorize.
+ */
+class LaneMath
+{
+public:
+#if SYNTHMARK_USE_NEON
+    static lane_float_t set(float value) { return vdupq_n_f32(value); }
+    static lane_float_t load(const float *p) { return vld1q_f32(p); }
+    static void store(float *p, lane_float_t a) { vst1q_f32(p, a); }
+    static lane_float_t add(lane_float_t a, lane_float_t b) { return vaddq_f32(a, b); }
+    static lane_float_t sub(lane_float_t a, lane_float_t b) { return vsubq_f32(a, b); }
+    static lane_float_t mul(lane_float_t a, lane_float_t b) { return vmulq_f32(a, b); }
+    static lane_float_t min(lane_float_t a, lane_float_t b) { return vminq_f32(a, b); }
+    static lane_float_t max(lane_float_t a, lane_float_t b) { return vmaxq_f32(a, b); }
+    static lane_float_t abs(lane_float_t a) { return vabsq_f32(a); }
+    static lane_float_t negate(lane_float_t a) { return vnegq_f32(a); }
+    static lane_mask_t lessThan(lane_float_t a, lane_float_t b) { return vcltq_f32(a, b); }
+    static lane_mask_t greaterThan(lane_float_t a, lane_float_t b) { return vcgtq_f32(a, b); }
+    static lane_mask_t greaterEqual(lane_float_t a, lane_float_t b) { return vcgeq_f32(a, b); }
+    static lane_mask_t maskOr(lane_mask_t a, lane_mask_t b) { return vorrq_u32(a, b); }
+    static lane_float_t select(lane_mask_t mask, lane_float_t a, lane_float_t b) {
+        return vbslq_f32(mask, a, b);
+    }
+    static lane_float_t divide(lane_float_t a, lane_float_t b) {
+#if defined(__aarch64__)
+        return vdivq_f32(a, b);
+#else
+        // Refine the reciprocal estimate to full precision with two Newton-Raphson steps.
+        float32x4_t reciprocal = vrecpeq_f32(b);
+        reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+        reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+        return vmulq_f32(a, reciprocal);
+#endif
+    }
+    static lane_float_t floor(lane_float_t a) {
+        lane_float_t truncated = vcvtq_f32_s32(vcvtq_s32_f32(a));
+        lane_float_t correction = vreinterpretq_f32_u32(
+                vandq_u32(vcgtq_f32(truncated, a), vreinterpretq_u32_f32(vdupq_n_f32(1.0f))));
+        return vsubq_f32(truncated, correction);
+    }
+    static lane_float_t scaleByPowerOfTwo(lane_float_t a, lane_float_t wholeNumber) {
+        int32x4_t exponent = vshlq_n_s32(vcvtq_s32_f32(wholeNumber), 23);
+        return vreinterpretq_f32_s32(vaddq_s32(vreinterpretq_s32_f32(a), exponent));
+    }
+    static int32_t maskBits(lane_mask_t mask) {
+        const int32x4_t shifts = {0, 1, 2, 3};
+        uint32x4_t bits = vshlq_u32(vshrq_n_u32(mask, 31), shifts);
+        uint32x2_t pairs = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+        return (int32_t) (vget_lane_u32(pairs, 0) | vget_lane_u32(pairs, 1));
+    }
+    static float sum(lane_float_t a) {
+        float32x2_t pairs = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+        return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+    }
+#elif SYNTHMARK_USE_SSE2
+    static lane_float_t set(float value) { return _mm_set1_ps(value); }
+    static lane_float_t load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, lane_float_t a) { _mm_storeu_ps(p, a); }
+    static lane_float_t add(lane_float_t a, lane_float_t b) { return _mm_add_ps(a, b); }
+    static lane_float_t sub(lane_float_t a, lane_float_t b) { return _mm_sub_ps(a, b); }
+    static lane_float_t mul(lane_float_t a, lane_float_t b) { return _mm_mul_ps(a, b); }
+    static lane_float_t min(lane_float_t a, lane_float_t b) { return _mm_min_ps(a, b); }
+    static lane_float_t max(lane_float_t a, lane_float_t b) { return _mm_max_ps(a, b); }
+    static lane_float_t abs(lane_float_t a) {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+    }
+    static lane_float_t negate(lane_float_t a) {
+        return _mm_xor_ps(_mm_set1_ps(-0.0f), a);
+    }
+    static lane_mask_t lessThan(lane_float_t a, lane_float_t b) { return _mm_cmplt_ps(a, b); }
+    static lane_mask_t greaterThan(lane_float_t a, lane_float_t b) { return _mm_cmpgt_ps(a, b); }
+    static lane_mask_t greaterEqual(lane_float_t a, lane_float_t b) { return _mm_cmpge_ps(a, b); }
+    static lane_mask_t maskOr(lane_mask_t a, lane_mask_t b) { return _mm_or_ps(a, b); }
+    static lane_float_t select(lane_mask_t mask, lane_float_t a, lane_float_t b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    static lane_float_t divide(lane_float_t a, lane_float_t b) { return _mm_div_ps(a, b); }
+    static lane_float_t floor(lane_float_t a) {
+        lane_float_t truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        lane_float_t correction = _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f));
+        return _mm_sub_ps(truncated, correction);
+    }
+    static lane_float_t scaleByPowerOfTwo(lane_float_t a, lane_float_t wholeNumber) {
+        __m128i exponent = _mm_slli_epi32(_mm_cvttps_epi32(wholeNumber), 23);
+        return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(a), exponent));
+    }
+    static int32_t maskBits(lane_mask_t mask) { return _mm_movemask_ps(mask); }
+    static float sum(lane_float_t a) {
+        __m128 pairs = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+#else
+    static lane_float_t set(float value) {
+        lane_float_t result;
+        for (int i = 0; i < kVoiceLanes; i++) result.v[i] = value;
+        return result;
+    }
+    static lane_float_t load(const float *p) {
+        lane_float_t result;
+        for (int i = 0; i < kVoiceLanes; i++) result.v[i] = p[i];
+        return result;
+    }
+    static void store(float *p, lane_float_t a) {
+        for (int i = 0; i < kVoiceLanes; i++) p[i] = a.v[i];
+    }
+    static lane_float_t add(lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] += b.v[i];
+        return a;
+    }
+    static lane_float_t sub(lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] -= b.v[i];
+        return a;
+    }
+    static lane_float_t mul(lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] *= b.v[i];
+        return a;
+    }
+    static lane_float_t min(lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = (b.v[i] < a.v[i]) ? b.v[i] : a.v[i];
+        return a;
+    }
+    static lane_float_t max(lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = (b.v[i] > a.v[i]) ? b.v[i] : a.v[i];
+        return a;
+    }
+    static lane_float_t abs(lane_float_t a) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = fabsf(a.v[i]);
+        return a;
+    }
+    static lane_float_t negate(lane_float_t a) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = -a.v[i];
+        return a;
+    }
+    static lane_mask_t lessThan(lane_float_t a, lane_float_t b) {
+        lane_mask_t result;
+        for (int i = 0; i < kVoiceLanes; i++) result.v[i] = a.v[i] < b.v[i];
+        return result;
+    }
+    static lane_mask_t greaterThan(lane_float_t a, lane_float_t b) {
+        return lessThan(b, a);
+    }
+    static lane_mask_t greaterEqual(lane_float_t a, lane_float_t b) {
+        lane_mask_t result;
+        for (int i = 0; i < kVoiceLanes; i++) result.v[i] = a.v[i] >= b.v[i];
+        return result;
+    }
+    static lane_mask_t maskOr(lane_mask_t a, lane_mask_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = a.v[i] || b.v[i];
+        return a;
+    }
+    static lane_float_t select(lane_mask_t mask, lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+        return a;
+    }
+    static lane_float_t divide(lane_float_t a, lane_float_t b) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] /= b.v[i];
+        return a;
+    }
+    static lane_float_t floor(lane_float_t a) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = floorf(a.v[i]);
+        return a;
+    }
+    static lane_float_t scaleByPowerOfTwo(lane_float_t a, lane_float_t wholeNumber) {
+        for (int i = 0; i < kVoiceLanes; i++) a.v[i] = ldexpf(a.v[i], (int) wholeNumber.v[i]);
+        return a;
+    }
+    static int32_t maskBits(lane_mask_t mask) {
+        int32_t bits = 0;
+        for (int i = 0; i < kVoiceLanes; i++) bits |= mask.v[i] ? (1 << i) : 0;
+        return bits;
+    }
+    static float sum(lane_float_t a) {
+        return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]);
+    }
+#endif
+
+    /**
+     * Same as SynthTools::fastSine() in every lane.
+     * @param phase between -PI and +PI
+     */
+    static lane_float_t fastSine(lane_float_t phase) {
+        const lane_float_t halfPi = set((float) M_PI_2);
+        const lane_float_t pi = set((float) M_PI);
+        lane_float_t x = select(greaterThan(phase, halfPi), sub(pi, phase),
+                                select(lessThan(phase, negate(halfPi)),
+                                       negate(add(pi, phase)), phase));
+        lane_float_t x2 = mul(x, x);
+        return mul(x, polynomial(x2, kSineCoefficients, 6));
+    }
+
+    /**
+     * Same as SynthTools::fastCosine() in every lane.
+     * @param phase between -PI and +PI
+     */
+    static lane_float_t fastCosine(lane_float_t phase) {
+        const lane_float_t halfPi = set((float) M_PI_2);
+        lane_float_t x = abs(phase);
+        lane_mask_t negative = greaterThan(x, halfPi);
+        x = select(negative, sub(halfPi, x), x);
+        lane_float_t cosine = polynomial(mul(x, x), kCosineCoefficients, 6);
+        return select(negative, negate(cosine), cosine);
+    }
+
+    /**
+     * Calculate 2 to the power of x without a table lookup.
+     * The relative error is below 1.0E-7, so this is more accurate than PowerOfTwoTable.
+     */
+    static lane_float_t powerOfTwo(lane_float_t x) {
+        lane_float_t wholeNumber = floor(x);
+        lane_float_t fraction = polynomial(sub(x, wholeNumber), kPowerOfTwoCoefficients, 6);
+        return scaleByPowerOfTwo(fraction, wholeNumber);
+    }
+
+private:
+    // Evaluate a polynomial using Horner's method. Coefficients start with the highest power.
+    static lane_float_t polynomial(lane_float_t x, const float *coefficients, int count) {
+        lane_float_t result = set(coefficients[0]);
+        for (int i = 1; i < count; i++) {
+            result = add(mul(result, x), set(coefficients[i]));
+        }
+        return result;
+    }
+
+    // Taylor series in x squared, matching SynthTools.
+    static constexpr float kSineCoefficients[6] = {
+            (float) (-1.0 / 39916800.0), (float) (1.0 / 362880.0), (float) (-1.0 / 5040.0),
+            (float) (1.0 / 120.0), (float) (-1.0 / 6.0), 1.0f};
+    static constexpr float kCosineCoefficients[6] = {
+            (float) (-1.0 / 3628800.0), (float) (1.0 / 40320.0), (float) (-1.0 / 720.0),
+            (float) (1.0 / 24.0), -0.5f, 1.0f};
+    // Minimax fit of 2^x between 0.0 and 1.0.
+    static constexpr float kPowerOfTwoCoefficients[6] = {
+            1.8775767e-3f, 8.9893397e-3f, 5.5826318e-2f,
+            2.4015361e-1f, 6.9315308e-1f, 9.9999994e-1f};
+};
+
+};
+#endif // SYNTHMARK_LANE_MATH_H
@@ -154,12 +154,19 @@ public:
      * Calculate random 32 bit number using linear-congruential method.
      */
     static uint32_t nextRandomInteger() {
-        static uint64_t seed = 99887766;
+        uint64_t &seed = randomSeed();
         // Use values for 64-bit sequence from MMIX by Donald Knuth.
         seed = (seed * 6364136223846793005L) + 1442695040888963407L;
         return (uint32_t) (seed >> 32); // The higher bits have a longer sequence.
     }
 
+    /**
+     * Restart the random sequence, for example to build two synthesizers with the same voices.
+     */
+    static void setRandomSeed(uint64_t seed) {
+        randomSeed() = seed;
+    }
+
     /**
      * @return a random double between 0.0 and 1.0
      */
@@ -168,6 +175,12 @@ public:
         return nextRandomInteger() * scaler;
     }
 
+private:
+    static uint64_t &randomSeed() {
+        static uint64_t seed = 99887766;
+        return seed;
+    }
+
 };
 };
 #endif // SYNTHMARK_SYNTHTOOLS_H
@@ -25,6 +25,7 @@
 #include "SynthTools.h"
 #include "VoiceBase.h"
 #include "SimpleVoice.h"
+#include "VoiceBank.h"
 
 namespace marksynth {
 #define SAMPLES_PER_FRAME   2
@@ -37,6 +38,11 @@ namespace marksynth {
 class Synthesizer
 {
 public:
+    enum class VoiceEngine {
+        Scalar, // one SimpleVoice at a time
+        Vector, // kVoiceLanes voices at a time in a VoiceBank
+    };
+
     Synthesizer()
     : mMaxVoices(0)
     , mActiveVoiceCount(0)
@@ -47,9 +53,14 @@ public:
         delete[] mVoices;
     };
 
-    int32_t setup(int32_t sampleRate, int32_t maxVoices) {
+    int32_t setup(int32_t sampleRate, int32_t maxVoices,
+                  VoiceEngine engine = VoiceEngine::Vector) {
         mMaxVoices = maxVoices;
+        mEngine = engine;
         UnitGenerator::setSampleRate(sampleRate);
+        if (mEngine == VoiceEngine::Vector) {
+            return mVoiceBank.setup(mMaxVoices);
+        }
         mVoices = new SimpleVoice[mMaxVoices];
         return (mVoices == NULL) ? -1 : 0;
     }
@@ -69,55 +80,75 @@ public:
         int pitchIndex = 0;
         synth_float_t pitches[] = {60.0, 64.0, 67.0, 69.0};
         for(int iv = 0; iv < mActiveVoiceCount; iv++ ) {
-            SimpleVoice *voice = &mVoices[iv];
             // Randomize pitches by a few cents to smooth out the CPU load.
             float pitchOffset = 0.03f * (float) SynthTools::nextRandomDouble();
             synth_float_t pitch = pitches[pitchIndex++] + pitchOffset;
             if (pitchIndex > 3) pitchIndex = 0;
-            voice->noteOn(pitch, 1.0);
+            if (mEngine == VoiceEngine::Vector) {
+                mVoiceBank.noteOn(iv, pitch);
+            } else {
+                mVoices[iv].noteOn(pitch, 1.0);
+            }
+        }
+        if (mEngine == VoiceEngine::Vector) {
+            // Silence the unused lanes of the last group.
+            for (int iv = 0; iv < mMaxVoices; iv++) {
+                synth_float_t leftGain = 0.0f;
+                synth_float_t rightGain = 0.0f;
+                if (iv < mActiveVoiceCount) {
+                    getGains(iv, &leftGain, &rightGain);
+                }
+                mVoiceBank.setGains(iv, leftGain, rightGain);
+            }
         }
         return 0;
     }
 
     void allNotesOff() {
         for(int iv = 0; iv < mActiveVoiceCount; iv++ ) {
-            SimpleVoice *voice = &mVoices[iv];
-            voice->noteOff();
+            if (mEngine == VoiceEngine::Vector) {
+                mVoiceBank.noteOff(iv);
+            } else {
+                mVoices[iv].noteOff();
+            }
         }
     }
 
     void renderStereo(float *output, int32_t numFrames) {
-        int32_t framesLeft = numFrames;
-        float *renderBuffer = output;
-
         // Clear mixing buffer.
         memset(output, 0, numFrames * SAMPLES_PER_FRAME * sizeof(float));
 
-        while (framesLeft > 0) {
-            int framesThisTime = std::min(kSynthmarkFramesPerRender, framesLeft);
-            for(int iv = 0; iv < mActiveVoiceCount; iv++ ) {
-                SimpleVoice *voice = &mVoices[iv];
-                voice->generate(framesThisTime);
-                float *mix = renderBuffer;
-
-                synth_float_t leftGain = mVoiceAmplitude;
-                synth_float_t rightGain = mVoiceAmplitude;
-                if (mActiveVoiceCount > 1) {
-                    synth_float_t pan = iv / (mActiveVoiceCount - 1.0f);
-                    leftGain *= pan;
-                    rightGain *= 1.0 - pan;
-                }
-                for(int n = 0; n < kSynthmarkFramesPerRender; n++ ) {
-                    synth_float_t sample = voice->output[n];
-                    *mix++ += (float) (sample * leftGain);
-                    *mix++ += (float) (sample * rightGain);
-                }
+        if (mEngine == VoiceEngine::Vector) {
+            mVoiceBank.mixStereo(output, numFrames, mActiveVoiceCount);
+        } else {
+            for (int iv = 0; iv < mActiveVoiceCount; iv++) {
+                mixVoice(iv, output, numFrames);
             }
-            framesLeft -= framesThisTime;
-            mFrameCounter += framesThisTime;
-            renderBuffer += framesThisTime * SAMPLES_PER_FRAME;
         }
-        assert(framesLeft == 0);
+        mFrameCounter += numFrames;
+    }
+
+    /**
+     * Rendering is split into tasks that can be spread across threads.
+     * @return number of tasks needed to render the active voices
+     */
+    int32_t getRenderTaskCount() const {
+        return (mEngine == VoiceEngine::Vector)
+                ? mVoiceBank.getGroupCount(mActiveVoiceCount)
+                : mActiveVoiceCount;
+    }
+
+    /**
+     * Render one task and add it to a stereo buffer.
+     * Different tasks may run on different threads at the same time.
+     * Adding every task to a cleared buffer gives the same result as renderStereo().
+     */
+    void mixRenderTask(int32_t taskIndex, float *output, int32_t numFrames) {
+        if (mEngine == VoiceEngine::Vector) {
+            mVoiceBank.mixGroup(taskIndex, output, numFrames);
+        } else {
+            mixVoice(taskIndex, output, numFrames);
+        }
     }
 
     int32_t getActiveVoiceCount() {
@@ -125,10 +156,42 @@ public:
     }
 
 private:
+    void mixVoice(int32_t voiceIndex, float *output, int32_t numFrames) {
+        SimpleVoice *voice = &mVoices[voiceIndex];
+        synth_float_t leftGain;
+        synth_float_t rightGain;
+        getGains(voiceIndex, &leftGain, &rightGain);
+        int32_t framesLeft = numFrames;
+        float *mix = output;
+        while (framesLeft > 0) {
+            int framesThisTime = std::min(kSynthmarkFramesPerRender, framesLeft);
+            voice->generate(framesThisTime);
+            for(int n = 0; n < framesThisTime; n++ ) {
+                synth_float_t sample = voice->output[n];
+                *mix++ += (float) (sample * leftGain);
+                *mix++ += (float) (sample * rightGain);
+            }
+            framesLeft -= framesThisTime;
+        }
+    }
+
+    // Pan the voices from right to left.
+    void getGains(int32_t voiceIndex, synth_float_t *leftGain, synth_float_t *rightGain) {
+        *leftGain = mVoiceAmplitude;
+        *rightGain = mVoiceAmplitude;
+        if (mActiveVoiceCount > 1) {
+            synth_float_t pan = voiceIndex / (mActiveVoiceCount - 1.0f);
+            *leftGain *= pan;
+            *rightGain *= 1.0 - pan;
+        }
+    }
+
     int32_t mMaxVoices;
     int32_t mActiveVoiceCount;
-    int64_t mFrameCounter;
+    int64_t mFrameCounter = 0;
     SimpleVoice *mVoices;
+    VoiceBank mVoiceBank;
+    VoiceEngine mEngine = VoiceEngine::Vector;
     synth_float_t mVoiceAmplitude = 1.0;
 };
 };
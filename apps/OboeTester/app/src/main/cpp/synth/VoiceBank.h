@@ -0,0 +1,534 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYNTHMARK_VOICE_BANK_H
+#define SYNTHMARK_VOICE_BANK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <math.h>
+#include "SynthTools.h"
+#include "UnitGenerator.h"
+#include "BiquadFilter.h"
+#include "EnvelopeADSR.h"
+#include "PitchToFrequency.h"
+#include "LaneMath.h"
+
+namespace marksynth {
+
+/**
+ * The same contour as EnvelopeADSR, for kVoiceLanes voices at once.
+ *
+ * Every stage is a multiply and an add, so all lanes advance together.
+ * The state machine only runs for a lane when its level crosses the
+ * limit for its stage or its gate changes.
+ */
+class LaneEnvelope
+{
+public:
+    LaneEnvelope() {
+        for (int lane = 0; lane < kVoiceLanes; lane++) {
+            mLevel[lane] = 0.0f;
+            updateLane(lane);
+        }
+    }
+
+    void setAttackTime(int lane, synth_float_t time) {
+        mAttack[lane] = time;
+    }
+
+    void setDecayTime(int lane, synth_float_t time) {
+        mDecay[lane] = time;
+    }
+
+    void setGate(int lane, bool gate) {
+        mTriggered[lane] = gate;
+        updateLane(lane);
+    }
+
+    /**
+     * Envelope values held in registers while a block is rendered.
+     */
+    struct Registers {
+        lane_float_t level;
+        lane_float_t multiplier;
+        lane_float_t offset;
+        lane_float_t outputOffset;
+        lane_float_t lowerLimit;
+        lane_float_t upperLimit;
+    };
+
+    void load(Registers &registers) const {
+        registers.level = LaneMath::load(mLevel);
+        registers.multiplier = LaneMath::load(mMultiplier);
+        registers.offset = LaneMath::load(mOffset);
+        registers.outputOffset = LaneMath::load(mOutputOffset);
+        registers.lowerLimit = LaneMath::load(mLowerLimit);
+        registers.upperLimit = LaneMath::load(mUpperLimit);
+    }
+
+    void save(const Registers &registers) {
+        LaneMath::store(mLevel, registers.level);
+    }
+
+    /**
+     * Advance every lane by one sample.
+     * @return the envelope value for this sample
+     */
+    lane_float_t next(Registers &registers) {
+        lane_float_t output = LaneMath::add(registers.level, registers.outputOffset);
+        lane_float_t level = LaneMath::add(LaneMath::mul(registers.level, registers.multiplier),
+                                           registers.offset);
+        lane_mask_t changed = LaneMath::maskOr(
+                LaneMath::lessThan(level, registers.lowerLimit),
+                LaneMath::greaterEqual(level, registers.upperLimit));
+        int32_t changedLanes = LaneMath::maskBits(changed);
+        if (changedLanes == 0) {
+            registers.level = level;
+        } else {
+            output = changeStages(registers, level, changedLanes);
+        }
+        return output;
+    }
+
+private:
+    enum State {
+        IDLE, ATTACKING, DECAYING, SUSTAINING, RELEASING
+    };
+
+    // Rare, so keep it out of the sample loop.
+    __attribute__((noinline))
+    lane_float_t changeStages(Registers &registers, lane_float_t level, int32_t changedLanes) {
+        float outputs[kVoiceLanes];
+        LaneMath::store(outputs, LaneMath::add(registers.level, registers.outputOffset));
+        LaneMath::store(mLevel, registers.level);
+        float levels[kVoiceLanes];
+        LaneMath::store(levels, level);
+        for (int lane = 0; lane < kVoiceLanes; lane++) {
+            if (changedLanes & (1 << lane)) {
+                outputs[lane] = generateOne(lane);
+            } else {
+                mLevel[lane] = levels[lane];
+            }
+        }
+        load(registers);
+        return LaneMath::load(outputs);
+    }
+
+    // One sample of EnvelopeADSR::generate() for one lane.
+    synth_float_t generateOne(int lane) {
+        synth_float_t &level = mLevel[lane];
+        synth_float_t output = level;
+        switch (mState[lane]) {
+            case IDLE:
+                if (mTriggered[lane]) {
+                    startAttack(lane);
+                }
+                break;
+
+            case ATTACKING:
+                level += mIncrement[lane];
+                if (level >= 1.0) {
+                    level = 1.0;
+                    output = level;
+                    startDecay(lane);
+                } else {
+                    output = level;
+                    if (!mTriggered[lane]) {
+                        startRelease(lane);
+                    }
+                }
+                break;
+
+            case DECAYING:
+                level *= mScaler[lane];
+                if (level < kAmplitudeDb96) {
+                    startIdle(lane);
+                } else if (!mTriggered[lane]) {
+                    startRelease(lane);
+                } else if (level < mSustainLevel) {
+                    level = mSustainLevel;
+                    startSustain(lane);
+                }
+                break;
+
+            case SUSTAINING:
+                level = mSustainLevel;
+                output = level;
+                if (!mTriggered[lane]) {
+                    startRelease(lane);
+                }
+                break;
+
+            case RELEASING:
+                level *= mScaler[lane];
+                if (mTriggered[lane]) {
+                    startAttack(lane);
+                } else if (level < kAmplitudeDb96) {
+                    startIdle(lane);
+                }
+                break;
+        }
+        updateLane(lane);
+        return output;
+    }
+
+    void startIdle(int lane) {
+        mState[lane] = IDLE;
+        mLevel[lane] = 0.0;
+    }
+
+    void startAttack(int lane) {
+        if (mAttack[lane] < MIN_DURATION) {
+            mLevel[lane] = 1.0;
+            startDecay(lane);
+        } else {
+            mIncrement[lane] = UnitGenerator::mSamplePeriod / mAttack[lane];
+            mState[lane] = ATTACKING;
+        }
+    }
+
+    void startDecay(int lane) {
+        double duration = mDecay[lane];
+        if (duration < MIN_DURATION) {
+            startSustain(lane);
+        } else {
+            mScaler[lane] = SynthTools::convertTimeToExponentialScaler(
+                    duration, UnitGenerator::mSampleRate);
+            mState[lane] = DECAYING;
+        }
+    }
+
+    void startSustain(int lane) {
+        // EnvelopeADSR sets the level on the next sample. Nothing reads it before then.
+        mLevel[lane] = mSustainLevel;
+        mState[lane] = SUSTAINING;
+    }
+
+    void startRelease(int lane) {
+        double duration = mRelease;
+        if (duration < MIN_DURATION) {
+            duration = MIN_DURATION;
+        }
+        mScaler[lane] = SynthTools::convertTimeToExponentialScaler(
+                duration, UnitGenerator::mSampleRate);
+        mState[lane] = RELEASING;
+    }
+
+    // Express the current stage as level * multiplier + offset with limits.
+    // A gate that does not match the stage forces a change on the next sample.
+    void updateLane(int lane) {
+        const synth_float_t kNone = HUGE_VALF;
+        bool gateChanged = false;
+        mMultiplier[lane] = 1.0f;
+        mOffset[lane] = 0.0f;
+        mOutputOffset[lane] = 0.0f;
+        mLowerLimit[lane] = -kNone;
+        mUpperLimit[lane] = kNone;
+        switch (mState[lane]) {
+            case IDLE:
+                gateChanged = mTriggered[lane];
+                break;
+            case ATTACKING:
+                mOffset[lane] = mIncrement[lane];
+                mOutputOffset[lane] = mIncrement[lane];
+                mUpperLimit[lane] = 1.0f;
+                gateChanged = !mTriggered[lane];
+                break;
+            case DECAYING:
+                mMultiplier[lane] = mScaler[lane];
+                mLowerLimit[lane] = std::max((synth_float_t) kAmplitudeDb96, mSustainLevel);
+                gateChanged = !mTriggered[lane];
+                break;
+            case SUSTAINING:
+                gateChanged = !mTriggered[lane];
+                break;
+            case RELEASING:
+                mMultiplier[lane] = mScaler[lane];
+                mLowerLimit[lane] = kAmplitudeDb96;
+                gateChanged = mTriggered[lane];
+                break;
+        }
+        if (gateChanged) {
+            mLowerLimit[lane] = kNone;
+        }
+    }
+
+    // Same stage settings as EnvelopeADSR.
+    synth_float_t mSustainLevel = 0.4;
+    synth_float_t mRelease = 2.5;
+
+    synth_float_t mAttack[kVoiceLanes] = {0.05, 0.05, 0.05, 0.05};
+    synth_float_t mDecay[kVoiceLanes] = {0.6, 0.6, 0.6, 0.6};
+    State mState[kVoiceLanes] = {IDLE, IDLE, IDLE, IDLE};
+    synth_float_t mScaler[kVoiceLanes] = {1.0, 1.0, 1.0, 1.0};
+    synth_float_t mIncrement[kVoiceLanes] = {};
+    bool mTriggered[kVoiceLanes] = {};
+
+    // Stage as a multiply and add, see updateLane().
+    synth_float_t mLevel[kVoiceLanes];
+    synth_float_t mMultiplier[kVoiceLanes];
+    synth_float_t mOffset[kVoiceLanes];
+    synth_float_t mOutputOffset[kVoiceLanes];
+    synth_float_t mLowerLimit[kVoiceLanes];
+    synth_float_t mUpperLimit[kVoiceLanes];
+};
+
+/**
+ * An array of voices that sound like SimpleVoice, rendered kVoiceLanes at a time.
+ *
+ * Each group of voices keeps its state as a structure of arrays, one lane per voice.
+ * A group renders a whole buffer with its state in registers, updating the
+ * filter coefficients for every kSynthmarkFramesPerRender frames like SimpleVoice.
+ * Pitch to frequency is a polynomial instead of a table lookup, and the
+ * filter feedback is single precision, so the output is close to SimpleVoice but not identical.
+ */
+class VoiceBank
+{
+public:
+    VoiceBank() {}
+
+    virtual ~VoiceBank() {
+        delete[] mGroups;
+    }
+
+    /**
+     * Draws the same random numbers in the same order as constructing
+     * an array of SimpleVoices.
+     */
+    int32_t setup(int32_t maxVoices) {
+        delete[] mGroups;
+        mNumGroups = (maxVoices + kVoiceLanes - 1) / kVoiceLanes;
+        mGroups = new VoiceGroup[mNumGroups];
+        for (int iv = 0; iv < maxVoices; iv++) {
+            VoiceGroup &group = mGroups[iv / kVoiceLanes];
+            int lane = iv % kVoiceLanes;
+            // Randomize attack times to smooth out CPU load for envelope state transitions.
+            group.filterEnvelope.setAttackTime(lane, 0.05 + (0.2 * SynthTools::nextRandomDouble()));
+            group.filterEnvelope.setDecayTime(lane, 7.0 + (1.0 * SynthTools::nextRandomDouble()));
+            group.amplitudeEnvelope.setAttackTime(lane,
+                    0.02 + (0.05 * SynthTools::nextRandomDouble()));
+            group.amplitudeEnvelope.setDecayTime(lane,
+                    1.0 + (0.2 * SynthTools::nextRandomDouble()));
+        }
+        return 0;
+    }
+
+    void noteOn(int32_t voiceIndex, synth_float_t pitch) {
+        VoiceGroup &group = mGroups[voiceIndex / kVoiceLanes];
+        int lane = voiceIndex % kVoiceLanes;
+        group.pitch[lane] = pitch;
+        group.filterEnvelope.setGate(lane, true);
+        group.amplitudeEnvelope.setGate(lane, true);
+    }
+
+    void noteOff(int32_t voiceIndex) {
+        VoiceGroup &group = mGroups[voiceIndex / kVoiceLanes];
+        int lane = voiceIndex % kVoiceLanes;
+        group.filterEnvelope.setGate(lane, false);
+        group.amplitudeEnvelope.setGate(lane, false);
+    }
+
+    /**
+     * Set the stereo gains used by mixStereo().
+     */
+    void setGains(int32_t voiceIndex, synth_float_t leftGain, synth_float_t rightGain) {
+        VoiceGroup &group = mGroups[voiceIndex / kVoiceLanes];
+        int lane = voiceIndex % kVoiceLanes;
+        group.leftGain[lane] = leftGain;
+        group.rightGain[lane] = rightGain;
+    }
+
+    /**
+     * Voices that share a group with an active voice are also rendered, so give them
+     * zero gain.
+     * @return number of groups that hold the voices below numVoices
+     */
+    int32_t getGroupCount(int32_t numVoices) const {
+        return std::min(mNumGroups, (numVoices + kVoiceLanes - 1) / kVoiceLanes);
+    }
+
+    /**
+     * Render one group of voices and add it to a stereo buffer.
+     * Different groups may be rendered on different threads at the same time.
+     */
+    void mixGroup(int32_t groupIndex, float *output, int32_t numFrames) {
+        mixGroup(mGroups[groupIndex], output, numFrames);
+    }
+
+    /**
+     * Render voices and add them to a stereo buffer.
+     * @param numVoices render the groups that hold the voices below this index
+     */
+    void mixStereo(float *output, int32_t numFrames, int32_t numVoices) {
+        int32_t numGroups = getGroupCount(numVoices);
+        for (int32_t groupIndex = 0; groupIndex < numGroups; groupIndex++) {
+            mixGroup(mGroups[groupIndex], output, numFrames);
+        }
+    }
+
+private:
+    struct VoiceGroup {
+        synth_float_t pitch[kVoiceLanes] = {60.0, 60.0, 60.0, 60.0}; // MIDI Middle C is 60
+        synth_float_t leftGain[kVoiceLanes] = {};
+        synth_float_t rightGain[kVoiceLanes] = {};
+        synth_float_t lfoPhase[kVoiceLanes] = {};
+        synth_float_t osc1Phase[kVoiceLanes] = {};
+        synth_float_t osc2Phase[kVoiceLanes] = {};
+        synth_float_t xn1[kVoiceLanes] = {};   // filter delay lines
+        synth_float_t xn2[kVoiceLanes] = {};
+        synth_float_t yn1[kVoiceLanes] = {};
+        synth_float_t yn2[kVoiceLanes] = {};
+        LaneEnvelope filterEnvelope;
+        LaneEnvelope amplitudeEnvelope;
+    };
+
+    // Same settings as SimpleVoice.
+    static constexpr synth_float_t kDetune = 1.0001f;
+    static constexpr synth_float_t kVibratoDepth = 0.03f;    // in semitones
+    static constexpr synth_float_t kVibratoRate = 6.0f;      // in Hertz
+    static constexpr synth_float_t kFilterEnvDepth = 3000.0f; // in Hertz
+    static constexpr synth_float_t kFilterCutoff = 400.0f;   // in Hertz
+    static constexpr synth_float_t kFilterQ = 2.0f;
+
+    static lane_float_t wrapPhase(lane_float_t phase) {
+        const lane_float_t one = LaneMath::set(1.0f);
+        return LaneMath::select(LaneMath::greaterThan(phase, one),
+                                LaneMath::sub(phase, LaneMath::set(2.0f)), phase);
+    }
+
+    void mixGroup(VoiceGroup &group, float *output, int32_t numFrames) {
+        using L = LaneMath;
+        const synth_float_t samplePeriod = UnitGenerator::mSamplePeriod;
+        const lane_float_t pi = L::set((float) M_PI);
+        const lane_float_t one = L::set(1.0f);
+        const lane_float_t two = L::set(2.0f);
+        const lane_float_t lfoIncrement = L::set(2.0 * kVibratoRate * samplePeriod);
+        const lane_float_t vibratoDepth = L::set(kVibratoDepth);
+        const lane_float_t octavesPerSemitone = L::set(1.0 / kSemitonesPerOctave);
+        const lane_float_t middleC = L::set(kPitchMiddleC);
+        const lane_float_t frequencyMiddleC = L::set(kFrequencyMiddleC);
+        const lane_float_t incrementPerHertz = L::set(2.0f * samplePeriod);
+        const lane_float_t detune = L::set(kDetune);
+        const lane_float_t squareAmplitude = L::set(0.92f); // see SquareOscillatorDPW
+        const lane_float_t osc1Gain = L::set(0.6f);
+        const lane_float_t osc2Gain = L::set(0.4f);
+        const lane_float_t filterEnvDepth = L::set(kFilterEnvDepth);
+        const lane_float_t filterCutoff = L::set(kFilterCutoff);
+        const lane_float_t alphaScaler = L::set(1.0f / (2.0f * kFilterQ));
+
+        const lane_float_t pitch = L::load(group.pitch);
+        const lane_float_t leftGain = L::load(group.leftGain);
+        const lane_float_t rightGain = L::load(group.rightGain);
+        lane_float_t lfoPhase = L::load(group.lfoPhase);
+        lane_float_t osc1Phase = L::load(group.osc1Phase);
+        lane_float_t osc2Phase = L::load(group.osc2Phase);
+        lane_float_t xn1 = L::load(group.xn1);
+        lane_float_t xn2 = L::load(group.xn2);
+        lane_float_t yn1 = L::load(group.yn1);
+        lane_float_t yn2 = L::load(group.yn2);
+        LaneEnvelope::Registers filterEnvelope;
+        LaneEnvelope::Registers amplitudeEnvelope;
+        group.filterEnvelope.load(filterEnvelope);
+        group.amplitudeEnvelope.load(amplitudeEnvelope);
+
+        for (int32_t frame = 0; frame < numFrames; frame += kSynthmarkFramesPerRender) {
+            const int32_t endFrame = std::min(numFrames, frame + kSynthmarkFramesPerRender);
+            lane_float_t a0 = L::set(0.0f);
+            lane_float_t a1 = a0;
+            lane_float_t b1 = a0;
+            lane_float_t b2 = a0;
+            lane_float_t amplitude = a0;
+            for (int32_t i = frame; i < endFrame; i++) {
+                // LFO #1 - vibrato
+                lane_float_t lfo = L::fastSine(L::mul(lfoPhase, pi));
+                lfoPhase = wrapPhase(L::add(lfoPhase, lfoIncrement));
+                lane_float_t pitches = L::add(L::mul(lfo, vibratoDepth), pitch);
+                lane_float_t frequency = L::mul(frequencyMiddleC, L::powerOfTwo(
+                        L::mul(L::sub(pitches, middleC), octavesPerSemitone)));
+
+                // OSC #1 - sawtooth. DifferentiatedParabola returns the phase for
+                // positive increments, so SimpleVoice plays the raw phase.
+                lane_float_t osc1 = osc1Phase;
+                osc1Phase = wrapPhase(L::add(osc1Phase, L::mul(frequency, incrementPerHertz)));
+
+                // OSC #2 - detuned square wave from two sawtooth phases 180 degrees apart.
+                lane_float_t increment2 = L::mul(L::mul(frequency, detune), incrementPerHertz);
+                lane_float_t shifted = L::add(osc2Phase, one);
+                shifted = L::select(L::greaterEqual(shifted, one), L::sub(shifted, two), shifted);
+                lane_float_t osc2 = L::mul(L::add(squareAmplitude, L::abs(increment2)),
+                                           L::sub(osc2Phase, shifted));
+                osc2Phase = wrapPhase(L::add(osc2Phase, increment2));
+
+                lane_float_t mixed = L::add(L::mul(osc1, osc1Gain), L::mul(osc2, osc2Gain));
+
+                lane_float_t filterLevel = group.filterEnvelope.next(filterEnvelope);
+                lane_float_t amplitudeLevel = group.amplitudeEnvelope.next(amplitudeEnvelope);
+                if (i == frame) {
+                    // Lowpass coefficients from the first cutoff of the block, see BiquadFilter.
+                    lane_float_t cutoff = L::add(L::mul(filterLevel, filterEnvDepth),
+                                                 filterCutoff);
+                    cutoff = L::max(cutoff, L::set(BIQUAD_MIN_FREQ));
+                    lane_float_t ratio = L::min(L::mul(cutoff, L::set(samplePeriod)),
+                                                L::set(0.499f));
+                    lane_float_t omega = L::mul(ratio, L::set(2.0f * (float) M_PI));
+                    lane_float_t cosOmega = L::fastCosine(omega);
+                    lane_float_t alpha = L::mul(L::fastSine(omega), alphaScaler);
+                    lane_float_t scalar = L::divide(one, L::add(one, alpha));
+                    lane_float_t omc = L::sub(one, cosOmega);
+                    a1 = L::mul(omc, scalar);
+                    a0 = L::mul(a1, L::set(0.5f));
+                    b1 = L::mul(L::mul(cosOmega, L::set(-2.0f)), scalar);
+                    b2 = L::mul(L::sub(one, alpha), scalar);
+                    // SimpleVoice scales a whole block by its first amplitude.
+                    amplitude = amplitudeLevel;
+                }
+
+                // Biquad resonant low-pass filter. a2 is the same as a0.
+                lane_float_t finite = L::add(L::mul(a0, L::add(mixed, xn2)), L::mul(a1, xn1));
+                lane_float_t filtered = L::sub(finite,
+                                               L::add(L::mul(b1, yn1), L::mul(b2, yn2)));
+                xn2 = xn1;
+                xn1 = mixed;
+                yn2 = yn1;
+                yn1 = filtered;
+
+                lane_float_t sample = L::mul(filtered, amplitude);
+                output[i * 2] += L::sum(L::mul(sample, leftGain));
+                output[i * 2 + 1] += L::sum(L::mul(sample, rightGain));
+            }
+            // Apply a small bipolar impulse to filter to prevent arithmetic underflow.
+            yn1 = L::add(yn1, L::set(1.0E-26f));
+            yn2 = L::sub(yn2, L::set(1.0E-26f));
+        }
+
+        L::store(group.lfoPhase, lfoPhase);
+        L::store(group.osc1Phase, osc1Phase);
+        L::store(group.osc2Phase, osc2Phase);
+        L::store(group.xn1, xn1);
+        L::store(group.xn2, xn2);
+        L::store(group.yn1, yn1);
+        L::store(group.yn2, yn2);
+        group.filterEnvelope.save(filterEnvelope);
+        group.amplitudeEnvelope.save(amplitudeEnvelope);
+    }
+
+    VoiceGroup *mGroups = nullptr;
+    int32_t mNumGroups = 0;
+};
+
+};
+#endif // SYNTHMARK_VOICE_BANK_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/OboeDebug.h"
+#include "BackgroundWaveRecorder.h"
+
+BackgroundWaveRecorder::BackgroundWaveRecorder(int32_t channelCount, int32_t capacityInFrames)
+        : mChannelCount(channelCount)
+        , mFifo(channelCount * sizeof(float), capacityInFrames)
+        , mDrainBuffer(kDrainFrames * channelCount) {
+}
+
+BackgroundWaveRecorder::~BackgroundWaveRecorder() {
+    stop();
+}
+
+int32_t BackgroundWaveRecorder::start(const char *path, int32_t sampleRate,
+                                      int32_t bitsPerSample) {
+    if (mRunning.load()) {
+        return -1;
+    }
+    mFile = fopen(path, "wb");
+    if (mFile == nullptr) {
+        LOGE("BackgroundWaveRecorder could not open %s", path);
+        return -2;
+    }
+    mStream = std::make_unique<WaveFileStdioStream>(mFile);
+    mWriter = std::make_unique<WaveFileWriter>(mStream.get());
+    mWriter->setFrameRate(sampleRate);
+    mWriter->setSamplesPerFrame(mChannelCount);
+    mWriter->setBitsPerSample(bitsPerSample);
+
+    // Discard anything left from a previous recording.
+    mFifo.setReadCounter(mFifo.getWriteCounter());
+    mFramesQueued = 0;
+    mFramesWritten = 0;
+    mOverrunCount = 0;
+    mOverrunFrames = 0;
+    mMaxFramesInFifo = 0;
+
+    mRunning = true;
+    mThread = std::thread(&BackgroundWaveRecorder::run, this);
+    return 0;
+}
+
+bool BackgroundWaveRecorder::write(const float *buffer, int32_t numFrames) {
+    if (!mRunning.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const int32_t framesInFifo = (int32_t) mFifo.getFullFramesAvailable();
+    const int32_t framesEmpty = (int32_t) mFifo.getBufferCapacityInFrames() - framesInFifo;
+    if (numFrames > framesEmpty) {
+        // Drop the whole block so the file never has part of a callback.
+        mOverrunCount.fetch_add(1, std::memory_order_relaxed);
+        mOverrunFrames.fetch_add(numFrames, std::memory_order_relaxed);
+        return false;
+    }
+    mFifo.write(buffer, numFrames);
+    mFramesQueued.fetch_add(numFrames, std::memory_order_relaxed);
+    // Wake the thread once per fill. It does not need the lock because the wait times out.
+    if (framesInFifo < kWakeFrames && framesInFifo + numFrames >= kWakeFrames) {
+        mWakeCondition.notify_one();
+    }
+    // Only this thread stores the maximum.
+    if (framesInFifo + numFrames > mMaxFramesInFifo.load(std::memory_order_relaxed)) {
+        mMaxFramesInFifo.store(framesInFifo + numFrames, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+int32_t BackgroundWaveRecorder::drain() {
+    int32_t framesMoved = 0;
+    int32_t framesRead;
+    while ((framesRead = mFifo.read(mDrainBuffer.data(), kDrainFrames)) > 0) {
+        mWriter->write(mDrainBuffer.data(), framesRead * mChannelCount);
+        mFramesWritten.fetch_add(framesRead, std::memory_order_relaxed);
+        framesMoved += framesRead;
+    }
+    return framesMoved;
+}
+
+void BackgroundWaveRecorder::run() {
+    while (mRunning.load()) {
+        drain();
+        std::unique_lock<std::mutex> lock(mWakeLock);
+        mWakeCondition.wait_for(lock, kMaxWait, [this] {
+            return !mRunning.load() || mFifo.getFullFramesAvailable() >= kWakeFrames;
+        });
+    }
+}
+
+int64_t BackgroundWaveRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mWakeLock);
+        if (!mRunning.exchange(false)) {
+            return -1;
+        }
+    }
+    mWakeCondition.notify_one();
+    mThread.join();
+    drain(); // whatever arrived after the last pass
+    mWriter->close(); // fills in the chunk sizes
+    fclose(mFile);
+    mFile = nullptr;
+    const int64_t length = mStream->length();
+    const bool failed = mStream->hasFailed();
+    mWriter.reset();
+    mStream.reset();
+    if (mOverrunCount.load() > 0) {
+        LOGW("BackgroundWaveRecorder dropped %d blocks, %lld frames",
+             (int) mOverrunCount.load(), (long long) mOverrunFrames.load());
+    }
+    return failed ? -3 : length;
+}
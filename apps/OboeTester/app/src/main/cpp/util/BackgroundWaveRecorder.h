@@ -0,0 +1,153 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTIL_BACKGROUND_WAVE_RECORDER
+#define UTIL_BACKGROUND_WAVE_RECORDER
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "oboe/FifoBuffer.h"
+#include "WaveFileWriter.h"
+
+/**
+ * Stream audio to a WAV file while a test runs, so a recording can be as long as the disk
+ * allows.
+ *
+ * The audio callback passes whole blocks to write(), which copies them into a lock-free
+ * FIFO and never blocks. A background thread drains the FIFO to a WaveFileWriter.
+ * The thread sleeps on a condition variable. write() wakes it when the FIFO fills past
+ * kWakeFrames, without taking the lock, so a wakeup can be missed. The wait has a timeout
+ * to cover that. If the FIFO does not have room for a block then the block is dropped and
+ * counted as an overrun.
+ *
+ * <pre>
+ * <code>
+ * BackgroundWaveRecorder recorder(2, 2 * 48000);
+ * recorder.start("/sdcard/loopback.wav", 48000);
+ * ... recorder.write(frames, numFrames); // from the callback
+ * recorder.stop();
+ * </code>
+ * </pre>
+ */
+class BackgroundWaveRecorder {
+public:
+    /**
+     * @param channelCount samples per frame
+     * @param capacityInFrames size of the FIFO between the callback and the disk
+     */
+    BackgroundWaveRecorder(int32_t channelCount, int32_t capacityInFrames);
+
+    ~BackgroundWaveRecorder();
+
+    /**
+     * Open the file and start the thread that writes it.
+     *
+     * @param path file to create
+     * @param sampleRate frames per second
+     * @param bitsPerSample 16, 24 or 32
+     * @return 0 or a negative error
+     */
+    int32_t start(const char *path, int32_t sampleRate, int32_t bitsPerSample = 24);
+
+    /**
+     * Queue a block of interleaved frames. This is safe to call from the audio callback.
+     * Only one thread may call write().
+     *
+     * @return true if the block was queued, false if it was dropped
+     */
+    bool write(const float *buffer, int32_t numFrames);
+
+    /**
+     * Write whatever is still queued, then close the file.
+     *
+     * @return size of the file in bytes or a negative error
+     */
+    int64_t stop();
+
+    bool isRunning() const {
+        return mRunning.load();
+    }
+
+    int32_t getChannelCount() const {
+        return mChannelCount;
+    }
+
+    /** Frames accepted by write(). */
+    int64_t getFramesQueued() const {
+        return mFramesQueued.load();
+    }
+
+    /** Frames passed to the file. */
+    int64_t getFramesWritten() const {
+        return mFramesWritten.load();
+    }
+
+    /** Number of blocks dropped because the FIFO was full. */
+    int32_t getOverrunCount() const {
+        return mOverrunCount.load();
+    }
+
+    /** Number of frames in the dropped blocks. */
+    int64_t getOverrunFrames() const {
+        return mOverrunFrames.load();
+    }
+
+    /** The fullest the FIFO has been, in frames. */
+    int32_t getMaxFramesInFifo() const {
+        return mMaxFramesInFifo.load();
+    }
+
+private:
+    void run();
+
+    /**
+     * Move everything in the FIFO to the file.
+     * @return number of frames moved
+     */
+    int32_t drain();
+
+    static constexpr int32_t kDrainFrames = 4096;
+    static constexpr int32_t kWakeFrames = kDrainFrames;
+    static constexpr std::chrono::milliseconds kMaxWait{100};
+
+    const int32_t                         mChannelCount;
+    oboe::FifoBuffer                      mFifo;
+    std::vector<float>                    mDrainBuffer;
+
+    FILE                                 *mFile = nullptr;
+    std::unique_ptr<WaveFileStdioStream>  mStream;
+    std::unique_ptr<WaveFileWriter>       mWriter;
+    std::thread                           mThread;
+    std::mutex                            mWakeLock;
+    std::condition_variable               mWakeCondition;
+
+    std::atomic<bool>                     mRunning{false};
+    std::atomic<int64_t>                  mFramesQueued{0};
+    std::atomic<int64_t>                  mFramesWritten{0};
+    std::atomic<int32_t>                  mOverrunCount{0};
+    std::atomic<int64_t>                  mOverrunFrames{0};
+    std::atomic<int32_t>                  mMaxFramesInFifo{0};
+};
+
+#endif /* UTIL_BACKGROUND_WAVE_RECORDER */
@@ -14,25 +14,200 @@
  * limitations under the License.
  */
 
+#include <math.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define WAVE_FILE_WRITER_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define WAVE_FILE_WRITER_USE_SSE2 1
+#endif
+
 #include "WaveFileWriter.h"
 
-void WaveFileWriter::WaveFileWriter::write(float value) {
+// Clip limits for each PCM size, as floats.
+// The largest float below 2^31 is used for 32-bit so the conversion cannot overflow.
+static constexpr float kPCM16Max = 32767.0f;
+static constexpr float kPCM24Max = 8388607.0f;
+static constexpr float kPCM32Max = 2147483520.0f;
+static constexpr float kPCM16Scale = 32767.0f;
+static constexpr float kPCM24Scale = 8388607.0f;
+static constexpr float kPCM32Scale = 2147483647.0f;
+static constexpr int32_t kConvertBlockSize = 256; // samples converted on the stack
+
+// Scale, clip and round a block of samples to 32-bit integers, in the default rounding mode.
+static void scaleToInt32(const float *src, int32_t *dst, int32_t numSamples,
+                         float scale, float minimum, float maximum) {
+    int32_t i = 0;
+#if WAVE_FILE_WRITER_USE_NEON && defined(__aarch64__)
+    const float32x4_t low = vdupq_n_f32(minimum);
+    const float32x4_t high = vdupq_n_f32(maximum);
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t scaled = vmulq_n_f32(vld1q_f32(src + i), scale);
+        scaled = vminq_f32(vmaxq_f32(scaled, low), high);
+        vst1q_s32(dst + i, vcvtnq_s32_f32(scaled));
+    }
+#elif WAVE_FILE_WRITER_USE_SSE2
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128 low = _mm_set1_ps(minimum);
+    const __m128 high = _mm_set1_ps(maximum);
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 scaled = _mm_mul_ps(_mm_loadu_ps(src + i), factor);
+        scaled = _mm_min_ps(_mm_max_ps(scaled, low), high);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_cvtps_epi32(scaled));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        float scaled = std::min(std::max(src[i] * scale, minimum), maximum);
+        dst[i] = (int32_t) lrintf(scaled);
+    }
+}
+
+void WaveFileWriter::convertToPCM16(const float *src, uint8_t *dst, int32_t numSamples) {
+    int32_t i = 0;
+#if WAVE_FILE_WRITER_USE_NEON && defined(__aarch64__)
+    const float32x4_t low = vdupq_n_f32(-kPCM16Max - 1.0f);
+    const float32x4_t high = vdupq_n_f32(kPCM16Max);
+    for (; i + 8 <= numSamples; i += 8) {
+        float32x4_t scaled0 = vmulq_n_f32(vld1q_f32(src + i), kPCM16Scale);
+        float32x4_t scaled1 = vmulq_n_f32(vld1q_f32(src + i + 4), kPCM16Scale);
+        scaled0 = vminq_f32(vmaxq_f32(scaled0, low), high);
+        scaled1 = vminq_f32(vmaxq_f32(scaled1, low), high);
+        int16x8_t samples = vcombine_s16(vmovn_s32(vcvtnq_s32_f32(scaled0)),
+                                         vmovn_s32(vcvtnq_s32_f32(scaled1)));
+        vst1q_u8(dst + (i * 2), vreinterpretq_u8_s16(samples));
+    }
+#elif WAVE_FILE_WRITER_USE_SSE2
+    const __m128 factor = _mm_set1_ps(kPCM16Scale);
+    const __m128 low = _mm_set1_ps(-kPCM16Max - 1.0f);
+    const __m128 high = _mm_set1_ps(kPCM16Max);
+    for (; i + 8 <= numSamples; i += 8) {
+        __m128 scaled0 = _mm_mul_ps(_mm_loadu_ps(src + i), factor);
+        __m128 scaled1 = _mm_mul_ps(_mm_loadu_ps(src + i + 4), factor);
+        scaled0 = _mm_min_ps(_mm_max_ps(scaled0, low), high);
+        scaled1 = _mm_min_ps(_mm_max_ps(scaled1, low), high);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (i * 2)),
+                         _mm_packs_epi32(_mm_cvtps_epi32(scaled0), _mm_cvtps_epi32(scaled1)));
+    }
+#endif
+    int32_t samples[kConvertBlockSize];
+    while (i < numSamples) {
+        const int32_t numNow = std::min(numSamples - i, kConvertBlockSize);
+        scaleToInt32(src + i, samples, numNow, kPCM16Scale, -kPCM16Max - 1.0f, kPCM16Max);
+        for (int32_t j = 0; j < numNow; j++) {
+            const int16_t sample = (int16_t) samples[j];
+            memcpy(dst + ((i + j) * 2), &sample, sizeof(sample)); // little endian
+        }
+        i += numNow;
+    }
+}
+
+void WaveFileWriter::convertToPCM24(const float *src, uint8_t *dst, int32_t numSamples) {
+    int32_t samples[kConvertBlockSize];
+    int32_t i = 0;
+    while (i < numSamples) {
+        const int32_t numNow = std::min(numSamples - i, kConvertBlockSize);
+        scaleToInt32(src + i, samples, numNow, kPCM24Scale, -kPCM24Max - 1.0f, kPCM24Max);
+        // Store 4 little endian bytes and step by 3, so the next sample covers the extra byte.
+        // The last sample of all is stored with exactly 3 bytes.
+        const int32_t numOverlapped = (i + numNow < numSamples) ? numNow : numNow - 1;
+        uint8_t *bytes = dst + (i * 3);
+        for (int32_t j = 0; j < numOverlapped; j++) {
+            memcpy(bytes, &samples[j], sizeof(int32_t));
+            bytes += 3;
+        }
+        if (numOverlapped < numNow) {
+            memcpy(bytes, &samples[numOverlapped], 3);
+        }
+        i += numNow;
+    }
+}
+
+void WaveFileWriter::convertToPCM32(const float *src, uint8_t *dst, int32_t numSamples) {
+    int32_t samples[kConvertBlockSize];
+    int32_t i = 0;
+    while (i < numSamples) {
+        const int32_t numNow = std::min(numSamples - i, kConvertBlockSize);
+        scaleToInt32(src + i, samples, numNow, kPCM32Scale, -kPCM32Max - 128.0f, kPCM32Max);
+        memcpy(dst + (i * 4), samples, numNow * sizeof(int32_t)); // little endian
+        i += numNow;
+    }
+}
+
+void WaveFileWriter::convertToFloat32(const float *src, uint8_t *dst, int32_t numSamples) {
+    memcpy(dst, src, numSamples * sizeof(float)); // little endian
+}
+
+void WaveFileWriter::write(float value) {
+    write(&value, 1);
+}
+
+void WaveFileWriter::write(const float *buffer, int32_t startSample, int32_t numSamples) {
+    write(buffer + startSample, numSamples);
+}
+
+void WaveFileWriter::write(const float *buffer, int32_t numSamples) {
     if (!mHeaderWritten) {
         writeHeader();
     }
-    if (mBitsPerSample == 24) {
-        writePCM24(value);
-    } else {
-        writePCM16(value);
+    const int32_t bytesPerSample = getBytesPerSample();
+    while (numSamples > 0) {
+        int32_t samplesFree = (kBufferSize - mBufferedBytes) / bytesPerSample;
+        if (samplesFree == 0) {
+            flush();
+            continue;
+        }
+        const int32_t numNow = std::min(numSamples, samplesFree);
+        uint8_t *dst = mBuffer.data() + mBufferedBytes;
+        if (mIsFloat) {
+            convertToFloat32(buffer, dst, numNow);
+        } else if (mBitsPerSample == 32) {
+            convertToPCM32(buffer, dst, numNow);
+        } else if (mBitsPerSample == 24) {
+            convertToPCM24(buffer, dst, numNow);
+        } else {
+            convertToPCM16(buffer, dst, numNow);
+        }
+        mBufferedBytes += numNow * bytesPerSample;
+        mBytesWritten += numNow * bytesPerSample;
+        buffer += numNow;
+        numSamples -= numNow;
     }
 }
 
-void WaveFileWriter::write(float *buffer, int32_t startSample, int32_t numSamples) {
-    for (int32_t i = 0; i < numSamples; i++) {
-        write(buffer[startSample + i]);
+void WaveFileWriter::flush() {
+    if (mBufferedBytes > 0) {
+        mOutputStream->write(mBuffer.data(), mBufferedBytes);
+        mBufferedBytes = 0;
     }
 }
 
+void WaveFileWriter::close() {
+    if (mClosed || !mHeaderWritten) {
+        return;
+    }
+    flush();
+    patchChunkSizes();
+    mClosed = true;
+}
+
+void WaveFileWriter::patchChunkSizes() {
+    const int64_t dataSize = mBytesWritten - kHeaderSize;
+    if (mFrameCount > 0 && dataSize == getDataSizeInBytes()) {
+        return; // the header is already correct
+    }
+    const int32_t dataSize32 = (int32_t) std::min(dataSize, (int64_t) INT32_MAX);
+    const int32_t riffSize32 = (int32_t) std::min(dataSize + kHeaderSize - 8,
+                                                  (int64_t) INT32_MAX);
+    uint8_t bytes[4];
+    memcpy(bytes, &riffSize32, sizeof(bytes)); // little endian
+    mOutputStream->writeAt(kRiffSizeOffset, bytes, sizeof(bytes));
+    memcpy(bytes, &dataSize32, sizeof(bytes));
+    mOutputStream->writeAt(kDataSizeOffset, bytes, sizeof(bytes));
+}
+
 void WaveFileWriter::writeIntLittle(int32_t n) {
     writeByte(n);
     writeByte(n >> 8);
@@ -53,7 +228,7 @@ void WaveFileWriter::writeFormatChunk() {
     writeByte('t');
     writeByte(' ');
     writeIntLittle(16); // chunk size
-    writeShortLittle(WAVE_FORMAT_PCM);
+    writeShortLittle(mIsFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
     writeShortLittle((int16_t) mSamplesPerFrame);
     writeIntLittle(mFrameRate);
     // bytes/second
@@ -78,6 +253,7 @@ void WaveFileWriter::writeDataChunkHeader() {
 }
 
 void WaveFileWriter::writeHeader() {
+    mBuffer.resize(kBufferSize);
     writeRiffHeader();
     writeFormatChunk();
     writeDataChunkHeader();
@@ -85,42 +261,12 @@ void WaveFileWriter::writeHeader() {
 }
 
 // Write lower 8 bits. Upper bits ignored.
+// The header is only 44 bytes so it always fits in the buffer.
 void WaveFileWriter::writeByte(uint8_t b) {
-    mOutputStream->write(b);
+    mBuffer[mBufferedBytes++] = b;
     mBytesWritten += 1;
 }
 
-void WaveFileWriter::writePCM24(float value) {
-    // Offset before casting so that we can avoid using floor().
-    // Also round by adding 0.5 so that very small signals go to zero.
-    float temp = (PCM24_MAX * value) + 0.5 - PCM24_MIN;
-    int32_t sample = ((int) temp) + PCM24_MIN;
-    // clip to 24-bit range
-    if (sample > PCM24_MAX) {
-        sample = PCM24_MAX;
-    } else if (sample < PCM24_MIN) {
-        sample = PCM24_MIN;
-    }
-    // encode as little-endian
-    writeByte(sample); // little end
-    writeByte(sample >> 8); // middle
-    writeByte(sample >> 16); // big end
-}
-
-void WaveFileWriter::writePCM16(float value) {
-    // Offset before casting so that we can avoid using floor().
-    // Also round by adding 0.5 so that very small signals go to zero.
-    float temp = (INT16_MAX * value) + 0.5 - INT16_MIN;
-    int32_t sample = ((int) temp) + INT16_MIN;
-    if (sample > INT16_MAX) {
-        sample = INT16_MAX;
-    } else if (sample < INT16_MIN) {
-        sample = INT16_MIN;
-    }
-    writeByte(sample); // little end
-    writeByte(sample >> 8); // big end
-}
-
 void WaveFileWriter::writeRiffHeader() {
     writeByte('R');
     writeByte('I');
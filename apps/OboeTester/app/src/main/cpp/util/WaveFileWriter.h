@@ -23,16 +23,85 @@
 #include <cassert>
 #include <stdio.h>
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 
 class WaveFileOutputStream {
 public:
     virtual ~WaveFileOutputStream() = default;
     virtual void write(uint8_t b) = 0;
+
+    /**
+     * Write a block of bytes.
+     * Override this when the destination can take a block at once.
+     */
+    virtual void write(const uint8_t *buffer, int32_t numBytes) {
+        for (int32_t i = 0; i < numBytes; i++) {
+            write(buffer[i]);
+        }
+    }
+
+    /**
+     * Overwrite bytes that were already written.
+     * This is used to fill in the chunk sizes when the WAV file is closed.
+     *
+     * @return true if the bytes could be rewritten
+     */
+    virtual bool writeAt(int64_t position, const uint8_t *buffer, int32_t numBytes) {
+        (void) position;
+        (void) buffer;
+        (void) numBytes;
+        return false;
+    }
+};
+
+/**
+ * Write the WAV file straight to a stdio FILE, which does its own buffering.
+ */
+class WaveFileStdioStream : public WaveFileOutputStream {
+public:
+    explicit WaveFileStdioStream(FILE *file) : mFile(file) {}
+
+    void write(uint8_t b) override {
+        write(&b, 1);
+    }
+
+    void write(const uint8_t *buffer, int32_t numBytes) override {
+        if (fwrite(buffer, 1, numBytes, mFile) != (size_t) numBytes) {
+            mFailed = true;
+        }
+        mLength += numBytes;
+    }
+
+    bool writeAt(int64_t position, const uint8_t *buffer, int32_t numBytes) override {
+        const long end = ftell(mFile);
+        bool ok = fseek(mFile, (long) position, SEEK_SET) == 0
+                && fwrite(buffer, 1, numBytes, mFile) == (size_t) numBytes;
+        ok = (fseek(mFile, end, SEEK_SET) == 0) && ok;
+        return ok;
+    }
+
+    int64_t length() const {
+        return mLength;
+    }
+
+    bool hasFailed() const {
+        return mFailed;
+    }
+
+private:
+    FILE    *mFile;
+    int64_t  mLength = 0;
+    bool     mFailed = false;
 };
 
 /**
  * Write audio data to a WAV file.
  *
+ * Samples are converted a block at a time into an internal buffer, which is passed to the
+ * stream in large writes. If the frame count was not set then the chunk sizes are filled in
+ * by close(), when the stream supports writeAt().
+ *
  * <pre>
  * <code>
  * WaveFileWriter writer = new WaveFileWriter(waveFileOutputStream);
@@ -57,6 +126,10 @@ public:
         mOutputStream = outputStream;
     }
 
+    ~WaveFileWriter() {
+        close();
+    }
+
     /**
      * Set the number of frames per second, also known as "sample rate".
      *
@@ -104,22 +177,42 @@ public:
         return mSamplesPerFrame;
     }
 
-    /** Only 16 or 24 bit samples supported at the moment. Default is 16.
+    /** 16, 24 or 32 bit samples are supported. Default is 16.
      *
      * If you call this then it must be called before the first write().
      * @param bits number of bits in a PCM sample
      */
     void setBitsPerSample(int32_t bits) {
-        assert((bits == 16) || (bits == 24));
+        assert((bits == 16) || (bits == 24) || (bits == 32));
         mBitsPerSample = bits;
     }
 
+    /**
+     * Write 32-bit IEEE float samples instead of PCM integers.
+     *
+     * If you call this then it must be called before the first write().
+     * @param isFloat true for float
+     */
+    void setFloatSamples(bool isFloat) {
+        mIsFloat = isFloat;
+        if (isFloat) {
+            mBitsPerSample = 32;
+        }
+    }
+
+    bool isFloatSamples() const {
+        return mIsFloat;
+    }
+
     int32_t getBitsPerSample() const {
         return mBitsPerSample;
     }
 
-    void close() {
-    }
+    /**
+     * Write any buffered data to the stream and fill in the chunk sizes if needed.
+     * This is also called by the destructor.
+     */
+    void close();
 
     /** Write single audio data value to the WAV file. */
     void write(float value);
@@ -127,16 +220,31 @@ public:
     /**
      * Write a buffer to the WAV file.
      */
-    void write(float *buffer, int32_t startSample, int32_t numSamples);
+    void write(const float *buffer, int32_t startSample, int32_t numSamples);
+
+    /**
+     * Write interleaved samples to the WAV file.
+     */
+    void write(const float *buffer, int32_t numSamples);
+
+    /**
+     * Convert float samples to little endian PCM or float.
+     * These are used by write() and are public so they can be tested on their own.
+     * Values are clipped and rounded to the nearest integer.
+     */
+    static void convertToPCM16(const float *src, uint8_t *dst, int32_t numSamples);
+    static void convertToPCM24(const float *src, uint8_t *dst, int32_t numSamples);
+    static void convertToPCM32(const float *src, uint8_t *dst, int32_t numSamples);
+    static void convertToFloat32(const float *src, uint8_t *dst, int32_t numSamples);
 
 private:
     /**
-     * Write a 32 bit integer to the stream in Little Endian format.
+     * Write a 32 bit integer to the buffer in Little Endian format.
      */
     void writeIntLittle(int32_t n);
 
     /**
-     * Write a 16 bit integer to the stream in Little Endian format.
+     * Write a 16 bit integer to the buffer in Little Endian format.
      */
     void writeShortLittle(int16_t n);
 
@@ -146,8 +254,8 @@ private:
     void writeFormatChunk();
 
     /**
-     * Write a 'data' chunk header to the WAV file. This should be followed by call to
-     * writeShortLittle() to write the data to the chunk.
+     * Write a 'data' chunk header to the WAV file. This should be followed by the
+     * sample data.
      */
     void writeDataChunkHeader();
 
@@ -159,10 +267,6 @@ private:
     // Write lower 8 bits. Upper bits ignored.
     void writeByte(uint8_t b);
 
-    void writePCM24(float value);
-
-    void writePCM16(float value);
-
     /**
      * Write a 'RIFF' file header and a 'WAVE' ID to the WAV file.
      */
@@ -170,17 +274,38 @@ private:
 
     int32_t getDataSizeInBytes();
 
+    int32_t getBytesPerSample() const {
+        return mBitsPerSample / 8;
+    }
+
+    /**
+     * Pass the buffered bytes to the stream.
+     */
+    void flush();
+
+    /**
+     * Overwrite the RIFF and data chunk sizes with the amount of data actually written.
+     */
+    void patchChunkSizes();
+
     static constexpr int WAVE_FORMAT_PCM = 1;
+    static constexpr int WAVE_FORMAT_IEEE_FLOAT = 3;
+    static constexpr int32_t kRiffSizeOffset = 4;
+    static constexpr int32_t kDataSizeOffset = 40;
+    static constexpr int32_t kHeaderSize = 44;
+    static constexpr int32_t kBufferSize = 64 * 1024; // bytes
+
     WaveFileOutputStream *mOutputStream = nullptr;
     int32_t mFrameRate = 48000;
     int32_t mSamplesPerFrame = 1;
     int32_t mFrameCount = 0; // 0 for unknown
     int32_t mBitsPerSample = 16;
-    int32_t mBytesWritten = 0;
+    bool mIsFloat = false;
+    int64_t mBytesWritten = 0;
     bool mHeaderWritten = false;
-    static constexpr int32_t PCM24_MIN = -(1 << 23);
-    static constexpr int32_t PCM24_MAX = (1 << 23) - 1;
-
+    bool mClosed = false;
+    std::vector<uint8_t> mBuffer;
+    int32_t mBufferedBytes = 0;
 };
 
 #endif /* UTIL_WAVE_FILE_WRITER */
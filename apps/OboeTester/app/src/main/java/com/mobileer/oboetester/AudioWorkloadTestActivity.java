@@ -31,6 +31,7 @@ import android.widget.TextView;
 import androidx.annotation.NonNull;
 
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.List;
 
 /**
@@ -43,6 +44,7 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
     private ExponentialSliderView mNumVoicesSlider;
     private ExponentialSliderView mAlternateNumVoicesSlider;
     private ExponentialSliderView mAlternatingPeriodMsSlider;
+    private ExponentialSliderView mNumRenderThreadsSlider;
 
     private CheckBox mEnableAdpfBox;
     private CheckBox mEnableAdpfWorkloadIncreaseBox;
@@ -77,14 +79,22 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
         public long finishTimeNs;
         public int xRunCount;
         public int cpuIndex;
+        // One entry for each thread that rendered the synth. Thread 0 is the callback thread.
+        public int[] renderBeginOffsetsNs; // relative to the start of rendering
+        public int[] renderDurationsNs;
+        public int[] renderCpuIndices; // -1 if the thread was not needed in this callback
 
         public CallbackStatus(int numVoices, long beginTimeNs, long finishTimeNs, int xRunCount,
-                              int cpuIndex) {
+                              int cpuIndex, int[] renderBeginOffsetsNs, int[] renderDurationsNs,
+                              int[] renderCpuIndices) {
             this.numVoices = numVoices;
             this.beginTimeNs = beginTimeNs;
             this.finishTimeNs = finishTimeNs;
             this.xRunCount = xRunCount;
             this.cpuIndex = cpuIndex;
+            this.renderBeginOffsetsNs = renderBeginOffsetsNs;
+            this.renderDurationsNs = renderDurationsNs;
+            this.renderCpuIndices = renderCpuIndices;
         }
 
         @NonNull
@@ -96,6 +106,8 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
                     ", finishTime=" + finishTimeNs +
                     ", xRunCount=" + xRunCount +
                     ", cpuIndex=" + cpuIndex +
+                    ", renderDurationsNs=" + Arrays.toString(renderDurationsNs) +
+                    ", renderCpuIndices=" + Arrays.toString(renderCpuIndices) +
                     '}';
         }
     }
@@ -145,6 +157,7 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
         mNumVoicesSlider = (ExponentialSliderView) findViewById(R.id.num_voices);
         mAlternateNumVoicesSlider = (ExponentialSliderView) findViewById(R.id.alternate_num_voices);
         mAlternatingPeriodMsSlider = (ExponentialSliderView) findViewById(R.id.alternating_period_ms);
+        mNumRenderThreadsSlider = (ExponentialSliderView) findViewById(R.id.num_render_threads);
 
         mEnableAdpfBox = (CheckBox) findViewById(R.id.enable_adpf);
         mEnableAdpfWorkloadIncreaseBox = (CheckBox) findViewById(R.id.enable_adpf_workload_increase);
@@ -224,7 +237,8 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
         int result = start(mTargetDurationMsSlider.getValue(), mNumBurstsSlider.getValue(),
                 mNumVoicesSlider.getValue(), mAlternateNumVoicesSlider.getValue(),
                 mAlternatingPeriodMsSlider.getValue(), mEnableAdpfBox.isChecked(),
-                mEnableAdpfWorkloadIncreaseBox.isChecked(), mHearWorkloadBox.isChecked());
+                mEnableAdpfWorkloadIncreaseBox.isChecked(), mHearWorkloadBox.isChecked(),
+                mNumRenderThreadsSlider.getValue());
         if (result != OPERATION_SUCCESS) {
             showErrorToast("start failed! Error:" + result);
             return;
@@ -265,6 +279,9 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
             double expectedCallbackTimeSeconds = (double) getBufferSizeInFrames() / getSampleRate();
 
             float maxWorkloadValue = max(mNumVoicesSlider.getValue(), mAlternateNumVoicesSlider.getValue());
+            int numRenderThreads = mNumRenderThreadsSlider.getValue();
+            double[] renderLoadSums = new double[numRenderThreads];
+            int[] renderCounts = new int[numRenderThreads];
             for (CallbackStatus callbackStatus : callbackStatuses) {
                 if (firstTimeNs == 0) {
                     firstTimeNs = callbackStatus.beginTimeNs;
@@ -280,8 +297,16 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
 
                 mCpuLoadTrace.add((float) cpuLoad, hasXRun);
                 mWorkloadTrace.add(callbackStatus.numVoices / maxWorkloadValue, false);
+
+                int numThreads = Math.min(numRenderThreads, callbackStatus.renderDurationsNs.length);
+                for (int i = 0; i < numThreads; i++) {
+                    renderLoadSums[i] += NANOS_TO_SECONDS * callbackStatus.renderDurationsNs[i]
+                            / expectedCallbackTimeSeconds;
+                    renderCounts[i]++;
+                }
             }
             mMultiLineChart.update();
+            mCurrentStatusView.append(formatRenderLoads(renderLoadSums, renderCounts));
         }
 
         if (mUpdateThread != null) {
@@ -296,6 +321,16 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
         enableParamsUI(true);
     }
 
+    // Average load of each render thread as a fraction of the callback period.
+    private static String formatRenderLoads(double[] loadSums, int[] counts) {
+        StringBuilder builder = new StringBuilder("\nrender threads:");
+        for (int i = 0; i < loadSums.length; i++) {
+            double averageLoad = (counts[i] > 0) ? loadSums[i] / counts[i] : 0.0;
+            builder.append(String.format(" #%d %.1f%%", i, averageLoad * 100.0));
+        }
+        return builder.toString();
+    }
+
     public void closeAudio(View view) {
         int result = close();
         if (result != OPERATION_SUCCESS) {
@@ -315,6 +350,7 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
         mNumVoicesSlider.setEnabled(enabled);
         mAlternateNumVoicesSlider.setEnabled(enabled);
         mAlternatingPeriodMsSlider.setEnabled(enabled);
+        mNumRenderThreadsSlider.setEnabled(enabled);
         mEnableAdpfBox.setEnabled(enabled);
         mEnableAdpfWorkloadIncreaseBox.setEnabled(enabled);
         mHearWorkloadBox.setEnabled(enabled);
@@ -331,7 +367,8 @@ public class AudioWorkloadTestActivity extends BaseOboeTesterActivity {
     private native int getBufferSizeInFrames();
     private native int start(int targetDurationMs, int numBursts, int numVoices,
                              int numAlternateVoices, int alternatingPeriodMs, boolean adpfEnabled,
-                             boolean adpfWorkloadIncreaseEnabled, boolean hearWorkload);
+                             boolean adpfWorkloadIncreaseEnabled, boolean hearWorkload,
+                             int numRenderThreads);
     private native int getCpuCount();
     private native int setCpuAffinityForCallback(int mask);
     private native int getXRunCount();
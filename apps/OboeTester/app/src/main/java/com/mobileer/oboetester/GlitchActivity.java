@@ -275,6 +275,18 @@ public class GlitchActivity extends AnalyzerActivity {
 
     public native void setOutputChannelNative(int channel);
 
+    /**
+     * Check every channel in the mask at once, instead of the selected channel.
+     * Only call this while the streams are closed.
+     * @param channelMask bit N selects channel N, or zero to check one channel
+     */
+    public native void setMultiChannelMaskNative(int channelMask);
+
+    /**
+     * @return per channel results of the multi-channel check, or "" if it is not enabled
+     */
+    public native String getMultiChannelReport();
+
     @Override
     protected void onCreate(Bundle savedInstanceState) {
         super.onCreate(savedInstanceState);
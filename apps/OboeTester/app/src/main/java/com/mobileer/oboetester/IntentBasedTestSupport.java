@@ -66,6 +66,9 @@ public class IntentBasedTestSupport {
     public static final String KEY_VOLUME = "volume";
     public static final String KEY_RESTART_STREAM_IF_CLOSED = "restart_if_closed";
     public static final String KEY_AUDIO_FOCUS = "audio_focus";
+    public static final String KEY_STREAMING_LATENCY = "streaming_latency";
+    public static final String KEY_MULTI_CHANNEL_MASK = "multi_channel_mask";
+    public static final String KEY_DISK_RECORDING = "disk_recording";
 
     public static final String KEY_VOLUME_TYPE = "volume_type";
     public static final float VALUE_VOLUME_INVALID = -1.0f;
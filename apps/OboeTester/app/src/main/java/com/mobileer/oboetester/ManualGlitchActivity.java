@@ -200,11 +200,16 @@ public class ManualGlitchActivity extends GlitchActivity {
     public void startTestUsingBundle() {
         configureStreamsFromBundle(mBundleFromIntent);
         int numBursts = mBundleFromIntent.getInt(KEY_BUFFER_BURSTS, VALUE_DEFAULT_BUFFER_BURSTS);
+        setMultiChannelMaskNative(mBundleFromIntent.getInt(
+                IntentBasedTestSupport.KEY_MULTI_CHANNEL_MASK, 0));
 
         try {
             openStartAudioTestUI();
             int sizeFrames = mAudioOutTester.getCurrentAudioStream().getFramesPerBurst() * numBursts;
             mAudioOutTester.getCurrentAudioStream().setBufferSizeInFrames(sizeFrames);
+            if (mBundleFromIntent.getBoolean(IntentBasedTestSupport.KEY_DISK_RECORDING, false)) {
+                startDiskRecordingToFile();
+            }
         } catch (IOException e) {
             String report = "Open failed: " + e.getMessage();
             maybeWriteTestResult(report);
@@ -219,8 +224,11 @@ public class ManualGlitchActivity extends GlitchActivity {
     public void stopAutomaticTest() {
         String report = getCommonTestReport()
                 + String.format(Locale.getDefault(), "tolerance = %5.3f\n", mTolerance)
-                + mLastGlitchReport;
+                + mLastGlitchReport
+                + getMultiChannelReport()
+                + stopDiskRecordingToFile();
         onStopAudioTest(null);
+        setMultiChannelMaskNative(0); // the UI checks one channel
         maybeWriteTestResult(report);
         mTestRunningByIntent = false;
     }
@@ -60,6 +60,8 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
     private int     mActualBufferBursts;
     private boolean mOutputIsMMapExclusive;
     private boolean mInputIsMMapExclusive;
+    // Measure continuously until the test duration ends, only from an intent.
+    private boolean mStreamingLatency = false;
 
     private Handler mHandler = new Handler(Looper.getMainLooper()); // UI thread
 
@@ -518,6 +520,11 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
                     if (resultFile != null) {
                         message = "result.file = " + resultFile.getAbsolutePath() + "\n" + message;
                     }
+                } else if (mStreamingLatency) {
+                    // Runs until stopAutomaticTest().
+                    message = getStreamingLatencyReport();
+                    message += "seconds = " + (mCounter * SNIFFER_UPDATE_PERIOD_MSEC / 1000) + "\n";
+                    mHandler.postDelayed(runnableCode, SNIFFER_UPDATE_PERIOD_MSEC);
                 } else if (mCounter > SNIFFER_MAX_COUNTER) {
                     message = getProgressText();
                     message += convertStateToString(getAnalyzerState()) + "\n";
@@ -638,6 +645,8 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
     native double getMeasuredCorrelation();
     native double getBackgroundRMS();
     native double getSignalRMS();
+    native void setStreamingLatencyEnabled(boolean enabled);
+    native String getStreamingLatencyReport();
 
     private void setAnalyzerText(String s) {
         mAnalyzerView.setText(s);
@@ -687,6 +696,8 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
             configureStreamsFromBundle(mBundleFromIntent, requestedInConfig, requestedOutConfig);
 
             mBufferBursts = mBundleFromIntent.getInt(IntentBasedTestSupport.KEY_BUFFER_BURSTS, mBufferBursts);
+            mStreamingLatency = mBundleFromIntent.getBoolean(
+                    IntentBasedTestSupport.KEY_STREAMING_LATENCY, false);
 
             onMeasure(null);
         } finally {
@@ -694,6 +705,20 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
         }
     }
 
+    @Override
+    public void stopAutomaticTest() {
+        if (!mStreamingLatency) {
+            // The single measurement stops by itself.
+            super.stopAutomaticTest();
+            return;
+        }
+        String report = getCommonTestReport() + getStreamingLatencyReport();
+        mStreamingLatency = false;
+        stopAudioTest();
+        maybeWriteTestResult(report);
+        mTestRunningByIntent = false;
+    }
+
     @Override
     protected void onStop() {
         mLatencySniffer.stopSniffer();
@@ -716,6 +741,7 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
 
     private void measureSingleLatency() {
         try {
+            setStreamingLatencyEnabled(mStreamingLatency);
             openAudio();
             AudioStreamBase outputStream = mAudioOutTester.getCurrentAudioStream();
             mOutputFramesPerBurst = outputStream.getFramesPerBurst();
@@ -756,6 +782,7 @@ public class RoundTripLatencyActivity extends AnalyzerActivity {
     }
 
     public void onCancel(View view) {
+        mStreamingLatency = false;
         mCurrentLatencyTestRunner.cancel();
         stopAudioTest();
     }
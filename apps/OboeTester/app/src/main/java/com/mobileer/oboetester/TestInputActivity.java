@@ -46,9 +46,12 @@ public class TestInputActivity  extends TestAudioActivity {
     private WorkloadView mWorkloadView;
 
     private PartialDataCallbackSizeView mPartialDataCallbackSizeView;
+    private File mDiskRecordingFile;
 
     public native void setMinimumFramesBeforeRead(int frames);
     public native int saveWaveFile(String absolutePath);
+    public native int startDiskRecording(String absolutePath);
+    public native long stopDiskRecording();
 
     @Override boolean isOutput() { return false; }
 
@@ -154,6 +157,7 @@ public class TestInputActivity  extends TestAudioActivity {
 
     @Override
     public void stopAudio() {
+        stopDiskRecordingToFile(); // closes the file if the test did not
         super.stopAudio();
         resetVolumeBars();
     }
@@ -173,6 +177,35 @@ public class TestInputActivity  extends TestAudioActivity {
         return "input";
     }
 
+    /**
+     * Stream the loopback output and input to a WAV file while the test runs.
+     * Only the full duplex analyzers support this. Call after the streams are started.
+     * @return true if the recording started
+     */
+    protected boolean startDiskRecordingToFile() {
+        File file = createFileName();
+        int result = startDiskRecording(file.getAbsolutePath());
+        if (result < 0) {
+            showErrorToast("Disk recording returned " + result);
+            return false;
+        }
+        mDiskRecordingFile = file;
+        return true;
+    }
+
+    /**
+     * Stop the recording from startDiskRecordingToFile(), if any.
+     * @return lines for the test report
+     */
+    protected String stopDiskRecordingToFile() {
+        if (mDiskRecordingFile == null) return "";
+        long result = stopDiskRecording();
+        String report = "disk.recording.file = " + mDiskRecordingFile.getAbsolutePath() + "\n"
+                + "disk.recording.bytes = " + result + "\n";
+        mDiskRecordingFile = null;
+        return report;
+    }
+
     @NonNull
     private File createFileName() {
         // Get directory and filename
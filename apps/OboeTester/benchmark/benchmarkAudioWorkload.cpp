@@ -0,0 +1,358 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Run the OboeTester AudioWorkloadTest without the app, for nightly dashboards.
+ *
+ * Every combination of voice count, buffer size, render thread count and duration is run
+ * on a SimulatedAudioStream. A summary of each run is printed with percentiles of the
+ * callback duration and load. The summaries can be saved as JSON, with percentiles for
+ * each render thread, and every callback as CSV, with the timing of each render thread.
+ *
+ * Usage: benchmarkAudioWorkload [--voices N,N] [--bursts N,N] [--threads N,N]
+ *                               [--seconds N,N] [--burst-frames N]
+ *                               [--csv FILE] [--json FILE]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpu/AudioWorkloadTest.h"
+#include "SimulatedAudioStream.h"
+#include "synth/IncludeMeOnce.h"
+
+namespace {
+
+constexpr int32_t kPollMillis = 20;
+// Give up on a run that does not stop this long after its duration.
+constexpr int32_t kStopTimeoutMillis = 2000;
+
+struct RunConfig {
+    int32_t numVoices;
+    int32_t numBursts;        // buffer size in bursts
+    int32_t numRenderThreads;
+    int32_t seconds;
+};
+
+struct Percentiles {
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Timing of one render thread over all the callbacks of a run.
+struct RenderThreadSummary {
+    int32_t numSkipped = 0;     // callbacks where the thread had not started in time
+    Percentiles beginOffsetUs;  // relative to the start of rendering in the callback
+    Percentiles durationUs;
+};
+
+struct RunSummary {
+    RunConfig config;
+    int32_t framesPerBurst = 0;
+    int32_t sampleRate = 0;
+    int32_t bufferSizeInFrames = 0;
+    int32_t numCallbacks = 0;
+    int32_t xRunCount = 0;
+    int32_t numCpuChanges = 0;  // callbacks that ran on a different CPU than the one before
+    Percentiles durationUs;
+    Percentiles loadPercent;    // callback duration as a percentage of the burst period
+    std::vector<RenderThreadSummary> renderThreads; // thread 0 is the callback thread
+};
+
+// Nearest rank percentiles of a list of values.
+Percentiles measurePercentiles(std::vector<double> values) {
+    Percentiles result;
+    if (values.empty()) return result;
+    std::sort(values.begin(), values.end());
+    auto rank = [&values](double fraction) {
+        size_t index = (size_t) (fraction * (values.size() - 1) + 0.5);
+        return values[index];
+    };
+    result.p50 = rank(0.50);
+    result.p90 = rank(0.90);
+    result.p99 = rank(0.99);
+    result.max = values.back();
+    return result;
+}
+
+std::vector<int32_t> parseList(const char *text) {
+    std::vector<int32_t> values;
+    for (const char *next = text; *next != 0;) {
+        char *end = nullptr;
+        long value = strtol(next, &end, 10);
+        if (end == next || value <= 0) return {};
+        values.push_back((int32_t) value);
+        next = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != 0) return {};
+    }
+    return values;
+}
+
+void writeCsvHeader(FILE *file, int32_t maxRenderThreads) {
+    fprintf(file, "run,voices,bufferBursts,renderThreads,callback,"
+                  "beginOffsetNs,durationNs,cpuIndex,xRunCount");
+    for (int32_t thread = 0; thread < maxRenderThreads; thread++) {
+        fprintf(file, ",thread%dBeginOffsetNs,thread%dDurationNs,thread%dCpuIndex",
+                thread, thread, thread);
+    }
+    fprintf(file, "\n");
+}
+
+/**
+ * Run one workload the way AudioWorkloadTestActivity does.
+ * The CSV has a column for each of maxRenderThreads threads. Columns for threads that did
+ * not render a callback are left empty.
+ * @return false if the stream could not be opened or started
+ */
+bool runWorkload(const RunConfig &config, FILE *csvFile, int32_t maxRenderThreads,
+                 int32_t runIndex, RunSummary *summary) {
+    AudioWorkloadTest test;
+    if (test.open() != 0) {
+        fprintf(stderr, "ERROR: could not open the stream\n");
+        return false;
+    }
+    const int32_t durationMillis = config.seconds * 1000;
+    if (test.start(durationMillis, config.numBursts, config.numVoices, config.numVoices,
+                   0 /* alternatingPeriodMs */, false /* adpfEnabled */,
+                   false /* adpfWorkloadIncreaseEnabled */, false /* hearWorkload */,
+                   config.numRenderThreads) != 0) {
+        fprintf(stderr, "ERROR: could not start the workload\n");
+        return false;
+    }
+    int32_t waitedMillis = 0;
+    while (test.isRunning() && waitedMillis < durationMillis + kStopTimeoutMillis) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kPollMillis));
+        waitedMillis += kPollMillis;
+    }
+    test.stop();
+    std::vector<AudioWorkloadTest::CallbackStatus> statistics = test.getCallbackStatistics();
+
+    summary->config = config;
+    summary->framesPerBurst = test.getFramesPerBurst();
+    summary->sampleRate = test.getSampleRate();
+    summary->bufferSizeInFrames = test.getBufferSizeInFrames();
+    summary->numCallbacks = (int32_t) statistics.size();
+    summary->xRunCount = test.getXRunCount();
+    test.close();
+
+    const double periodNs = 1.0e9 * summary->framesPerBurst / summary->sampleRate;
+    std::vector<double> durations;
+    std::vector<double> loads;
+    durations.reserve(statistics.size());
+    loads.reserve(statistics.size());
+    std::vector<std::vector<double>> threadBeginOffsets(maxRenderThreads);
+    std::vector<std::vector<double>> threadDurations(maxRenderThreads);
+    summary->renderThreads.resize(config.numRenderThreads);
+    for (size_t i = 0; i < statistics.size(); i++) {
+        const AudioWorkloadTest::CallbackStatus &status = statistics[i];
+        const int64_t durationNs = status.finishTimeNs - status.beginTimeNs;
+        durations.push_back(durationNs * 1.0e-3);
+        loads.push_back(100.0 * durationNs / periodNs);
+        if (i > 0 && status.cpuIndex != statistics[i - 1].cpuIndex) {
+            summary->numCpuChanges++;
+        }
+        const int32_t numThreads = std::min(status.numRenderThreads, config.numRenderThreads);
+        for (int32_t thread = 0; thread < numThreads; thread++) {
+            const ParallelVoiceRenderer::WorkerStatus &worker = status.renderThreads[thread];
+            if (worker.cpuIndex < 0) {
+                summary->renderThreads[thread].numSkipped++;
+            } else {
+                threadBeginOffsets[thread].push_back(worker.beginOffsetNs * 1.0e-3);
+                threadDurations[thread].push_back(worker.durationNs * 1.0e-3);
+            }
+        }
+        if (csvFile != nullptr) {
+            fprintf(csvFile, "%d,%d,%d,%d,%zu,%lld,%lld,%d,%d",
+                    runIndex, config.numVoices, config.numBursts, config.numRenderThreads, i,
+                    (long long) (status.beginTimeNs - statistics[0].beginTimeNs),
+                    (long long) durationNs, status.cpuIndex, status.xRunCount);
+            for (int32_t thread = 0; thread < maxRenderThreads; thread++) {
+                if (thread < numThreads) {
+                    const ParallelVoiceRenderer::WorkerStatus &worker =
+                            status.renderThreads[thread];
+                    fprintf(csvFile, ",%d,%d,%d",
+                            worker.beginOffsetNs, worker.durationNs, worker.cpuIndex);
+                } else {
+                    fprintf(csvFile, ",,,");
+                }
+            }
+            fprintf(csvFile, "\n");
+        }
+    }
+    summary->durationUs = measurePercentiles(durations);
+    summary->loadPercent = measurePercentiles(loads);
+    for (int32_t thread = 0; thread < config.numRenderThreads; thread++) {
+        RenderThreadSummary &threadSummary = summary->renderThreads[thread];
+        threadSummary.beginOffsetUs = measurePercentiles(threadBeginOffsets[thread]);
+        threadSummary.durationUs = measurePercentiles(threadDurations[thread]);
+    }
+    return true;
+}
+
+void writePercentiles(FILE *file, const char *name, const Percentiles &percentiles) {
+    fprintf(file, "\"%s\": {\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f}",
+            name, percentiles.p50, percentiles.p90, percentiles.p99, percentiles.max);
+}
+
+void writeJson(FILE *file, const std::vector<RunSummary> &summaries) {
+    fprintf(file, "[\n");
+    for (size_t i = 0; i < summaries.size(); i++) {
+        const RunSummary &summary = summaries[i];
+        fprintf(file, "  {\"voices\": %d, \"bufferBursts\": %d, \"renderThreads\": %d, "
+                      "\"seconds\": %d, \"framesPerBurst\": %d, \"sampleRate\": %d, "
+                      "\"bufferSizeInFrames\": %d, \"callbacks\": %d, \"xRuns\": %d, "
+                      "\"cpuChanges\": %d, ",
+                summary.config.numVoices, summary.config.numBursts,
+                summary.config.numRenderThreads, summary.config.seconds,
+                summary.framesPerBurst, summary.sampleRate, summary.bufferSizeInFrames,
+                summary.numCallbacks, summary.xRunCount, summary.numCpuChanges);
+        writePercentiles(file, "durationUs", summary.durationUs);
+        fprintf(file, ", ");
+        writePercentiles(file, "loadPercent", summary.loadPercent);
+        fprintf(file, ",\n   \"renderThreads\": [");
+        for (size_t thread = 0; thread < summary.renderThreads.size(); thread++) {
+            const RenderThreadSummary &threadSummary = summary.renderThreads[thread];
+            fprintf(file, "%s\n    {\"thread\": %zu, \"skipped\": %d, ",
+                    (thread > 0) ? "," : "", thread, threadSummary.numSkipped);
+            writePercentiles(file, "beginOffsetUs", threadSummary.beginOffsetUs);
+            fprintf(file, ", ");
+            writePercentiles(file, "durationUs", threadSummary.durationUs);
+            fprintf(file, "}");
+        }
+        fprintf(file, "]}%s\n", (i + 1 < summaries.size()) ? "," : "");
+    }
+    fprintf(file, "]\n");
+}
+
+void usage() {
+    printf("usage: benchmarkAudioWorkload [--voices N,N] [--bursts N,N] [--threads N,N]\n"
+           "                              [--seconds N,N] [--burst-frames N]\n"
+           "                              [--csv FILE] [--json FILE]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    std::vector<int32_t> voiceCounts = {8, 32, 128};
+    std::vector<int32_t> burstCounts = {1, 2, 4};
+    std::vector<int32_t> threadCounts = {1};
+    std::vector<int32_t> durations = {5};
+    const char *csvPath = nullptr;
+    const char *jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::vector<int32_t> *list = nullptr;
+        if (i + 1 < argc && strcmp(argv[i], "--voices") == 0) {
+            list = &voiceCounts;
+        } else if (i + 1 < argc && strcmp(argv[i], "--bursts") == 0) {
+            list = &burstCounts;
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            list = &threadCounts;
+        } else if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            list = &durations;
+        } else if (i + 1 < argc && strcmp(argv[i], "--burst-frames") == 0) {
+            oboe::getDefaultSimulatedDevice().framesPerBurst = std::max(16, atoi(argv[++i]));
+            continue;
+        } else if (i + 1 < argc && strcmp(argv[i], "--csv") == 0) {
+            csvPath = argv[++i];
+            continue;
+        } else if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[++i];
+            continue;
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+        *list = parseList(argv[++i]);
+        if (list->empty()) {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+    const int32_t maxRenderThreads = *std::max_element(threadCounts.begin(), threadCounts.end());
+    for (int32_t numThreads : threadCounts) {
+        if (numThreads > ParallelVoiceRenderer::kMaxWorkers) {
+            fprintf(stderr, "ERROR: at most %d render threads\n",
+                    ParallelVoiceRenderer::kMaxWorkers);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The SDK version is unknown on a host, so every workaround for old devices would apply.
+    oboe::OboeGlobals::setWorkaroundsEnabled(false);
+
+    FILE *csvFile = nullptr;
+    if (csvPath != nullptr) {
+        csvFile = fopen(csvPath, "w");
+        if (csvFile == nullptr) {
+            fprintf(stderr, "ERROR: could not create %s\n", csvPath);
+            return EXIT_FAILURE;
+        }
+        writeCsvHeader(csvFile, maxRenderThreads);
+    }
+
+    printf("benchmarkAudioWorkload: simulated device, %d frames per burst, us per callback\n",
+           oboe::getDefaultSimulatedDevice().framesPerBurst);
+    printf("%6s %6s %7s %7s %9s %6s %8s %8s %8s %8s %8s\n", "voices", "bursts", "threads",
+           "seconds", "callbacks", "xruns", "p50", "p90", "p99", "max", "max load");
+    std::vector<RunSummary> summaries;
+    bool passed = true;
+    for (int32_t seconds : durations) {
+        for (int32_t numThreads : threadCounts) {
+            for (int32_t numBursts : burstCounts) {
+                for (int32_t numVoices : voiceCounts) {
+                    RunConfig config{numVoices, numBursts, numThreads, seconds};
+                    RunSummary summary;
+                    if (!runWorkload(config, csvFile, maxRenderThreads,
+                                     (int32_t) summaries.size(), &summary)
+                            || summary.numCallbacks == 0) {
+                        fprintf(stderr, "ERROR: no callbacks for %d voices in %d bursts "
+                                        "on %d threads\n", numVoices, numBursts, numThreads);
+                        passed = false;
+                        continue;
+                    }
+                    printf("%6d %6d %7d %7d %9d %6d %8.1f %8.1f %8.1f %8.1f %7.1f%%\n",
+                           numVoices, numBursts, numThreads, seconds, summary.numCallbacks,
+                           summary.xRunCount, summary.durationUs.p50, summary.durationUs.p90,
+                           summary.durationUs.p99, summary.durationUs.max,
+                           summary.loadPercent.max);
+                    summaries.push_back(summary);
+                }
+            }
+        }
+    }
+
+    if (csvFile != nullptr) {
+        fclose(csvFile);
+    }
+    if (jsonPath != nullptr) {
+        FILE *jsonFile = fopen(jsonPath, "w");
+        if (jsonFile == nullptr) {
+            fprintf(stderr, "ERROR: could not create %s\n", jsonPath);
+            return EXIT_FAILURE;
+        }
+        writeJson(jsonFile, summaries);
+        fclose(jsonFile);
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
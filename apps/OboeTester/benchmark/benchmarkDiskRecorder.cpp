@@ -0,0 +1,172 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Stream a long simulated loopback recording to disk with BackgroundWaveRecorder.
+ *
+ * A producer thread calls write() with callback sized blocks, faster than real time,
+ * while the recorder thread writes a WAV file. This times write(), which runs in the
+ * audio callback, and counts overruns. The file is read back and must contain exactly
+ * the queued frames, in order.
+ *
+ * Usage: benchmarkDiskRecorder [--minutes N] [--speedup N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "util/BackgroundWaveRecorder.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kChannelCount = 2;
+constexpr int32_t kFramesPerBurst = 192;
+constexpr int32_t kFifoFrames = 2 * kSampleRate;
+constexpr int32_t kHeaderSize = 44;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A ramp that is exact in 24-bit PCM, so the file can be checked sample by sample.
+float sampleAt(int64_t frame, int32_t channel) {
+    const int32_t value = (int32_t) (((frame * kChannelCount) + channel) % (1 << 23));
+    return (float) value / 8388607.0f;
+}
+
+bool checkFile(const char *path, int64_t numFrames) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) return false;
+    uint8_t header[kHeaderSize];
+    bool ok = fread(header, 1, sizeof(header), file) == sizeof(header);
+    int32_t dataSize = 0;
+    memcpy(&dataSize, header + 40, sizeof(dataSize));
+    ok = ok && dataSize == numFrames * kChannelCount * 3;
+    std::vector<uint8_t> block(kSampleRate * kChannelCount * 3);
+    int64_t frame = 0;
+    while (ok && frame < numFrames) {
+        const int32_t framesNow = (int32_t) std::min<int64_t>(numFrames - frame, kSampleRate);
+        if (fread(block.data(), 3 * kChannelCount, framesNow, file) != (size_t) framesNow) {
+            ok = false;
+            break;
+        }
+        for (int32_t i = 0; ok && i < framesNow; i++) {
+            for (int32_t channel = 0; channel < kChannelCount; channel++) {
+                const uint8_t *bytes = &block[((i * kChannelCount) + channel) * 3];
+                const int32_t actual = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+                const int32_t expected = (int32_t) (((frame + i) * kChannelCount + channel)
+                                                    % (1 << 23));
+                ok = actual == expected;
+            }
+        }
+        frame += framesNow;
+    }
+    fclose(file);
+    return ok;
+}
+
+void usage() {
+    printf("usage: benchmarkDiskRecorder [--minutes N] [--speedup N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t minutes = 60;
+    int32_t speedup = 100;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--minutes") == 0) {
+            minutes = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--speedup") == 0) {
+            speedup = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    char path[] = "/tmp/benchmarkDiskRecorderXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: could not create %s\n", path);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    BackgroundWaveRecorder recorder(kChannelCount, kFifoFrames);
+    if (recorder.start(path, kSampleRate) != 0) {
+        fprintf(stderr, "ERROR: could not start recording to %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    // Pretend to be an audio callback that runs speedup times faster than real time.
+    const int64_t numBursts = (int64_t) minutes * 60 * kSampleRate / kFramesPerBurst;
+    const double burstSeconds = (double) kFramesPerBurst / kSampleRate / speedup;
+    std::vector<float> burst(kFramesPerBurst * kChannelCount);
+    double writeSeconds = 0.0;
+    double maxWriteSeconds = 0.0;
+    const double startTime = nowSeconds();
+    int64_t frame = 0;
+    for (int64_t i = 0; i < numBursts; i++) {
+        for (int32_t j = 0; j < kFramesPerBurst; j++) {
+            for (int32_t channel = 0; channel < kChannelCount; channel++) {
+                burst[(j * kChannelCount) + channel] = sampleAt(frame + j, channel);
+            }
+        }
+        const double start = nowSeconds();
+        if (recorder.write(burst.data(), kFramesPerBurst)) {
+            frame += kFramesPerBurst;
+        }
+        const double elapsed = nowSeconds() - start;
+        writeSeconds += elapsed;
+        maxWriteSeconds = std::max(maxWriteSeconds, elapsed);
+        const double wakeTime = startTime + ((i + 1) * burstSeconds);
+        const double sleepSeconds = wakeTime - nowSeconds();
+        if (sleepSeconds > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(sleepSeconds));
+        }
+    }
+    const int64_t fileSize = recorder.stop();
+    const double totalSeconds = nowSeconds() - startTime;
+
+    const bool fileOk = fileSize == kHeaderSize + (frame * kChannelCount * 3)
+            && recorder.getFramesWritten() == frame
+            && checkFile(path, frame);
+    unlink(path);
+
+    printf("benchmarkDiskRecorder: %d minutes of %d channel audio at %dx real time\n",
+           minutes, kChannelCount, speedup);
+    printf("recorded %lld frames, %.1f MB in %.1f seconds\n", (long long) frame,
+           fileSize * 1.0e-6, totalSeconds);
+    printf("write() mean %.0f ns, max %.0f ns\n",
+           writeSeconds * 1.0e9 / numBursts, maxWriteSeconds * 1.0e9);
+    printf("overruns %d blocks, %lld frames, FIFO peak %d of %d frames\n",
+           recorder.getOverrunCount(), (long long) recorder.getOverrunFrames(),
+           recorder.getMaxFramesInFifo(), kFifoFrames);
+    if (!fileOk) {
+        fprintf(stderr, "ERROR: the file does not match the queued frames\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measure how fast the analyzers can transform a block of real samples.
+ *
+ * For each size this times RealFft, in float and double, against the recursive complex
+ * FFT that the analyzers used before. It also checks that every transform gives the
+ * same spectrum, and that the inverse gives back the input, so it fails if RealFft is wrong.
+ *
+ * Usage: benchmarkFft [--repeats N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "RealFft.h"
+
+namespace {
+
+using Complex = std::complex<double>;
+using CVector = std::vector<Complex>;
+
+const int32_t kSizes[] = {256, 1024, 4096, 16384};
+
+// Enough transforms per run that even the smallest size takes a measurable time.
+constexpr int32_t kPointsPerRun = 1 << 20;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the fastest of several runs, in seconds.
+double timeBest(int repeats, const std::function<void()> &work) {
+    double best = 1.0e9;
+    for (int i = 0; i < repeats; i++) {
+        double start = nowSeconds();
+        work();
+        best = std::min(best, nowSeconds() - start);
+    }
+    return best;
+}
+
+// The radix-2 FFT the analyzers used before RealFft.
+void fftRecursive(CVector &a) {
+    int n = a.size();
+    if (n <= 1) return;
+
+    CVector a0(n / 2), a1(n / 2);
+    for (int i = 0; 2 * i < n; i++) {
+        a0[i] = a[2 * i];
+        a1[i] = a[2 * i + 1];
+    }
+    fftRecursive(a0);
+    fftRecursive(a1);
+
+    const double ang = 2 * M_PI / n;
+    Complex w(1), wn(cos(ang), sin(ang));
+    for (int i = 0; 2 * i < n; i++) {
+        a[i] = a0[i] + w * a1[i];
+        a[i + n / 2] = a0[i] - w * a1[i];
+        w *= wn;
+    }
+}
+
+std::vector<double> makeNoise(int32_t size) {
+    std::vector<double> samples(size);
+    uint32_t noise = 12345;
+    for (double &sample : samples) {
+        noise = noise * 1664525 + 1013904223; // LCG
+        sample = ((int32_t) noise) * (1.0 / 2147483648.0);
+    }
+    return samples;
+}
+
+// Largest difference between the magnitudes of a packed spectrum and a complex one,
+// relative to the largest magnitude.
+template <typename T>
+double compareMagnitudes(const std::vector<T> &packed, const CVector &reference) {
+    const int32_t size = (int32_t) packed.size();
+    double maxError = 0.0;
+    double maxMagnitude = 0.0;
+    for (int32_t k = 0; k <= size / 2; k++) {
+        double expected = std::abs(reference[k]);
+        double actual = RealFft<T>::magnitude(packed.data(), size, k);
+        maxError = std::max(maxError, std::abs(actual - expected));
+        maxMagnitude = std::max(maxMagnitude, expected);
+    }
+    return maxError / maxMagnitude;
+}
+
+// Largest difference between a round trip through RealFft and the input.
+template <typename T>
+double checkRoundTrip(const RealFft<T> &fft, const std::vector<double> &input) {
+    std::vector<T> data(input.begin(), input.end());
+    fft.forward(data.data());
+    fft.inverse(data.data());
+    double maxError = 0.0;
+    for (size_t i = 0; i < input.size(); i++) {
+        maxError = std::max(maxError, std::abs(data[i] - input[i]));
+    }
+    return maxError;
+}
+
+void usage() {
+    printf("usage: benchmarkFft [--repeats N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int repeats = 5;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--repeats") == 0) {
+            repeats = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("benchmarkFft: %d points per run, best of %d, microseconds per transform\n",
+           kPointsPerRun, repeats);
+    printf("%-6s %10s %10s %10s %8s %10s %10s\n",
+           "size", "recursive", "double", "float", "speedup", "error", "roundtrip");
+    bool passed = true;
+    for (int32_t size : kSizes) {
+        const int32_t numTransforms = kPointsPerRun / size;
+        const std::vector<double> input = makeNoise(size);
+        RealFft<double> fftDouble(size);
+        RealFft<float> fftFloat(size);
+
+        CVector reference(size);
+        double recursiveTime = timeBest(repeats, [&]() {
+            for (int32_t n = 0; n < numTransforms; n++) {
+                std::copy(input.begin(), input.end(), reference.begin());
+                fftRecursive(reference);
+            }
+        });
+        std::vector<double> dataDouble(size);
+        double doubleTime = timeBest(repeats, [&]() {
+            for (int32_t n = 0; n < numTransforms; n++) {
+                std::copy(input.begin(), input.end(), dataDouble.begin());
+                fftDouble.forward(dataDouble.data());
+            }
+        });
+        std::vector<float> dataFloat(size);
+        double floatTime = timeBest(repeats, [&]() {
+            for (int32_t n = 0; n < numTransforms; n++) {
+                std::copy(input.begin(), input.end(), dataFloat.begin());
+                fftFloat.forward(dataFloat.data());
+            }
+        });
+
+        double error = std::max(compareMagnitudes(dataDouble, reference),
+                                compareMagnitudes(dataFloat, reference) * 1.0e-6);
+        double roundTrip = std::max(checkRoundTrip(fftDouble, input),
+                                    checkRoundTrip(fftFloat, input) * 1.0e-6);
+        // Float errors are scaled so one threshold fits both precisions.
+        passed = passed && error < 1.0e-9 && roundTrip < 1.0e-9;
+
+        const double micros = 1.0e6 / numTransforms;
+        printf("%-6d %10.2f %10.2f %10.2f %7.1fx %10.2g %10.2g\n", size,
+               recursiveTime * micros, doubleTime * micros, floatTime * micros,
+               recursiveTime / doubleTime, error, roundTrip);
+    }
+    if (!passed) {
+        fprintf(stderr, "ERROR: RealFft does not match the recursive FFT\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measure how fast GlitchAnalyzer runs on a simulated loopback.
+ *
+ * Each channel has its own analyzer. The output is fed back to the input through a delay,
+ * with short dropouts to make glitches. Every channel is analyzed by ReferenceGlitchAnalyzer,
+ * a copy of the original frame by frame algorithm, and then by GlitchAnalyzer a callback at
+ * a time. Both must find the same glitches, so this fails if the block analysis changes the
+ * result. The speedup is measured against the original algorithm.
+ *
+ * Usage: benchmarkGlitch [--seconds N] [--channels N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "GlitchAnalyzer.h"
+#include "ReferenceGlitchAnalyzer.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kFramesPerBurst = 192;
+constexpr int32_t kDelayFrames = 1000;
+constexpr int32_t kBurstsPerDropout = 997;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct GlitchResult {
+    int32_t glitchCount = 0;
+    int32_t lockedFrames = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * Run one analyzer per channel over an interleaved loopback.
+ * Each analyzer is called once per callback, through its own process().
+ */
+template <class Analyzer>
+std::vector<GlitchResult> runLoopback(int32_t channelCount, int32_t seconds) {
+    std::vector<std::unique_ptr<Analyzer>> analyzers;
+    for (int32_t channel = 0; channel < channelCount; channel++) {
+        auto analyzer = std::make_unique<Analyzer>();
+        analyzer->setSampleRate(kSampleRate);
+        analyzer->setInputChannel(channel);
+        analyzer->setOutputChannel(channel);
+        analyzer->reset();
+        analyzer->prepareToTest();
+        analyzers.push_back(std::move(analyzer));
+    }
+
+    const int32_t ringFrames = 4096;
+    std::vector<float> ring(ringFrames * channelCount, 0.0f);
+    std::vector<float> input(kFramesPerBurst * channelCount);
+    std::vector<float> output(kFramesPerBurst * channelCount);
+    std::vector<float> channelOutput(kFramesPerBurst * channelCount);
+    std::vector<GlitchResult> results(channelCount);
+    PseudoRandom noise;
+    const int64_t numBursts = (int64_t) seconds * kSampleRate / kFramesPerBurst;
+    for (int64_t burst = 0; burst < numBursts; burst++) {
+        const int64_t firstFrame = burst * kFramesPerBurst;
+        const bool dropout = (burst % kBurstsPerDropout) == (kBurstsPerDropout / 2);
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            const int64_t source = firstFrame + i - kDelayFrames;
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                float sample = (source >= 0)
+                        ? ring[(source % ringFrames) * channelCount + channel] : 0.0f;
+                if (dropout && i > 10 && i < 20) {
+                    sample = 0.0f;
+                }
+                input[i * channelCount + channel] = (sample * 0.7f)
+                        + (float) (noise.nextRandomDouble() * 0.0005);
+            }
+        }
+
+        for (int32_t channel = 0; channel < channelCount; channel++) {
+            Analyzer &analyzer = *analyzers[channel];
+            double start = nowSeconds();
+            analyzer.process(input.data(), channelCount, kFramesPerBurst,
+                             channelOutput.data(), channelCount, kFramesPerBurst);
+            results[channel].seconds += nowSeconds() - start;
+            // Each analyzer writes only its own output channel.
+            for (int32_t i = 0; i < kFramesPerBurst; i++) {
+                output[i * channelCount + channel] = channelOutput[i * channelCount + channel];
+            }
+        }
+
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            std::copy(&output[i * channelCount], &output[(i + 1) * channelCount],
+                      &ring[((firstFrame + i) % ringFrames) * channelCount]);
+        }
+    }
+
+    for (int32_t channel = 0; channel < channelCount; channel++) {
+        results[channel].glitchCount = analyzers[channel]->getGlitchCount();
+        results[channel].lockedFrames = analyzers[channel]->getStateFrameCount(4);
+    }
+    return results;
+}
+
+void usage() {
+    printf("usage: benchmarkGlitch [--seconds N] [--channels N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t seconds = 60;
+    int32_t channelCount = 8;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--channels") == 0) {
+            channelCount = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<GlitchResult> frameResults =
+            runLoopback<ReferenceGlitchAnalyzer>(channelCount, seconds);
+    std::vector<GlitchResult> blockResults = runLoopback<GlitchAnalyzer>(channelCount, seconds);
+
+    printf("benchmarkGlitch: %d seconds, %d channels, %d frames per callback\n",
+           seconds, channelCount, kFramesPerBurst);
+    printf("%-8s %10s %10s %10s %10s %8s\n",
+           "channel", "glitches", "locked", "ref ns", "block ns", "speedup");
+    bool passed = true;
+    const double numFrames = (double) seconds * kSampleRate;
+    for (int32_t channel = 0; channel < channelCount; channel++) {
+        const GlitchResult &frame = frameResults[channel];
+        const GlitchResult &block = blockResults[channel];
+        bool matches = frame.glitchCount == block.glitchCount
+                && frame.lockedFrames == block.lockedFrames
+                && block.glitchCount > 0;
+        passed = passed && matches;
+        printf("%-8d %10d %10d %10.1f %10.1f %7.1fx%s\n", channel, block.glitchCount,
+               block.lockedFrames, frame.seconds * 1.0e9 / numFrames,
+               block.seconds * 1.0e9 / numFrames, frame.seconds / block.seconds,
+               matches ? "" : "  MISMATCH");
+    }
+    if (!passed) {
+        fprintf(stderr, "ERROR: block analysis does not match the reference analysis\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measure how long the latency analyzers take to find the pulse in a recording.
+ *
+ * Each case builds a recording with a known delay and some noise. It is correlated
+ * directly at every frame, with the old coarse then fine direct search, and with
+ * measureLatencyFromPulseFft(). The FFT result must match the direct one, so this fails
+ * if the FFT correlation is wrong.
+ *
+ * Usage: benchmarkLatency [--repeats N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include "LatencyAnalyzer.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kPulseLength = kSampleRate / 2;
+constexpr int32_t kFramesPerEncodedBit = 8;
+
+struct LatencyCase {
+    const char *name;
+    int32_t latencyFrames;
+    float gain;
+    float noise;
+};
+
+const LatencyCase kCases[] = {
+        {"wired",   117,   0.9f,  0.001f},
+        {"speaker", 4567,  0.3f,  0.05f},
+        {"noisy",   13001, 0.05f, 0.2f},
+};
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the fastest of several runs, in seconds.
+double timeBest(int repeats, const std::function<void()> &work) {
+    double best = 1.0e9;
+    for (int i = 0; i < repeats; i++) {
+        double start = nowSeconds();
+        work();
+        best = std::min(best, nowSeconds() - start);
+    }
+    return best;
+}
+
+// The coarse then fine search that measureLatencyFromPulse() used before the FFT.
+int measureLatencyCoarseFine(AudioRecording &recorded,
+                             AudioRecording &pulse,
+                             LatencyReport *report) {
+    const int32_t coarseStride = 16;
+    const int32_t fineWindowSize = coarseStride * 8;
+    LatencyReport coarseReport;
+    int result = measureLatencyFromPulsePartial(recorded, 0, recorded.size() - pulse.size(),
+                                                pulse, &coarseReport, coarseStride);
+    if (result != 0) {
+        return result;
+    }
+    int32_t maxRecordedOffset = recorded.size() - pulse.size() - fineWindowSize;
+    int32_t recordedOffset = coarseReport.latencyInFrames - (fineWindowSize / 2);
+    recordedOffset = std::max(0, std::min(maxRecordedOffset, recordedOffset));
+    return measureLatencyFromPulsePartial(recorded, recordedOffset, fineWindowSize,
+                                          pulse, report, 1);
+}
+
+void makeSignals(const LatencyCase &latencyCase, AudioRecording &pulse,
+                 AudioRecording &recorded) {
+    srand(1234); // RandomPulseGenerator uses rand()
+    RandomPulseGenerator pulser(kFramesPerEncodedBit);
+    pulse.allocate(kPulseLength);
+    for (int32_t i = 0; i < kPulseLength; i++) {
+        pulse.write(pulser.nextFloat() * 0.5f);
+    }
+
+    const int32_t maxLatencyFrames = kSampleRate * kMaxLatencyMillis / kMillisPerSecond;
+    recorded.allocate(kPulseLength + maxLatencyFrames);
+    PseudoRandom random;
+    for (int32_t i = 0; i < kPulseLength + maxLatencyFrames; i++) {
+        int32_t pulseIndex = i - latencyCase.latencyFrames;
+        float sample = (pulseIndex >= 0 && pulseIndex < kPulseLength)
+                ? pulse.getData()[pulseIndex] * latencyCase.gain : 0.0f;
+        recorded.write(sample + (float) random.nextRandomDouble() * latencyCase.noise);
+    }
+    recorded.normalize(1.0f);
+}
+
+void usage() {
+    printf("usage: benchmarkLatency [--repeats N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int repeats = 3;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--repeats") == 0) {
+            repeats = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("benchmarkLatency: %d frame pulse in a %d frame recording, best of %d\n",
+           kPulseLength, kPulseLength + kSampleRate * kMaxLatencyMillis / kMillisPerSecond,
+           repeats);
+    printf("%-10s %8s %8s %8s %8s %10s %10s %10s %8s\n", "case", "expected", "direct",
+           "coarse", "fft", "direct ms", "coarse ms", "fft ms", "speedup");
+    bool passed = true;
+    for (const LatencyCase &latencyCase : kCases) {
+        AudioRecording pulse;
+        AudioRecording recorded;
+        makeSignals(latencyCase, pulse, recorded);
+        const int32_t windowSize = recorded.size() - pulse.size();
+
+        LatencyReport direct;
+        LatencyReport coarse;
+        LatencyReport fft;
+        int directResult = 0;
+        int coarseResult = 0;
+        int fftResult = 0;
+        double directTime = timeBest(repeats, [&]() {
+            directResult = measureLatencyFromPulsePartial(recorded, 0, windowSize, pulse,
+                                                          &direct, 1);
+        });
+        double coarseTime = timeBest(repeats, [&]() {
+            coarseResult = measureLatencyCoarseFine(recorded, pulse, &coarse);
+        });
+        double fftTime = timeBest(repeats, [&]() {
+            fftResult = measureLatencyFromPulseFft(recorded, 0, windowSize, pulse, &fft);
+        });
+
+        bool matches = directResult == 0 && fftResult == 0
+                && fft.latencyInFrames == direct.latencyInFrames
+                && fabs(fft.correlation - direct.correlation) < 1.0e-3;
+        passed = passed && matches;
+        printf("%-10s %8d %8d %8d %8d %10.1f %10.1f %10.1f %7.1fx%s\n", latencyCase.name,
+               latencyCase.latencyFrames, direct.latencyInFrames,
+               coarseResult == 0 ? coarse.latencyInFrames : -1, fft.latencyInFrames,
+               directTime * 1000.0, coarseTime * 1000.0, fftTime * 1000.0,
+               directTime / fftTime, matches ? "" : "  MISMATCH");
+    }
+    if (!passed) {
+        fprintf(stderr, "ERROR: FFT correlation does not match the direct correlation\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Check MultiChannelAnalyzer on a simulated loopback and compare it with one GlitchAnalyzer
+ * per channel.
+ *
+ * The output is fed back to the input through a delay. Channel 0 leaks into channel 1 at
+ * -40 dB, and the last channel has short dropouts. This fails unless the analyzer locks on
+ * every channel, finds each dropout on the last channel only, and measures the crosstalk.
+ *
+ * With --full-duplex the MultiChannelAnalyzer is driven by a FullDuplexAnalyzer, as in the
+ * glitch test of OboeTester with multi_channel_mask set. The streams are simulated and the
+ * input stream returns the loopback.
+ *
+ * Usage: benchmarkMultiChannel [--seconds N] [--channels N] [--sample-rate N] [--full-duplex]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "FullDuplexAnalyzer.h"
+#include "GlitchAnalyzer.h"
+#include "MultiChannelAnalyzer.h"
+#include "SimulatedAudioStream.h"
+
+using namespace oboe;
+
+namespace {
+
+constexpr int32_t kDefaultBenchmarkRate = 48000;
+constexpr int32_t kFramesPerBurst = 192;
+constexpr int32_t kDelayFrames = 1000;
+constexpr int32_t kBurstsPerDropout = 997;
+constexpr float   kCrosstalkGain = 0.01f; // -40 dB from channel 0 into channel 1
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Feed the output back to the input for a number of bursts.
+ * @param process called with input and output buffers for each burst
+ * @return seconds spent in process
+ * @return number of dropouts
+ */
+double runLoopback(int32_t sampleRate, int32_t channelCount, int32_t seconds,
+                   int32_t *numDropouts,
+                   const std::function<void(const float *, float *)> &process) {
+    const int32_t ringFrames = 4096;
+    std::vector<float> ring(ringFrames * channelCount, 0.0f);
+    std::vector<float> input(kFramesPerBurst * channelCount);
+    std::vector<float> output(kFramesPerBurst * channelCount);
+    PseudoRandom noise;
+    double elapsed = 0.0;
+    *numDropouts = 0;
+    const int64_t numBursts = (int64_t) seconds * sampleRate / kFramesPerBurst;
+    for (int64_t burst = 0; burst < numBursts; burst++) {
+        const int64_t firstFrame = burst * kFramesPerBurst;
+        const bool dropout = (burst % kBurstsPerDropout) == (kBurstsPerDropout / 2);
+        if (dropout) (*numDropouts)++;
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            const int64_t source = firstFrame + i - kDelayFrames;
+            const float *frame = (source >= 0)
+                    ? &ring[(source % ringFrames) * channelCount] : nullptr;
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                float sample = 0.0f;
+                if (frame != nullptr) {
+                    sample = frame[channel];
+                    if (channel == 1) {
+                        sample += frame[0] * kCrosstalkGain;
+                    }
+                }
+                if (dropout && channel == channelCount - 1 && i > 10 && i < 20) {
+                    sample = 0.0f;
+                }
+                input[i * channelCount + channel] = (sample * 0.7f)
+                        + (float) (noise.nextRandomDouble() * 0.0005);
+            }
+        }
+
+        double start = nowSeconds();
+        process(input.data(), output.data());
+        elapsed += nowSeconds() - start;
+
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            std::copy(&output[i * channelCount], &output[(i + 1) * channelCount],
+                      &ring[((firstFrame + i) % ringFrames) * channelCount]);
+        }
+    }
+    return elapsed;
+}
+
+/**
+ * A blocking input stream that returns the frames passed to write(), instead of silence.
+ */
+class LoopbackInputStream : public SimulatedAudioStream {
+public:
+    LoopbackInputStream(const AudioStreamBuilder &builder, const SimulatedDevice &device)
+            : SimulatedAudioStream(builder, device) {}
+
+    ResultWithValue<int32_t> write(const void *buffer,
+                                   int32_t numFrames,
+                                   int64_t /* timeoutNanoseconds */) override {
+        const float *frames = static_cast<const float *>(buffer);
+        mFrames.insert(mFrames.end(), frames, frames + numFrames * getChannelCount());
+        mFramesWritten += numFrames;
+        return ResultWithValue<int32_t>(numFrames);
+    }
+
+    ResultWithValue<int32_t> read(void *buffer,
+                                  int32_t numFrames,
+                                  int64_t /* timeoutNanoseconds */) override {
+        const int32_t framesToRead = (int32_t) std::min<int64_t>(
+                numFrames, mFramesWritten - mFramesRead);
+        const int32_t numSamples = framesToRead * getChannelCount();
+        std::copy(mFrames.begin(), mFrames.begin() + numSamples, static_cast<float *>(buffer));
+        mFrames.erase(mFrames.begin(), mFrames.begin() + numSamples);
+        mFramesRead += framesToRead;
+        return ResultWithValue<int32_t>(framesToRead);
+    }
+
+    void updateFramesWritten() override {}
+
+private:
+    std::vector<float> mFrames;
+};
+
+/**
+ * Open simulated output and loopback input streams with the format used by the glitch test.
+ */
+std::shared_ptr<AudioStream> openSimulatedStream(Direction direction, int32_t sampleRate,
+                                                 int32_t channelCount) {
+    SimulatedDevice device;
+    device.sampleRate = sampleRate;
+    device.channelCount = channelCount;
+    device.framesPerBurst = kFramesPerBurst;
+    AudioStreamBuilder builder;
+    builder.setDirection(direction)
+            ->setFormat(AudioFormat::Float)
+            ->setSampleRate(sampleRate)
+            ->setChannelCount(channelCount);
+    std::shared_ptr<AudioStream> stream;
+    if (direction == Direction::Input) {
+        stream = std::make_shared<LoopbackInputStream>(builder, device);
+    } else {
+        stream = std::make_shared<SimulatedAudioStream>(builder, device);
+    }
+    return (stream->open() == Result::OK) ? stream : nullptr;
+}
+
+void usage() {
+    printf("usage: benchmarkMultiChannel [--seconds N] [--channels N] [--sample-rate N]"
+           " [--full-duplex]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t seconds = 60;
+    int32_t channelCount = 8;
+    int32_t sampleRate = kDefaultBenchmarkRate;
+    bool fullDuplex = false;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--channels") == 0) {
+            channelCount = std::max(2, std::min(MultiChannelAnalyzer::kMaxChannels,
+                                                atoi(argv[++i])));
+        } else if (i + 1 < argc && strcmp(argv[i], "--sample-rate") == 0) {
+            sampleRate = std::max(8000, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--full-duplex") == 0) {
+            fullDuplex = true;
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    MultiChannelAnalyzer analyzer;
+    analyzer.setSampleRate(sampleRate);
+    analyzer.setChannelMask((uint32_t) ((1ull << channelCount) - 1));
+    analyzer.reset();
+    int32_t numDropouts = 0;
+    double multiSeconds = 0.0;
+    if (fullDuplex) {
+        std::shared_ptr<AudioStream> outputStream = openSimulatedStream(Direction::Output,
+                                                                        sampleRate, channelCount);
+        std::shared_ptr<AudioStream> inputStream = openSimulatedStream(Direction::Input,
+                                                                       sampleRate, channelCount);
+        if (!outputStream || !inputStream) {
+            fprintf(stderr, "ERROR: could not open the simulated streams\n");
+            return EXIT_FAILURE;
+        }
+        FullDuplexAnalyzer fullDuplexAnalyzer(&analyzer);
+        fullDuplexAnalyzer.setSharedOutputStream(outputStream);
+        fullDuplexAnalyzer.setSharedInputStream(inputStream);
+        // Calls prepareToTest() with the sample rate of the output stream.
+        if (fullDuplexAnalyzer.start() != Result::OK) {
+            fprintf(stderr, "ERROR: could not start the full duplex analyzer\n");
+            return EXIT_FAILURE;
+        }
+        multiSeconds = runLoopback(sampleRate, channelCount, seconds, &numDropouts,
+                [&](const float *input, float *output) {
+            inputStream->write(input, kFramesPerBurst, 0);
+            fullDuplexAnalyzer.onAudioReady(outputStream.get(), output, kFramesPerBurst);
+        });
+        fullDuplexAnalyzer.stop();
+        outputStream->close();
+        inputStream->close();
+    } else {
+        analyzer.prepareToTest();
+        multiSeconds = runLoopback(sampleRate, channelCount, seconds, &numDropouts,
+                [&](const float *input, float *output) {
+            analyzer.process(input, channelCount, kFramesPerBurst,
+                             output, channelCount, kFramesPerBurst);
+        });
+    }
+
+    // The same loopback checked the old way, one analyzer per channel.
+    std::vector<std::unique_ptr<GlitchAnalyzer>> glitchAnalyzers;
+    for (int32_t channel = 0; channel < channelCount; channel++) {
+        auto glitchAnalyzer = std::make_unique<GlitchAnalyzer>();
+        glitchAnalyzer->setSampleRate(sampleRate);
+        glitchAnalyzer->setInputChannel(channel);
+        glitchAnalyzer->setOutputChannel(channel);
+        glitchAnalyzer->reset();
+        glitchAnalyzer->prepareToTest();
+        glitchAnalyzers.push_back(std::move(glitchAnalyzer));
+    }
+    std::vector<float> channelOutput(kFramesPerBurst * channelCount);
+    int32_t numGlitchDropouts = 0;
+    const double glitchSeconds = runLoopback(sampleRate, channelCount, seconds, &numGlitchDropouts,
+            [&](const float *input, float *output) {
+        for (int32_t channel = 0; channel < channelCount; channel++) {
+            glitchAnalyzers[channel]->process(input, channelCount, kFramesPerBurst,
+                                              channelOutput.data(), channelCount,
+                                              kFramesPerBurst);
+            for (int32_t i = 0; i < kFramesPerBurst; i++) {
+                output[i * channelCount + channel] = channelOutput[i * channelCount + channel];
+            }
+        }
+    });
+
+    printf("benchmarkMultiChannel: %d seconds, %d channels, %d Hz, %d dropouts on channel %d%s\n",
+           seconds, channelCount, sampleRate, numDropouts, channelCount - 1,
+           fullDuplex ? ", through FullDuplexAnalyzer" : "");
+    printf("%-8s %8s %10s %10s %10s %8s %6s\n",
+           "channel", "freq", "magnitude", "glitches", "xtalk dB", "source", "path");
+    bool passed = true;
+    for (int32_t index = 0; index < analyzer.getNumChannels(); index++) {
+        MultiChannelAnalyzer::ChannelResult result = analyzer.getChannelResult(index);
+        const int32_t channel = analyzer.getChannel(index);
+        const int32_t expectedGlitches = (channel == channelCount - 1) ? numDropouts : 0;
+        bool ok = result.locked && result.glitchCount == expectedGlitches
+                && result.dataPathValid;
+        if (channel == 1) {
+            ok = ok && result.crosstalkSource == 0 && fabs(result.crosstalkDB + 40.0) < 1.0;
+        } else {
+            ok = ok && result.crosstalkDB < -60.0;
+        }
+        passed = passed && ok;
+        printf("%-8d %8.1f %10.4f %10d %10.1f %8d %6s%s\n", channel,
+               analyzer.getToneFrequency(index), result.magnitude, result.glitchCount,
+               result.crosstalkDB, result.crosstalkSource,
+               result.dataPathValid ? "ok" : "bad", ok ? "" : "  FAILED");
+    }
+
+    const double numFrames = (double) seconds * sampleRate;
+    printf("one MultiChannelAnalyzer  %8.1f ns per frame\n", multiSeconds * 1.0e9 / numFrames);
+    printf("%2d GlitchAnalyzers        %8.1f ns per frame\n", channelCount,
+           glitchSeconds * 1.0e9 / numFrames);
+    if (!passed) {
+        fprintf(stderr, "ERROR: multi-channel analysis did not find the expected results\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Run StreamingLatencyAnalyzer on a simulated loopback for a long time.
+ *
+ * The output of the analyzer is fed back to its input through a delay line with noise.
+ * The delay changes every few seconds. Every accepted measurement must equal the delay,
+ * so this fails if the streaming matched filter is wrong. It also reports how much CPU
+ * the analyzer needs per second of audio.
+ *
+ * Usage: benchmarkStreamingLatency [--minutes N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "StreamingLatencyAnalyzer.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kFramesPerBurst = 192;
+constexpr int32_t kSecondsPerDelay = 10;
+const int32_t kDelays[] = {96, 1234, 4800, 333, 20000, 2500};
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void usage() {
+    printf("usage: benchmarkStreamingLatency [--minutes N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t minutes = 10;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--minutes") == 0) {
+            minutes = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    StreamingLatencyAnalyzer analyzer;
+    analyzer.setSampleRate(kSampleRate);
+    analyzer.setup();
+
+    const int32_t maxDelay = *std::max_element(std::begin(kDelays), std::end(kDelays));
+    std::vector<float> delayLine(maxDelay + kFramesPerBurst, 0.0f);
+    const int64_t numFrames = (int64_t) minutes * 60 * kSampleRate;
+    const int32_t numDelays = sizeof(kDelays) / sizeof(kDelays[0]);
+    PseudoRandom noise;
+
+    int32_t numWrong = 0;
+    int32_t lastCount = 0;
+    int32_t previousDelay = kDelays[0];
+    double analyzerTime = 0.0;
+    for (int64_t frame = 0; frame < numFrames; frame += kFramesPerBurst) {
+        const int64_t delaySection = frame / ((int64_t) kSecondsPerDelay * kSampleRate);
+        const int32_t delay = kDelays[delaySection % numDelays];
+        float output[kFramesPerBurst];
+        float input[kFramesPerBurst];
+
+        double start = nowSeconds();
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            analyzer.processOutputFrame(&output[i], 1);
+        }
+        analyzerTime += nowSeconds() - start;
+
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            const int64_t t = frame + i;
+            delayLine[t % delayLine.size()] = output[i];
+            float delayed = (t >= delay) ? delayLine[(t - delay) % delayLine.size()] : 0.0f;
+            input[i] = delayed * 0.3f + (float) noise.nextRandomDouble() * 0.02f;
+        }
+
+        start = nowSeconds();
+        for (int32_t i = 0; i < kFramesPerBurst; i++) {
+            analyzer.processInputFrame(&input[i], 1);
+        }
+        analyzerTime += nowSeconds() - start;
+
+        // Around a change of delay a measurement may see either delay.
+        int32_t count = analyzer.getNumMeasurements();
+        if (count != lastCount) {
+            int32_t latency = analyzer.getMeasuredLatency();
+            if (latency != delay && latency != previousDelay) {
+                printf("wrong latency %d at %.1f s, delay = %d\n", latency,
+                       (double) frame / kSampleRate, delay);
+                numWrong++;
+            }
+            lastCount = count;
+            previousDelay = delay;
+        }
+    }
+
+    const double audioSeconds = (double) numFrames / kSampleRate;
+    const int32_t expected = (int32_t) ((numFrames - kSampleRate / 2)
+                                        / analyzer.getPeriodFrames());
+    printf("benchmarkStreamingLatency: %d minutes of audio, one pulse per %d frames\n",
+           minutes, analyzer.getPeriodFrames());
+    printf("measurements = %d of %d, missed = %d, wrong = %d\n",
+           analyzer.getNumMeasurements(), expected, analyzer.getNumMissed(), numWrong);
+    printf("latency min = %d, max = %d, mean = %.1f frames\n", analyzer.getMinLatency(),
+           analyzer.getMaxLatency(), analyzer.getMeanLatency());
+    printf("analyzer time = %.3f s, %.3f%% of one core\n", analyzerTime,
+           100.0 * analyzerTime / audioSeconds);
+    // A pulse that is cut by a change of delay may be missed.
+    const int32_t numChanges = (int32_t) (audioSeconds / kSecondsPerDelay);
+    if (numWrong > 0 || analyzer.getNumMissed() > numChanges
+            || analyzer.getNumMeasurements() + analyzer.getNumMissed() < expected - 1) {
+        fprintf(stderr, "ERROR: streaming latency measurements are wrong or missing\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
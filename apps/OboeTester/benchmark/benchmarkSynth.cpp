@@ -0,0 +1,277 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Compare the cost of rendering marksynth voices one at a time, in SIMD lanes
+ * and spread across threads by ParallelVoiceRenderer.
+ *
+ * Both engines are built with the same random seed so they play the same notes.
+ * VoiceBank calculates pitch more accurately than the SimpleVoice table, so the
+ * oscillator phases slowly drift apart. This fails unless the waveforms match at the start
+ * and the level of every burst matches while notes attack, decay, release and restart.
+ * It also fails unless rendering on several threads gives the same output as one thread.
+ *
+ * Usage: benchmarkSynth [--seconds N] [--voices N] [--repeats N] [--threads N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "cpu/ParallelVoiceRenderer.h"
+#include "synth/Synthesizer.h"
+#include "synth/IncludeMeOnce.h"
+
+using namespace marksynth;
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kFramesPerBurst = 192;
+constexpr uint64_t kSeed = 12345;
+constexpr int32_t kMatchedBursts = 1;
+constexpr double kMinimumMatchDb = 80.0;   // signal to difference for the first burst
+constexpr double kMaximumLevelDb = 0.5;    // difference in the level of a burst
+constexpr double kSilenceDb = -80.0;
+// Only the order of adding the voices changes on several threads.
+constexpr double kMinimumParallelMatchDb = 100.0;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the fastest of several runs, in seconds.
+double timeBest(int repeats, const std::function<void()> &work) {
+    double best = 1.0e9;
+    for (int i = 0; i < repeats; i++) {
+        double start = nowSeconds();
+        work();
+        best = std::min(best, nowSeconds() - start);
+    }
+    return best;
+}
+
+std::unique_ptr<Synthesizer> makeSynth(Synthesizer::VoiceEngine engine, int32_t numVoices) {
+    SynthTools::setRandomSeed(kSeed);
+    std::unique_ptr<Synthesizer> synth = std::make_unique<Synthesizer>();
+    synth->setup(kSampleRate, numVoices, engine);
+    synth->notesOn(numVoices);
+    return synth;
+}
+
+// Render a number of bursts into one stereo buffer.
+void render(Synthesizer *synth, float *output, int32_t numFrames) {
+    for (int32_t frame = 0; frame < numFrames; frame += kFramesPerBurst) {
+        synth->renderStereo(output + (frame * SAMPLES_PER_FRAME), kFramesPerBurst);
+    }
+}
+
+struct Match {
+    double startDb = 0.0; // signal to difference for the first burst
+    double levelDb = 0.0; // largest difference in the level of a burst
+};
+
+double powerDb(double power) {
+    return 10.0 * log10(std::max(power, 1.0e-30));
+}
+
+/**
+ * Play both engines through attack, release and a second attack.
+ */
+Match measureMatch(int32_t numVoices) {
+    std::unique_ptr<Synthesizer> scalar = makeSynth(Synthesizer::VoiceEngine::Scalar, numVoices);
+    std::unique_ptr<Synthesizer> vector = makeSynth(Synthesizer::VoiceEngine::Vector, numVoices);
+    const int32_t burstsPerPhase = kSampleRate / 4 / kFramesPerBurst;
+    const int32_t samplesPerBurst = kFramesPerBurst * SAMPLES_PER_FRAME;
+    std::vector<float> expected(samplesPerBurst);
+    std::vector<float> actual(samplesPerBurst);
+    Match match;
+    double signal = 0.0;
+    double difference = 0.0;
+    for (int phase = 0; phase < 3; phase++) {
+        if (phase == 1) {
+            scalar->allNotesOff();
+            vector->allNotesOff();
+        } else if (phase == 2) {
+            SynthTools::setRandomSeed(kSeed);
+            scalar->notesOn(numVoices);
+            SynthTools::setRandomSeed(kSeed);
+            vector->notesOn(numVoices);
+        }
+        for (int32_t burst = 0; burst < burstsPerPhase; burst++) {
+            scalar->renderStereo(expected.data(), kFramesPerBurst);
+            vector->renderStereo(actual.data(), kFramesPerBurst);
+            double expectedPower = 0.0;
+            double actualPower = 0.0;
+            for (int32_t i = 0; i < samplesPerBurst; i++) {
+                expectedPower += expected[i] * expected[i];
+                actualPower += actual[i] * actual[i];
+                if (phase == 0 && burst < kMatchedBursts) {
+                    difference += (actual[i] - expected[i]) * (actual[i] - expected[i]);
+                }
+            }
+            if (phase == 0 && burst < kMatchedBursts) {
+                signal += expectedPower;
+            }
+            expectedPower /= samplesPerBurst;
+            actualPower /= samplesPerBurst;
+            if (powerDb(expectedPower) > kSilenceDb || powerDb(actualPower) > kSilenceDb) {
+                match.levelDb = std::max(match.levelDb,
+                                         fabs(powerDb(actualPower) - powerDb(expectedPower)));
+            }
+        }
+    }
+    match.startDb = powerDb(signal) - powerDb(difference);
+    return match;
+}
+
+struct ParallelResult {
+    double meanBurstNs = 0.0;
+    double maxBurstNs = 0.0;
+    double stolenPerBurst = 0.0;
+    double skippedPercent = 0.0; // helpers that woke too late to help
+    double matchDb = 0.0;        // signal to difference compared with one thread
+};
+
+/**
+ * Render burst by burst on a number of threads and on the calling thread only.
+ */
+ParallelResult measureParallel(int32_t numThreads, int32_t numVoices, int32_t numBursts) {
+    std::unique_ptr<Synthesizer> serial = makeSynth(Synthesizer::VoiceEngine::Vector, numVoices);
+    std::unique_ptr<Synthesizer> parallel = makeSynth(Synthesizer::VoiceEngine::Vector,
+                                                      numVoices);
+    ParallelVoiceRenderer renderer;
+    renderer.start(numThreads);
+    const int32_t samplesPerBurst = kFramesPerBurst * SAMPLES_PER_FRAME;
+    std::vector<float> expected(samplesPerBurst);
+    std::vector<float> actual(samplesPerBurst);
+    ParallelResult result;
+    double signal = 0.0;
+    double difference = 0.0;
+    int64_t numStolen = 0;
+    int64_t numSkipped = 0;
+    for (int32_t burst = 0; burst < numBursts; burst++) {
+        serial->renderStereo(expected.data(), kFramesPerBurst);
+        double start = nowSeconds();
+        renderer.render(*parallel, actual.data(), kFramesPerBurst);
+        double burstNs = (nowSeconds() - start) * 1.0e9;
+        result.meanBurstNs += burstNs;
+        result.maxBurstNs = std::max(result.maxBurstNs, burstNs);
+        for (int32_t i = 0; i < numThreads; i++) {
+            const ParallelVoiceRenderer::WorkerStatus &status = renderer.getWorkerStatus(i);
+            numStolen += status.numStolen;
+            if (status.cpuIndex < 0) numSkipped++;
+        }
+        for (int32_t i = 0; i < samplesPerBurst; i++) {
+            signal += expected[i] * expected[i];
+            difference += (actual[i] - expected[i]) * (actual[i] - expected[i]);
+        }
+    }
+    renderer.stop();
+    result.meanBurstNs /= numBursts;
+    result.stolenPerBurst = (double) numStolen / numBursts;
+    result.skippedPercent = (numThreads > 1)
+            ? 100.0 * numSkipped / ((double) numBursts * (numThreads - 1)) : 0.0;
+    result.matchDb = powerDb(signal) - powerDb(difference);
+    return result;
+}
+
+void usage() {
+    printf("usage: benchmarkSynth [--seconds N] [--voices N] [--repeats N] [--threads N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t seconds = 10;
+    int32_t maxVoices = 256;
+    int repeats = 3;
+    int32_t maxThreads = std::max(1, std::min((int32_t) std::thread::hardware_concurrency(),
+                                              ParallelVoiceRenderer::kMaxWorkers));
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--voices") == 0) {
+            maxVoices = std::max(1, std::min(kSynthmarkMaxVoices, atoi(argv[++i])));
+        } else if (i + 1 < argc && strcmp(argv[i], "--repeats") == 0) {
+            repeats = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            maxThreads = std::max(1, std::min(ParallelVoiceRenderer::kMaxWorkers,
+                                              atoi(argv[++i])));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("benchmarkSynth: %d seconds, best of %d, ns per voice per frame\n", seconds, repeats);
+    printf("%6s %10s %10s %8s %10s %10s\n",
+           "voices", "scalar", "vector", "speedup", "start dB", "level dB");
+    const int32_t numFrames = seconds * kSampleRate / kFramesPerBurst * kFramesPerBurst;
+    std::vector<float> output(numFrames * SAMPLES_PER_FRAME);
+    bool passed = true;
+    for (int32_t numVoices = 1; numVoices <= maxVoices; numVoices *= 4) {
+        std::unique_ptr<Synthesizer> scalar = makeSynth(Synthesizer::VoiceEngine::Scalar,
+                                                        numVoices);
+        std::unique_ptr<Synthesizer> vector = makeSynth(Synthesizer::VoiceEngine::Vector,
+                                                        numVoices);
+        double scalarTime = timeBest(repeats, [&]() {
+            render(scalar.get(), output.data(), numFrames);
+        });
+        double vectorTime = timeBest(repeats, [&]() {
+            render(vector.get(), output.data(), numFrames);
+        });
+        // Include a partly filled group of lanes.
+        Match match = measureMatch(numVoices + 1);
+        const double voiceFrames = (double) numVoices * numFrames;
+        printf("%6d %10.2f %10.2f %7.1fx %10.1f %10.3f\n", numVoices,
+               scalarTime * 1.0e9 / voiceFrames, vectorTime * 1.0e9 / voiceFrames,
+               scalarTime / vectorTime, match.startDb, match.levelDb);
+        if (match.startDb < kMinimumMatchDb || match.levelDb > kMaximumLevelDb) {
+            fprintf(stderr, "ERROR: VoiceBank does not match SimpleVoice for %d voices\n",
+                    numVoices + 1);
+            passed = false;
+        }
+    }
+
+    printf("\nParallelVoiceRenderer: %d voices in bursts of %d frames, us per burst\n",
+           maxVoices, kFramesPerBurst);
+    printf("%7s %10s %10s %8s %8s %8s %10s\n",
+           "threads", "mean", "max", "speedup", "stolen", "skipped", "match dB");
+    const int32_t numBursts = numFrames / kFramesPerBurst;
+    double oneThreadNs = 0.0;
+    for (int32_t numThreads = 1; numThreads <= maxThreads; numThreads++) {
+        ParallelResult result = measureParallel(numThreads, maxVoices, numBursts);
+        if (numThreads == 1) oneThreadNs = result.meanBurstNs;
+        printf("%7d %10.1f %10.1f %7.2fx %8.1f %7.1f%% %10.1f\n", numThreads,
+               result.meanBurstNs * 1.0e-3, result.maxBurstNs * 1.0e-3,
+               oneThreadNs / result.meanBurstNs, result.stolenPerBurst, result.skippedPercent,
+               result.matchDb);
+        if (result.matchDb < kMinimumParallelMatchDb) {
+            fprintf(stderr, "ERROR: %d threads do not match one thread\n", numThreads);
+            passed = false;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measure how fast WaveFileWriter converts and writes float audio.
+ *
+ * For each sample format this times the block writer into memory and into a file.
+ * For 16 and 24 bit it also times the old path, which converted one sample at a time and
+ * passed every byte through a virtual call. The converters are checked against a scalar
+ * reference, and a file of unknown length must have its chunk sizes filled in by close().
+ *
+ * Usage: benchmarkWaveFileWriter [--seconds N] [--channels N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+#include "util/WaveFileWriter.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kFramesPerWrite = 1024;
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Like the per-byte stream that saveWaveFile() used before, but into memory that is
+// already mapped so that page faults do not hide the cost of the calls.
+class ByteStream : public WaveFileOutputStream {
+public:
+    explicit ByteStream(size_t capacity) : mData(capacity) {}
+    void write(uint8_t b) override {
+        mData[mSize++] = b;
+    }
+    size_t size() const {
+        return mSize;
+    }
+protected:
+    std::vector<uint8_t> mData;
+    size_t mSize = 0;
+};
+
+class BlockStream : public ByteStream {
+public:
+    explicit BlockStream(size_t capacity) : ByteStream(capacity) {}
+    void write(uint8_t b) override {
+        mData[mSize++] = b;
+    }
+    void write(const uint8_t *buffer, int32_t numBytes) override {
+        memcpy(&mData[mSize], buffer, numBytes);
+        mSize += numBytes;
+    }
+};
+
+// The per-sample conversion WaveFileWriter used before, one virtual call per byte.
+void writeLegacy(WaveFileOutputStream *stream, const float *buffer, int32_t numSamples,
+                 int32_t bitsPerSample) {
+    const int32_t maximum = (bitsPerSample == 24) ? (1 << 23) - 1 : INT16_MAX;
+    const int32_t minimum = -maximum - 1;
+    for (int32_t i = 0; i < numSamples; i++) {
+        float temp = (maximum * buffer[i]) + 0.5 - minimum;
+        int32_t sample = ((int) temp) + minimum;
+        sample = std::min(std::max(sample, minimum), maximum);
+        stream->write((uint8_t) sample);
+        stream->write((uint8_t) (sample >> 8));
+        if (bitsPerSample == 24) {
+            stream->write((uint8_t) (sample >> 16));
+        }
+    }
+}
+
+// Reference conversion for the bulk converters.
+void convertReference(const float *src, uint8_t *dst, int32_t numSamples,
+                      int32_t bitsPerSample) {
+    const int32_t bytesPerSample = bitsPerSample / 8;
+    const double maximum = (bitsPerSample == 32) ? 2147483647.0
+            : (double) ((1 << (bitsPerSample - 1)) - 1);
+    const float clipMax = (bitsPerSample == 32) ? 2147483520.0f : (float) maximum;
+    const float clipMin = (float) (-maximum - 1.0);
+    for (int32_t i = 0; i < numSamples; i++) {
+        float scaled = src[i] * (float) maximum;
+        scaled = std::min(std::max(scaled, clipMin), clipMax);
+        int32_t sample = (int32_t) lrintf(scaled);
+        for (int32_t b = 0; b < bytesPerSample; b++) {
+            dst[i * bytesPerSample + b] = (uint8_t) (sample >> (8 * b));
+        }
+    }
+}
+
+bool checkConverters() {
+    std::vector<float> signal(4099);
+    uint32_t noise = 12345;
+    for (size_t i = 0; i < signal.size(); i++) {
+        noise = noise * 1664525 + 1013904223; // LCG
+        signal[i] = ((int32_t) noise) * (1.5f / 2147483648.0f); // includes out of range
+    }
+    signal[0] = 1.0f;
+    signal[1] = -1.0f;
+    signal[2] = 1.0e9f;
+    signal[3] = -1.0e9f;
+    const int32_t numSamples = (int32_t) signal.size();
+    std::vector<uint8_t> actual(numSamples * 4);
+    std::vector<uint8_t> expected(numSamples * 4);
+    struct {
+        int32_t bits;
+        void (*convert)(const float *, uint8_t *, int32_t);
+    } formats[] = {
+        {16, WaveFileWriter::convertToPCM16},
+        {24, WaveFileWriter::convertToPCM24},
+        {32, WaveFileWriter::convertToPCM32},
+    };
+    bool passed = true;
+    for (const auto &format : formats) {
+        format.convert(signal.data(), actual.data(), numSamples);
+        convertReference(signal.data(), expected.data(), numSamples, format.bits);
+        const size_t numBytes = numSamples * format.bits / 8;
+        if (memcmp(actual.data(), expected.data(), numBytes) != 0) {
+            fprintf(stderr, "ERROR: PCM%d conversion does not match the reference\n",
+                    format.bits);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+int32_t readIntLittle(const uint8_t *bytes) {
+    int32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+void usage() {
+    printf("usage: benchmarkWaveFileWriter [--seconds N] [--channels N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t seconds = 60;
+    int32_t channelCount = 8;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--channels") == 0) {
+            channelCount = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (!checkConverters()) {
+        return EXIT_FAILURE;
+    }
+
+    const int32_t numWrites = seconds * kSampleRate / kFramesPerWrite;
+    const int32_t samplesPerWrite = kFramesPerWrite * channelCount;
+    std::vector<float> buffer(samplesPerWrite);
+    for (int32_t i = 0; i < samplesPerWrite; i++) {
+        buffer[i] = 0.9f * (float) sin(i * 0.0123);
+    }
+    const double megaSamples = (double) numWrites * samplesPerWrite * 1.0e-6;
+    char path[] = "/tmp/benchmarkWaveFileWriterXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR: could not create %s\n", path);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    printf("benchmarkWaveFileWriter: %d seconds of %d channel audio, MSamples/s\n",
+           seconds, channelCount);
+    printf("%-8s %10s %10s %10s %8s\n", "format", "old", "memory", "file", "speedup");
+    struct {
+        const char *name;
+        int32_t bits;
+        bool isFloat;
+    } formats[] = {
+        {"PCM16", 16, false},
+        {"PCM24", 24, false},
+        {"PCM32", 32, false},
+        {"Float32", 32, true},
+    };
+    bool passed = true;
+    for (const auto &format : formats) {
+        const size_t capacity = 44 + ((size_t) numWrites * samplesPerWrite * format.bits / 8);
+        double legacyTime = 0.0;
+        if (!format.isFloat && format.bits != 32) {
+            ByteStream stream(capacity);
+            double start = nowSeconds();
+            for (int32_t i = 0; i < numWrites; i++) {
+                writeLegacy(&stream, buffer.data(), samplesPerWrite, format.bits);
+            }
+            legacyTime = nowSeconds() - start;
+        }
+
+        BlockStream memoryStream(capacity);
+        double start = nowSeconds();
+        {
+            WaveFileWriter writer(&memoryStream);
+            writer.setFrameRate(kSampleRate);
+            writer.setSamplesPerFrame(channelCount);
+            writer.setBitsPerSample(format.bits);
+            writer.setFloatSamples(format.isFloat);
+            for (int32_t i = 0; i < numWrites; i++) {
+                writer.write(buffer.data(), samplesPerWrite);
+            }
+            writer.close();
+        }
+        const double memoryTime = nowSeconds() - start;
+
+        // Unknown length, so close() has to fill in the chunk sizes.
+        FILE *file = fopen(path, "wb");
+        start = nowSeconds();
+        WaveFileStdioStream fileStream(file);
+        {
+            WaveFileWriter writer(&fileStream);
+            writer.setFrameRate(kSampleRate);
+            writer.setSamplesPerFrame(channelCount);
+            writer.setBitsPerSample(format.bits);
+            writer.setFloatSamples(format.isFloat);
+            for (int32_t i = 0; i < numWrites; i++) {
+                writer.write(buffer.data(), samplesPerWrite);
+            }
+            writer.close();
+        }
+        fclose(file);
+        const double fileTime = nowSeconds() - start;
+
+        uint8_t header[44];
+        file = fopen(path, "rb");
+        const bool readOk = fread(header, 1, sizeof(header), file) == sizeof(header);
+        fclose(file);
+        const int64_t fileSize = fileStream.length();
+        const bool sizesOk = readOk && !fileStream.hasFailed()
+                && readIntLittle(header + 4) == fileSize - 8
+                && readIntLittle(header + 40) == fileSize - 44
+                && fileSize == (int64_t) memoryStream.size();
+        passed = passed && sizesOk;
+
+        if (legacyTime > 0.0) {
+            printf("%-8s %10.1f %10.1f %10.1f %7.1fx%s\n", format.name,
+                   megaSamples / legacyTime, megaSamples / memoryTime, megaSamples / fileTime,
+                   legacyTime / memoryTime, sizesOk ? "" : "  BAD HEADER");
+        } else {
+            printf("%-8s %10s %10.1f %10.1f %8s%s\n", format.name, "-",
+                   megaSamples / memoryTime, megaSamples / fileTime, "-",
+                   sizesOk ? "" : "  BAD HEADER");
+        }
+    }
+    unlink(path);
+    if (!passed) {
+        fprintf(stderr, "ERROR: close() did not fill in the chunk sizes\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -563,6 +563,18 @@ public:
         return mPerformanceHintEnabled;
     }
 
+    /**
+     * This tells you if a performance hint session was actually opened for the data callback.
+     * It can be false even if setPerformanceHintEnabled(true) was called, for example if the
+     * device does not support ADPF. The session is opened in the first data callback,
+     * so call this from the data callback.
+     *
+     * @return true if the stream is reporting the callback duration to a hint session
+     */
+    virtual bool isPerformanceHintActive() {
+        return false;
+    }
+
     /**
      * Use this to give the performance manager more information about your workload.
      * You can call this at the beginning of the callback when you figure
@@ -780,6 +792,29 @@ public:
         return ResultWithValue<PlaybackParameters>(Result::ErrorUnimplemented);
     }
 
+    /**
+     * Open a new stream with the same settings that were used to open this stream.
+     *
+     * This is faster than calling AudioStreamBuilder::openStream() because decisions that
+     * were made when this stream was opened, such as whether data conversion is needed,
+     * are reused. If this stream has been closed then its sample rate converter is also
+     * reused, which avoids recalculating the filter coefficients.
+     *
+     * This is intended for restarting after a disconnect, for example from
+     * AudioStreamErrorCallback::onErrorAfterClose(). The new stream may be on a different
+     * device so its properties may differ from this stream where the app did not
+     * request specific values.
+     *
+     * The new stream is not started.
+     *
+     * @param newStream reference to a shared_ptr to receive the new stream
+     * @return OK, ErrorInvalidState if this stream was not opened by an AudioStreamBuilder,
+     *         or another negative error code if the open fails
+     */
+    Result reopen(std::shared_ptr<oboe::AudioStream> &newStream) {
+        return AudioStreamBuilder::reopenStream(*this, newStream);
+    }
+
     /*
      * Make a shared_ptr that will prevent this stream from being deleted.
      */
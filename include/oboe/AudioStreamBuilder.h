@@ -28,6 +28,9 @@ namespace oboe {
     struct StreamDeleterFunctor;
     using ManagedStream = std::unique_ptr<AudioStream, StreamDeleterFunctor>;
 
+    // Decisions saved when a stream is opened, used by AudioStream::reopen().
+    struct ReopenSnapshot;
+
 /**
  * Factory class for an audio Stream.
  */
@@ -770,6 +773,7 @@ public:
     Result openManagedStream(ManagedStream &stream);
 
 private:
+    friend class AudioStream; // allow access to reopenStream()
 
     /**
      * Use this internally to implement opening with a shared_ptr.
@@ -779,6 +783,22 @@ private:
      */
     Result openStreamInternal(AudioStream **streamPP);
 
+    /**
+     * Open a stream using the decisions saved in the snapshot instead of making them again.
+     * The snapshot will be updated with anything learned while opening.
+     *
+     * @param snapshot saved decisions
+     * @param streamPP pointer to a variable to receive the stream address
+     * @return OBOE_OK if successful or a negative error code.
+     */
+    static Result openStreamWithSnapshot(std::shared_ptr<ReopenSnapshot> &snapshot,
+                                         AudioStream **streamPP);
+
+    /**
+     * Implementation of AudioStream::reopen().
+     */
+    static Result reopenStream(AudioStream &oldStream, std::shared_ptr<AudioStream> &sharedStream);
+
     /**
      * @param other
      * @return true if channels, format and sample rate match
@@ -17,7 +17,9 @@
 #ifndef OBOE_STABILIZEDCALLBACK_H
 #define OBOE_STABILIZEDCALLBACK_H
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include "oboe/AudioStream.h"
 
 namespace oboe {
@@ -53,6 +55,131 @@ private:
     void generateLoad(int64_t durationNanos);
 };
 
+class AdpfWrapper;
+
+/**
+ * A lower energy alternative to StabilizedCallback.
+ *
+ * StabilizedCallback spins the CPU for most of every callback so that the CPU governor does not
+ * lower the clock frequency. This callback instead relies on performance hints (ADPF) to tell
+ * the governor how long the real work takes. It only generates synthetic load when the measured
+ * late-start jitter of the callback exceeds a threshold, and then only up to a minimum work
+ * budget, which is much smaller than the load used by StabilizedCallback.
+ *
+ * If the stream has opened its own hint session, see AudioStream::isPerformanceHintActive(),
+ * then that session is used. It measures the whole callback, so no synthetic load is generated
+ * and the session only sees the real work. Otherwise this callback opens its own session and
+ * reports the wrapped callback's work to it, without the load. That includes a stream that had
+ * performance hints enabled but could not open a session, so the jitter fallback still works
+ * on devices without ADPF.
+ *
+ * The amount of synthetic load that was actually injected can be queried from any thread so
+ * that the energy cost can be measured. The counters start again from zero when an error
+ * closes the stream, so a reopened stream is measured on its own.
+ */
+class EnergyAwareStabilizedCallback : public AudioStreamCallback {
+
+public:
+    explicit EnergyAwareStabilizedCallback(AudioStreamCallback *callback);
+
+    ~EnergyAwareStabilizedCallback();
+
+    DataCallbackResult
+    onAudioReady(AudioStream *oboeStream, void *audioData, int32_t numFrames) override;
+
+    void onErrorBeforeClose(AudioStream *oboeStream, Result error) override {
+        return mCallback->onErrorBeforeClose(oboeStream, error);
+    }
+
+    void onErrorAfterClose(AudioStream *oboeStream, Result error) override;
+
+    /**
+     * Set the late-start jitter, as a fraction of the callback duration, above which
+     * synthetic load will be generated. The default is 0.1.
+     *
+     * @param fraction of the callback duration, between 0.0 and 1.0
+     */
+    void setJitterThreshold(double fraction) {
+        mJitterThreshold = fraction;
+    }
+
+    /**
+     * Set the minimum amount of work, as a fraction of the callback duration, that will be
+     * done when synthetic load is being generated. This includes the time spent in the
+     * wrapped callback.
+     *
+     * This is a tuning knob. The default of 0.3 is a starting point, well below the 0.8 that
+     * StabilizedCallback spins for, and not a value measured to be best on any device.
+     * If glitches continue while isGeneratingLoad() is true then raise it. If they do not
+     * then try lowering it and compare getInjectedLoadNanos() against getAudioDurationNanos().
+     *
+     * @param fraction of the callback duration, between 0.0 and 1.0
+     */
+    void setMinimumWorkBudget(double fraction) {
+        mMinimumWorkBudget = fraction;
+    }
+
+    /**
+     * @return true if the last callback generated synthetic load because of excessive jitter
+     */
+    bool isGeneratingLoad() const {
+        return mGeneratingLoad.load();
+    }
+
+    /**
+     * @return total nanoseconds of synthetic load generated since this callback was created
+     * or an error closed its stream
+     */
+    int64_t getInjectedLoadNanos() const {
+        return mInjectedLoadNanos.load();
+    }
+
+    /**
+     * @return total nanoseconds spent in the wrapped callback since this callback was
+     * created or an error closed its stream
+     */
+    int64_t getCallbackWorkNanos() const {
+        return mCallbackWorkNanos.load();
+    }
+
+    /**
+     * @return total duration of the audio processed since this callback was created or
+     * an error closed its stream, in nanoseconds
+     */
+    int64_t getAudioDurationNanos() const {
+        return mAudioDurationNanos.load();
+    }
+
+private:
+
+    void reset();
+
+    /**
+     * Opens this callback's own hint session if the stream does not have one.
+     * @return true if the stream's session is reporting the whole callback
+     */
+    bool beginPerformanceHint(AudioStream *oboeStream, int64_t burstNanos);
+
+    void endPerformanceHint(int32_t numFrames, int32_t framesPerBurst);
+
+    int64_t generateLoadUntil(int64_t deadlineNanos);
+
+    AudioStreamCallback *mCallback = nullptr;
+    std::unique_ptr<AdpfWrapper> mAdpfWrapper;
+    bool    mAdpfOpenAttempted = false;
+    int64_t mFrameCount = 0;
+    int64_t mEpochTimeNanos = 0;
+    double  mOpsPerNano = 1;
+    double  mJitterThreshold = 0.1;
+    double  mMinimumWorkBudget = 0.3;
+    double  mLateStartAverageNanos = 0;
+
+    std::atomic<bool>    mGeneratingLoad{false};
+    std::atomic<int64_t> mInjectedLoadNanos{0};
+    std::atomic<int64_t> mCallbackWorkNanos{0};
+    std::atomic<int64_t> mAudioDurationNanos{0};
+};
+
 /**
  * cpu_relax is an architecture specific method of telling the CPU that you don't want it to
  * do much work. asm volatile keeps the compiler from optimising these instructions out.
@@ -15,8 +15,11 @@
  */
 
 #include "DJEngine.h"
+#include <algorithm>
 #include <android/log.h>
 
+#include "MixKernels.h"
+
 static const char* TAG = "DJEngine";
 
 namespace oboedj {
@@ -54,6 +57,11 @@ bool DJEngine::openStream() {
     }
 
     mSampleRate = mStream->getSampleRate();
+    // Size the deck buffer now so the callback does not allocate. No callback asks for more
+    // than the buffer capacity, or the fixed callback size if one was set.
+    int32_t maxCallbackFrames = std::max(mStream->getBufferCapacityInFrames(),
+                                         mStream->getFramesPerDataCallback());
+    mDeckBuffer.assign(maxCallbackFrames * mStream->getChannelCount(), 0.0f);
     __android_log_print(ANDROID_LOG_INFO, TAG, "Stream opened with sample rate: %d", mSampleRate);
 
     return true;
@@ -90,7 +98,8 @@ void DJEngine::loadTrack(uint8_t* buffer, int32_t length, int32_t deckIndex) {
     reader.parse();
 
     auto sampleBuffer = std::make_shared<iolib::SampleBuffer>();
-    sampleBuffer->loadSampleData(&reader);
+    // The decks interpolate the float samples in place, see SoundPlayer.
+    sampleBuffer->loadSampleData(&reader, iolib::SampleFormat::Float);
     
     // Statically resample to device rate if needed
     sampleBuffer->resampleData(mSampleRate);
@@ -130,20 +139,33 @@ oboe::DataCallbackResult DJEngine::onAudioReady(oboe::AudioStream *oboeStream,
     float leftVolume = 1.0f - crossfade;
     float rightVolume = crossfade;
 
-    // We need a temp buffer for each deck to scale volume
-    std::vector<float> tempBuffer(numFrames * numChannels, 0.0f);
+    // The deck buffer is sized in openStream(). A larger callback than expected is rendered
+    // in pieces rather than allocating here.
+    const int32_t maxDeckFrames = static_cast<int32_t>(mDeckBuffer.size()) / numChannels;
+    if (maxDeckFrames == 0) {
+        return oboe::DataCallbackResult::Continue;
+    }
 
     for (size_t i = 0; i < mDecks.size(); ++i) {
+        float volume = (i == 0) ? leftVolume : rightVolume;
         if (mDecks[i]->isPlaying()) {
-            std::fill(tempBuffer.begin(), tempBuffer.end(), 0.0f);
-            mDecks[i]->renderAudio(tempBuffer.data(), numChannels, numFrames);
-
-            float volume = (i == 0) ? leftVolume : rightVolume;
-
-            for (int32_t j = 0; j < numFrames * numChannels; ++j) {
-                floatData[j] += tempBuffer[j] * volume;
+            // Ramp from the last volume so moving the crossfader does not cause zipper noise.
+            float volumeStep = (volume - mDeckVolumes[i]) / numFrames;
+            int32_t framesDone = 0;
+            while (framesDone < numFrames) {
+                int32_t deckFrames = std::min(numFrames - framesDone, maxDeckFrames);
+                int32_t deckSamples = deckFrames * numChannels;
+                std::fill(mDeckBuffer.begin(), mDeckBuffer.begin() + deckSamples, 0.0f);
+                mDecks[i]->renderAudio(mDeckBuffer.data(), numChannels, deckFrames);
+
+                MixKernels::mixGain(floatData + (framesDone * numChannels), mDeckBuffer.data(),
+                                    deckSamples,
+                                    mDeckVolumes[i] + (volumeStep * framesDone),
+                                    mDeckVolumes[i] + (volumeStep * (framesDone + deckFrames)));
+                framesDone += deckFrames;
             }
         }
+        mDeckVolumes[i] = volume;
     }
 
     return oboe::DataCallbackResult::Continue;
@@ -57,6 +57,10 @@ private:
     std::vector<std::shared_ptr<Deck>> mDecks;
     
     std::atomic<float> mCrossfader; // 0.0 to 1.0
+    float mDeckVolumes[2] = {0.5f, 0.5f}; // Volumes reached by the last callback, for ramping
+
+    // Each deck is rendered here and then mixed in with its volume
+    std::vector<float> mDeckBuffer;
     int32_t mChannelCount;
     int32_t mSampleRate;
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBOEDJ_SINCINTERPOLATOR_H
+#define OBOEDJ_SINCINTERPOLATOR_H
+
+#include <cstdint>
+#include <math.h>
+#include <vector>
+
+#include <resampler/HyperbolicCosineWindow.h>
+
+namespace oboedj {
+
+/**
+ * Variable ratio windowed-sinc interpolation over a looping buffer of frames.
+ *
+ * This follows resampler::SincResampler: the filter is held as a table of coefficient rows,
+ * one row per fractional phase plus a guard row, and each output frame is the dot product with
+ * the two nearest rows blended by the remaining fraction. Unlike SincResampler the phase comes
+ * from a position accumulator that the caller can move at any speed, so the ratio can change
+ * on every block without recalculating the table.
+ *
+ * The cost per output frame is kNumTaps multiply-adds per channel, whatever the speed.
+ *
+ * The cutoff is fixed at kNormalizedCutoff of the input Nyquist rate. It is not lowered as the
+ * speed goes up, so it only prevents aliasing up to a speed of about 1 / kNormalizedCutoff,
+ * which covers the usual +/-8% pitch range. Faster playback, from the speed slider or from
+ * scratching, folds input between Nyquist / speed and the cutoff back into the audible band.
+ * At 2x that is the input from a quarter of the sample rate up to the cutoff. Playing slower
+ * does not alias.
+ */
+class SincInterpolator {
+public:
+    static constexpr int32_t kNumTaps = 16; // must be even
+    static constexpr int32_t kNumPhases = 256;
+    static constexpr int32_t kMaxChannels = 8;
+    static constexpr float kNormalizedCutoff = 0.90f;
+
+    SincInterpolator() {
+        generateCoefficients();
+    }
+
+    /**
+     * Interpolate numFrames output frames, starting at position and stepping by increment.
+     * Positions wrap around the ends of the input, so it plays as a loop in either direction.
+     *
+     * @param input interleaved input frames
+     * @param numInputFrames number of frames in input
+     * @param channelCount channels in both input and output, up to kMaxChannels
+     * @param position fractional position of the first output frame in the input
+     * @param increment input frames per output frame, negative to play backwards
+     * @param output interleaved output frames, overwritten
+     * @param numFrames number of output frames
+     * @return the position of the next output frame, in the range [0, numInputFrames)
+     */
+    double process(const float* input, int32_t numInputFrames, int32_t channelCount,
+                   double position, double increment, float* output, int32_t numFrames) const {
+        float window[kNumTaps * kMaxChannels];
+        for (int32_t i = 0; i < numFrames; ++i) {
+            position = wrap(position, numInputFrames);
+            const int32_t index = static_cast<int32_t>(position);
+
+            // Find the two coefficient rows on either side of the fractional position.
+            const double tablePhase = (position - index) * kNumPhases;
+            const int32_t row = static_cast<int32_t>(tablePhase);
+            const float fraction = static_cast<float>(tablePhase - row);
+            const float* coefficientsLow = &mCoefficients[row * kNumTaps];
+            const float* coefficientsHigh = coefficientsLow + kNumTaps;
+
+            // The taps cover the input frames around the position.
+            const int32_t firstFrame = index - (kNumTaps / 2) + 1;
+            const float* frames;
+            if (firstFrame >= 0 && firstFrame + kNumTaps <= numInputFrames) {
+                frames = &input[firstFrame * channelCount];
+            } else {
+                gatherWrapped(input, numInputFrames, channelCount, firstFrame, window);
+                frames = window;
+            }
+
+            float* frame = &output[i * channelCount];
+            if (channelCount == 1) {
+                frame[0] = filterChannel(frames, 1, coefficientsLow, coefficientsHigh, fraction);
+            } else if (channelCount == 2) {
+                frame[0] = filterChannel(frames, 2, coefficientsLow, coefficientsHigh, fraction);
+                frame[1] = filterChannel(frames + 1, 2, coefficientsLow, coefficientsHigh,
+                                         fraction);
+            } else {
+                for (int32_t c = 0; c < channelCount; ++c) {
+                    frame[c] = filterChannel(frames + c, channelCount,
+                                             coefficientsLow, coefficientsHigh, fraction);
+                }
+            }
+
+            position += increment;
+        }
+        return wrap(position, numInputFrames);
+    }
+
+    static double wrap(double position, int32_t numFrames) {
+        if (position < 0.0 || position >= numFrames) {
+            position -= floor(position / numFrames) * numFrames;
+            if (position >= numFrames) position = 0.0; // rounding
+        }
+        return position;
+    }
+
+private:
+    static float filterChannel(const float* frames, int32_t stride,
+                               const float* coefficientsLow, const float* coefficientsHigh,
+                               float fraction) {
+        float low = 0.0f;
+        float high = 0.0f;
+        for (int32_t tap = 0; tap < kNumTaps; ++tap) {
+            const float sample = frames[tap * stride];
+            low += sample * coefficientsLow[tap];
+            high += sample * coefficientsHigh[tap];
+        }
+        return low + (fraction * (high - low));
+    }
+
+    static void gatherWrapped(const float* input, int32_t numInputFrames, int32_t channelCount,
+                              int32_t firstFrame, float* window) {
+        for (int32_t tap = 0; tap < kNumTaps; ++tap) {
+            int32_t frameIndex = (firstFrame + tap) % numInputFrames;
+            if (frameIndex < 0) frameIndex += numInputFrames;
+            for (int32_t c = 0; c < channelCount; ++c) {
+                window[tap * channelCount + c] = input[frameIndex * channelCount + c];
+            }
+        }
+    }
+
+    // Row r holds the taps for a position r / kNumPhases of a frame past the input frame
+    // at tap (kNumTaps / 2) - 1. The last row is the guard row for a fraction of 1.0.
+    void generateCoefficients() {
+        RESAMPLER_OUTER_NAMESPACE::resampler::HyperbolicCosineWindow coshWindow;
+        const int32_t numRows = kNumPhases + 1;
+        const double numTapsHalfInverse = 1.0 / (kNumTaps / 2);
+        mCoefficients.resize(numRows * kNumTaps);
+        for (int32_t row = 0; row < numRows; ++row) {
+            const double phase = static_cast<double>(row) / kNumPhases;
+            float* coefficients = &mCoefficients[row * kNumTaps];
+            float gain = 0.0f;
+            for (int32_t tap = 0; tap < kNumTaps; ++tap) {
+                const double tapPhase = tap - (kNumTaps / 2) + 1 - phase;
+                const double radians = tapPhase * M_PI * kNormalizedCutoff;
+                const double sinc = (fabs(radians) < 1.0e-9) ? 1.0 : sin(radians) / radians;
+                coefficients[tap] = static_cast<float>(
+                        sinc * coshWindow(tapPhase * numTapsHalfInverse));
+                gain += coefficients[tap];
+            }
+            // Normalize so that every row has unity gain at DC.
+            for (int32_t tap = 0; tap < kNumTaps; ++tap) {
+                coefficients[tap] /= gain;
+            }
+        }
+    }
+
+    std::vector<float> mCoefficients;
+};
+
+} // namespace oboedj
+
+#endif // OBOEDJ_SINCINTERPOLATOR_H
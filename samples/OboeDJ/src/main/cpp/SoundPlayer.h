@@ -20,18 +20,26 @@
 #include <cstdint>
 #include <memory>
 #include <vector>
+#include <algorithm>
 #include <math.h>
 #include <player/SampleBuffer.h>
 
+#include "MixKernels.h"
+#include "SincInterpolator.h"
+
 namespace oboedj {
 
 /**
- * A player that reads from a pre-loaded PCM buffer with variable speed and linear interpolation.
+ * A player that loops a pre-loaded PCM buffer at variable speed.
+ * The interpolator reads the samples in place, so the buffer must be SampleFormat::Float.
+ * The buffer is resampled a block at a time with a windowed-sinc SincInterpolator, so the cost
+ * per frame does not depend on the speed. The position is kept as a double, which stays exact
+ * to a tiny fraction of a frame for hours of audio.
  */
 class SoundPlayer {
 public:
     SoundPlayer(std::shared_ptr<iolib::SampleBuffer> buffer)
-        : mBuffer(buffer), mPosition(0.0f), mSpeed(1.0f), mIsPlaying(false) {}
+        : mBuffer(buffer), mPosition(0.0), mSpeed(1.0f), mIsPlaying(false) {}
 
     void setSpeed(float speed) {
         mSpeed = speed;
@@ -46,66 +54,69 @@ public:
     }
 
     void reset() {
-        mPosition = 0.0f;
+        mPosition = 0.0;
     }
 
     /**
-     * Render audio into the output buffer with linear interpolation for variable speed.
+     * Render audio into the output buffer at the current speed.
+     * The audio is resampled a block at a time and then mixed in with the MixKernels.
      */
     void renderAudio(float* outBuffer, int32_t numChannels, int32_t numFrames) {
         if (!mIsPlaying || !mBuffer) return;
+        // Compact buffers have no float data to interpolate.
+        if (mBuffer->getSampleFormat() != iolib::SampleFormat::Float) return;
 
         float* data = mBuffer->getSampleData();
         int32_t totalSamples = mBuffer->getNumSamples();
         int32_t bufferChannels = mBuffer->getProperties().channelCount;
 
         if (totalSamples == 0 || data == nullptr) return;
+        if (bufferChannels > SincInterpolator::kMaxChannels) return;
 
         int32_t framesAvailable = (totalSamples / bufferChannels);
+        // Read the speed once so the whole callback plays at one rate.
+        double increment = mSpeed;
+
+        float block[kBlockFrames * SincInterpolator::kMaxChannels];
+        int32_t framesDone = 0;
+        while (framesDone < numFrames) {
+            int32_t framesToDo = std::min(kBlockFrames, numFrames - framesDone);
+            mPosition = mInterpolator.process(data, framesAvailable, bufferChannels,
+                                              mPosition, increment, block, framesToDo);
+            mixBlock(block, bufferChannels, outBuffer + (framesDone * numChannels),
+                     numChannels, framesToDo);
+            framesDone += framesToDo;
+        }
+    }
 
-        for (int32_t i = 0; i < numFrames; ++i) {
-            float floatIndex = mPosition;
-            int32_t index0 = static_cast<int32_t>(floatIndex);
-            int32_t index1 = index0 + 1;
-
-            float frac = floatIndex - index0;
-
-            // Loop or clamp
-            if (index0 >= framesAvailable) {
-                mPosition = 0.0f; // Reset if looped
-                break; // Or handle loop properly
-            }
-            if (index1 >= framesAvailable) {
-                index1 = index0; // Clamp at edge
-            }
-
-            for (int32_t c = 0; c < numChannels; ++c) {
-                // If buffer is mono and output is stereo, duplicate. If same, map.
-                int32_t bufChannel = (c < bufferChannels) ? c : 0;
-                
-                float sample0 = data[index0 * bufferChannels + bufChannel];
-                float sample1 = data[index1 * bufferChannels + bufChannel];
-
-                // Linear interpolation
-                float interpolated = sample0 * (1.0f - frac) + sample1 * frac;
-
-                outBuffer[i * numChannels + c] += interpolated;
-            }
+private:
+    static constexpr int32_t kBlockFrames = 128;
 
-            mPosition += mSpeed;
-            while (mPosition >= framesAvailable) {
-                mPosition -= framesAvailable;
-            }
-            while (mPosition < 0) {
-                mPosition += framesAvailable;
+    /**
+     * Add a block in the buffer's channel layout to the output.
+     */
+    static void mixBlock(const float* block, int32_t bufferChannels,
+                         float* out, int32_t numChannels, int32_t numFrames) {
+        if (bufferChannels == numChannels) {
+            MixKernels::accumulate(out, block, numFrames * numChannels);
+        } else if (bufferChannels == 1 && numChannels == 2) {
+            // If buffer is mono and output is stereo, duplicate.
+            MixKernels::mixMonoToStereo(out, block, numFrames, 1.0f, 1.0f, 1.0f, 1.0f);
+        } else {
+            // Other layouts take the matching channel, or the first one.
+            for (int32_t i = 0; i < numFrames; ++i) {
+                for (int32_t c = 0; c < numChannels; ++c) {
+                    int32_t bufChannel = (c < bufferChannels) ? c : 0;
+                    out[i * numChannels + c] += block[i * bufferChannels + bufChannel];
+                }
             }
         }
     }
 
-private:
     std::shared_ptr<iolib::SampleBuffer> mBuffer;
-    float mPosition; // Fractional position in frames
-    float mSpeed;    // 1.0 = normal, 2.0 = double speed, -1.0 = reverse
+    SincInterpolator mInterpolator;
+    double mPosition; // Fractional position in frames
+    float mSpeed;     // 1.0 = normal, 2.0 = double speed, -1.0 = reverse
     bool mIsPlaying;
 };
 
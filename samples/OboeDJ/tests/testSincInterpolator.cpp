@@ -0,0 +1,146 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test the quality of SincInterpolator at deck speeds
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "SincInterpolator.h"
+
+using namespace oboedj;
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kNumInputFrames = kSampleRate;
+constexpr int32_t kNumOutputFrames = 20000;
+constexpr double kStartPosition = 1000.0;
+
+double sineAt(double frequency, double position) {
+    return sin(2.0 * M_PI * frequency * position / kSampleRate);
+}
+
+std::vector<float> makeSine(double frequency, int32_t channelCount) {
+    std::vector<float> input(kNumInputFrames * channelCount);
+    for (int32_t i = 0; i < kNumInputFrames; i++) {
+        for (int32_t c = 0; c < channelCount; c++) {
+            input[i * channelCount + c] = (float) sineAt(frequency, i);
+        }
+    }
+    return input;
+}
+
+double snrDecibels(double signalPower, double errorPower) {
+    return 10.0 * log10(signalPower / errorPower);
+}
+
+/**
+ * Plays a sine at the given speed and compares it with the ideal sine at the same positions.
+ * The read stays away from the ends of the input, so the loop seam is not measured.
+ */
+double measureSnr(double frequency, double speed, int32_t channelCount = 1) {
+    std::vector<float> input = makeSine(frequency, channelCount);
+    std::vector<float> output(kNumOutputFrames * channelCount);
+    double start = speed < 0.0 ? kNumInputFrames - kStartPosition : kStartPosition;
+
+    SincInterpolator interpolator;
+    interpolator.process(input.data(), kNumInputFrames, channelCount, start, speed,
+                         output.data(), kNumOutputFrames);
+
+    double signalPower = 0.0;
+    double errorPower = 0.0;
+    for (int32_t i = 0; i < kNumOutputFrames; i++) {
+        double expected = sineAt(frequency, start + (i * speed));
+        for (int32_t c = 0; c < channelCount; c++) {
+            double error = output[i * channelCount + c] - expected;
+            signalPower += expected * expected;
+            errorPower += error * error;
+        }
+    }
+    return snrDecibels(signalPower, errorPower);
+}
+
+// The same measurement for two point linear interpolation, as the decks used before.
+double measureLinearSnr(double frequency, double speed) {
+    std::vector<float> input = makeSine(frequency, 1);
+    double signalPower = 0.0;
+    double errorPower = 0.0;
+    for (int32_t i = 0; i < kNumOutputFrames; i++) {
+        double position = kStartPosition + (i * speed);
+        int32_t index = (int32_t) position;
+        double fraction = position - index;
+        double actual = input[index] + ((input[index + 1] - input[index]) * fraction);
+        double expected = sineAt(frequency, position);
+        signalPower += expected * expected;
+        errorPower += (actual - expected) * (actual - expected);
+    }
+    return snrDecibels(signalPower, errorPower);
+}
+
+} // namespace
+
+/**
+ * The figure quoted for the interpolator: a 5 kHz sine at 1.08x measured 78 dB, against
+ * 28 dB for linear interpolation.
+ */
+TEST(TestSincInterpolator, SnrOf5kHzAt108Percent) {
+    constexpr double kFrequency = 5000.0;
+    constexpr double kSpeed = 1.08;
+    double snr = measureSnr(kFrequency, kSpeed);
+    double linearSnr = measureLinearSnr(kFrequency, kSpeed);
+    EXPECT_GT(snr, 78.0);
+    EXPECT_LT(linearSnr, 29.0);
+}
+
+TEST(TestSincInterpolator, PitchRangeKeepsSnr) {
+    // The pitch fader range, forwards and backwards.
+    const double speeds[] = { 0.92, 0.96, 1.0, 1.04, 1.08, -0.92, -1.0, -1.08 };
+    const double frequencies[] = { 1000.0, 5000.0, 10000.0 };
+    for (double speed : speeds) {
+        for (double frequency : frequencies) {
+            EXPECT_GT(measureSnr(frequency, speed), 67.0)
+                    << frequency << " Hz at " << speed << "x";
+        }
+    }
+}
+
+TEST(TestSincInterpolator, StereoMatchesMono) {
+    EXPECT_NEAR(measureSnr(5000.0, 1.08, 1), measureSnr(5000.0, 1.08, 2), 0.01);
+    EXPECT_NEAR(measureSnr(5000.0, 1.08, 1), measureSnr(5000.0, 1.08, 3), 0.01);
+}
+
+TEST(TestSincInterpolator, WrapsAroundTheLoop) {
+    // A sine with a whole number of cycles in the buffer loops without a seam.
+    constexpr double kFrequency = 1000.0;
+    std::vector<float> input = makeSine(kFrequency, 1);
+    constexpr int32_t kNumFrames = 64;
+    std::vector<float> output(kNumFrames);
+
+    SincInterpolator interpolator;
+    double start = kNumInputFrames - (kNumFrames / 2) + 0.25;
+    double end = interpolator.process(input.data(), kNumInputFrames, 1, start, 1.0,
+                                      output.data(), kNumFrames);
+    EXPECT_NEAR(start + kNumFrames - kNumInputFrames, end, 1.0e-9);
+    for (int32_t i = 0; i < kNumFrames; i++) {
+        EXPECT_NEAR(sineAt(kFrequency, start + i), output[i], 1.0e-3) << "frame " << i;
+    }
+}
@@ -68,7 +68,9 @@ void Game::tap(int64_t eventTimeAsUptime) {
     if (mGameState != GameState::Playing){
         LOGW("Game not in playing state, ignoring tap event");
     } else {
-        mClap->setPlaying(true);
+        // Clap at the start of the next callback. Going through the sequencer means the
+        // audio thread is the only one that touches the players.
+        mSequencer.schedule(mSequencer.getCurrentFrame(), kClapEvent);
 
         int64_t nextClapWindowTimeMs;
         if (mClapWindows.pop(nextClapWindowTimeMs)){
@@ -117,22 +119,18 @@ DataCallbackResult Game::onAudioReady(AudioStream *oboeStream, void *audioData,
 
     auto *outputBuffer = static_cast<float *>(audioData);
 
-    int64_t nextClapEventMs;
-
-    for (int i = 0; i < numFrames; ++i) {
-
-        mSongPositionMs = convertFramesToMillis(
-                mCurrentFrame,
-                mAudioStream->getSampleRate());
-
-        if (mClapEvents.peek(nextClapEventMs) && mSongPositionMs >= nextClapEventMs){
-            mClap->setPlaying(true);
-            mClapEvents.pop(nextClapEventMs);
-        }
-        mMixer.renderAudio(outputBuffer+(oboeStream->getChannelCount()*i), 1);
-        mCurrentFrame++;
-    }
-
+    // Render in blocks, split at the frames where claps start.
+    mSequencer.process(outputBuffer, numFrames, oboeStream->getChannelCount(),
+            [this](float *buffer, int32_t frames) {
+                mMixer.renderAudio(buffer, frames);
+            },
+            [this](int32_t eventId) {
+                if (eventId == kClapEvent) mClap->setPlaying(true);
+            });
+
+    mSongPositionMs = convertFramesToMillis(
+            mSequencer.getCurrentFrame(),
+            oboeStream->getSampleRate());
     mLastUpdateTime = nowUptimeMillis();
 
     return DataCallbackResult::Continue;
@@ -143,7 +141,7 @@ void Game::onErrorAfterClose(AudioStream *audioStream, Result error) {
         mGameState = GameState::Loading;
         mAudioStream.reset();
         mMixer.removeAllTracks();
-        mCurrentFrame = 0;
+        mSequencer.reset();
         mSongPositionMs = 0;
         mLastUpdateTime = 0;
         start();
@@ -236,6 +234,8 @@ bool Game::setupAudioSources() {
 
 void Game::scheduleSongEvents() {
 
-    for (auto t : kClapEvents) mClapEvents.push(t);
+    for (auto t : kClapEvents) {
+        mSequencer.schedule(convertMillisToFrames(t, mAudioStream->getSampleRate()), kClapEvent);
+    }
     for (auto t : kClapWindows) mClapWindows.push(t);
 }
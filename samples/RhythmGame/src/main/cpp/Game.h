@@ -26,6 +26,7 @@
 
 #include "audio/Player.h"
 #include "audio/AAssetDataSource.h"
+#include "audio/Sequencer.h"
 #include "ui/OpenGLFunctions.h"
 #include "utils/LockFreeQueue.h"
 #include "utils/UtilityFunctions.h"
@@ -65,8 +66,7 @@ private:
     std::unique_ptr<Player> mBackingTrack;
     Mixer mMixer;
 
-    LockFreeQueue<int64_t, kMaxQueueItems> mClapEvents;
-    std::atomic<int64_t> mCurrentFrame { 0 };
+    Sequencer<kMaxSequencerEvents> mSequencer;
     std::atomic<int64_t> mSongPositionMs { 0 };
     LockFreeQueue<int64_t, kMaxQueueItems> mClapWindows;
     LockFreeQueue<TapResult, kMaxQueueItems> mUiEvents;
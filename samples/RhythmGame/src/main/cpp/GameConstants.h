@@ -21,6 +21,10 @@
 
 constexpr int kBufferSizeInBursts = 2; // Use 2 bursts as the buffer size (double buffer)
 constexpr int kMaxQueueItems = 4; // Must be power of 2
+constexpr int kMaxSequencerEvents = 64; // Must be power of 2
+
+// Events played by the Sequencer
+constexpr int32_t kClapEvent = 0;
 
 // Colors for game states and visual feedback for taps
 constexpr ScreenColor kPlayingColor = GREY;
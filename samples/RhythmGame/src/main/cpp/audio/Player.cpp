@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include "Player.h"
 #include "utils/logging.h"
 
@@ -33,18 +36,26 @@ void Player::renderAudio(float *targetData, int32_t numFrames){
             mIsPlaying = false;
         }
 
-        for (int i = 0; i < framesToRenderFromData; ++i) {
-            for (int j = 0; j < properties.channelCount; ++j) {
-                targetData[(i*properties.channelCount)+j] = data[(mReadFrameIndex*properties.channelCount)+j];
-            }
+        // Copy contiguous runs of frames, splitting where the play head wraps around.
+        int64_t framesRendered = 0;
+        while (framesRendered < framesToRenderFromData) {
+            int64_t framesToCopy = std::min(framesToRenderFromData - framesRendered,
+                                            totalSourceFrames - mReadFrameIndex);
+            if (framesToCopy <= 0) break;
+            memcpy(&targetData[framesRendered * properties.channelCount],
+                   &data[mReadFrameIndex * properties.channelCount],
+                   framesToCopy * properties.channelCount * sizeof(float));
+            framesRendered += framesToCopy;
 
             // Increment and handle wraparound
-            if (++mReadFrameIndex >= totalSourceFrames) mReadFrameIndex = 0;
+            mReadFrameIndex += framesToCopy;
+            if (mReadFrameIndex >= totalSourceFrames) mReadFrameIndex = 0;
         }
 
         if (framesToRenderFromData < numFrames){
             // fill the rest of the buffer with silence
-            renderSilence(&targetData[framesToRenderFromData], numFrames * properties.channelCount);
+            renderSilence(&targetData[framesToRenderFromData * properties.channelCount],
+                          (numFrames - framesToRenderFromData) * properties.channelCount);
         }
 
     } else {
@@ -53,7 +64,5 @@ void Player::renderAudio(float *targetData, int32_t numFrames){
 }
 
 void Player::renderSilence(float *start, int32_t numSamples){
-    for (int i = 0; i < numSamples; ++i) {
-        start[i] = 0;
-    }
+    memset(start, 0, numSamples * sizeof(float));
 }
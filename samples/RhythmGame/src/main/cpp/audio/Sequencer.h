@@ -0,0 +1,152 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RHYTHMGAME_SEQUENCER_H
+#define RHYTHMGAME_SEQUENCER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "utils/LockFreeQueue.h"
+
+/**
+ * Plays events at exact frames of an audio stream while still rendering in blocks.
+ *
+ * Events are stamped with a frame position on the stream's timeline and scheduled from any
+ * single thread. Each callback passes its buffer to process(), which splits it into sub-blocks
+ * at the event boundaries. It renders each sub-block with one call to the render function and
+ * fires the events between them, so a mixer is called once per event instead of once per frame.
+ *
+ * Example code:
+ *
+ * Sequencer<64> sequencer;
+ * sequencer.schedule(48000, kClapEvent); // one second in at 48000 Hz
+ *
+ * // In onAudioReady()
+ * sequencer.process(audioData, numFrames, channelCount,
+ *         [&](float *buffer, int32_t frames) { mixer.renderAudio(buffer, frames); },
+ *         [&](int32_t eventId) { clap->setPlaying(true); });
+ *
+ * @tparam CAPACITY - Maximum number of events waiting to be played. Must be a power of 2.
+ */
+template <uint32_t CAPACITY>
+class Sequencer {
+public:
+
+    struct Event {
+        int64_t frame;
+        int32_t id;
+    };
+
+    /**
+     * Schedule an event. Events may be scheduled in any order. An event whose frame has already
+     * been rendered is played at the start of the next callback.
+     *
+     * @param frame - Frame position to play the event at, see getCurrentFrame()
+     * @param id - Passed to the event function of process()
+     * @return true if the event was scheduled, false if the queue was full
+     */
+    bool schedule(int64_t frame, int32_t id) {
+        return mIncoming.push(Event { frame, id });
+    }
+
+    /**
+     * Render a callback's worth of audio. Call this from the audio callback only.
+     *
+     * @param audioData - Interleaved output for numFrames frames
+     * @param numFrames - Number of frames to render
+     * @param channelCount - Number of channels in audioData
+     * @param render - Called as render(float *buffer, int32_t numFrames) for each sub-block
+     * @param onEvent - Called as onEvent(int32_t id) for each event, between the sub-blocks
+     */
+    template <typename RenderFunction, typename EventFunction>
+    void process(float *audioData, int32_t numFrames, int32_t channelCount,
+                 RenderFunction &&render, EventFunction &&onEvent) {
+
+        collectEvents();
+
+        const int64_t startFrame = mCurrentFrame;
+        const int64_t endFrame = startFrame + numFrames;
+        int32_t framesDone = 0;
+
+        while (mNumPending > 0 && mPending[0].frame < endFrame) {
+            Event event = mPending[0];
+            removeFirstPending();
+
+            int32_t eventOffset = event.frame > startFrame + framesDone
+                    ? static_cast<int32_t>(event.frame - startFrame) : framesDone;
+            if (eventOffset > framesDone) {
+                render(audioData + (framesDone * channelCount), eventOffset - framesDone);
+                framesDone = eventOffset;
+            }
+            onEvent(event.id);
+        }
+
+        if (framesDone < numFrames) {
+            render(audioData + (framesDone * channelCount), numFrames - framesDone);
+        }
+        mCurrentFrame = endFrame;
+    }
+
+    /**
+     * @return the frame position that the next callback will start at
+     */
+    int64_t getCurrentFrame() const { return mCurrentFrame; }
+
+    /**
+     * Drop all events and go back to frame 0. Only call this while the stream is not running.
+     */
+    void reset() {
+        Event event;
+        while (mIncoming.pop(event)) {}
+        mNumPending = 0;
+        mCurrentFrame = 0;
+    }
+
+private:
+
+    // Move scheduled events into the pending list, which is kept sorted by frame. Events with
+    // the same frame stay in the order they were scheduled.
+    void collectEvents() {
+        Event event;
+        while (mNumPending < CAPACITY && mIncoming.pop(event)) {
+            uint32_t index = mNumPending;
+            while (index > 0 && mPending[index - 1].frame > event.frame) {
+                mPending[index] = mPending[index - 1];
+                index--;
+            }
+            mPending[index] = event;
+            mNumPending++;
+        }
+    }
+
+    void removeFirstPending() {
+        mNumPending--;
+        for (uint32_t i = 0; i < mNumPending; ++i) {
+            mPending[i] = mPending[i + 1];
+        }
+    }
+
+    LockFreeQueue<Event, CAPACITY> mIncoming;
+
+    // Only used by the audio callback
+    Event mPending[CAPACITY];
+    uint32_t mNumPending = 0;
+
+    std::atomic<int64_t> mCurrentFrame { 0 };
+};
+
+#endif //RHYTHMGAME_SEQUENCER_H
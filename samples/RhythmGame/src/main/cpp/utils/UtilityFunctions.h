@@ -34,6 +34,10 @@ constexpr int64_t convertFramesToMillis(const int64_t frames, const int sampleRa
     return static_cast<int64_t>((static_cast<double>(frames)/ sampleRate) * kMillisecondsInSecond);
 }
 
+constexpr int64_t convertMillisToFrames(const int64_t millis, const int sampleRate){
+    return (millis * sampleRate) / kMillisecondsInSecond;
+}
+
 TapResult getTapResult(int64_t tapTimeInMillis, int64_t tapWindowInMillis);
 
 void renderEvent(TapResult r);
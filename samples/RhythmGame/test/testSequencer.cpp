@@ -0,0 +1,162 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "audio/Sequencer.h"
+
+/**
+ * Tests
+ * =====
+ *
+ * RENDERING:
+ *  - no events renders the whole block in one call
+ *  - an event splits the block at its frame
+ *  - events in later blocks wait for their block
+ *  - an event at the first frame of a block does not render an empty sub-block
+ *  - a late event plays at the start of the next block
+ *
+ * ORDERING:
+ *  - events scheduled out of order play in frame order
+ *  - events on the same frame play in the order scheduled
+ *
+ * QUEUE:
+ *  - schedule returns false when full
+ *  - reset drops events and rewinds the frame position
+ */
+
+constexpr int kCapacity = 8;
+constexpr int32_t kChannelCount = 2;
+constexpr int32_t kFramesPerBlock = 64;
+
+class TestSequencer : public ::testing::Test {
+
+public:
+
+    struct Call {
+        bool isEvent;
+        int32_t offset;     // sub-block start or event position within the block
+        int32_t value;      // sub-block length or event id
+    };
+
+    // Process one block and record what the sequencer asked for.
+    std::vector<Call> processBlock() {
+        std::vector<Call> calls;
+        int32_t position = 0;
+        sequencer.process(buffer, kFramesPerBlock, kChannelCount,
+                [&](float *data, int32_t numFrames) {
+                    int32_t offset = static_cast<int32_t>(data - buffer) / kChannelCount;
+                    EXPECT_EQ(offset, position);
+                    calls.push_back({false, offset, numFrames});
+                    position += numFrames;
+                },
+                [&](int32_t id) {
+                    calls.push_back({true, position, id});
+                });
+        EXPECT_EQ(position, kFramesPerBlock);
+        return calls;
+    }
+
+    float buffer[kFramesPerBlock * kChannelCount];
+    Sequencer<kCapacity> sequencer;
+};
+
+TEST_F(TestSequencer, NoEventsRendersWholeBlock){
+    std::vector<Call> calls = processBlock();
+    ASSERT_EQ(calls.size(), 1);
+    ASSERT_EQ(calls[0].value, kFramesPerBlock);
+    ASSERT_EQ(sequencer.getCurrentFrame(), kFramesPerBlock);
+}
+
+TEST_F(TestSequencer, EventSplitsBlock){
+    sequencer.schedule(20, 7);
+    std::vector<Call> calls = processBlock();
+    ASSERT_EQ(calls.size(), 3);
+    ASSERT_EQ(calls[0].value, 20);
+    ASSERT_TRUE(calls[1].isEvent);
+    ASSERT_EQ(calls[1].offset, 20);
+    ASSERT_EQ(calls[1].value, 7);
+    ASSERT_EQ(calls[2].value, kFramesPerBlock - 20);
+}
+
+TEST_F(TestSequencer, EventWaitsForItsBlock){
+    sequencer.schedule(kFramesPerBlock * 2 + 5, 1);
+    ASSERT_EQ(processBlock().size(), 1);
+    ASSERT_EQ(processBlock().size(), 1);
+    std::vector<Call> calls = processBlock();
+    ASSERT_EQ(calls.size(), 3);
+    ASSERT_EQ(calls[1].offset, 5);
+}
+
+TEST_F(TestSequencer, EventOnFirstFrameHasNoEmptySubBlock){
+    sequencer.schedule(kFramesPerBlock, 1);
+    processBlock();
+    std::vector<Call> calls = processBlock();
+    ASSERT_EQ(calls.size(), 2);
+    ASSERT_TRUE(calls[0].isEvent);
+    ASSERT_EQ(calls[1].value, kFramesPerBlock);
+}
+
+TEST_F(TestSequencer, LateEventPlaysAtStartOfBlock){
+    processBlock();
+    processBlock();
+    sequencer.schedule(10, 3);
+    std::vector<Call> calls = processBlock();
+    ASSERT_EQ(calls.size(), 2);
+    ASSERT_TRUE(calls[0].isEvent);
+    ASSERT_EQ(calls[0].offset, 0);
+}
+
+TEST_F(TestSequencer, EventsPlayInFrameOrder){
+    sequencer.schedule(50, 2);
+    sequencer.schedule(10, 1);
+    sequencer.schedule(30, 3);
+    std::vector<Call> calls = processBlock();
+    std::vector<int32_t> ids;
+    for (const Call &call : calls) {
+        if (call.isEvent) ids.push_back(call.value);
+    }
+    ASSERT_EQ(ids, (std::vector<int32_t> { 1, 3, 2 }));
+    ASSERT_EQ(calls.size(), 7);
+}
+
+TEST_F(TestSequencer, SameFrameKeepsScheduleOrder){
+    sequencer.schedule(40, 1);
+    sequencer.schedule(40, 2);
+    sequencer.schedule(40, 3);
+    std::vector<Call> calls = processBlock();
+    ASSERT_EQ(calls.size(), 5);
+    ASSERT_EQ(calls[1].value, 1);
+    ASSERT_EQ(calls[2].value, 2);
+    ASSERT_EQ(calls[3].value, 3);
+}
+
+TEST_F(TestSequencer, ScheduleWhenFullReturnsFalse){
+    for (int i = 0; i < kCapacity; ++i) {
+        ASSERT_TRUE(sequencer.schedule(1000 + i, i));
+    }
+    ASSERT_FALSE(sequencer.schedule(2000, 0));
+}
+
+TEST_F(TestSequencer, ResetDropsEvents){
+    sequencer.schedule(10, 1);
+    processBlock();
+    sequencer.schedule(kFramesPerBlock + 10, 2);
+    sequencer.reset();
+    ASSERT_EQ(sequencer.getCurrentFrame(), 0);
+    ASSERT_EQ(processBlock().size(), 1);
+}
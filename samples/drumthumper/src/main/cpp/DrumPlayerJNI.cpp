@@ -20,13 +20,12 @@
 #include <fcntl.h>
 #include <unistd.h>
 
-#include <android/log.h>
+#include <memory>
+#include <vector>
 
-// parselib includes
-#include <stream/MemInputStream.h>
-#include <wav/WavStreamReader.h>
+#include <android/log.h>
 
-#include <player/OneShotSampleSource.h>
+#include <player/SampleBankLoader.h>
 #include <player/SimpleMultiPlayer.h>
 
 static const char* TAG = "DrumPlayerJNI";
@@ -37,16 +36,19 @@ extern "C" {
 #endif
 
 using namespace iolib;
-using namespace parselib;
 
 static SimpleMultiPlayer sDTPlayer;
 
+// Hits that can ring at once. Fast rolls steal the oldest hit.
+static constexpr int32_t kMaxPolyphony = 16;
+
 /**
  * Native (JNI) implementation of DrumPlayer.setupAudioStreamNative()
  */
 JNIEXPORT void JNICALL Java_com_plausiblesoftware_drumthumper_DrumPlayer_setupAudioStreamNative(
         JNIEnv* env, jobject, jint numChannels) {
     __android_log_print(ANDROID_LOG_INFO, TAG, "%s", "init()");
+    sDTPlayer.setMaxPolyphony(kMaxPolyphony);
     sDTPlayer.setupAudioStream(numChannels);
 }
 
@@ -67,32 +69,29 @@ JNIEXPORT void JNICALL Java_com_plausiblesoftware_drumthumper_DrumPlayer_teardow
 }
 
 /**
- * Native (JNI) implementation of DrumPlayer.allocSampleDataNative()
+ * Native (JNI) implementation of DrumPlayer.loadWavAssetsNative()
  */
-/**
- * Native (JNI) implementation of DrumPlayer.loadWavAssetNative()
- */
-JNIEXPORT void JNICALL Java_com_plausiblesoftware_drumthumper_DrumPlayer_loadWavAssetNative(
-        JNIEnv* env, jobject, jbyteArray bytearray, jint index, jfloat pan) {
-    int len = env->GetArrayLength (bytearray);
-
-    unsigned char* buf = new unsigned char[len];
-    env->GetByteArrayRegion (bytearray, 0, len, reinterpret_cast<jbyte*>(buf));
-
-    MemInputStream stream(buf, len);
-
-    WavStreamReader reader(&stream);
-    reader.parse();
-
-    reader.getNumChannels();
-
-    SampleBuffer* sampleBuffer = new SampleBuffer();
-    sampleBuffer->loadSampleData(&reader);
+JNIEXPORT void JNICALL Java_com_plausiblesoftware_drumthumper_DrumPlayer_loadWavAssetsNative(
+        JNIEnv* env, jobject, jobjectArray wavBytes, jfloatArray pans) {
+    const jsize numFiles = env->GetArrayLength(wavBytes);
+    std::vector<std::unique_ptr<unsigned char[]>> fileData;
+    SampleBankLoader loader;
+    for (jsize index = 0; index < numFiles; index++) {
+        auto bytearray = static_cast<jbyteArray>(env->GetObjectArrayElement(wavBytes, index));
+        int len = env->GetArrayLength(bytearray);
+        fileData.emplace_back(new unsigned char[len]);
+        env->GetByteArrayRegion(bytearray, 0, len,
+                                reinterpret_cast<jbyte*>(fileData.back().get()));
+        env->DeleteLocalRef(bytearray);
+        loader.addFile(fileData.back().get(), len);
+    }
 
-    OneShotSampleSource* source = new OneShotSampleSource(sampleBuffer, pan);
-    sDTPlayer.addSampleSource(source, sampleBuffer);
+    std::vector<float> panValues(env->GetArrayLength(pans));
+    env->GetFloatArrayRegion(pans, 0, panValues.size(), panValues.data());
 
-    delete[] buf;
+    int32_t numLoaded = sDTPlayer.addSampleBank(loader, panValues);
+    __android_log_print(ANDROID_LOG_INFO, TAG, "loaded %d of %d drum samples", numLoaded,
+                        numFiles);
 }
 
 /**
@@ -134,6 +133,8 @@ JNIEXPORT void JNICALL Java_com_plausiblesoftware_drumthumper_DrumPlayer_clearOu
  * Native (JNI) implementation of DrumPlayer.restartStream()
  */
 JNIEXPORT void JNICALL Java_com_plausiblesoftware_drumthumper_DrumPlayer_restartStream(JNIEnv*, jobject) {
+    // With the old stream closed, resetAll() stops the sources before the new one starts.
+    sDTPlayer.teardownAudioStream();
     sDTPlayer.resetAll();
     if (sDTPlayer.openStream() && sDTPlayer.startStream()){
         __android_log_print(ANDROID_LOG_INFO, TAG, "openStream successful");
@@ -63,31 +63,33 @@ class DrumPlayer {
 
     // asset-based samples
     fun loadWavAssets(assetMgr: AssetManager) {
-        loadWavAsset(assetMgr, "KickDrum.wav", BASSDRUM, PAN_BASSDRUM)
-        loadWavAsset(assetMgr, "SnareDrum.wav", SNAREDRUM, PAN_SNAREDRUM)
-        loadWavAsset(assetMgr, "CrashCymbal.wav", CRASHCYMBAL, PAN_CRASHCYMBAL)
-        loadWavAsset(assetMgr, "RideCymbal.wav", RIDECYMBAL, PAN_RIDECYMBAL)
-        loadWavAsset(assetMgr, "MidTom.wav", MIDTOM, PAN_MIDTOM)
-        loadWavAsset(assetMgr, "LowTom.wav", LOWTOM, PAN_LOWTOM)
-        loadWavAsset(assetMgr, "HiHat_Open.wav", HIHATOPEN, PAN_HIHATOPEN)
-        loadWavAsset(assetMgr, "HiHat_Closed.wav", HIHATCLOSED, PAN_HIHATCLOSED)
+        // In the order of the sample buffer IDs, so drum i is file i.
+        val assetNames = arrayOf("KickDrum.wav", "SnareDrum.wav", "CrashCymbal.wav",
+                "RideCymbal.wav", "MidTom.wav", "LowTom.wav", "HiHat_Open.wav", "HiHat_Closed.wav")
+        val pans = floatArrayOf(PAN_BASSDRUM, PAN_SNAREDRUM, PAN_CRASHCYMBAL, PAN_RIDECYMBAL,
+                PAN_MIDTOM, PAN_LOWTOM, PAN_HIHATOPEN, PAN_HIHATCLOSED)
+        val wavBytes = Array(assetNames.size) { index -> readWavAsset(assetMgr, assetNames[index]) }
+        // Decoded and resampled on several threads.
+        loadWavAssetsNative(wavBytes, pans)
     }
 
     fun unloadWavAssets() {
         unloadWavAssetsNative()
     }
 
-    private fun loadWavAsset(assetMgr: AssetManager, assetName: String, index: Int, pan: Float) {
+    private fun readWavAsset(assetMgr: AssetManager, assetName: String): ByteArray {
         try {
             val assetFD = assetMgr.openFd(assetName)
             val dataStream = assetFD.createInputStream()
             val dataLen = assetFD.getLength().toInt()
             val dataBytes = ByteArray(dataLen)
             dataStream.read(dataBytes, 0, dataLen)
-            loadWavAssetNative(dataBytes, index, pan)
             assetFD.close()
+            return dataBytes
         } catch (ex: IOException) {
             Log.i(TAG, "IOException$ex")
+            // Not a WAV file, so the native side keeps a silent pad in its place.
+            return ByteArray(0)
         }
     }
 
@@ -95,7 +97,7 @@ class DrumPlayer {
     private external fun startAudioStreamNative()
     private external fun teardownAudioStreamNative()
 
-    private external fun loadWavAssetNative(wavBytes: ByteArray, index: Int, pan: Float)
+    private external fun loadWavAssetsNative(wavBytes: Array<ByteArray>, pans: FloatArray)
     private external fun unloadWavAssetsNative()
 
     external fun trigger(drumIndex: Int)
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android/log.h>
+
+#include "CommandQueue.h"
+
+static const char* TAG = "CommandQueue";
+
+namespace iolib {
+
+CommandQueue::CommandQueue(int32_t capacity)
+  : mCapacity(capacity),
+    mTimedCapacity(capacity - capacity / kImmediateReserveDivisor),
+    mFifo(sizeof(PlayerCommand), capacity),
+    mNumQueued(0),
+    mPending(new PlayerCommand[capacity]),
+    mNumPending(0) {}
+
+CommandQueue::~CommandQueue() {
+    delete[] mPending;
+}
+
+bool CommandQueue::post(const PlayerCommand& command) {
+    int32_t limit = command.frame == PlayerCommand::kImmediate ? mCapacity : mTimedCapacity;
+    // Count the command before it can be popped, so the count never goes below zero.
+    if (++mNumQueued > limit || mFifo.write(&command, 1) != 1) {
+        mNumQueued--;
+        __android_log_print(ANDROID_LOG_WARN, TAG, "post() queue full, dropped command %d",
+                            (int) command.type);
+        return false;
+    }
+    return true;
+}
+
+void CommandQueue::clear() {
+    PlayerCommand command;
+    int32_t numDropped = mNumPending;
+    while (mFifo.read(&command, 1) == 1) {
+        numDropped++;
+    }
+    mNumPending = 0;
+    mNumQueued -= numDropped;
+}
+
+void CommandQueue::collect() {
+    // post() never lets more than mCapacity commands in, so the list is only full when
+    // the FIFO is empty.
+    PlayerCommand command;
+    while (mNumPending < mCapacity && mFifo.read(&command, 1) == 1) {
+        // Insert after any command with the same frame so the posting order is kept.
+        int32_t index = mNumPending;
+        while (index > 0 && mPending[index - 1].frame > command.frame) {
+            mPending[index] = mPending[index - 1];
+            index--;
+        }
+        mPending[index] = command;
+        mNumPending++;
+    }
+}
+
+bool CommandQueue::popDue(int64_t endFrame, PlayerCommand& command) {
+    if (mNumPending == 0 || mPending[0].frame >= endFrame) {
+        return false;
+    }
+    command = mPending[0];
+    mNumPending--;
+    mNumQueued--;
+    for (int32_t index = 0; index < mNumPending; index++) {
+        mPending[index] = mPending[index + 1];
+    }
+    return true;
+}
+
+} // namespace iolib
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_COMMANDQUEUE_
+#define _PLAYER_COMMANDQUEUE_
+
+#include <atomic>
+#include <cstdint>
+
+#include <oboe/FifoBuffer.h>
+
+namespace iolib {
+
+/**
+ * A request to change one source of a player at a given frame of its output.
+ */
+struct PlayerCommand {
+    enum class Type : int32_t {
+        Trigger,        // start the source from the beginning
+        Stop,           // stop the source
+        Pause,          // stop the source but keep its place
+        Resume,         // play the source on from where it was paused
+        StopAll,        // stop every source, index is ignored
+        SetGain,        // value is the gain
+        SetPan,         // value is the pan
+        SetLoopMode,    // value is non-zero for loop mode
+    };
+
+    // Apply at the start of the next callback
+    static constexpr int64_t kImmediate = -1;
+
+    Type type;
+    int32_t index;
+    float value;
+    int64_t frame;  // in frames since the player started rendering, or kImmediate
+};
+
+/**
+ * Carries timestamped PlayerCommands from one producer thread (UI, JNI or a sequencer)
+ * to the audio callback without locks.
+ *
+ * Commands are posted through an oboe::FifoBuffer. The callback collects them into a
+ * list sorted by frame, then takes those that fall in the block it is rendering with
+ * popDue(). Commands for later blocks wait in the list. Commands whose frame has passed
+ * are applied at the start of the block.
+ *
+ * Timed commands may only fill the queue to kImmediateReserve short of its capacity, so a
+ * long sequence posted ahead of time never locks out a kImmediate command from the UI.
+ */
+class CommandQueue {
+public:
+    static constexpr int32_t kDefaultCapacity = 256;
+    // Room kept for kImmediate commands, as a fraction of the capacity
+    static constexpr int32_t kImmediateReserveDivisor = 8;
+
+    CommandQueue(int32_t capacity = kDefaultCapacity);
+    ~CommandQueue();
+
+    /**
+     * Producer thread only.
+     * @return false if the queue is full and the command was dropped
+     */
+    bool post(const PlayerCommand& command);
+
+    /**
+     * Drops every posted and pending command.
+     * Call from the consumer side only, see collect().
+     */
+    void clear();
+
+    /**
+     * Moves posted commands into the sorted pending list.
+     * Audio thread only, call once at the start of each callback.
+     */
+    void collect();
+
+    /**
+     * Removes the earliest pending command if it is due before endFrame.
+     * Audio thread only.
+     * @return true if a command was returned
+     */
+    bool popDue(int64_t endFrame, PlayerCommand& command);
+
+    /** Audio thread only. */
+    int32_t getNumPending() const { return mNumPending; }
+
+private:
+    const int32_t mCapacity;
+    const int32_t mTimedCapacity;
+    oboe::FifoBuffer mFifo;
+    // Posted and not yet popped, so the pending list always has room for the FIFO
+    std::atomic<int32_t> mNumQueued;
+
+    // Sorted by frame, commands with the same frame in the order posted. Audio thread only.
+    PlayerCommand* mPending;
+    int32_t mNumPending;
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_COMMANDQUEUE_
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "DiskStreamer.h"
+
+namespace iolib {
+
+DiskStreamer::DiskStreamer(int32_t periodMillis)
+        : mPeriodMillis(periodMillis), mRunning(false) {}
+
+DiskStreamer::~DiskStreamer() {
+    stop();
+}
+
+void DiskStreamer::addSource(StreamingSampleSource *source) {
+    std::lock_guard<std::mutex> lock(mLock);
+    mSources.push_back(source);
+    if (!mRunning) {
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+        mRunning = true;
+        mThread = std::thread(&DiskStreamer::run, this);
+    } else {
+        mWakeup.notify_one();
+    }
+}
+
+void DiskStreamer::removeSource(StreamingSampleSource *source) {
+    std::unique_lock<std::mutex> lock(mLock);
+    mSources.erase(std::remove(mSources.begin(), mSources.end(), source), mSources.end());
+    mFillDone.wait(lock, [this, source] { return mFillingSource != source; });
+}
+
+void DiskStreamer::removeAllSources() {
+    std::unique_lock<std::mutex> lock(mLock);
+    mSources.clear();
+    mFillDone.wait(lock, [this] { return mFillingSource == nullptr; });
+}
+
+void DiskStreamer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mRunning = false;
+    }
+    mWakeup.notify_one();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+void DiskStreamer::run() {
+    std::unique_lock<std::mutex> lock(mLock);
+    while (mRunning) {
+        // One block per source per pass, so a long file cannot starve the others.
+        bool didWork = true;
+        while (didWork && mRunning) {
+            didWork = false;
+            // Index the list because it may change while the lock is released.
+            // A source removed meanwhile can only shift the next one to the next pass.
+            for (size_t index = 0; index < mSources.size() && mRunning; index++) {
+                mFillingSource = mSources[index];
+                lock.unlock();
+                bool filled = mFillingSource->fillRing(); // reads the disk
+                lock.lock();
+                mFillingSource = nullptr;
+                mFillDone.notify_all();
+                didWork |= filled;
+            }
+        }
+        mWakeup.wait_for(lock, std::chrono::milliseconds(mPeriodMillis));
+    }
+}
+
+} // namespace iolib
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_DISKSTREAMER_
+#define _PLAYER_DISKSTREAMER_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "StreamingSampleSource.h"
+
+namespace iolib {
+
+/**
+ * Runs a background thread that keeps the rings of some number of
+ * StreamingSampleSources full. The sources are serviced a block at a time in turn,
+ * then the thread sleeps for the polling period.
+ *
+ * The audio callback never talks to this thread, it only looks at the rings.
+ * The lock only guards the list of sources. It is released while a source reads the disk,
+ * so adding or removing a source only waits for the read of that one source.
+ */
+class DiskStreamer {
+public:
+    static constexpr int32_t kDefaultPeriodMillis = 5;
+
+    DiskStreamer(int32_t periodMillis = kDefaultPeriodMillis);
+    ~DiskStreamer();
+
+    /**
+     * Starts servicing the source. The thread is started with the first source.
+     * The DiskStreamer does not take ownership.
+     */
+    void addSource(StreamingSampleSource *source);
+
+    /**
+     * Stops servicing the source. If the thread is filling it, this waits for that fill
+     * to finish. When this returns the source may be deleted.
+     */
+    void removeSource(StreamingSampleSource *source);
+    void removeAllSources();
+
+    /** Stops and joins the thread. */
+    void stop();
+
+private:
+    void run();
+
+    const int32_t mPeriodMillis;
+
+    std::mutex mLock;
+    std::condition_variable mWakeup;
+    std::condition_variable mFillDone;
+    std::vector<StreamingSampleSource*> mSources;
+    StreamingSampleSource *mFillingSource = nullptr; // being filled without the lock
+    std::thread mThread;
+    bool mRunning;
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_DISKSTREAMER_
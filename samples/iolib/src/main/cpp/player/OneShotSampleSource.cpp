@@ -22,48 +22,41 @@
 
 namespace iolib {
 
+// Samples converted at a time from the compact formats.
+constexpr int32_t kConvertSamples = 512;
+
 void OneShotSampleSource::mixAudio(float* outBuff, int numChannels, int32_t numFrames) {
     int32_t numSamples = mSampleBuffer->getNumSamples();
     int32_t sampleChannels = mSampleBuffer->getProperties().channelCount;
     int32_t totalSamplesNeeded = numFrames * numChannels; // Total samples to fill the output buffer
     int32_t samplesProcessed = 0;
+
     bool isLoopMode = mIsLoopMode;
+    // Compact samples go through a small float buffer on their way to the mix.
+    bool isFloat = mSampleBuffer->getSampleFormat() == SampleFormat::Float;
+    float convertBuffer[kConvertSamples];
 
     while (samplesProcessed < totalSamplesNeeded && mIsPlaying) {
         int32_t samplesLeft = numSamples - mCurSampleIndex;
         int32_t framesLeft = (totalSamplesNeeded - samplesProcessed) / numChannels;
         int32_t numWriteFrames = std::min(framesLeft, samplesLeft / sampleChannels);
+        if (!isFloat) {
+            numWriteFrames = std::min(numWriteFrames, kConvertSamples / sampleChannels);
+        }
 
         if (numWriteFrames > 0) {
-            const float* data = mSampleBuffer->getSampleData();
-            if ((sampleChannels == 1) && (numChannels == 1)) {
-                // MONO output from MONO samples
-                for (int32_t frameIndex = 0; frameIndex < numWriteFrames; frameIndex++) {
-                    outBuff[samplesProcessed + frameIndex] += data[mCurSampleIndex++] * mGain;
-                }
-            } else if ((sampleChannels == 1) && (numChannels == 2)) {
-                // STEREO output from MONO samples
-                int dstSampleIndex = samplesProcessed;
-                for (int32_t frameIndex = 0; frameIndex < numWriteFrames; frameIndex++) {
-                    outBuff[dstSampleIndex++] += data[mCurSampleIndex] * mLeftGain;
-                    outBuff[dstSampleIndex++] += data[mCurSampleIndex++] * mRightGain;
-                }
-            } else if ((sampleChannels == 2) && (numChannels == 1)) {
-                // MONO output from STEREO samples
-                int dstSampleIndex = samplesProcessed;
-                for (int32_t frameIndex = 0; frameIndex < numWriteFrames; frameIndex++) {
-                    outBuff[dstSampleIndex++] += data[mCurSampleIndex++] * mLeftGain +
-                                                 data[mCurSampleIndex++] * mRightGain;
-                }
-            } else if ((sampleChannels == 2) && (numChannels == 2)) {
-                // STEREO output from STEREO samples
-                int dstSampleIndex = samplesProcessed;
-                for (int32_t frameIndex = 0; frameIndex < numWriteFrames; frameIndex++) {
-                    outBuff[dstSampleIndex++] += data[mCurSampleIndex++] * mLeftGain;
-                    outBuff[dstSampleIndex++] += data[mCurSampleIndex++] * mRightGain;
-                }
+            const float* data;
+            if (isFloat) {
+                data = mSampleBuffer->getSampleData() + mCurSampleIndex;
+            } else {
+                mSampleBuffer->getSamplesFloat(mCurSampleIndex, convertBuffer,
+                                               numWriteFrames * sampleChannels);
+                data = convertBuffer;
             }
 
+            mixFrames(data, sampleChannels, outBuff + samplesProcessed, numChannels, numWriteFrames);
+
+            mCurSampleIndex += numWriteFrames * sampleChannels;
             samplesProcessed += numWriteFrames * numChannels;
 
             if (mCurSampleIndex >= numSamples) {
@@ -74,6 +67,9 @@ void OneShotSampleSource::mixAudio(float* outBuff, int numChannels, int32_t numF
                 }
             }
         } else {
+            if (mCurSampleIndex >= numSamples) {
+                mIsPlaying = false; // an empty sample ends as soon as it starts
+            }
             break; // No more samples to write in the current chunk
         }
     }
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ResamplerCache.h"
+
+namespace iolib {
+
+std::unique_ptr<ResamplerCache::MultiChannelResampler> ResamplerCache::acquire(
+        int32_t channelCount, int32_t inputRate, int32_t outputRate) {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        auto idle = mIdle.find(Key(channelCount, inputRate, outputRate));
+        if (idle != mIdle.end() && !idle->second.empty()) {
+            std::unique_ptr<MultiChannelResampler> resampler = std::move(idle->second.back());
+            idle->second.pop_back();
+            return resampler;
+        }
+        mNumBuilt++;
+    }
+    // Build outside the lock so other threads are not held up by the coefficient setup.
+    return std::unique_ptr<MultiChannelResampler>(
+            MultiChannelResampler::make(channelCount, inputRate, outputRate, mQuality));
+}
+
+void ResamplerCache::release(int32_t channelCount,
+                             int32_t inputRate,
+                             int32_t outputRate,
+                             std::unique_ptr<MultiChannelResampler> resampler) {
+    if (resampler == nullptr) {
+        return;
+    }
+    resampler->reset();
+    std::lock_guard<std::mutex> lock(mLock);
+    mIdle[Key(channelCount, inputRate, outputRate)].push_back(std::move(resampler));
+}
+
+} // namespace iolib
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_RESAMPLERCACHE_
+#define _PLAYER_RESAMPLERCACHE_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <resampler/MultiChannelResampler.h>
+
+namespace iolib {
+
+/**
+ * Keeps resamplers for reuse, keyed by channel count and rate pair.
+ *
+ * Building a MultiChannelResampler calculates its filter coefficients, which costs far more
+ * than resampling a short drum hit. When many samples share a rate pair, a resampler is
+ * reset() and handed out again instead.
+ *
+ * acquire() and release() may be called from any thread.
+ */
+class ResamplerCache {
+public:
+    using MultiChannelResampler = RESAMPLER_OUTER_NAMESPACE::resampler::MultiChannelResampler;
+
+    explicit ResamplerCache(MultiChannelResampler::Quality quality =
+            MultiChannelResampler::Quality::Medium)
+            : mQuality(quality) {}
+
+    /**
+     * Returns a resampler in its initial state. It is either taken from the cache
+     * or newly built.
+     */
+    std::unique_ptr<MultiChannelResampler> acquire(int32_t channelCount,
+                                                   int32_t inputRate,
+                                                   int32_t outputRate);
+
+    /**
+     * Returns a resampler from acquire() to the cache. The arguments must match.
+     */
+    void release(int32_t channelCount,
+                 int32_t inputRate,
+                 int32_t outputRate,
+                 std::unique_ptr<MultiChannelResampler> resampler);
+
+    /** Number of resamplers that had to be built. */
+    int32_t getNumBuilt() const { return mNumBuilt; }
+
+private:
+    using Key = std::tuple<int32_t, int32_t, int32_t>;
+
+    const MultiChannelResampler::Quality mQuality;
+
+    std::mutex mLock;
+    std::map<Key, std::vector<std::unique_ptr<MultiChannelResampler>>> mIdle;
+    std::atomic<int32_t> mNumBuilt{0};
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_RESAMPLERCACHE_
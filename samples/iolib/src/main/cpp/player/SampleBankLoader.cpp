@@ -0,0 +1,114 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include <android/log.h>
+
+// parselib includes
+#include <stream/MemInputStream.h>
+#include <wav/WavStreamReader.h>
+
+#include "SampleBankLoader.h"
+
+static const char* TAG = "SampleBankLoader";
+
+using namespace parselib;
+
+namespace iolib {
+
+SampleBankLoader::SampleBankLoader(int32_t numThreads)
+        : mNumThreads(numThreads > 0
+                      ? numThreads
+                      : std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()))) {}
+
+int32_t SampleBankLoader::addFile(const unsigned char *data, int32_t numBytes) {
+    mFiles.push_back({data, numBytes, nullptr});
+    return getNumFiles() - 1;
+}
+
+int32_t SampleBankLoader::addFile(int fd) {
+    auto stream = std::make_unique<MappedInputStream>(fd);
+    if (stream->isValid()) {
+        // Start reading the file in while the rest are being added.
+        stream->willNeed(0, stream->getLength());
+    }
+    mFiles.push_back({nullptr, 0, std::move(stream)});
+    return getNumFiles() - 1;
+}
+
+SampleBuffer* SampleBankLoader::loadFile(File &file, int32_t sampleRate) {
+    std::unique_ptr<MemInputStream> memStream;
+    parselib::InputStream *stream = file.mappedStream.get();
+    if (stream == nullptr) {
+        memStream = std::make_unique<MemInputStream>(
+                const_cast<unsigned char *>(file.data), file.numBytes);
+        stream = memStream.get();
+    } else if (!file.mappedStream->isValid()) {
+        return nullptr;
+    }
+
+    WavStreamReader reader(stream);
+    reader.parse();
+    if (!reader.isValid()) {
+        return nullptr;
+    }
+
+    SampleBuffer* sampleBuffer = new SampleBuffer();
+    sampleBuffer->loadSampleData(&reader, mSampleFormat);
+    sampleBuffer->resampleData(sampleRate, &mResamplerCache);
+    return sampleBuffer;
+}
+
+std::vector<SampleBuffer*> SampleBankLoader::load(int32_t sampleRate) {
+    const int32_t numFiles = getNumFiles();
+    std::vector<SampleBuffer*> sampleBuffers(numFiles, nullptr);
+    mNextFile = 0;
+    mNumLoaded = 0;
+
+    auto worker = [&]() {
+        int32_t index;
+        while ((index = mNextFile++) < numFiles) {
+            sampleBuffers[index] = loadFile(mFiles[index], sampleRate);
+            if (sampleBuffers[index] == nullptr) {
+                __android_log_print(ANDROID_LOG_ERROR, TAG, "load() could not parse file %d",
+                                    index);
+            }
+            int32_t numLoaded = ++mNumLoaded;
+            if (mProgressCallback) {
+                mProgressCallback(numLoaded, numFiles);
+            }
+        }
+    };
+
+    // The calling thread is one of the workers.
+    std::vector<std::thread> threads;
+    for (int32_t i = 1; i < std::min(mNumThreads, numFiles); i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    __android_log_print(ANDROID_LOG_INFO, TAG, "load() %d files, %d threads, %d resamplers built",
+                        numFiles, std::min(mNumThreads, numFiles),
+                        mResamplerCache.getNumBuilt());
+    return sampleBuffers;
+}
+
+} // namespace iolib
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_SAMPLEBANKLOADER_
+#define _PLAYER_SAMPLEBANKLOADER_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <stream/MappedInputStream.h>
+
+#include "ResamplerCache.h"
+#include "SampleBuffer.h"
+
+namespace iolib {
+
+/**
+ * Decodes and resamples a bank of WAV files on several threads.
+ *
+ * Add the files, then call load(). Each worker thread takes the next file that nobody has
+ * started yet, so a few long files do not hold up the rest. All the workers share a
+ * ResamplerCache, so the filter coefficients are calculated once per rate pair rather
+ * than once per file.
+ */
+class SampleBankLoader {
+public:
+    /**
+     * Called after each file has been loaded, from the worker thread that loaded it.
+     */
+    using ProgressCallback = std::function<void(int32_t numLoaded, int32_t numFiles)>;
+
+    /**
+     * @param numThreads number of worker threads, or 0 to use one per CPU core
+     */
+    explicit SampleBankLoader(int32_t numThreads = 0);
+
+    /**
+     * Adds a WAV file image in memory. The memory must stay valid until load() returns.
+     * @return the index of the file in the vector returned by load()
+     */
+    int32_t addFile(const unsigned char *data, int32_t numBytes);
+
+    /**
+     * Adds a WAV file. The file handle may be closed once this returns.
+     * @return the index of the file in the vector returned by load()
+     */
+    int32_t addFile(int fd);
+
+    int32_t getNumFiles() const { return static_cast<int32_t>(mFiles.size()); }
+
+    void setProgressCallback(ProgressCallback callback) { mProgressCallback = callback; }
+
+    /** Format the loaded samples are held in, see SampleBuffer. Float by default. */
+    void setSampleFormat(SampleFormat format) { mSampleFormat = format; }
+
+    /**
+     * Number of files loaded so far by a load() in progress. May be polled from any thread.
+     */
+    int32_t getNumLoaded() const { return mNumLoaded; }
+
+    /**
+     * Loads all the files and resamples them to sampleRate. Blocks until all are done.
+     * The caller owns the returned buffers. A file that could not be parsed gives a nullptr.
+     */
+    std::vector<SampleBuffer*> load(int32_t sampleRate);
+
+private:
+    struct File {
+        const unsigned char *data;
+        int32_t numBytes;
+        std::unique_ptr<parselib::MappedInputStream> mappedStream;
+    };
+
+    SampleBuffer* loadFile(File &file, int32_t sampleRate);
+
+    const int32_t mNumThreads;
+    std::vector<File> mFiles;
+    ResamplerCache mResamplerCache;
+    ProgressCallback mProgressCallback;
+    SampleFormat mSampleFormat = SampleFormat::Float;
+
+    std::atomic<int32_t> mNextFile{0};
+    std::atomic<int32_t> mNumLoaded{0};
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_SAMPLEBANKLOADER_
@@ -14,27 +14,69 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "ResamplerCache.h"
 #include "SampleBuffer.h"
 
 // Resampler Includes
 #include <resampler/MultiChannelResampler.h>
 
+#include "wav/PcmDecoder.h"
 #include "wav/WavStreamReader.h"
 
+using namespace parselib;
 using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
 
 namespace iolib {
 
-void SampleBuffer::loadSampleData(parselib::WavStreamReader* reader) {
+// Frames converted at a time when loading into one of the compact formats.
+constexpr int32_t kLoadBlockFrames = 4096;
+
+void SampleBuffer::loadSampleData(parselib::WavStreamReader* reader, SampleFormat format) {
+    unloadSampleData();
+    mSampleFormat = format;
     mAudioProperties.channelCount = reader->getNumChannels();
     mAudioProperties.sampleRate = reader->getSampleRate();
 
     reader->positionToAudio();
 
-    mNumSamples = reader->getNumSampleFrames() * reader->getNumChannels();
-    mSampleData = new float[mNumSamples];
+    const int32_t numFrames = reader->getNumSampleFrames();
+    mNumSamples = numFrames * reader->getNumChannels();
+    if (format == SampleFormat::Float) {
+        mSampleData = new float[mNumSamples];
+        reader->getDataFloat(mSampleData, numFrames);
+        return;
+    }
+
+    if (format == SampleFormat::I16) {
+        mSampleData16 = new int16_t[mNumSamples]();
+    } else {
+        mSampleData24In32 = new int32_t[mNumSamples]();
+    }
+    // Go through a small float block rather than decoding the whole file as float.
+    const int32_t channelCount = mAudioProperties.channelCount;
+    std::unique_ptr<float[]> block(new float[kLoadBlockFrames * channelCount]);
+    int32_t frameIndex = 0;
+    while (frameIndex < numFrames) {
+        int32_t numRead = reader->getDataFloat(block.get(),
+                                               std::min(kLoadBlockFrames, numFrames - frameIndex));
+        if (numRead <= 0) {
+            break;
+        }
+        compactSamples(block.get(), frameIndex * channelCount, numRead * channelCount);
+        frameIndex += numRead;
+    }
+}
 
-    reader->getDataFloat(mSampleData, reader->getNumSampleFrames());
+void SampleBuffer::loadSilence(int32_t sampleRate) {
+    unloadSampleData();
+    mSampleFormat = SampleFormat::Float;
+    mAudioProperties.channelCount = 1;
+    mAudioProperties.sampleRate = sampleRate;
 }
 
 void SampleBuffer::unloadSampleData() {
@@ -42,77 +84,173 @@ void SampleBuffer::unloadSampleData() {
         delete[] mSampleData;
         mSampleData = nullptr;
     }
+    if (mSampleData16 != nullptr) {
+        delete[] mSampleData16;
+        mSampleData16 = nullptr;
+    }
+    if (mSampleData24In32 != nullptr) {
+        delete[] mSampleData24In32;
+        mSampleData24In32 = nullptr;
+    }
     mNumSamples = 0;
 }
 
-class ResampleBlock {
-public:
-    int32_t mSampleRate;
-    float*  mBuffer;
-    int32_t mNumSamples;
-};
-
-void resampleData(const ResampleBlock& input, ResampleBlock* output, int numChannels) {
-    // Calculate output buffer size
-    double temp =
-            ((double)input.mNumSamples * (double)output->mSampleRate) / (double)input.mSampleRate;
-
-    // round up
-    int32_t numOutFramesAllocated = (int32_t)(temp + 0.5);
-    // We iterate thousands of times through the loop. Roundoff error could accumulate
-    // so add a few more frames for padding
-    numOutFramesAllocated += 8;
-
-    MultiChannelResampler *resampler = MultiChannelResampler::make(
-            numChannels, // channel count
-            input.mSampleRate, // input sampleRate
-            output->mSampleRate, // output sampleRate
-            MultiChannelResampler::Quality::Medium); // conversion quality
-
-    float *inputBuffer = input.mBuffer;;     // multi-channel buffer to be consumed
-    float *outputBuffer = new float[numOutFramesAllocated];    // multi-channel buffer to be filled
-    output->mBuffer = outputBuffer;
-
-    int numOutputSamples = 0;
-    int inputSamplesLeft = input.mNumSamples;
-    while ((inputSamplesLeft > 0) && (numOutputSamples < numOutFramesAllocated)) {
-        if(resampler->isWriteNeeded()) {
-            resampler->writeNextFrame(inputBuffer);
-            inputBuffer += numChannels;
-            inputSamplesLeft -= numChannels;
-        } else {
-            resampler->readNextFrame(outputBuffer);
-            outputBuffer += numChannels;
-            numOutputSamples += numChannels;
+void SampleBuffer::compactSamples(const float* src, int32_t sampleIndex, int32_t numSamples) {
+    if (mSampleFormat == SampleFormat::I16) {
+        int16_t* dst = mSampleData16 + sampleIndex;
+        for (int32_t i = 0; i < numSamples; i++) {
+            float sample = std::round(src[i] * 32768.0f);
+            dst[i] = (int16_t) std::min(32767.0f, std::max(-32768.0f, sample));
+        }
+    } else {
+        int32_t* dst = mSampleData24In32 + sampleIndex;
+        for (int32_t i = 0; i < numSamples; i++) {
+            float sample = std::round(src[i] * 8388608.0f);
+            dst[i] = ((int32_t) std::min(8388607.0f, std::max(-8388608.0f, sample))) * 256;
         }
     }
-    output->mNumSamples = numOutputSamples;
+}
 
-    delete resampler;
+void SampleBuffer::getSamplesFloat(int32_t sampleIndex, float* buff, int32_t numSamples) const {
+    // The parselib decoders read little endian integers, which is what we hold in memory.
+    switch (mSampleFormat) {
+        case SampleFormat::Float:
+            memcpy(buff, mSampleData + sampleIndex, numSamples * sizeof(float));
+            break;
+        case SampleFormat::I16:
+            PcmDecoder::decodePCM16(reinterpret_cast<const uint8_t*>(mSampleData16 + sampleIndex),
+                                    buff, numSamples);
+            break;
+        case SampleFormat::I24In32:
+            PcmDecoder::decodePCM32(
+                    reinterpret_cast<const uint8_t*>(mSampleData24In32 + sampleIndex),
+                    buff, numSamples);
+            break;
+    }
+}
+
+// Frames resampled at a time. The compact formats are expanded to float one block at a time.
+constexpr int32_t kResampleBlockFrames = 4096;
+
+/*
+ * Runs the resampler over a block of input until the input is used up or the output is full.
+ * Returns the number of frames written and sets inputFramesUsed.
+ */
+static int32_t resampleBlock(MultiChannelResampler *resampler,
+                             const float *input, int32_t numInputFrames,
+                             float *output, int32_t numOutputFrames,
+                             int32_t *inputFramesUsed) {
+    const int32_t channelCount = resampler->getChannelCount();
+    int32_t inputFrame = 0;
+    int32_t outputFrame = 0;
+    while (inputFrame < numInputFrames && outputFrame < numOutputFrames) {
+        if (resampler->isWriteNeeded()) {
+            resampler->writeNextFrame(input + (inputFrame * channelCount));
+            inputFrame++;
+        } else {
+            resampler->readNextFrame(output + (outputFrame * channelCount));
+            outputFrame++;
+        }
+    }
+    *inputFramesUsed = inputFrame;
+    return outputFrame;
 }
 
 void SampleBuffer::resampleData(int sampleRate) {
+    resampleData(sampleRate, nullptr);
+}
+
+void SampleBuffer::resampleData(int sampleRate, ResamplerCache *resamplerCache) {
     if (mAudioProperties.sampleRate == sampleRate) {
         // nothing to do
         return;
     }
 
-    ResampleBlock inputBlock;
-    inputBlock.mBuffer = mSampleData;
-    inputBlock.mNumSamples = mNumSamples;
-    inputBlock.mSampleRate = mAudioProperties.sampleRate;
+    const int32_t channelCount = mAudioProperties.channelCount;
+    const int32_t inputRate = mAudioProperties.sampleRate;
+    std::unique_ptr<MultiChannelResampler> resampler;
+    if (resamplerCache != nullptr) {
+        resampler = resamplerCache->acquire(channelCount, inputRate, sampleRate);
+    } else {
+        resampler.reset(MultiChannelResampler::make(
+                channelCount, // channel count
+                inputRate, // input sampleRate
+                sampleRate, // output sampleRate
+                MultiChannelResampler::Quality::Medium)); // conversion quality
+    }
+
+    // Move the current samples into a local buffer, which frees them when we are done.
+    SampleBuffer source;
+    source.mAudioProperties = mAudioProperties;
+    source.mSampleFormat = mSampleFormat;
+    source.mSampleData = mSampleData;
+    source.mSampleData16 = mSampleData16;
+    source.mSampleData24In32 = mSampleData24In32;
+    source.mNumSamples = mNumSamples;
+    mSampleData = nullptr;
+    mSampleData16 = nullptr;
+    mSampleData24In32 = nullptr;
+
+    const int32_t numInputFrames = source.mNumSamples / channelCount;
+    // Round up and pad a few frames so roundoff in the phase cannot run past the end.
+    const int32_t numOutputFrames = static_cast<int32_t>(
+            ((double) numInputFrames * sampleRate) / inputRate + 0.5) + 8;
+    const int32_t numOutputSamples = numOutputFrames * channelCount;
+    const bool isFloat = mSampleFormat == SampleFormat::Float;
+    if (isFloat) {
+        mSampleData = new float[numOutputSamples];
+    } else if (mSampleFormat == SampleFormat::I16) {
+        mSampleData16 = new int16_t[numOutputSamples];
+    } else {
+        mSampleData24In32 = new int32_t[numOutputSamples];
+    }
+
+    // Float data is read and written in place, the compact formats go through these blocks.
+    std::unique_ptr<float[]> inputBlock;
+    std::unique_ptr<float[]> outputBlock;
+    if (!isFloat) {
+        inputBlock.reset(new float[kResampleBlockFrames * channelCount]);
+        outputBlock.reset(new float[kResampleBlockFrames * channelCount]);
+    }
 
-    ResampleBlock outputBlock;
-    outputBlock.mSampleRate = sampleRate;
-    iolib::resampleData(inputBlock, &outputBlock, mAudioProperties.channelCount);
+    int32_t inputFrame = 0;
+    int32_t outputFrame = 0;
+    while (inputFrame < numInputFrames && outputFrame < numOutputFrames) {
+        const float *input;
+        float *output;
+        int32_t blockInputFrames;
+        int32_t blockOutputFrames;
+        if (isFloat) {
+            input = source.mSampleData + (inputFrame * channelCount);
+            output = mSampleData + (outputFrame * channelCount);
+            blockInputFrames = numInputFrames - inputFrame;
+            blockOutputFrames = numOutputFrames - outputFrame;
+        } else {
+            blockInputFrames = std::min(kResampleBlockFrames, numInputFrames - inputFrame);
+            blockOutputFrames = std::min(kResampleBlockFrames, numOutputFrames - outputFrame);
+            source.getSamplesFloat(inputFrame * channelCount, inputBlock.get(),
+                                   blockInputFrames * channelCount);
+            input = inputBlock.get();
+            output = outputBlock.get();
+        }
 
-    // delete previous samples
-    delete[] mSampleData;
+        int32_t inputFramesUsed = 0;
+        int32_t framesWritten = resampleBlock(resampler.get(), input, blockInputFrames,
+                                              output, blockOutputFrames, &inputFramesUsed);
+        if (!isFloat) {
+            compactSamples(output, outputFrame * channelCount, framesWritten * channelCount);
+        }
+        inputFrame += inputFramesUsed;
+        outputFrame += framesWritten;
+    }
+
+    if (resamplerCache != nullptr) {
+        resamplerCache->release(channelCount, inputRate, sampleRate, std::move(resampler));
+    }
 
     // install the resampled data
-    mSampleData = outputBlock.mBuffer;
-    mNumSamples = outputBlock.mNumSamples;
-    mAudioProperties.sampleRate = outputBlock.mSampleRate;
+    mNumSamples = outputFrame * channelCount;
+    mAudioProperties.sampleRate = sampleRate;
 }
 
 } // namespace iolib
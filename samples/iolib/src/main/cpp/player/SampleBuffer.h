@@ -21,6 +21,8 @@
 
 namespace iolib {
 
+class ResamplerCache;
+
 /*
  * Defines the relevant properties of the audio data being sourced.
  */
@@ -29,27 +31,70 @@ struct AudioProperties {
     int32_t sampleRate;
 };
 
+/*
+ * How a SampleBuffer holds its samples in memory.
+ * The integer formats are converted to float as they are played.
+ */
+enum class SampleFormat {
+    Float,      // 32-bit float
+    I16,        // 16-bit integer, half the memory of Float
+    I24In32,    // 24-bit integer in the top of a 32-bit word, keeps the precision of 24-bit files
+};
+
 class SampleBuffer {
 public:
-    SampleBuffer() : mNumSamples(0) {};
+    SampleBuffer() : mSampleFormat(SampleFormat::Float), mSampleData(nullptr),
+                     mSampleData16(nullptr), mSampleData24In32(nullptr), mNumSamples(0) {};
     virtual ~SampleBuffer() { unloadSampleData(); }
 
     // Data load/unload
-    void loadSampleData(parselib::WavStreamReader* reader);
+    void loadSampleData(parselib::WavStreamReader* reader,
+                        SampleFormat format = SampleFormat::Float);
     void unloadSampleData();
+    /**
+     * Makes this an empty mono buffer at sampleRate, which plays as silence.
+     * Stands in for a sample that could not be loaded.
+     */
+    void loadSilence(int32_t sampleRate);
 
     void resampleData(int sampleRate);
+    /**
+     * Resamples with a resampler from the cache, so the filter coefficients are only
+     * calculated once for each rate pair. The cache may be shared between threads.
+     */
+    void resampleData(int sampleRate, ResamplerCache *resamplerCache);
 
     virtual AudioProperties getProperties() const { return mAudioProperties; }
 
+    SampleFormat getSampleFormat() const { return mSampleFormat; }
+
+    // Only the pointer for the current format is valid, the others are nullptr.
+    // So getSampleData() is nullptr for I16 and I24In32 buffers. Code that may be given
+    // either should check getSampleFormat() or read through getSamplesFloat().
     float* getSampleData() { return mSampleData; }
+    int16_t* getSampleData16() { return mSampleData16; }
+    int32_t* getSampleData24In32() { return mSampleData24In32; }
+
     int32_t getNumSamples() { return mNumSamples; }
 
+    /**
+     * Converts samples of any format to float.
+     * Safe to call from an audio callback.
+     */
+    void getSamplesFloat(int32_t sampleIndex, float* buff, int32_t numSamples) const;
+
 protected:
     AudioProperties mAudioProperties;
+    SampleFormat mSampleFormat;
 
     float*  mSampleData;
+    int16_t* mSampleData16;
+    int32_t* mSampleData24In32;
     int32_t mNumSamples;
+
+private:
+    // Converts numSamples floats into the compact data starting at sampleIndex.
+    void compactSamples(const float* src, int32_t sampleIndex, int32_t numSamples);
 };
 
 }
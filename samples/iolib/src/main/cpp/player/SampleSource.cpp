@@ -14,8 +14,76 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
+#include "MixKernels.h"
 #include "SampleSource.h"
 
 namespace iolib {
-    // for now, all methods of SampleSource are either in-line or pure virtual
+
+void SampleSource::mixFrames(const float *src, int32_t srcChannels,
+                             float *dst, int32_t dstChannels, int32_t numFrames) {
+    // Read the targets once, they may be changed by another thread.
+    float gain = mGain;
+    float leftGain = mLeftGain;
+    float rightGain = mRightGain;
+    if (gain != mRampGain || leftGain != mRampLeftGain || rightGain != mRampRightGain) {
+        mRampGain = gain;
+        mRampLeftGain = leftGain;
+        mRampRightGain = rightGain;
+        mRampFramesLeft = kGainRampFrames;
+    }
+
+    int32_t numRampFrames = std::min(numFrames, mRampFramesLeft);
+    if (numRampFrames > 0) {
+        // Go part of the way if the ramp does not finish in this block.
+        float fraction = (float) numRampFrames / (float) mRampFramesLeft;
+        mixFramesWithGains(src, srcChannels, dst, dstChannels, numRampFrames,
+                           mMixGain + ((mRampGain - mMixGain) * fraction),
+                           mMixLeftGain + ((mRampLeftGain - mMixLeftGain) * fraction),
+                           mMixRightGain + ((mRampRightGain - mMixRightGain) * fraction));
+        mRampFramesLeft -= numRampFrames;
+        if (mRampFramesLeft == 0) {
+            mMixGain = mRampGain;
+            mMixLeftGain = mRampLeftGain;
+            mMixRightGain = mRampRightGain;
+        }
+        src += numRampFrames * srcChannels;
+        dst += numRampFrames * dstChannels;
+        numFrames -= numRampFrames;
+    }
+
+    if (numFrames > 0) {
+        mixFramesWithGains(src, srcChannels, dst, dstChannels, numFrames,
+                           mMixGain, mMixLeftGain, mMixRightGain);
+    }
 }
+
+void SampleSource::mixFramesWithGains(const float *src, int32_t srcChannels,
+                                      float *dst, int32_t dstChannels, int32_t numFrames,
+                                      float gainEnd, float leftGainEnd, float rightGainEnd) {
+    if ((srcChannels == 1) && (dstChannels == 1)) {
+        // MONO output from MONO samples
+        MixKernels::mixGain(dst, src, numFrames, mMixGain, gainEnd);
+    } else if ((srcChannels == 1) && (dstChannels == 2)) {
+        // STEREO output from MONO samples
+        MixKernels::mixMonoToStereo(dst, src, numFrames, mMixLeftGain, mMixRightGain,
+                                    leftGainEnd, rightGainEnd);
+    } else if ((srcChannels == 2) && (dstChannels == 1)) {
+        // MONO output from STEREO samples
+        MixKernels::mixStereoToMono(dst, src, numFrames, mMixLeftGain, mMixRightGain,
+                                    leftGainEnd, rightGainEnd);
+    } else if ((srcChannels == 2) && (dstChannels == 2)) {
+        // STEREO output from STEREO samples
+        MixKernels::mixStereo(dst, src, numFrames, mMixLeftGain, mMixRightGain,
+                              leftGainEnd, rightGainEnd);
+    } else if (srcChannels == dstChannels) {
+        // Multichannel, no panning
+        MixKernels::mixGain(dst, src, numFrames * srcChannels, mMixGain, gainEnd);
+    }
+    mMixGain = gainEnd;
+    mMixLeftGain = leftGainEnd;
+    mMixRightGain = rightGainEnd;
+}
+
+} // namespace iolib
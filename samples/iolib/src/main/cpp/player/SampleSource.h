@@ -17,6 +17,7 @@
 #ifndef _PLAYER_SAMPLESOURCE_
 #define _PLAYER_SAMPLESOURCE_
 
+#include <atomic>
 #include <cstdint>
 
 #include "DataSource.h"
@@ -38,9 +39,13 @@ public:
     static constexpr float PAN_HARDRIGHT = 1.0f;
     static constexpr float PAN_CENTER = 0.0f;
 
+    // Frames over which a change of gain or pan is ramped in
+    static constexpr int32_t kGainRampFrames = 128;
+
     SampleSource(SampleBuffer *sampleBuffer, float pan)
      : mSampleBuffer(sampleBuffer), mCurSampleIndex(0), mIsPlaying(false), mIsLoopMode(false), mGain(1.0f) {
         setPan(pan);
+        resetGainRamp();
     }
     virtual ~SampleSource() {}
 
@@ -58,12 +63,13 @@ public:
     }
 
     void setLoopMode(bool isLoopMode) { mIsLoopMode = isLoopMode; }
+    bool isLoopMode() { return mIsLoopMode; }
 
     bool isPlaying() { return mIsPlaying; }
 
     int32_t getPlayHeadPosition() const { return mCurSampleIndex; }
 
-    void setPlayHeadPosition(int32_t position) {
+    virtual void setPlayHeadPosition(int32_t position) {
         if (mSampleBuffer != nullptr && position >= 0 && position < mSampleBuffer->getNumSamples()) {
             mCurSampleIndex = position;
         }
@@ -113,7 +119,39 @@ protected:
     // Overall gain
     float mGain;
 
+    /**
+     * Mixes frames into the output with the current gain and pan, using the MixKernels.
+     * A change of gain or pan is ramped in over kGainRampFrames to avoid zipper noise.
+     * Mono, stereo and matching channel counts are supported. Call from the audio thread only.
+     */
+    void mixFrames(const float *src, int32_t srcChannels,
+                   float *dst, int32_t dstChannels, int32_t numFrames);
+
+    /**
+     * Makes the next mixFrames() start at the current gain and pan instead of ramping to them.
+     */
+    void resetGainRamp() {
+        mMixGain = mRampGain = mGain;
+        mMixLeftGain = mRampLeftGain = mLeftGain;
+        mMixRightGain = mRampRightGain = mRightGain;
+        mRampFramesLeft = 0;
+    }
+
 private:
+    void mixFramesWithGains(const float *src, int32_t srcChannels,
+                            float *dst, int32_t dstChannels, int32_t numFrames,
+                            float gainEnd, float leftGainEnd, float rightGainEnd);
+
+    // Gains reached by the last mixFrames() and the gains it is ramping towards.
+    // Only used by the audio thread.
+    float mMixGain;
+    float mMixLeftGain;
+    float mMixRightGain;
+    float mRampGain;
+    float mRampLeftGain;
+    float mRampRightGain;
+    int32_t mRampFramesLeft;
+
     void calcGainFactors() {
         // useful panning information: http://www.cs.cmu.edu/~music/icm-online/readings/panlaws/
         float rightPan = (mPan * 0.5) + 0.5;
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include <android/log.h>
 
 // parselib includes
@@ -34,7 +36,7 @@ namespace iolib {
 constexpr int32_t kBufferSizeInBursts = 2; // Use 2 bursts as the buffer size (double buffer)
 
 SimpleMultiPlayer::SimpleMultiPlayer()
-  : mChannelCount(0), mOutputReset(false), mSampleRate(0), mNumSampleBuffers(0)
+  : mChannelCount(0), mOutputReset(false), mSampleRate(0), mNumSampleBuffers(0), mFramePosition(0)
 {}
 
 DataCallbackResult SimpleMultiPlayer::MyDataCallback::onAudioReady(AudioStream *oboeStream,
@@ -52,17 +54,118 @@ DataCallbackResult SimpleMultiPlayer::MyDataCallback::onAudioReady(AudioStream *
     memset(audioData, 0, static_cast<size_t>(numFrames) * static_cast<size_t>
             (mParent->mChannelCount) * sizeof(float));
 
-    // OneShotSampleSource* sources = mSampleSources.get();
-    for(int32_t index = 0; index < mParent->mNumSampleBuffers; index++) {
-        if (mParent->mSampleSources[index]->isPlaying()) {
-            mParent->mSampleSources[index]->mixAudio((float*)audioData, mParent->mChannelCount,
-                                                     numFrames);
+    std::unique_lock<std::mutex> lock(mParent->mCommandLock, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        // Another thread is changing the sources, which only happens around a start or stop.
+        mParent->mFramePosition += numFrames;
+        return DataCallbackResult::Continue;
+    }
+
+    // Render up to the frame of each command that falls in this callback, then apply it.
+    float* outBuff = (float*)audioData;
+    int64_t startFrame = mParent->mFramePosition;
+    int64_t endFrame = startFrame + numFrames;
+    int32_t framesDone = 0;
+
+    PlayerCommand command;
+    mParent->mCommands.collect();
+    while (mParent->mCommands.popDue(endFrame, command)) {
+        int32_t commandOffset = (int32_t) std::max<int64_t>(command.frame - startFrame, framesDone);
+        if (commandOffset > framesDone) {
+            mParent->mixSources(outBuff + (framesDone * mParent->mChannelCount),
+                                commandOffset - framesDone);
+            framesDone = commandOffset;
         }
+        mParent->applyCommand(command);
     }
+    if (framesDone < numFrames) {
+        mParent->mixSources(outBuff + (framesDone * mParent->mChannelCount),
+                            numFrames - framesDone);
+    }
+
+    mParent->mFramePosition = endFrame;
 
     return DataCallbackResult::Continue;
 }
 
+void SimpleMultiPlayer::mixSources(float* outBuff, int32_t numFrames) {
+    if (mVoicePool) {
+        mVoicePool->mixAudio(outBuff, mChannelCount, numFrames,
+                             mSampleSources, mNumSampleBuffers);
+        for (SampleSource* source : mStreamingSources) {
+            if (source->isPlaying()) {
+                source->mixAudio(outBuff, mChannelCount, numFrames);
+            }
+        }
+        return;
+    }
+
+    for(int32_t index = 0; index < mNumSampleBuffers; index++) {
+        if (mSampleSources[index]->isPlaying()) {
+            mSampleSources[index]->mixAudio(outBuff, mChannelCount, numFrames);
+        }
+    }
+}
+
+void SimpleMultiPlayer::applyCommand(const PlayerCommand& command) {
+    if (command.type == PlayerCommand::Type::StopAll) {
+        for (int32_t index = 0; index < mNumSampleBuffers; index++) {
+            mSampleSources[index]->setStopMode();
+        }
+        if (mVoicePool) {
+            mVoicePool->releaseAll();
+        }
+        return;
+    }
+
+    if (command.index < 0 || command.index >= mNumSampleBuffers) {
+        return; // unloaded since it was posted
+    }
+    SampleSource* source = mSampleSources[command.index];
+    switch (command.type) {
+        case PlayerCommand::Type::Trigger:
+            if (isVoiced(command.index)) {
+                mVoicePool->trigger(source, command.index);
+            } else {
+                source->setPlayMode();
+            }
+            break;
+        case PlayerCommand::Type::Stop:
+            if (isVoiced(command.index)) {
+                mVoicePool->release(command.index);
+            } else {
+                source->setStopMode();
+            }
+            break;
+        case PlayerCommand::Type::Pause:
+            if (isVoiced(command.index)) {
+                mVoicePool->release(command.index);
+            } else {
+                source->setStopMode(true);
+            }
+            break;
+        case PlayerCommand::Type::Resume:
+            if (isVoiced(command.index)) {
+                mVoicePool->trigger(source, command.index);
+            } else {
+                source->setPlayMode(false);
+            }
+            break;
+        case PlayerCommand::Type::SetGain:
+            // Voices pick this up from the source.
+            source->setGain(command.value);
+            break;
+        case PlayerCommand::Type::SetPan:
+            source->setPan(command.value);
+            break;
+        case PlayerCommand::Type::SetLoopMode:
+            source->setLoopMode(command.value != 0.0f);
+            break;
+        default:
+            break;
+    }
+}
+
 void SimpleMultiPlayer::MyErrorCallback::onErrorAfterClose(AudioStream *oboeStream, Result error) {
     __android_log_print(ANDROID_LOG_INFO, TAG, "==== onErrorAfterClose() error:%d", error);
 
@@ -168,12 +271,62 @@ void SimpleMultiPlayer::addSampleSource(SampleSource* source, SampleBuffer* buff
 
     mSampleBuffers.push_back(buffer);
     mSampleSources.push_back(source);
+    mGains.push_back(source->getGain());
+    mPans.push_back(source->getPan());
+    mNumSampleBuffers++;
+}
+
+void SimpleMultiPlayer::addStreamingSampleSource(StreamingSampleSource* source,
+                                                 StreamingSampleBuffer* buffer) {
+    if (buffer->getProperties().sampleRate != mSampleRate) {
+        __android_log_print(ANDROID_LOG_WARN, TAG,
+                "addStreamingSampleSource() sample rate %d does not match stream rate %d",
+                buffer->getProperties().sampleRate, mSampleRate);
+    }
+
+    mSampleBuffers.push_back(buffer);
+    mSampleSources.push_back(source);
+    mGains.push_back(source->getGain());
+    mPans.push_back(source->getPan());
+    mStreamingSources.push_back(source);
     mNumSampleBuffers++;
+
+    mDiskStreamer.addSource(source);
+}
+
+int32_t SimpleMultiPlayer::addSampleBank(SampleBankLoader& loader, const std::vector<float>& pans) {
+    std::vector<SampleBuffer*> sampleBuffers = loader.load(mSampleRate);
+
+    int32_t numAdded = 0;
+    for (size_t index = 0; index < sampleBuffers.size(); index++) {
+        if (sampleBuffers[index] == nullptr) {
+            // Keep the place of a file that could not be parsed, so pad i is still file i.
+            sampleBuffers[index] = new SampleBuffer();
+            sampleBuffers[index]->loadSilence(mSampleRate);
+        } else {
+            numAdded++;
+        }
+        float pan = index < pans.size() ? pans[index] : SampleSource::PAN_CENTER;
+        // Already at the stream rate, so this does not resample again.
+        addSampleSource(new OneShotSampleSource(sampleBuffers[index], pan), sampleBuffers[index]);
+    }
+    return numAdded;
 }
 
 void SimpleMultiPlayer::unloadSampleData() {
     __android_log_print(ANDROID_LOG_INFO, TAG, "unloadSampleData()");
-    resetAll();
+    std::lock_guard<std::mutex> lock(mCommandLock);
+    // The indices of queued commands would point at whatever is loaded next.
+    mCommands.clear();
+    mFramePosition = 0;
+
+    for (int32_t bufferIndex = 0; bufferIndex < mNumSampleBuffers; bufferIndex++) {
+        mSampleSources[bufferIndex]->setStopMode();
+    }
+    if (mVoicePool) {
+        mVoicePool->reset();
+    }
+    mDiskStreamer.removeAllSources();
 
     for (int32_t bufferIndex = 0; bufferIndex < mNumSampleBuffers; bufferIndex++) {
         delete mSampleBuffers[bufferIndex];
@@ -182,46 +335,142 @@ void SimpleMultiPlayer::unloadSampleData() {
 
     mSampleBuffers.clear();
     mSampleSources.clear();
+    mGains.clear();
+    mPans.clear();
+    mStreamingSources.clear();
 
     mNumSampleBuffers = 0;
 }
 
-void SimpleMultiPlayer::triggerDown(int32_t index, oboe::PerformanceMode /* performanceMode */) {
-    if (index < mNumSampleBuffers) {
-        mSampleSources[index]->setPlayMode();
+bool SimpleMultiPlayer::setMaxPolyphony(int32_t maxVoices, VoicePool::StealMode stealMode) {
+    __android_log_print(ANDROID_LOG_INFO, TAG, "setMaxPolyphony(%d)", maxVoices);
+    if (isCallbackRunning()) {
+        __android_log_print(ANDROID_LOG_WARN, TAG,
+                "setMaxPolyphony() refused, the stream is running (state %d)",
+                mAudioStream->getState());
+        return false;
     }
+
+    std::lock_guard<std::mutex> lock(mCommandLock);
+    // Whatever is sounding belongs to the old way of playing, so stop it.
+    for (int32_t index = 0; index < mNumSampleBuffers; index++) {
+        mSampleSources[index]->setStopMode();
+    }
+    if (maxVoices > 0) {
+        mVoicePool = std::make_unique<VoicePool>(maxVoices, stealMode);
+    } else {
+        mVoicePool.reset();
+    }
+    return true;
+}
+
+int32_t SimpleMultiPlayer::getMaxPolyphony() {
+    return mVoicePool ? mVoicePool->getMaxPolyphony() : 0;
+}
+
+int32_t SimpleMultiPlayer::getNumActiveVoices() {
+    return mVoicePool ? mVoicePool->getNumActiveVoices() : 0;
+}
+
+bool SimpleMultiPlayer::isCallbackRunning() {
+    if (!mAudioStream) {
+        return false;
+    }
+    StreamState state = mAudioStream->getState();
+    return state != StreamState::Uninitialized && state != StreamState::Open
+            && state != StreamState::Paused && state != StreamState::Flushed
+            && state != StreamState::Stopped && state != StreamState::Closed
+            && state != StreamState::Disconnected;
+}
+
+bool SimpleMultiPlayer::isVoiced(int32_t index) {
+    return mVoicePool && std::find(mStreamingSources.begin(), mStreamingSources.end(),
+                                   mSampleSources[index]) == mStreamingSources.end();
+}
+
+void SimpleMultiPlayer::triggerDown(int32_t index, oboe::PerformanceMode /* performanceMode */) {
+    triggerAt(index, PlayerCommand::kImmediate);
 }
 
 void SimpleMultiPlayer::triggerUp(int32_t index) {
-    if (index < mNumSampleBuffers) {
-        mSampleSources[index]->setStopMode();
+    stopAt(index, PlayerCommand::kImmediate);
+}
+
+bool SimpleMultiPlayer::postCommand(PlayerCommand::Type type, int32_t index, float value,
+                                    int64_t frame) {
+    if (type != PlayerCommand::Type::StopAll && (index < 0 || index >= mNumSampleBuffers)) {
+        return false;
+    }
+    PlayerCommand command = { type, index, value, frame };
+    if (isCallbackRunning() || frame > mFramePosition) {
+        return mCommands.post(command);
     }
+
+    // Nothing is rendering, so apply it now rather than leave it in the queue.
+    std::lock_guard<std::mutex> lock(mCommandLock);
+    applyDueCommands();
+    applyCommand(command);
+    return true;
 }
 
-void SimpleMultiPlayer::resetAll() {
-    for (int32_t bufferIndex = 0; bufferIndex < mNumSampleBuffers; bufferIndex++) {
-        mSampleSources[bufferIndex]->setStopMode();
+void SimpleMultiPlayer::applyDueCommands() {
+    PlayerCommand command;
+    mCommands.collect();
+    while (mCommands.popDue(mFramePosition + 1, command)) {
+        applyCommand(command);
+    }
+}
+
+bool SimpleMultiPlayer::triggerAt(int32_t index, int64_t frame) {
+    return postCommand(PlayerCommand::Type::Trigger, index, 0.0f, frame);
+}
+
+bool SimpleMultiPlayer::stopAt(int32_t index, int64_t frame) {
+    return postCommand(PlayerCommand::Type::Stop, index, 0.0f, frame);
+}
+
+bool SimpleMultiPlayer::setGainAt(int32_t index, float gain, int64_t frame) {
+    if (!postCommand(PlayerCommand::Type::SetGain, index, gain, frame)) {
+        return false;
     }
+    mGains[index] = gain;
+    return true;
+}
+
+bool SimpleMultiPlayer::setPanAt(int32_t index, float pan, int64_t frame) {
+    if (!postCommand(PlayerCommand::Type::SetPan, index, pan, frame)) {
+        return false;
+    }
+    mPans[index] = std::min(std::max(pan, SampleSource::PAN_HARDLEFT), SampleSource::PAN_HARDRIGHT);
+    return true;
+}
+
+bool SimpleMultiPlayer::setLoopModeAt(int32_t index, bool isLoopMode, int64_t frame) {
+    return postCommand(PlayerCommand::Type::SetLoopMode, index, isLoopMode ? 1.0f : 0.0f, frame);
+}
+
+void SimpleMultiPlayer::resetAll() {
+    postCommand(PlayerCommand::Type::StopAll, -1, 0.0f, PlayerCommand::kImmediate);
 }
 
 void SimpleMultiPlayer::setPan(int index, float pan) {
-    mSampleSources[index]->setPan(pan);
+    setPanAt(index, pan, PlayerCommand::kImmediate);
 }
 
 float SimpleMultiPlayer::getPan(int index) {
-    return mSampleSources[index]->getPan();
+    return mPans[index];
 }
 
 void SimpleMultiPlayer::setGain(int index, float gain) {
-    mSampleSources[index]->setGain(gain);
+    setGainAt(index, gain, PlayerCommand::kImmediate);
 }
 
 float SimpleMultiPlayer::getGain(int index) {
-    return mSampleSources[index]->getGain();
+    return mGains[index];
 }
 
 void SimpleMultiPlayer::setLoopMode(int index, bool isLoopMode) {
-    mSampleSources[index]->setLoopMode(isLoopMode);
+    setLoopModeAt(index, isLoopMode, PlayerCommand::kImmediate);
 }
 
 }
@@ -17,17 +17,32 @@
 #ifndef _PLAYER_SIMPLEMULTIPLAYER_H_
 #define _PLAYER_SIMPLEMULTIPLAYER_H_
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <oboe/Oboe.h>
 
+#include "CommandQueue.h"
+#include "DiskStreamer.h"
 #include "OneShotSampleSource.h"
+#include "SampleBankLoader.h"
 #include "SampleBuffer.h"
+#include "StreamingSampleBuffer.h"
+#include "StreamingSampleSource.h"
+#include "VoicePool.h"
 
 namespace iolib {
 
 /**
  * A simple streaming player for multiple SampleBuffers.
+ *
+ * Triggers and parameter changes are not applied to the sources directly. They are posted
+ * to a CommandQueue, with a frame time, and applied by the audio callback at that frame.
+ * While the callback is not running they are applied at once by the calling thread, so
+ * changes made with the stream paused or stopped do not pile up in the queue.
+ * Post them from one thread only.
  */
 class SimpleMultiPlayer  {
 public:
@@ -49,14 +64,64 @@ public:
      * are added.
      */
     void addSampleSource(SampleSource* source, SampleBuffer* buffer);
+    /**
+     * Like addSampleSource() for a sample that is streamed from disk.
+     * The source is serviced by the player's DiskStreamer thread.
+     * Streamed data is not resampled, see StreamingSampleBuffer.
+     */
+    void addStreamingSampleSource(StreamingSampleSource* source, StreamingSampleBuffer* buffer);
+    /**
+     * Loads all the files in the loader on several threads, resampled to the stream rate,
+     * and adds a OneShotSampleSource for each one in order.
+     * pans[i] is the pan for file i, center if there is none.
+     * Call this after the stream is open so the sample rate is known.
+     * A file that cannot be parsed gets a silent source, so source i is always file i.
+     * @return the number of files loaded
+     */
+    int32_t addSampleBank(SampleBankLoader& loader, const std::vector<float>& pans = {});
     /**
      * Deallocates and deletes all added source/buffer (see addSampleSource()).
+     * Commands that are still queued are dropped and getFramePosition() starts again at 0.
      */
     void unloadSampleData();
 
+    /**
+     * Plays the samples through a pool of maxVoices voices instead of one source per sample.
+     * A retrigger then starts another voice rather than restarting the sample, and once all
+     * the voices are busy a trigger steals one as chosen by stealMode.
+     * The callback only visits the playing voices. Streamed samples are not voiced.
+     * Pass 0 to go back to one source per sample.
+     * The callback uses the pool without a lock, so this is refused while the stream is
+     * started. Call it before startStream() or after the stream is stopped.
+     * @return false if the stream is running and nothing was changed
+     */
+    bool setMaxPolyphony(int32_t maxVoices,
+                         VoicePool::StealMode stealMode = VoicePool::StealMode::Oldest);
+    int32_t getMaxPolyphony();
+    int32_t getNumActiveVoices();
+
     virtual void triggerDown(int32_t index, oboe::PerformanceMode performanceMode = oboe::PerformanceMode::LowLatency);
     virtual void triggerUp(int32_t index);
 
+    /**
+     * Frames rendered since the stream was first started. Commands are timed by this clock.
+     */
+    int64_t getFramePosition() { return mFramePosition; }
+
+    // Sample accurate versions of triggerDown(), triggerUp(), setGain(), setPan() and
+    // setLoopMode(). The change happens at the given getFramePosition(), or at the start
+    // of the next callback if that has already been rendered.
+    // These return false if the index is not valid or the queue is full.
+    bool triggerAt(int32_t index, int64_t frame);
+    bool stopAt(int32_t index, int64_t frame);
+    bool setGainAt(int32_t index, float gain, int64_t frame);
+    bool setPanAt(int32_t index, float pan, int64_t frame);
+    bool setLoopModeAt(int32_t index, bool isLoopMode, int64_t frame);
+
+    /**
+     * Stops every source. The sources are stopped when this returns if the callback is not
+     * running, otherwise at the start of the next callback.
+     */
     void resetAll();
 
     bool getOutputReset() { return mOutputReset; }
@@ -71,6 +136,18 @@ public:
     void setLoopMode(int index, bool isLoopMode);
 
 protected:
+    // True if the source at index is played by the voice pool
+    bool isVoiced(int32_t index);
+    // True if the stream may be calling onAudioReady()
+    bool isCallbackRunning();
+
+    bool postCommand(PlayerCommand::Type type, int32_t index, float value, int64_t frame);
+    // Audio thread, or any thread holding mCommandLock while the callback is not running
+    void applyCommand(const PlayerCommand& command);
+    // Applies the queued commands that are due by getFramePosition(). Hold mCommandLock.
+    void applyDueCommands();
+    void mixSources(float* outBuff, int32_t numFrames);
+
     class MyDataCallback : public oboe::AudioStreamDataCallback {
     public:
         MyDataCallback(SimpleMultiPlayer *parent) : mParent(parent) {}
@@ -108,6 +185,24 @@ protected:
     int32_t mNumSampleBuffers;
     std::vector<SampleBuffer*>  mSampleBuffers;
     std::vector<SampleSource*>  mSampleSources;
+    // The gain and pan of each source as last set, which the audio thread may not have applied yet
+    std::vector<float>  mGains;
+    std::vector<float>  mPans;
+    // Sources the voice pool leaves alone, mixed directly
+    std::vector<SampleSource*>  mStreamingSources;
+
+    // Plays the other sources when a polyphony limit is set
+    std::unique_ptr<VoicePool> mVoicePool;
+
+    // From the UI to the audio callback
+    CommandQueue mCommands;
+    std::atomic<int64_t> mFramePosition;
+    // Held by any thread other than the callback that applies commands or changes the
+    // sources. The callback only tries it, and renders silence if it is taken.
+    std::mutex mCommandLock;
+
+    // Keeps the StreamingSampleSources fed
+    DiskStreamer mDiskStreamer;
 
     bool    mOutputReset;
 
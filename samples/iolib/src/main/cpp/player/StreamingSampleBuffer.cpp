@@ -0,0 +1,84 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <android/log.h>
+
+#include "StreamingSampleBuffer.h"
+
+static const char* TAG = "StreamingSampleBuffer";
+
+using namespace parselib;
+
+namespace iolib {
+
+StreamingSampleBuffer::StreamingSampleBuffer() : mNumFrames(0), mBytesPerFrame(0) {
+    mAudioProperties.channelCount = 0;
+    mAudioProperties.sampleRate = 0;
+}
+
+StreamingSampleBuffer::~StreamingSampleBuffer() {}
+
+bool StreamingSampleBuffer::open(int fd, int32_t residentMillis) {
+    unloadSampleData();
+
+    mStream = std::make_unique<MappedInputStream>(fd);
+    if (!mStream->isValid()) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "open() could not map the file");
+        mStream.reset();
+        return false;
+    }
+    mReader = std::make_unique<WavStreamReader>(mStream.get());
+    mReader->parse();
+    if (!mReader->isValid() || mReader->getNumChannels() <= 0) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "open() not a valid WAV file");
+        mReader.reset();
+        mStream.reset();
+        return false;
+    }
+
+    mAudioProperties.channelCount = mReader->getNumChannels();
+    mAudioProperties.sampleRate = mReader->getSampleRate();
+    mNumFrames = mReader->getNumSampleFrames();
+    mBytesPerFrame = (mReader->getBitsPerSample() / 8) * mAudioProperties.channelCount;
+
+    int64_t residentFrames = ((int64_t) residentMillis * mAudioProperties.sampleRate) / 1000;
+    int32_t numResidentFrames = (int32_t) std::min<int64_t>(mNumFrames,
+                                                            std::max<int64_t>(0, residentFrames));
+    mNumSamples = numResidentFrames * mAudioProperties.channelCount;
+    mSampleData = new float[mNumSamples];
+
+    mReader->positionToAudio();
+    numResidentFrames = std::max(0, mReader->getDataFloat(mSampleData, numResidentFrames));
+    mNumSamples = numResidentFrames * mAudioProperties.channelCount;
+    return true;
+}
+
+int32_t StreamingSampleBuffer::readFrames(int32_t frameIndex, float *buff, int32_t numFrames) {
+    if (mReader == nullptr || frameIndex >= mNumFrames) {
+        return 0;
+    }
+    numFrames = std::min(numFrames, mNumFrames - frameIndex);
+    mReader->positionToFrame(frameIndex);
+    int32_t numFramesRead = std::max(0, mReader->getDataFloat(buff, numFrames));
+
+    // Start paging in the next block while the caller is busy with this one.
+    mStream->willNeed(mStream->getPos(), numFrames * mBytesPerFrame);
+    return numFramesRead;
+}
+
+} // namespace iolib
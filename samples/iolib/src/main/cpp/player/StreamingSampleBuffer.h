@@ -0,0 +1,75 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_STREAMINGSAMPLEBUFFER_
+#define _PLAYER_STREAMINGSAMPLEBUFFER_
+
+#include <memory>
+
+#include <stream/MappedInputStream.h>
+#include <wav/WavStreamReader.h>
+
+#include "SampleBuffer.h"
+
+namespace iolib {
+
+/**
+ * A SampleBuffer that keeps only the first part (the "head") of a WAV file in memory.
+ * The rest of the file stays on disk and is read on demand by a StreamingSampleSource.
+ *
+ * getSampleData() and getNumSamples() describe the resident head only. The head is always
+ * held as SampleFormat::Float.
+ *
+ * The data is not resampled, so the file should be at the sample rate of the output stream.
+ */
+class StreamingSampleBuffer : public SampleBuffer {
+public:
+    StreamingSampleBuffer();
+    virtual ~StreamingSampleBuffer();
+
+    /**
+     * Parses the WAV file open on fd and loads the first residentMillis of audio.
+     * The file handle may be closed once this returns.
+     * @return true if the file could be mapped and parsed.
+     */
+    bool open(int fd, int32_t residentMillis);
+
+    /** Number of frames in the whole file. */
+    int32_t getNumFrames() const { return mNumFrames; }
+
+    /** Number of frames that are held in memory. */
+    int32_t getNumResidentFrames() const {
+        return mAudioProperties.channelCount > 0 ? mNumSamples / mAudioProperties.channelCount : 0;
+    }
+
+    /**
+     * Reads and converts frames from disk, starting at frameIndex.
+     * This may block on I/O so it must only be called from the streaming thread.
+     * @return the number of frames read.
+     */
+    int32_t readFrames(int32_t frameIndex, float *buff, int32_t numFrames);
+
+private:
+    std::unique_ptr<parselib::MappedInputStream> mStream;
+    std::unique_ptr<parselib::WavStreamReader> mReader;
+
+    int32_t mNumFrames;
+    int32_t mBytesPerFrame;
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_STREAMINGSAMPLEBUFFER_
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "StreamingSampleSource.h"
+
+namespace iolib {
+
+// Frames read from disk at a time.
+constexpr int32_t kDiskBlockFrames = 4096;
+// Frames taken from the ring at a time in the callback.
+constexpr int32_t kReadBlockFrames = 256;
+
+StreamingSampleSource::StreamingSampleSource(StreamingSampleBuffer *sampleBuffer, float pan,
+                                             int32_t ringMillis)
+        : SampleSource(sampleBuffer, pan)
+        , mStreamingBuffer(sampleBuffer)
+        , mNumFrames(sampleBuffer->getNumFrames())
+        , mNumResidentFrames(sampleBuffer->getNumResidentFrames())
+        , mChannelCount(std::max(1, sampleBuffer->getProperties().channelCount))
+        , mRing(mChannelCount * sizeof(float),
+                std::max<int32_t>(2 * kDiskBlockFrames,
+                        (int32_t) (((int64_t) ringMillis
+                                * sampleBuffer->getProperties().sampleRate) / 1000)))
+        , mReadBuffer(new float[kReadBlockFrames * mChannelCount])
+        , mRingFrame(-1)
+        , mSeekGeneration(0)
+        , mSkipPending(false)
+        , mDiskBuffer(new float[kDiskBlockFrames * mChannelCount])
+        , mDiskFrame(mNumFrames)
+        , mSeekServiced(0)
+        , mSeekFrame(0)
+        , mSeekRequest(0)
+        , mSeekAck(0)
+        , mSegmentStart(0)
+        , mUnderrunCount(0) {
+    // Prime the ring with the frames after the head.
+    syncRing(0);
+}
+
+void StreamingSampleSource::setPlayHeadPosition(int32_t position) {
+    if (position >= 0 && position < mNumFrames * mChannelCount) {
+        mCurSampleIndex = position - (position % mChannelCount);
+    }
+}
+
+void StreamingSampleSource::requestSeek(int32_t frameIndex) {
+    mSeekGeneration++;
+    mSeekFrame.store(frameIndex, std::memory_order_relaxed);
+    mSeekRequest.store(mSeekGeneration, std::memory_order_release);
+    mRingFrame = frameIndex;
+    mSkipPending = true;
+}
+
+void StreamingSampleSource::syncRing(int32_t frameIndex) {
+    int32_t nextRingFrame = std::max(frameIndex, mNumResidentFrames);
+    if (nextRingFrame < mNumFrames && nextRingFrame != mRingFrame) {
+        requestSeek(nextRingFrame);
+    }
+    if (mSkipPending && mSeekAck.load(std::memory_order_acquire) == mSeekGeneration) {
+        // Drop whatever was written before the seek was serviced.
+        mRing.setReadCounter(mSegmentStart.load(std::memory_order_relaxed));
+        mSkipPending = false;
+    }
+}
+
+void StreamingSampleSource::mixAudio(float* outBuff, int numChannels, int32_t numFrames) {
+    const float* head = mSampleBuffer->getSampleData();
+    int32_t frameIndex = mCurSampleIndex / mChannelCount;
+    int32_t framesProcessed = 0;
+
+    bool isLoopMode = mIsLoopMode;
+
+    while (framesProcessed < numFrames && mIsPlaying) {
+        syncRing(frameIndex);
+
+        int32_t framesLeft = numFrames - framesProcessed;
+        float* dst = outBuff + (framesProcessed * numChannels);
+        int32_t numMixFrames;
+        if (frameIndex < mNumResidentFrames) {
+            numMixFrames = std::min(framesLeft, mNumResidentFrames - frameIndex);
+            mixFrames(head + (frameIndex * mChannelCount), mChannelCount,
+                      dst, numChannels, numMixFrames);
+        } else {
+            numMixFrames = 0;
+            if (!mSkipPending) {
+                numMixFrames = std::min({framesLeft, mNumFrames - frameIndex, kReadBlockFrames,
+                                         (int32_t) mRing.getFullFramesAvailable()});
+            }
+            if (numMixFrames <= 0) {
+                // The streaming thread has fallen behind. Hold the position and play silence.
+                mUnderrunCount++;
+                break;
+            }
+            mRing.read(mReadBuffer.get(), numMixFrames);
+            mixFrames(mReadBuffer.get(), mChannelCount, dst, numChannels, numMixFrames);
+            mRingFrame += numMixFrames;
+        }
+
+        framesProcessed += numMixFrames;
+        frameIndex += numMixFrames;
+        if (frameIndex >= mNumFrames) {
+            if (isLoopMode) {
+                frameIndex = 0;
+            } else {
+                mIsPlaying = false;
+            }
+        }
+    }
+    mCurSampleIndex = frameIndex * mChannelCount;
+
+    if (!mIsPlaying) {
+        // Get ready for the next trigger.
+        syncRing(0);
+    }
+}
+
+bool StreamingSampleSource::fillRing() {
+    uint32_t request = mSeekRequest.load(std::memory_order_acquire);
+    if (request != mSeekServiced) {
+        mDiskFrame = mSeekFrame.load(std::memory_order_relaxed);
+        mSeekServiced = request;
+        // Anything already in the ring precedes the new data.
+        mSegmentStart.store(mRing.getWriteCounter(), std::memory_order_relaxed);
+        mSeekAck.store(request, std::memory_order_release);
+    }
+
+    int32_t framesLeft = mNumFrames - mDiskFrame;
+    if (framesLeft <= 0) {
+        return false;
+    }
+    // Wait until a whole block fits, so the disk is read in reasonably large pieces.
+    int32_t numFrames = std::min(framesLeft, kDiskBlockFrames);
+    uint32_t framesEmpty = mRing.getBufferCapacityInFrames() - mRing.getFullFramesAvailable();
+    if ((int32_t) framesEmpty < numFrames) {
+        return false;
+    }
+
+    int32_t numFramesRead = mStreamingBuffer->readFrames(mDiskFrame, mDiskBuffer.get(), numFrames);
+    if (numFramesRead <= 0) {
+        // Truncated file. Stop here rather than reading the same block over and over.
+        mDiskFrame = mNumFrames;
+        return false;
+    }
+    mRing.write(mDiskBuffer.get(), numFramesRead);
+    mDiskFrame += numFramesRead;
+    return true;
+}
+
+} // namespace iolib
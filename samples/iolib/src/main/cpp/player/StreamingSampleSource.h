@@ -0,0 +1,101 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_STREAMINGSAMPLESOURCE_
+#define _PLAYER_STREAMINGSAMPLESOURCE_
+
+#include <atomic>
+#include <memory>
+
+#include <oboe/FifoBuffer.h>
+
+#include "SampleSource.h"
+#include "StreamingSampleBuffer.h"
+
+namespace iolib {
+
+/**
+ * A SampleSource that plays a StreamingSampleBuffer.
+ *
+ * The resident head of the sample is played straight from memory, so a trigger sounds
+ * immediately. Meanwhile a DiskStreamer thread fills a lock-free ring with the frames
+ * that follow the head. mixAudio() never blocks or allocates. If the ring has not been
+ * filled in time it outputs silence and counts an underrun.
+ *
+ * The audio callback is the only reader of the ring and the streaming thread is the only
+ * writer. When the play head jumps (a retrigger, a loop or setPlayHeadPosition()) the callback
+ * posts a seek request. The streaming thread acknowledges it with the ring position where
+ * the new data begins, and the callback skips any stale frames before it.
+ */
+class StreamingSampleSource: public SampleSource {
+public:
+    static constexpr int32_t kDefaultRingMillis = 500;
+
+    StreamingSampleSource(StreamingSampleBuffer *sampleBuffer, float pan,
+                          int32_t ringMillis = kDefaultRingMillis);
+    virtual ~StreamingSampleSource() {};
+
+    virtual void mixAudio(float* outBuff, int numChannels, int32_t numFrames) override;
+
+    /**
+     * Unlike the other sources the position may be anywhere in the file, not just in the
+     * resident part.
+     */
+    virtual void setPlayHeadPosition(int32_t position) override;
+
+    /**
+     * Reads the next block from disk into the ring. Only called from the streaming thread.
+     * @return true if a block was read, false if there is nothing to do at the moment.
+     */
+    bool fillRing();
+
+    /** Number of times mixAudio() ran out of streamed data. */
+    int32_t getUnderrunCount() const { return mUnderrunCount; }
+
+private:
+    // Make sure the ring will deliver the frames needed after this one. Callback only.
+    void syncRing(int32_t frameIndex);
+    void requestSeek(int32_t frameIndex);
+
+    StreamingSampleBuffer *mStreamingBuffer;
+    const int32_t mNumFrames;
+    const int32_t mNumResidentFrames;
+    const int32_t mChannelCount;
+
+    oboe::FifoBuffer mRing;
+
+    // Used only by the callback
+    std::unique_ptr<float[]> mReadBuffer;
+    int32_t mRingFrame;         // frame in the file that the next ring frame belongs to
+    uint32_t mSeekGeneration;   // last seek requested
+    bool mSkipPending;          // waiting for the acknowledgement of mSeekGeneration
+
+    // Used only by the streaming thread
+    std::unique_ptr<float[]> mDiskBuffer;
+    int32_t mDiskFrame;         // next frame to read from disk
+    uint32_t mSeekServiced;
+
+    // Shared
+    std::atomic<int32_t> mSeekFrame;
+    std::atomic<uint32_t> mSeekRequest;
+    std::atomic<uint32_t> mSeekAck;
+    std::atomic<uint64_t> mSegmentStart; // ring write counter when mSeekAck was serviced
+    std::atomic<int32_t> mUnderrunCount;
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_STREAMINGSAMPLESOURCE_
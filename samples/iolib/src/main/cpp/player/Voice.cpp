@@ -0,0 +1,95 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "Voice.h"
+
+namespace iolib {
+
+// Samples looked at by getLevel().
+constexpr int32_t kLevelWindowSamples = 256;
+
+void Voice::start(SampleSource* pad, int32_t padIndex, int64_t startOrder) {
+    mSampleBuffer = pad->getSampleBuffer();
+    mPadIndex = padIndex;
+    mStartOrder = startOrder;
+    mFadeFramesLeft = 0;
+
+    followPad(pad);
+    // A new voice should hit at full level, not ramp up from the last one.
+    resetGainRamp();
+    setPlayMode();
+}
+
+void Voice::followPad(SampleSource* pad) {
+    if (mFadeFramesLeft > 0) {
+        return;
+    }
+    if (pad->getGain() != mGain) {
+        setGain(pad->getGain());
+    }
+    if (pad->getPan() != mPan) {
+        setPan(pad->getPan());
+    }
+    mIsLoopMode = pad->isLoopMode();
+}
+
+void Voice::release() {
+    if (mIsPlaying && mFadeFramesLeft == 0) {
+        // mixFrames() ramps to the new gain over kGainRampFrames.
+        setGain(0.0f);
+        mFadeFramesLeft = kGainRampFrames;
+    }
+}
+
+float Voice::getLevel() const {
+    if (!mIsPlaying || mSampleBuffer == nullptr) {
+        return 0.0f;
+    }
+
+    float samples[kLevelWindowSamples];
+    int32_t numSamples = std::min(kLevelWindowSamples,
+                                  mSampleBuffer->getNumSamples() - mCurSampleIndex);
+    if (numSamples <= 0) {
+        return 0.0f;
+    }
+    mSampleBuffer->getSamplesFloat(mCurSampleIndex, samples, numSamples);
+
+    float peak = 0.0f;
+    for (int32_t index = 0; index < numSamples; index++) {
+        peak = std::max(peak, std::abs(samples[index]));
+    }
+    return peak * std::abs(mGain);
+}
+
+void Voice::mixAudio(float* outBuff, int numChannels, int32_t numFrames) {
+    if (mFadeFramesLeft == 0) {
+        OneShotSampleSource::mixAudio(outBuff, numChannels, numFrames);
+        return;
+    }
+
+    // Play out the rest of the fade, then stop.
+    int32_t numFadeFrames = std::min(numFrames, mFadeFramesLeft);
+    OneShotSampleSource::mixAudio(outBuff, numChannels, numFadeFrames);
+    mFadeFramesLeft -= numFadeFrames;
+    if (mFadeFramesLeft == 0) {
+        setStopMode();
+    }
+}
+
+} // namespace iolib
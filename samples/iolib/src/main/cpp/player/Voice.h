@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_VOICE_
+#define _PLAYER_VOICE_
+
+#include "OneShotSampleSource.h"
+
+namespace iolib {
+
+/**
+ * One playing instance of a sample, owned by a VoicePool.
+ * A voice takes its sample, gain, pan and loop mode from the SampleSource ("pad")
+ * that triggered it, so the same sample can sound several times at once.
+ * All methods are called from the audio thread.
+ */
+class Voice: public OneShotSampleSource {
+public:
+    Voice() : OneShotSampleSource(nullptr, PAN_CENTER),
+              mPadIndex(-1), mStartOrder(0), mFadeFramesLeft(0) {};
+    virtual ~Voice() {};
+
+    /**
+     * Starts playing the pad's sample from the beginning, at the pad's gain without a ramp.
+     */
+    void start(SampleSource* pad, int32_t padIndex, int64_t startOrder);
+
+    /**
+     * Picks up changes to the pad's gain, pan and loop mode. Ignored while fading out.
+     */
+    void followPad(SampleSource* pad);
+
+    /**
+     * Fades out over kGainRampFrames, then stops.
+     */
+    void release();
+
+    bool isReleasing() const { return mFadeFramesLeft > 0; }
+    int32_t getPadIndex() const { return mPadIndex; }
+    int64_t getStartOrder() const { return mStartOrder; }
+    int32_t getFadeFramesLeft() const { return mFadeFramesLeft; }
+
+    /**
+     * Estimates how loud the voice is about to be: the peak of the next few frames
+     * of the sample, scaled by the gain. Used to pick a voice to steal.
+     */
+    float getLevel() const;
+
+    void mixAudio(float* outBuff, int numChannels, int32_t numFrames) override;
+
+private:
+    int32_t mPadIndex;
+    int64_t mStartOrder;
+    int32_t mFadeFramesLeft;
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_VOICE_
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "VoicePool.h"
+
+namespace iolib {
+
+VoicePool::VoicePool(int32_t maxPolyphony, StealMode stealMode)
+  : mMaxPolyphony(std::max(1, maxPolyphony)),
+    mStealMode(stealMode),
+    mNextStartOrder(0),
+    mNumActiveVoices(0),
+    mNumStolenVoices(0) {
+    int32_t numVoices = mMaxPolyphony + kNumFadeVoices;
+    mVoices.reserve(numVoices);
+    mActiveVoices.reserve(numVoices);
+    mFreeVoices.reserve(numVoices);
+    for (int32_t index = 0; index < numVoices; index++) {
+        mVoices.push_back(std::make_unique<Voice>());
+        mFreeVoices.push_back(mVoices.back().get());
+    }
+}
+
+void VoicePool::release(int32_t padIndex) {
+    for (Voice* voice : mActiveVoices) {
+        if (voice->getPadIndex() == padIndex) {
+            voice->release();
+        }
+    }
+}
+
+void VoicePool::releaseAll() {
+    for (Voice* voice : mActiveVoices) {
+        voice->release();
+    }
+}
+
+void VoicePool::mixAudio(float* outBuff, int numChannels, int32_t numFrames,
+                         const std::vector<SampleSource*>& pads, int32_t numPads) {
+    for (int32_t activeIndex = 0; activeIndex < (int32_t) mActiveVoices.size();) {
+        Voice* voice = mActiveVoices[activeIndex];
+        if (voice->getPadIndex() < numPads) {
+            voice->followPad(pads[voice->getPadIndex()]);
+            voice->mixAudio(outBuff, numChannels, numFrames);
+        } else {
+            voice->setStopMode();
+        }
+        if (voice->isPlaying()) {
+            activeIndex++;
+        } else {
+            freeVoice(activeIndex);
+        }
+    }
+
+    mNumActiveVoices = (int32_t) mActiveVoices.size();
+}
+
+void VoicePool::reset() {
+    while (!mActiveVoices.empty()) {
+        mActiveVoices.back()->setStopMode();
+        freeVoice((int32_t) mActiveVoices.size() - 1);
+    }
+    mNumActiveVoices = 0;
+}
+
+void VoicePool::trigger(SampleSource* pad, int32_t padIndex) {
+    if (pad->getSampleBuffer() == nullptr || pad->getSampleBuffer()->getNumSamples() == 0) {
+        return;
+    }
+
+    int32_t numSounding = 0;
+    for (Voice* voice : mActiveVoices) {
+        if (!voice->isReleasing()) {
+            numSounding++;
+        }
+    }
+    if (numSounding >= mMaxPolyphony) {
+        Voice* victim = chooseVictim();
+        if (victim != nullptr) {
+            victim->release();
+            mNumStolenVoices++;
+        }
+    }
+
+    if (mFreeVoices.empty()) {
+        // Every spare voice is still fading. Cut the one nearest to the end of its fade.
+        int32_t cutIndex = 0;
+        for (int32_t activeIndex = 0; activeIndex < (int32_t) mActiveVoices.size(); activeIndex++) {
+            Voice* voice = mActiveVoices[activeIndex];
+            if (voice->isReleasing() && (!mActiveVoices[cutIndex]->isReleasing()
+                    || voice->getFadeFramesLeft()
+                            < mActiveVoices[cutIndex]->getFadeFramesLeft())) {
+                cutIndex = activeIndex;
+            }
+        }
+        mActiveVoices[cutIndex]->setStopMode();
+        freeVoice(cutIndex);
+    }
+
+    Voice* voice = mFreeVoices.back();
+    mFreeVoices.pop_back();
+    voice->start(pad, padIndex, mNextStartOrder++);
+    mActiveVoices.push_back(voice);
+}
+
+Voice* VoicePool::chooseVictim() {
+    Voice* victim = nullptr;
+    float victimLevel = 0.0f;
+    for (Voice* voice : mActiveVoices) {
+        if (voice->isReleasing()) {
+            continue;
+        }
+        if (mStealMode == StealMode::Quietest) {
+            // Ties go to the oldest voice.
+            float level = voice->getLevel();
+            if (victim == nullptr || level < victimLevel
+                    || (level == victimLevel
+                        && voice->getStartOrder() < victim->getStartOrder())) {
+                victim = voice;
+                victimLevel = level;
+            }
+        } else if (victim == nullptr || voice->getStartOrder() < victim->getStartOrder()) {
+            victim = voice;
+        }
+    }
+    return victim;
+}
+
+void VoicePool::freeVoice(int32_t activeIndex) {
+    // The order of the active list does not matter, so swap in the last one.
+    mFreeVoices.push_back(mActiveVoices[activeIndex]);
+    mActiveVoices[activeIndex] = mActiveVoices.back();
+    mActiveVoices.pop_back();
+}
+
+} // namespace iolib
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PLAYER_VOICEPOOL_
+#define _PLAYER_VOICEPOOL_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Voice.h"
+
+namespace iolib {
+
+/**
+ * A fixed set of Voices that play the samples of some number of SampleSources ("pads").
+ *
+ * Every method is called from the audio thread, or while the callback is not running.
+ * SimpleMultiPlayer feeds it from its CommandQueue. Only the voices that are playing are
+ * visited, so the cost of a callback follows the number of sounding voices, not the number
+ * of loaded samples.
+ *
+ * When all maxPolyphony voices are busy a trigger steals one, either the oldest or the
+ * quietest. The stolen voice fades out over SampleSource::kGainRampFrames while the new
+ * one starts on one of a few spare voices kept for fades.
+ */
+class VoicePool {
+public:
+    enum class StealMode {
+        Oldest,     // the voice that started first
+        Quietest,   // the voice with the lowest level, see Voice::getLevel()
+    };
+
+    // Extra voices that let stolen voices fade out while the new ones start
+    static constexpr int32_t kNumFadeVoices = 4;
+
+    VoicePool(int32_t maxPolyphony, StealMode stealMode = StealMode::Oldest);
+
+    /**
+     * Starts a voice for the pad, stealing one if maxPolyphony voices are sounding.
+     */
+    void trigger(SampleSource* pad, int32_t padIndex);
+    /** Fades out the voices of one pad. */
+    void release(int32_t padIndex);
+    void releaseAll();
+
+    /**
+     * Mixes every playing voice into the output. Does not allocate or lock.
+     */
+    void mixAudio(float* outBuff, int numChannels, int32_t numFrames,
+                  const std::vector<SampleSource*>& pads, int32_t numPads);
+
+    /**
+     * Stops all voices at once. Only call this when the audio callback is not running.
+     */
+    void reset();
+
+    int32_t getMaxPolyphony() const { return mMaxPolyphony; }
+    StealMode getStealMode() const { return mStealMode; }
+
+    /** Voices playing at the end of the last callback, including those fading out. */
+    int32_t getNumActiveVoices() const { return mNumActiveVoices; }
+    /** Voices stolen so far. */
+    int32_t getNumStolenVoices() const { return mNumStolenVoices; }
+
+private:
+    Voice* chooseVictim();
+    void freeVoice(int32_t activeIndex);
+
+    const int32_t mMaxPolyphony;
+    const StealMode mStealMode;
+
+    std::vector<std::unique_ptr<Voice>> mVoices;
+    // Both lists have room for every voice, so they never allocate. Audio thread only.
+    std::vector<Voice*> mActiveVoices;
+    std::vector<Voice*> mFreeVoices;
+    int64_t mNextStartOrder;
+
+    std::atomic<int32_t> mNumActiveVoices;
+    std::atomic<int32_t> mNumStolenVoices;
+};
+
+} // namespace iolib
+
+#endif //_PLAYER_VOICEPOOL_
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IOLIB_TESTS_TEST_PLAYER_H
+#define IOLIB_TESTS_TEST_PLAYER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <stream/MemInputStream.h>
+#include <wav/WavStreamReader.h>
+
+#include "OneShotSampleSource.h"
+#include "SimpleMultiPlayer.h"
+#include "WavTestFiles.h"
+
+/** Loads a makeTestWav() sample into buffer. */
+inline void loadTestSample(iolib::SampleBuffer &buffer, int32_t channelCount, int32_t sampleRate,
+                           int32_t numFrames,
+                           iolib::SampleFormat format = iolib::SampleFormat::Float) {
+    std::vector<uint8_t> wav = makeTestWav(channelCount, sampleRate, numFrames);
+    parselib::MemInputStream stream(wav.data(), (int32_t) wav.size());
+    parselib::WavStreamReader reader(&stream);
+    reader.parse();
+    buffer.loadSampleData(&reader, format);
+}
+
+/**
+ * A SimpleMultiPlayer whose callback is run by the test rather than by the stream.
+ * The stream is a SimulatedAudioStream that is opened but never started, so every block
+ * is rendered on the test thread and the results do not depend on timing.
+ */
+class TestPlayer : public iolib::SimpleMultiPlayer {
+public:
+    static constexpr int32_t kChannelCount = 2;
+
+    TestPlayer() {
+        setupAudioStream(kChannelCount);
+    }
+
+    ~TestPlayer() {
+        teardownAudioStream();
+        unloadSampleData();
+    }
+
+    /** Runs the data callback once, as the stream would, and returns the interleaved output. */
+    std::vector<float> render(int32_t numFrames) {
+        std::vector<float> output(numFrames * kChannelCount);
+        mDataCallback->onAudioReady(mAudioStream.get(), output.data(), numFrames);
+        return output;
+    }
+
+    /** Adds a mono makeTestWav() sample at the stream rate, panned center. */
+    void addTestSample(int32_t numFrames) {
+        auto *buffer = new iolib::SampleBuffer();
+        loadTestSample(*buffer, 1, getSampleRate(), numFrames);
+        addSampleSource(new iolib::OneShotSampleSource(buffer, iolib::SampleSource::PAN_CENTER),
+                        buffer);
+    }
+
+    using iolib::SimpleMultiPlayer::postCommand;
+
+    int32_t getNumSources() const { return mNumSampleBuffers; }
+
+    iolib::SampleSource* getSource(int32_t index) { return mSampleSources[index]; }
+};
+
+#endif // IOLIB_TESTS_TEST_PLAYER_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IOLIB_TESTS_WAV_TEST_FILES_H
+#define IOLIB_TESTS_WAV_TEST_FILES_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Builds small 16-bit WAV files in memory or in a temporary file for the tests.
+ * Sample n of the file is makeTestSample(n), so any frame can be checked by position.
+ */
+
+inline int16_t makeTestSample(int32_t sampleIndex) {
+    // Never zero, so a sample of silence is never mistaken for data.
+    return (int16_t) ((sampleIndex % 30000) + 1);
+}
+
+inline float testSampleToFloat(int32_t sampleIndex) {
+    return (float) makeTestSample(sampleIndex) * (1.0f / 32768.0f);
+}
+
+inline void appendLittleEndian(std::vector<uint8_t> &data, uint32_t value, int numBytes) {
+    for (int i = 0; i < numBytes; i++) {
+        data.push_back((uint8_t) (value >> (8 * i)));
+    }
+}
+
+inline std::vector<uint8_t> makeTestWav(int32_t channelCount, int32_t sampleRate,
+                                        int32_t numFrames) {
+    const int32_t numDataBytes = numFrames * channelCount * 2;
+    std::vector<uint8_t> wav;
+    wav.insert(wav.end(), {'R', 'I', 'F', 'F'});
+    appendLittleEndian(wav, 36 + numDataBytes, 4);
+    wav.insert(wav.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    appendLittleEndian(wav, 16, 4);
+    appendLittleEndian(wav, 1, 2); // PCM
+    appendLittleEndian(wav, channelCount, 2);
+    appendLittleEndian(wav, sampleRate, 4);
+    appendLittleEndian(wav, sampleRate * channelCount * 2, 4);
+    appendLittleEndian(wav, channelCount * 2, 2);
+    appendLittleEndian(wav, 16, 2);
+    wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+    appendLittleEndian(wav, numDataBytes, 4);
+    for (int32_t i = 0; i < numFrames * channelCount; i++) {
+        appendLittleEndian(wav, (uint16_t) makeTestSample(i), 2);
+    }
+    return wav;
+}
+
+/**
+ * A WAV file in the temporary directory, deleted by the destructor.
+ */
+class TestWavFile {
+public:
+    TestWavFile(int32_t channelCount, int32_t sampleRate, int32_t numFrames) {
+        std::vector<uint8_t> wav = makeTestWav(channelCount, sampleRate, numFrames);
+        mFd = mkstemp(mPath);
+        if (mFd >= 0 && write(mFd, wav.data(), wav.size()) != (ssize_t) wav.size()) {
+            close(mFd);
+            mFd = -1;
+        }
+    }
+
+    ~TestWavFile() {
+        if (mFd >= 0) {
+            close(mFd);
+        }
+        unlink(mPath);
+    }
+
+    int getFd() const {
+        return mFd;
+    }
+
+private:
+    char mPath[32] = "/tmp/testIolibXXXXXX";
+    int  mFd = -1;
+};
+
+#endif // IOLIB_TESTS_WAV_TEST_FILES_H
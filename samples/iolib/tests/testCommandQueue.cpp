@@ -0,0 +1,175 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test CommandQueue and how SimpleMultiPlayer applies its commands
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "CommandQueue.h"
+#include "TestPlayer.h"
+
+using namespace iolib;
+
+namespace {
+
+constexpr int32_t kCapacity = 16;
+constexpr int32_t kNumFrames = 4800;
+constexpr int32_t kBlockFrames = 256;
+constexpr int64_t kFarFuture = 1000000000;
+
+PlayerCommand makeCommand(int32_t index, int64_t frame) {
+    return { PlayerCommand::Type::Trigger, index, 0.0f, frame };
+}
+
+} // namespace
+
+TEST(TestCommandQueue, PopsInFrameThenPostingOrder) {
+    CommandQueue queue(kCapacity);
+    ASSERT_TRUE(queue.post(makeCommand(0, 200)));
+    ASSERT_TRUE(queue.post(makeCommand(1, 100)));
+    ASSERT_TRUE(queue.post(makeCommand(2, 200)));
+    ASSERT_TRUE(queue.post(makeCommand(3, PlayerCommand::kImmediate)));
+    queue.collect();
+
+    PlayerCommand command;
+    std::vector<int32_t> order;
+    while (queue.popDue(150, command)) {
+        order.push_back(command.index);
+    }
+    EXPECT_EQ((std::vector<int32_t>{ 3, 1 }), order);
+    while (queue.popDue(300, command)) {
+        order.push_back(command.index);
+    }
+    EXPECT_EQ((std::vector<int32_t>{ 3, 1, 0, 2 }), order);
+}
+
+TEST(TestCommandQueue, TimedCommandsLeaveRoomForImmediate) {
+    CommandQueue queue(kCapacity);
+    const int32_t numReserved = kCapacity / CommandQueue::kImmediateReserveDivisor;
+    for (int32_t i = 0; i < kCapacity - numReserved; i++) {
+        ASSERT_TRUE(queue.post(makeCommand(i, kFarFuture)));
+    }
+    EXPECT_FALSE(queue.post(makeCommand(-1, kFarFuture)));
+    for (int32_t i = 0; i < numReserved; i++) {
+        ASSERT_TRUE(queue.post(makeCommand(100 + i, PlayerCommand::kImmediate)));
+    }
+    EXPECT_FALSE(queue.post(makeCommand(-1, PlayerCommand::kImmediate)));
+
+    // The immediate commands get past the sequence waiting in the pending list.
+    queue.collect();
+    PlayerCommand command;
+    for (int32_t i = 0; i < numReserved; i++) {
+        ASSERT_TRUE(queue.popDue(0, command));
+        EXPECT_EQ(100 + i, command.index);
+    }
+    EXPECT_FALSE(queue.popDue(0, command));
+
+    // Popping makes room again.
+    EXPECT_TRUE(queue.post(makeCommand(200, PlayerCommand::kImmediate)));
+}
+
+TEST(TestCommandQueue, ClearDropsEverything) {
+    CommandQueue queue(kCapacity);
+    for (int32_t i = 0; i < kCapacity / 2; i++) {
+        ASSERT_TRUE(queue.post(makeCommand(i, i)));
+    }
+    queue.collect();
+    for (int32_t i = 0; i < kCapacity / 4; i++) {
+        ASSERT_TRUE(queue.post(makeCommand(i, i)));
+    }
+    queue.clear();
+    EXPECT_EQ(0, queue.getNumPending());
+
+    // The whole capacity is free again.
+    for (int32_t i = 0; i < kCapacity; i++) {
+        ASSERT_TRUE(queue.post(makeCommand(i, PlayerCommand::kImmediate)));
+    }
+    queue.collect();
+    EXPECT_EQ(kCapacity, queue.getNumPending());
+}
+
+TEST(TestPlayerCommands, TimedTriggerLandsOnItsFrame) {
+    TestPlayer player;
+    player.addTestSample(kNumFrames);
+    constexpr int32_t kTriggerFrame = 100;
+    ASSERT_TRUE(player.triggerAt(0, kTriggerFrame));
+
+    std::vector<float> output = player.render(kBlockFrames);
+    for (int32_t frame = 0; frame < kTriggerFrame; frame++) {
+        ASSERT_EQ(0.0f, output[frame * TestPlayer::kChannelCount]) << "frame " << frame;
+    }
+    EXPECT_NE(0.0f, output[kTriggerFrame * TestPlayer::kChannelCount]);
+    EXPECT_EQ(kBlockFrames, player.getFramePosition());
+}
+
+TEST(TestPlayerCommands, ChangesApplyAtOnceWhileStopped) {
+    TestPlayer player;
+    player.addTestSample(kNumFrames);
+
+    // Far more than the queue holds, as a volume slider would send with the stream paused.
+    constexpr int32_t kNumChanges = CommandQueue::kDefaultCapacity * 4;
+    for (int32_t i = 0; i < kNumChanges; i++) {
+        ASSERT_TRUE(player.setGainAt(0, (float) i / kNumChanges, PlayerCommand::kImmediate))
+                << "change " << i;
+    }
+    EXPECT_EQ((float) (kNumChanges - 1) / kNumChanges, player.getSource(0)->getGain());
+
+    player.triggerDown(0);
+    EXPECT_TRUE(player.getSource(0)->isPlaying());
+    player.resetAll();
+    EXPECT_FALSE(player.getSource(0)->isPlaying());
+}
+
+TEST(TestPlayerCommands, PauseKeepsPlaceAndResumeContinues) {
+    TestPlayer player;
+    player.addTestSample(kNumFrames);
+    player.triggerDown(0);
+    player.render(kBlockFrames);
+    const int32_t playHead = player.getSource(0)->getPlayHeadPosition();
+    ASSERT_GT(playHead, 0);
+
+    player.postCommand(PlayerCommand::Type::Pause, 0, 0.0f, PlayerCommand::kImmediate);
+    EXPECT_FALSE(player.getSource(0)->isPlaying());
+    EXPECT_EQ(playHead, player.getSource(0)->getPlayHeadPosition());
+
+    player.postCommand(PlayerCommand::Type::Resume, 0, 0.0f, PlayerCommand::kImmediate);
+    EXPECT_TRUE(player.getSource(0)->isPlaying());
+    std::vector<float> output = player.render(1);
+    // Center pan puts half of the mono sample in each channel.
+    EXPECT_FLOAT_EQ(0.5f * testSampleToFloat(playHead), output[0]);
+}
+
+TEST(TestPlayerCommands, UnloadDropsQueuedCommands) {
+    TestPlayer player;
+    player.addTestSample(kNumFrames);
+    player.render(kBlockFrames);
+    ASSERT_TRUE(player.triggerAt(0, kBlockFrames * 2));
+
+    player.unloadSampleData();
+    EXPECT_EQ(0, player.getFramePosition());
+
+    // The trigger was for the old sample 0, so the new one stays quiet.
+    player.addTestSample(kNumFrames);
+    for (int32_t i = 0; i < 4; i++) {
+        player.render(kBlockFrames);
+    }
+    EXPECT_FALSE(player.getSource(0)->isPlaying());
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test the MixKernels against scalar code, and the gain ramp of SampleSource
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "MixKernels.h"
+#include "OneShotSampleSource.h"
+#include "TestPlayer.h"
+
+using namespace iolib;
+
+namespace {
+
+// Long enough for several vectors plus every remainder, at every misalignment.
+constexpr int32_t kMaxFrames = 37;
+constexpr int32_t kMaxOffset = 4;
+constexpr float kTolerance = 1.0e-6f;
+
+constexpr float kGainStart = 0.9f;
+constexpr float kGainEnd = -0.3f;
+constexpr float kRightStart = 0.2f;
+constexpr float kRightEnd = 1.1f;
+
+// The gain the kernels are documented to use for frame i of numFrames.
+float rampGain(float gainStart, float gainEnd, int32_t i, int32_t numFrames) {
+    return gainStart + (gainEnd - gainStart) * (float) (i + 1) / (float) numFrames;
+}
+
+std::vector<float> makeSignal(int32_t numSamples, float scale) {
+    std::vector<float> signal(numSamples);
+    for (int32_t i = 0; i < numSamples; i++) {
+        signal[i] = scale * std::sin(0.37f * (float) i + scale);
+    }
+    return signal;
+}
+
+void expectNear(const std::vector<float> &expected, const std::vector<float> &actual,
+                const char *kernel, int32_t numFrames, int32_t offset) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_NEAR(expected[i], actual[i], kTolerance)
+                << kernel << " numFrames " << numFrames << " offset " << offset
+                << " sample " << i;
+    }
+}
+
+} // namespace
+
+TEST(TestMixKernels, MixGainMatchesScalar) {
+    for (int32_t offset = 0; offset < kMaxOffset; offset++) {
+        for (int32_t numSamples = 1; numSamples <= kMaxFrames; numSamples++) {
+            std::vector<float> src = makeSignal(numSamples + offset, 0.5f);
+            std::vector<float> actual = makeSignal(numSamples + offset, 0.25f);
+            std::vector<float> expected = actual;
+            for (int32_t i = 0; i < numSamples; i++) {
+                expected[offset + i] += src[offset + i]
+                        * rampGain(kGainStart, kGainEnd, i, numSamples);
+            }
+            MixKernels::mixGain(actual.data() + offset, src.data() + offset, numSamples,
+                                kGainStart, kGainEnd);
+            expectNear(expected, actual, "mixGain", numSamples, offset);
+        }
+    }
+}
+
+TEST(TestMixKernels, AccumulateMatchesScalar) {
+    for (int32_t offset = 0; offset < kMaxOffset; offset++) {
+        for (int32_t numSamples = 1; numSamples <= kMaxFrames; numSamples++) {
+            std::vector<float> src = makeSignal(numSamples + offset, 0.5f);
+            std::vector<float> actual = makeSignal(numSamples + offset, 0.25f);
+            std::vector<float> expected = actual;
+            for (int32_t i = 0; i < numSamples; i++) {
+                expected[offset + i] += src[offset + i];
+            }
+            MixKernels::accumulate(actual.data() + offset, src.data() + offset, numSamples);
+            expectNear(expected, actual, "accumulate", numSamples, offset);
+        }
+    }
+}
+
+TEST(TestMixKernels, MixStereoMatchesScalar) {
+    for (int32_t offset = 0; offset < kMaxOffset; offset++) {
+        for (int32_t numFrames = 1; numFrames <= kMaxFrames; numFrames++) {
+            std::vector<float> src = makeSignal(numFrames * 2 + offset, 0.5f);
+            std::vector<float> actual = makeSignal(numFrames * 2 + offset, 0.25f);
+            std::vector<float> expected = actual;
+            for (int32_t i = 0; i < numFrames; i++) {
+                expected[offset + i * 2] += src[offset + i * 2]
+                        * rampGain(kGainStart, kGainEnd, i, numFrames);
+                expected[offset + i * 2 + 1] += src[offset + i * 2 + 1]
+                        * rampGain(kRightStart, kRightEnd, i, numFrames);
+            }
+            MixKernels::mixStereo(actual.data() + offset, src.data() + offset, numFrames,
+                                  kGainStart, kRightStart, kGainEnd, kRightEnd);
+            expectNear(expected, actual, "mixStereo", numFrames, offset);
+        }
+    }
+}
+
+TEST(TestMixKernels, MixMonoToStereoMatchesScalar) {
+    for (int32_t offset = 0; offset < kMaxOffset; offset++) {
+        for (int32_t numFrames = 1; numFrames <= kMaxFrames; numFrames++) {
+            std::vector<float> src = makeSignal(numFrames + offset, 0.5f);
+            std::vector<float> actual = makeSignal(numFrames * 2 + offset, 0.25f);
+            std::vector<float> expected = actual;
+            for (int32_t i = 0; i < numFrames; i++) {
+                expected[offset + i * 2] += src[offset + i]
+                        * rampGain(kGainStart, kGainEnd, i, numFrames);
+                expected[offset + i * 2 + 1] += src[offset + i]
+                        * rampGain(kRightStart, kRightEnd, i, numFrames);
+            }
+            MixKernels::mixMonoToStereo(actual.data() + offset, src.data() + offset, numFrames,
+                                        kGainStart, kRightStart, kGainEnd, kRightEnd);
+            expectNear(expected, actual, "mixMonoToStereo", numFrames, offset);
+        }
+    }
+}
+
+TEST(TestMixKernels, MixStereoToMonoMatchesScalar) {
+    for (int32_t offset = 0; offset < kMaxOffset; offset++) {
+        for (int32_t numFrames = 1; numFrames <= kMaxFrames; numFrames++) {
+            std::vector<float> src = makeSignal(numFrames * 2 + offset, 0.5f);
+            std::vector<float> actual = makeSignal(numFrames + offset, 0.25f);
+            std::vector<float> expected = actual;
+            for (int32_t i = 0; i < numFrames; i++) {
+                expected[offset + i] +=
+                        src[offset + i * 2] * rampGain(kGainStart, kGainEnd, i, numFrames)
+                        + src[offset + i * 2 + 1]
+                        * rampGain(kRightStart, kRightEnd, i, numFrames);
+            }
+            MixKernels::mixStereoToMono(actual.data() + offset, src.data() + offset, numFrames,
+                                        kGainStart, kRightStart, kGainEnd, kRightEnd);
+            expectNear(expected, actual, "mixStereoToMono", numFrames, offset);
+        }
+    }
+}
+
+/**
+ * A change of gain is ramped in over SampleSource::kGainRampFrames, however the callbacks
+ * split those frames up.
+ */
+TEST(TestSampleSourceRamp, GainRampsOverRampFrames) {
+    constexpr int32_t kSampleRate = 48000;
+    constexpr int32_t kNumFrames = 1024;
+    constexpr float kNewGain = 0.25f;
+    const int32_t blockSizes[] = { 1, 50, 128, 192, 256 };
+
+    for (int32_t blockFrames : blockSizes) {
+        SampleBuffer buffer;
+        loadTestSample(buffer, 1, kSampleRate, kNumFrames);
+        OneShotSampleSource source(&buffer, SampleSource::PAN_CENTER);
+        source.setPlayMode();
+        source.setGain(kNewGain);
+
+        std::vector<float> output(kNumFrames, 0.0f);
+        for (int32_t frame = 0; frame < kNumFrames; frame += blockFrames) {
+            source.mixAudio(output.data() + frame, 1, std::min(blockFrames, kNumFrames - frame));
+        }
+
+        for (int32_t frame = 0; frame < kNumFrames; frame++) {
+            float gain = frame < SampleSource::kGainRampFrames
+                    ? rampGain(1.0f, kNewGain, frame, SampleSource::kGainRampFrames)
+                    : kNewGain;
+            ASSERT_NEAR(testSampleToFloat(frame) * gain, output[frame], kTolerance)
+                    << "block " << blockFrames << " frame " << frame;
+        }
+    }
+}
+
+TEST(TestSampleSourceRamp, PanRampsOverRampFrames) {
+    constexpr int32_t kSampleRate = 48000;
+    constexpr int32_t kNumFrames = 512;
+    constexpr int32_t kBlockFrames = 96;
+
+    SampleBuffer buffer;
+    loadTestSample(buffer, 1, kSampleRate, kNumFrames);
+    OneShotSampleSource source(&buffer, SampleSource::PAN_CENTER);
+    source.setPlayMode();
+    source.setPan(SampleSource::PAN_HARDRIGHT);
+
+    std::vector<float> output(kNumFrames * 2, 0.0f);
+    for (int32_t frame = 0; frame < kNumFrames; frame += kBlockFrames) {
+        source.mixAudio(output.data() + frame * 2, 2, std::min(kBlockFrames, kNumFrames - frame));
+    }
+
+    // Center sends half to each side, hard right sends everything right.
+    for (int32_t frame = 0; frame < kNumFrames; frame++) {
+        bool ramping = frame < SampleSource::kGainRampFrames;
+        float left = ramping ? rampGain(0.5f, 0.0f, frame, SampleSource::kGainRampFrames) : 0.0f;
+        float right = ramping ? rampGain(0.5f, 1.0f, frame, SampleSource::kGainRampFrames) : 1.0f;
+        ASSERT_NEAR(testSampleToFloat(frame) * left, output[frame * 2], kTolerance)
+                << "frame " << frame;
+        ASSERT_NEAR(testSampleToFloat(frame) * right, output[frame * 2 + 1], kTolerance)
+                << "frame " << frame;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test SampleBankLoader and SimpleMultiPlayer::addSampleBank()
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "SampleBankLoader.h"
+#include "TestPlayer.h"
+#include "WavTestFiles.h"
+
+using namespace iolib;
+
+namespace {
+
+constexpr int32_t kNumFrames = 1000;
+constexpr int32_t kRenderFrames = 256;
+
+// Sum of the absolute samples of one channel of a stereo block.
+float channelEnergy(const std::vector<float>& output, int32_t channel) {
+    float sum = 0.0f;
+    for (size_t i = channel; i < output.size(); i += TestPlayer::kChannelCount) {
+        sum += output[i] < 0.0f ? -output[i] : output[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST(TestSampleBank, BadFileKeepsPadIndices) {
+    TestPlayer player;
+    ASSERT_GT(player.getSampleRate(), 0);
+
+    std::vector<uint8_t> goodWav = makeTestWav(1, player.getSampleRate(), kNumFrames);
+    std::vector<uint8_t> badWav(64, 'x');
+
+    SampleBankLoader loader(2);
+    loader.addFile(goodWav.data(), (int32_t) goodWav.size());
+    loader.addFile(badWav.data(), (int32_t) badWav.size());
+    loader.addFile(goodWav.data(), (int32_t) goodWav.size());
+
+    const std::vector<float> pans = { SampleSource::PAN_HARDLEFT, SampleSource::PAN_CENTER,
+                                      SampleSource::PAN_HARDRIGHT };
+    EXPECT_EQ(2, player.addSampleBank(loader, pans));
+
+    // The bad file still has a pad, so the one after it keeps its index and pan.
+    ASSERT_EQ(3, player.getNumSources());
+    EXPECT_EQ(SampleSource::PAN_HARDLEFT, player.getPan(0));
+    EXPECT_EQ(SampleSource::PAN_CENTER, player.getPan(1));
+    EXPECT_EQ(SampleSource::PAN_HARDRIGHT, player.getPan(2));
+
+    player.triggerDown(2);
+    std::vector<float> output = player.render(kRenderFrames);
+    EXPECT_EQ(0.0f, channelEnergy(output, 0));
+    EXPECT_GT(channelEnergy(output, 1), 0.0f);
+}
+
+TEST(TestSampleBank, PlaceholderIsSilentAndStops) {
+    TestPlayer player;
+    std::vector<uint8_t> badWav(64, 'x');
+    SampleBankLoader loader(1);
+    loader.addFile(badWav.data(), (int32_t) badWav.size());
+    EXPECT_EQ(0, player.addSampleBank(loader));
+    ASSERT_EQ(1, player.getNumSources());
+
+    player.triggerDown(0);
+    std::vector<float> output = player.render(kRenderFrames);
+    EXPECT_EQ(0.0f, channelEnergy(output, 0));
+    EXPECT_EQ(0.0f, channelEnergy(output, 1));
+    EXPECT_FALSE(player.getSource(0)->isPlaying());
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test the sample formats of SampleBuffer
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <resampler/MultiChannelResampler.h>
+
+#include "SampleBuffer.h"
+#include "TestPlayer.h"
+
+using namespace iolib;
+using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kNumFrames = 1000;
+constexpr int32_t kChannelCount = 2;
+// The test samples are 16-bit, so every format holds them exactly.
+constexpr float kOneLsb16 = 1.0f / 32768.0f;
+
+void loadInFormat(SampleBuffer &buffer, SampleFormat format, int32_t sampleRate) {
+    loadTestSample(buffer, kChannelCount, sampleRate, kNumFrames, format);
+}
+
+class SampleFormatTest : public ::testing::TestWithParam<SampleFormat> {};
+
+} // namespace
+
+TEST_P(SampleFormatTest, OnlyTheCurrentFormatHasData) {
+    const SampleFormat format = GetParam();
+    SampleBuffer buffer;
+    loadInFormat(buffer, format, kSampleRate);
+    ASSERT_EQ(format, buffer.getSampleFormat());
+    ASSERT_EQ(kNumFrames * kChannelCount, buffer.getNumSamples());
+
+    EXPECT_EQ(format == SampleFormat::Float, buffer.getSampleData() != nullptr);
+    EXPECT_EQ(format == SampleFormat::I16, buffer.getSampleData16() != nullptr);
+    EXPECT_EQ(format == SampleFormat::I24In32, buffer.getSampleData24In32() != nullptr);
+}
+
+TEST_P(SampleFormatTest, GetSamplesFloatConverts) {
+    SampleBuffer buffer;
+    loadInFormat(buffer, GetParam(), kSampleRate);
+
+    std::vector<float> samples(buffer.getNumSamples());
+    buffer.getSamplesFloat(0, samples.data(), buffer.getNumSamples());
+    for (int32_t i = 0; i < buffer.getNumSamples(); i++) {
+        ASSERT_EQ(testSampleToFloat(i), samples[i]) << "sample " << i;
+    }
+
+    // Any range, as OneShotSampleSource reads it a chunk at a time.
+    constexpr int32_t kStart = 333;
+    constexpr int32_t kCount = 77;
+    std::vector<float> range(kCount);
+    buffer.getSamplesFloat(kStart, range.data(), kCount);
+    for (int32_t i = 0; i < kCount; i++) {
+        ASSERT_EQ(testSampleToFloat(kStart + i), range[i]) << "sample " << kStart + i;
+    }
+}
+
+TEST_P(SampleFormatTest, ResampleKeepsFormat) {
+    constexpr int32_t kFileRate = 44100;
+    SampleBuffer floatBuffer;
+    loadInFormat(floatBuffer, SampleFormat::Float, kFileRate);
+    floatBuffer.resampleData(kSampleRate);
+
+    SampleBuffer buffer;
+    loadInFormat(buffer, GetParam(), kFileRate);
+    buffer.resampleData(kSampleRate);
+    EXPECT_EQ(GetParam(), buffer.getSampleFormat());
+    EXPECT_EQ(kSampleRate, buffer.getProperties().sampleRate);
+    ASSERT_EQ(floatBuffer.getNumSamples(), buffer.getNumSamples());
+
+    // The compact formats only round the resampled data to their own resolution.
+    std::vector<float> expected(floatBuffer.getNumSamples());
+    std::vector<float> actual(buffer.getNumSamples());
+    floatBuffer.getSamplesFloat(0, expected.data(), floatBuffer.getNumSamples());
+    buffer.getSamplesFloat(0, actual.data(), buffer.getNumSamples());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_NEAR(expected[i], actual[i], kOneLsb16) << "sample " << i;
+    }
+}
+
+TEST_P(SampleFormatTest, ResampleInBlocksMatchesOnePass) {
+    // Longer than the blocks SampleBuffer resamples in, both up and down.
+    constexpr int32_t kLongFrames = 10000;
+    for (int32_t fileRate : {44100, 96000}) {
+        SampleBuffer buffer;
+        loadTestSample(buffer, kChannelCount, fileRate, kLongFrames, GetParam());
+        buffer.resampleData(kSampleRate);
+
+        // Run the whole file through a resampler one frame at a time.
+        std::unique_ptr<MultiChannelResampler> resampler(MultiChannelResampler::make(
+                kChannelCount, fileRate, kSampleRate, MultiChannelResampler::Quality::Medium));
+        std::vector<float> expected;
+        std::vector<float> frame(kChannelCount);
+        int32_t inputFrame = 0;
+        while (inputFrame < kLongFrames) {
+            if (resampler->isWriteNeeded()) {
+                for (int32_t channel = 0; channel < kChannelCount; channel++) {
+                    frame[channel] = testSampleToFloat(inputFrame * kChannelCount + channel);
+                }
+                resampler->writeNextFrame(frame.data());
+                inputFrame++;
+            } else {
+                resampler->readNextFrame(frame.data());
+                expected.insert(expected.end(), frame.begin(), frame.end());
+            }
+        }
+
+        ASSERT_EQ(static_cast<int32_t>(expected.size()), buffer.getNumSamples())
+                << "from " << fileRate;
+        std::vector<float> actual(buffer.getNumSamples());
+        buffer.getSamplesFloat(0, actual.data(), buffer.getNumSamples());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT_NEAR(expected[i], actual[i], kOneLsb16) << "from " << fileRate
+                                                           << ", sample " << i;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TestSampleBuffer, SampleFormatTest,
+                         ::testing::Values(SampleFormat::Float, SampleFormat::I16,
+                                           SampleFormat::I24In32));
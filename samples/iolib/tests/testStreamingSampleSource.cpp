@@ -0,0 +1,168 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test StreamingSampleSource and DiskStreamer
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DiskStreamer.h"
+#include "StreamingSampleBuffer.h"
+#include "StreamingSampleSource.h"
+#include "WavTestFiles.h"
+
+using namespace iolib;
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kResidentMillis = 20; // 960 frames
+constexpr int32_t kBurstFrames = 192;
+
+// Plays one burst into a cleared mono buffer.
+std::vector<float> playBurst(StreamingSampleSource &source) {
+    std::vector<float> output(kBurstFrames, 0.0f);
+    source.mixAudio(output.data(), 1, kBurstFrames);
+    return output;
+}
+
+} // namespace
+
+TEST(TestStreamingSampleSource, PlaysHeadThenRing) {
+    constexpr int32_t kNumFrames = kSampleRate; // one second, much longer than the head
+    TestWavFile file(1, kSampleRate, kNumFrames);
+    StreamingSampleBuffer buffer;
+    ASSERT_TRUE(buffer.open(file.getFd(), kResidentMillis));
+    ASSERT_EQ(kNumFrames, buffer.getNumFrames());
+    ASSERT_EQ(kResidentMillis * kSampleRate / 1000, buffer.getNumResidentFrames());
+
+    StreamingSampleSource source(&buffer, 0.0f);
+    source.setPlayMode();
+    int32_t frame = 0;
+    while (source.isPlaying()) {
+        // Refill before every burst, so the ring never runs dry.
+        while (source.fillRing()) {}
+        std::vector<float> output = playBurst(source);
+        for (int32_t i = 0; i < kBurstFrames && frame < kNumFrames; i++, frame++) {
+            ASSERT_EQ(testSampleToFloat(frame), output[i]) << "frame " << frame;
+        }
+    }
+    EXPECT_EQ(kNumFrames, frame);
+    EXPECT_EQ(0, source.getUnderrunCount());
+}
+
+TEST(TestStreamingSampleSource, UnderrunHoldsPositionThenResumes) {
+    constexpr int32_t kNumFrames = kSampleRate;
+    TestWavFile file(1, kSampleRate, kNumFrames);
+    StreamingSampleBuffer buffer;
+    ASSERT_TRUE(buffer.open(file.getFd(), kResidentMillis));
+    const int32_t numResidentFrames = buffer.getNumResidentFrames();
+
+    StreamingSampleSource source(&buffer, 0.0f);
+    source.setPlayMode();
+    // Play the head and then past it without ever filling the ring.
+    int32_t frame = 0;
+    while (frame + kBurstFrames <= numResidentFrames) {
+        playBurst(source);
+        frame += kBurstFrames;
+    }
+    std::vector<float> output = playBurst(source);
+    const int32_t headFramesLeft = numResidentFrames - frame;
+    for (int32_t i = headFramesLeft; i < kBurstFrames; i++) {
+        EXPECT_EQ(0.0f, output[i]) << "frame " << i << " should be silent";
+    }
+    EXPECT_EQ(1, source.getUnderrunCount());
+    EXPECT_EQ(numResidentFrames, source.getPlayHeadPosition());
+    EXPECT_TRUE(source.isPlaying());
+
+    // A second starved burst is all silence and does not move the play head.
+    output = playBurst(source);
+    for (float sample : output) {
+        EXPECT_EQ(0.0f, sample);
+    }
+    EXPECT_EQ(2, source.getUnderrunCount());
+    EXPECT_EQ(numResidentFrames, source.getPlayHeadPosition());
+
+    // Once the ring is refilled it continues from the first frame after the head.
+    while (source.fillRing()) {}
+    output = playBurst(source);
+    for (int32_t i = 0; i < kBurstFrames; i++) {
+        ASSERT_EQ(testSampleToFloat(numResidentFrames + i), output[i]) << "frame " << i;
+    }
+    EXPECT_EQ(2, source.getUnderrunCount());
+}
+
+TEST(TestStreamingSampleSource, DiskStreamerKeepsUpWithPlayback) {
+    constexpr int32_t kNumFrames = 2 * kSampleRate;
+    TestWavFile file(1, kSampleRate, kNumFrames);
+    StreamingSampleBuffer buffer;
+    ASSERT_TRUE(buffer.open(file.getFd(), kResidentMillis));
+
+    StreamingSampleSource source(&buffer, 0.0f);
+    DiskStreamer streamer(1);
+    streamer.addSource(&source);
+    // Give the thread time to prime the ring, as a sample would be loaded before it is played.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    source.setPlayMode();
+    int32_t frame = 0;
+    bool matched = true;
+    while (source.isPlaying()) {
+        std::vector<float> output = playBurst(source);
+        for (int32_t i = 0; i < kBurstFrames && frame < kNumFrames; i++, frame++) {
+            matched = matched && (output[i] == testSampleToFloat(frame));
+        }
+        // Play at about 4x real time. The 500 ms ring covers any scheduling delays.
+        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    }
+    streamer.removeSource(&source);
+
+    EXPECT_EQ(kNumFrames, frame);
+    EXPECT_EQ(0, source.getUnderrunCount());
+    EXPECT_TRUE(matched);
+}
+
+TEST(TestStreamingSampleSource, RemoveSourceWhileStreaming) {
+    constexpr int32_t kNumSources = 4;
+    TestWavFile file(2, kSampleRate, 4 * kSampleRate);
+    std::vector<std::unique_ptr<StreamingSampleBuffer>> buffers;
+    std::vector<std::unique_ptr<StreamingSampleSource>> sources;
+    for (int32_t i = 0; i < kNumSources; i++) {
+        buffers.push_back(std::make_unique<StreamingSampleBuffer>());
+        ASSERT_TRUE(buffers.back()->open(file.getFd(), kResidentMillis));
+    }
+
+    DiskStreamer streamer(1);
+    for (int32_t round = 0; round < 20; round++) {
+        for (int32_t i = 0; i < kNumSources; i++) {
+            sources.push_back(std::make_unique<StreamingSampleSource>(buffers[i].get(), 0.0f));
+            streamer.addSource(sources.back().get());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Each source may be deleted as soon as it is removed, even mid-read.
+        for (auto &source : sources) {
+            streamer.removeSource(source.get());
+            source.reset();
+        }
+        sources.clear();
+    }
+    streamer.stop();
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test VoicePool and the polyphony of SimpleMultiPlayer
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "OneShotSampleSource.h"
+#include "SampleBuffer.h"
+#include "TestPlayer.h"
+#include "VoicePool.h"
+
+using namespace iolib;
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kNumFrames = kSampleRate; // long enough to never end during a test
+constexpr int32_t kChannelCount = 2;
+constexpr int32_t kBlockFrames = 192;
+
+/**
+ * Three pads on one mono sample. Pads 0 and 2 are hard left at full gain,
+ * pad 1 is hard right and quiet. So the right channel shows whether pad 1 is still playing.
+ */
+class VoicePoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        loadTestSample(mBuffer, 1, kSampleRate, kNumFrames);
+
+        const float pans[] = { SampleSource::PAN_HARDLEFT, SampleSource::PAN_HARDRIGHT,
+                               SampleSource::PAN_HARDLEFT };
+        for (float pan : pans) {
+            mSources.push_back(std::make_unique<OneShotSampleSource>(&mBuffer, pan));
+            mPads.push_back(mSources.back().get());
+        }
+        mPads[1]->setGain(0.1f);
+    }
+
+    // Mixes one block and returns the sum of the absolute samples of each channel.
+    std::vector<float> mixBlock(VoicePool &pool) {
+        std::vector<float> output(kBlockFrames * kChannelCount, 0.0f);
+        pool.mixAudio(output.data(), kChannelCount, kBlockFrames, mPads, (int32_t) mPads.size());
+        std::vector<float> energy(kChannelCount, 0.0f);
+        for (int32_t i = 0; i < kBlockFrames * kChannelCount; i++) {
+            energy[i % kChannelCount] += output[i] < 0.0f ? -output[i] : output[i];
+        }
+        return energy;
+    }
+
+    // Mixes past the fade of any stolen or released voice.
+    void mixPastFade(VoicePool &pool) {
+        for (int32_t frames = 0; frames <= SampleSource::kGainRampFrames; frames += kBlockFrames) {
+            mixBlock(pool);
+        }
+    }
+
+    SampleBuffer mBuffer;
+    std::vector<std::unique_ptr<OneShotSampleSource>> mSources;
+    std::vector<SampleSource*> mPads;
+};
+
+} // namespace
+
+TEST_F(VoicePoolTest, StealsOldest) {
+    VoicePool pool(2, VoicePool::StealMode::Oldest);
+    pool.trigger(mPads[1], 1);
+    mixBlock(pool);
+    pool.trigger(mPads[0], 0);
+    mixBlock(pool);
+    pool.trigger(mPads[2], 2);
+    EXPECT_EQ(1, pool.getNumStolenVoices());
+
+    // The stolen voice fades out on a spare voice while the new one starts.
+    mixPastFade(pool);
+    EXPECT_EQ(2, pool.getNumActiveVoices());
+
+    // Pad 1 was the first to start, so it was the one stolen.
+    std::vector<float> energy = mixBlock(pool);
+    EXPECT_GT(energy[0], 0.0f);
+    EXPECT_EQ(0.0f, energy[1]);
+}
+
+TEST_F(VoicePoolTest, StealsQuietest) {
+    VoicePool pool(2, VoicePool::StealMode::Quietest);
+    pool.trigger(mPads[0], 0);
+    mixBlock(pool);
+    pool.trigger(mPads[1], 1);
+    mixBlock(pool);
+    pool.trigger(mPads[2], 2);
+    EXPECT_EQ(1, pool.getNumStolenVoices());
+    mixPastFade(pool);
+    EXPECT_EQ(2, pool.getNumActiveVoices());
+
+    // Pad 1 is the quietest, so it goes even though pad 0 is older.
+    std::vector<float> energy = mixBlock(pool);
+    EXPECT_GT(energy[0], 0.0f);
+    EXPECT_EQ(0.0f, energy[1]);
+}
+
+TEST_F(VoicePoolTest, RetriggerStartsAnotherVoice) {
+    VoicePool pool(4);
+    pool.trigger(mPads[0], 0);
+    mixBlock(pool);
+    pool.trigger(mPads[0], 0);
+    mixBlock(pool);
+    EXPECT_EQ(2, pool.getNumActiveVoices());
+    EXPECT_EQ(0, pool.getNumStolenVoices());
+}
+
+TEST_F(VoicePoolTest, ReleaseFadesOut) {
+    VoicePool pool(4);
+    pool.trigger(mPads[0], 0);
+    pool.trigger(mPads[1], 1);
+    mixBlock(pool);
+    pool.release(1);
+    mixPastFade(pool);
+    EXPECT_EQ(1, pool.getNumActiveVoices());
+    std::vector<float> energy = mixBlock(pool);
+    EXPECT_GT(energy[0], 0.0f);
+    EXPECT_EQ(0.0f, energy[1]);
+
+    pool.releaseAll();
+    mixPastFade(pool);
+    EXPECT_EQ(0, pool.getNumActiveVoices());
+}
+
+TEST_F(VoicePoolTest, StealNeverExceedsFadeVoices) {
+    constexpr int32_t kMaxPolyphony = 2;
+    VoicePool pool(kMaxPolyphony);
+    // Many triggers in one block, each one steals.
+    for (int32_t i = 0; i < 20; i++) {
+        pool.trigger(mPads[i % 3], i % 3);
+    }
+    mixBlock(pool);
+    EXPECT_LE(pool.getNumActiveVoices(), kMaxPolyphony + VoicePool::kNumFadeVoices);
+    mixPastFade(pool);
+    EXPECT_EQ(kMaxPolyphony, pool.getNumActiveVoices());
+}
+
+TEST(TestPlayerPolyphony, RefusedWhileStarted) {
+    TestPlayer player;
+    EXPECT_TRUE(player.setMaxPolyphony(4));
+    EXPECT_EQ(4, player.getMaxPolyphony());
+
+    ASSERT_TRUE(player.startStream());
+    EXPECT_FALSE(player.setMaxPolyphony(8));
+    EXPECT_FALSE(player.setMaxPolyphony(0));
+    EXPECT_EQ(4, player.getMaxPolyphony());
+
+    player.teardownAudioStream();
+    EXPECT_TRUE(player.setMaxPolyphony(0));
+    EXPECT_EQ(0, player.getMaxPolyphony());
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measure how fast WAV sample data is decoded to float.
+ *
+ * For each encoding this times the bulk PcmDecoder kernel against a plain scalar loop,
+ * then loads a whole WAV file through WavStreamReader from memory, from a file
+ * and from a mapped file.
+ *
+ * Every kernel is first checked against the scalar loop, for short lengths that exercise
+ * the remainder code, for unaligned sources and for decoding in place. The WAV loads are
+ * checked too. Any difference fails the benchmark.
+ *
+ * Usage: benchmarkPcmDecode [--seconds N] [--repeats N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <unistd.h>
+#include <vector>
+
+#include "stream/FileInputStream.h"
+#include "stream/MappedInputStream.h"
+#include "stream/MemInputStream.h"
+#include "wav/AudioEncoding.h"
+#include "wav/PcmDecoder.h"
+#include "wav/WavStreamReader.h"
+
+using namespace parselib;
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kChannelCount = 2;
+
+struct EncodingInfo {
+    const char *name;
+    int encoding;
+    int16_t formatTag;
+    int16_t bitsPerSample;
+};
+
+const EncodingInfo kEncodings[] = {
+        {"PCM8",    AudioEncoding::PCM_8,           1, 8},
+        {"PCM16",   AudioEncoding::PCM_16,          1, 16},
+        {"PCM24",   AudioEncoding::PCM_24,          1, 24},
+        {"PCM32",   AudioEncoding::PCM_32,          1, 32},
+        {"Float32", AudioEncoding::PCM_IEEEFLOAT,   3, 32},
+        {"Float64", AudioEncoding::PCM_IEEEFLOAT64, 3, 64},
+};
+
+double nowSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the fastest of several runs, in seconds.
+double timeBest(int repeats, const std::function<void()> &work) {
+    double best = 1.0e9;
+    for (int i = 0; i < repeats; i++) {
+        double start = nowSeconds();
+        work();
+        best = std::min(best, nowSeconds() - start);
+    }
+    return best;
+}
+
+// The per-sample conversion WavStreamReader used before bulk decoding.
+void decodeScalar(int encoding, const uint8_t *src, float *dst, int32_t numSamples) {
+    switch (encoding) {
+        case AudioEncoding::PCM_8:
+            for (int32_t i = 0; i < numSamples; i++) {
+                dst[i] = ((float) src[i] - 128.0f) * (1.0f / 128.0f);
+            }
+            break;
+        case AudioEncoding::PCM_16:
+            for (int32_t i = 0; i < numSamples; i++) {
+                int16_t sample;
+                memcpy(&sample, src + (i * 2), sizeof(sample));
+                dst[i] = (float) sample * (1.0f / 32768.0f);
+            }
+            break;
+        case AudioEncoding::PCM_24:
+            for (int32_t i = 0; i < numSamples; i++) {
+                const uint8_t *bytes = src + (i * 3);
+                int32_t sample = (bytes[0] << 8) | (bytes[1] << 16) | (bytes[2] << 24);
+                dst[i] = (float) sample * (1.0f / (float) 0x80000000);
+            }
+            break;
+        case AudioEncoding::PCM_32:
+            for (int32_t i = 0; i < numSamples; i++) {
+                int32_t sample;
+                memcpy(&sample, src + (i * 4), sizeof(sample));
+                dst[i] = (float) sample * (1.0f / (float) 0x80000000);
+            }
+            break;
+        case AudioEncoding::PCM_IEEEFLOAT:
+            for (int32_t i = 0; i < numSamples; i++) {
+                memcpy(dst + i, src + (i * 4), sizeof(float));
+            }
+            break;
+        default:
+            for (int32_t i = 0; i < numSamples; i++) {
+                double sample;
+                memcpy(&sample, src + (i * 8), sizeof(sample));
+                dst[i] = (float) sample;
+            }
+            break;
+    }
+}
+
+// @return number of samples that differ from the scalar loop
+int32_t countMismatches(int encoding, const uint8_t *src, const float *actual,
+                        int32_t numSamples) {
+    std::vector<float> expected(numSamples);
+    decodeScalar(encoding, src, expected.data(), numSamples);
+    int32_t mismatches = 0;
+    for (int32_t i = 0; i < numSamples; i++) {
+        // Compare bits so that a NaN from a bad kernel is also caught.
+        if (memcmp(&expected[i], &actual[i], sizeof(float)) != 0) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/**
+ * Decode short blocks at every offset and length up to kMaxCheckSamples, out of place
+ * and in place, and compare them with the scalar loop.
+ * @return true if all of them match
+ */
+bool checkDecoder(const char *name, int encoding, int32_t bytesPerSample,
+                  const uint8_t *pcm) {
+    constexpr int32_t kMaxCheckSamples = 67;
+    constexpr int32_t kMaxOffset = 7;
+    PcmDecoder::DecodeFunction decode = PcmDecoder::getDecoder(encoding);
+    const bool canDecodeInPlace = bytesPerSample <= (int32_t) sizeof(float);
+    std::vector<float> output(kMaxCheckSamples);
+    for (int32_t offset = 0; offset <= kMaxOffset; offset++) {
+        const uint8_t *src = pcm + offset;
+        for (int32_t numSamples = 0; numSamples <= kMaxCheckSamples; numSamples++) {
+            decode(src, output.data(), numSamples);
+            if (countMismatches(encoding, src, output.data(), numSamples) > 0) {
+                fprintf(stderr, "ERROR: %s decode of %d samples at offset %d is wrong\n",
+                        name, numSamples, offset);
+                return false;
+            }
+            if (!canDecodeInPlace) continue;
+            // Put the source at the end of the destination, as WavStreamReader does.
+            uint8_t *end = reinterpret_cast<uint8_t *>(output.data() + numSamples);
+            uint8_t *inPlace = end - (numSamples * bytesPerSample);
+            memmove(inPlace, src, numSamples * bytesPerSample);
+            decode(inPlace, output.data(), numSamples);
+            if (countMismatches(encoding, src, output.data(), numSamples) > 0) {
+                fprintf(stderr, "ERROR: %s in place decode of %d samples is wrong\n",
+                        name, numSamples);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void appendBytes(std::vector<uint8_t> &data, uint32_t value, int numBytes) {
+    for (int i = 0; i < numBytes; i++) {
+        data.push_back((uint8_t) (value >> (8 * i)));
+    }
+}
+
+std::vector<uint8_t> makeWavFile(const EncodingInfo &info, int32_t numFrames) {
+    const int32_t bytesPerSample = info.bitsPerSample / 8;
+    const int32_t numDataBytes = numFrames * kChannelCount * bytesPerSample;
+    std::vector<uint8_t> wav;
+    wav.reserve(44 + numDataBytes);
+    wav.insert(wav.end(), {'R', 'I', 'F', 'F'});
+    appendBytes(wav, 36 + numDataBytes, 4);
+    wav.insert(wav.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    appendBytes(wav, 16, 4);
+    appendBytes(wav, info.formatTag, 2);
+    appendBytes(wav, kChannelCount, 2);
+    appendBytes(wav, kSampleRate, 4);
+    appendBytes(wav, kSampleRate * kChannelCount * bytesPerSample, 4);
+    appendBytes(wav, kChannelCount * bytesPerSample, 2);
+    appendBytes(wav, info.bitsPerSample, 2);
+    wav.insert(wav.end(), {'d', 'a', 't', 'a'});
+    appendBytes(wav, numDataBytes, 4);
+
+    uint32_t noise = 12345;
+    for (int32_t i = 0; i < numFrames * kChannelCount; i++) {
+        noise = noise * 1664525 + 1013904223; // LCG
+        double value = ((int32_t) noise) * (1.0 / 2147483648.0);
+        if (info.encoding == AudioEncoding::PCM_IEEEFLOAT) {
+            float sample = (float) value;
+            uint32_t bits;
+            memcpy(&bits, &sample, sizeof(bits));
+            appendBytes(wav, bits, 4);
+        } else if (info.encoding == AudioEncoding::PCM_IEEEFLOAT64) {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            appendBytes(wav, (uint32_t) bits, 4);
+            appendBytes(wav, (uint32_t) (bits >> 32), 4);
+        } else {
+            appendBytes(wav, noise >> (32 - info.bitsPerSample), bytesPerSample);
+        }
+    }
+    return wav;
+}
+
+void usage() {
+    printf("usage: benchmarkPcmDecode [--seconds N] [--repeats N]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t seconds = 60;
+    int repeats = 5;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(argv[i], "--repeats") == 0) {
+            repeats = std::max(1, atoi(argv[++i]));
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    const int32_t numFrames = seconds * kSampleRate;
+    const int32_t numSamples = numFrames * kChannelCount;
+    std::vector<float> output(numSamples);
+    char path[] = "/tmp/benchmarkPcmDecodeXXXXXX";
+
+    printf("benchmarkPcmDecode: %d seconds of %d channel audio, best of %d, MSamples/s\n",
+           seconds, kChannelCount, repeats);
+    printf("%-8s %10s %10s %8s %10s %10s %10s\n",
+           "encoding", "scalar", "bulk", "speedup", "mem", "file", "mapped");
+    bool passed = true;
+    for (const EncodingInfo &info : kEncodings) {
+        std::vector<uint8_t> wav = makeWavFile(info, numFrames);
+        const uint8_t *pcm = wav.data() + 44;
+        PcmDecoder::DecodeFunction decode = PcmDecoder::getDecoder(info.encoding);
+        passed = checkDecoder(info.name, info.encoding, info.bitsPerSample / 8, pcm) && passed;
+        // Each check below decodes the whole file, so report it once and keep timing.
+        auto checkOutput = [&](const char *method) {
+            int32_t mismatches = countMismatches(info.encoding, pcm, output.data(), numSamples);
+            if (mismatches > 0) {
+                fprintf(stderr, "ERROR: %s %s has %d samples that differ from scalar\n",
+                        info.name, method, mismatches);
+                passed = false;
+            }
+        };
+
+        double scalarTime = timeBest(repeats, [&]() {
+            decodeScalar(info.encoding, pcm, output.data(), numSamples);
+        });
+        double bulkTime = timeBest(repeats, [&]() {
+            decode(pcm, output.data(), numSamples);
+        });
+        checkOutput("bulk");
+        double memTime = timeBest(repeats, [&]() {
+            MemInputStream stream(wav.data(), (int32_t) wav.size());
+            WavStreamReader reader(&stream);
+            reader.parse();
+            reader.getDataFloat(output.data(), reader.getNumSampleFrames());
+        });
+        checkOutput("mem");
+
+        int fd = mkstemp(path);
+        if (fd < 0 || write(fd, wav.data(), wav.size()) != (ssize_t) wav.size()) {
+            fprintf(stderr, "ERROR: could not write %s\n", path);
+            return EXIT_FAILURE;
+        }
+        double fileTime = timeBest(repeats, [&]() {
+            lseek(fd, 0, SEEK_SET);
+            FileInputStream stream(fd);
+            WavStreamReader reader(&stream);
+            reader.parse();
+            reader.getDataFloat(output.data(), reader.getNumSampleFrames());
+        });
+        checkOutput("file");
+        double mappedTime = timeBest(repeats, [&]() {
+            MappedInputStream stream(fd);
+            WavStreamReader reader(&stream);
+            reader.parse();
+            reader.getDataFloat(output.data(), reader.getNumSampleFrames());
+        });
+        checkOutput("mapped");
+        close(fd);
+        unlink(path);
+        strcpy(path + strlen(path) - 6, "XXXXXX");
+
+        const double megaSamples = numSamples * 1.0e-6;
+        printf("%-8s %10.1f %10.1f %7.1fx %10.1f %10.1f %10.1f\n", info.name,
+               megaSamples / scalarTime, megaSamples / bulkTime, scalarTime / bulkTime,
+               megaSamples / memTime, megaSamples / fileTime, megaSamples / mappedTime);
+    }
+    if (!passed) {
+        fprintf(stderr, "ERROR: a bulk decoder does not match the scalar loop\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
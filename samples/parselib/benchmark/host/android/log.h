@@ -0,0 +1,31 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PARSELIB_HOST_ANDROID_LOG_H
+#define PARSELIB_HOST_ANDROID_LOG_H
+
+// Lets parselib build on a Linux host for benchmarking. Logs go to stderr.
+#include <cstdio>
+
+#define ANDROID_LOG_INFO    "I"
+#define ANDROID_LOG_WARN    "W"
+#define ANDROID_LOG_ERROR   "E"
+
+#define __android_log_print(priority, tag, ...) \
+        (fprintf(stderr, "%s/%s: ", priority, tag), \
+         fprintf(stderr, __VA_ARGS__), \
+         fputc('\n', stderr))
+
+#endif // PARSELIB_HOST_ANDROID_LOG_H
@@ -25,7 +25,9 @@ int32_t FileInputStream::read(void *buff, int32_t numBytes) {
 
 int32_t FileInputStream::peek(void *buff, int32_t numBytes) {
     int32_t numRead = ::read(mFH, buff, numBytes);
-    ::lseek(mFH, -numBytes, SEEK_CUR);
+    if (numRead > 0) {
+        ::lseek(mFH, -numRead, SEEK_CUR);
+    }
     return numRead;
 }
 
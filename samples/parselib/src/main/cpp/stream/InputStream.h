@@ -56,6 +56,16 @@ public:
      * Sets the read position of the stream to the 0 or positive position.
      */
     virtual void setPos(int32_t pos) = 0;
+
+    /**
+     * Returns a pointer to the data at the read position if the whole stream is resident
+     * in memory, or nullptr if it must be read(). DOES NOT advance the read position.
+     * numBytesAvailable receives the number of bytes that can be accessed through the pointer.
+     */
+    virtual const uint8_t *peekDirect(int32_t *numBytesAvailable) {
+        *numBytesAvailable = 0;
+        return nullptr;
+    }
 };
 
 } // namespace parselib
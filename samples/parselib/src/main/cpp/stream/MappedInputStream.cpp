@@ -0,0 +1,95 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <climits>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedInputStream.h"
+
+namespace parselib {
+
+MappedInputStream::MappedInputStream(int fh) : mBuffer(nullptr), mBufferLen(0), mPos(0) {
+    struct stat fileStat;
+    if (::fstat(fh, &fileStat) != 0 || fileStat.st_size <= 0 || fileStat.st_size > INT32_MAX) {
+        return;
+    }
+    void *address = ::mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fh, 0);
+    if (address == MAP_FAILED) {
+        return;
+    }
+    mBuffer = static_cast<uint8_t *>(address);
+    mBufferLen = static_cast<int32_t>(fileStat.st_size);
+}
+
+MappedInputStream::~MappedInputStream() {
+    if (mBuffer != nullptr) {
+        ::munmap(mBuffer, mBufferLen);
+    }
+}
+
+void MappedInputStream::willNeed(int32_t pos, int32_t numBytes) {
+    if (mBuffer == nullptr || pos < 0 || pos >= mBufferLen || numBytes <= 0) {
+        return;
+    }
+    // madvise() needs a page aligned address.
+    const uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(mBuffer + pos) & ~(pageSize - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(mBuffer + pos)
+            + std::min(numBytes, mBufferLen - pos);
+    ::madvise(reinterpret_cast<void *>(start), end - start, MADV_WILLNEED);
+}
+
+int32_t MappedInputStream::read(void *buff, int32_t numBytes) {
+    numBytes = peek(buff, numBytes);
+    mPos += numBytes;
+    return numBytes;
+}
+
+int32_t MappedInputStream::peek(void *buff, int32_t numBytes) {
+    int32_t numAvail = mBufferLen - mPos;
+    numBytes = std::max(0, std::min(numBytes, numAvail));
+    if (numBytes > 0) {
+        memcpy(buff, mBuffer + mPos, numBytes);
+    }
+    return numBytes;
+}
+
+void MappedInputStream::advance(int32_t numBytes) {
+    if (numBytes > 0) {
+        int32_t numAvail = mBufferLen - mPos;
+        mPos += std::min(numAvail, numBytes);
+    }
+}
+
+int32_t MappedInputStream::getPos() {
+    return mPos;
+}
+
+void MappedInputStream::setPos(int32_t pos) {
+    if (pos >= 0) {
+        mPos = std::min(pos, mBufferLen);
+    }
+}
+
+const uint8_t *MappedInputStream::peekDirect(int32_t *numBytesAvailable) {
+    *numBytesAvailable = mBufferLen - mPos;
+    return (mBuffer != nullptr) ? mBuffer + mPos : nullptr;
+}
+
+} // namespace parselib
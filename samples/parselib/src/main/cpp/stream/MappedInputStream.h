@@ -0,0 +1,76 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _IO_STREAM_MAPPEDINPUTSTREAM_H_
+#define _IO_STREAM_MAPPEDINPUTSTREAM_H_
+
+#include "InputStream.h"
+
+namespace parselib {
+
+/**
+ * A concrete implementation of InputStream for a file that is mapped into memory.
+ * Reads are served from the page cache without a system call, and peekDirect() gives
+ * zero-copy access to the file contents.
+ */
+class MappedInputStream : public InputStream {
+public:
+    /**
+     * constructor. Caller is presumed to have opened the file with (at least) read permission.
+     * The file handle may be closed once the stream has been constructed.
+     */
+    MappedInputStream(int fh);
+    virtual ~MappedInputStream();
+
+    MappedInputStream(const MappedInputStream &) = delete;
+    MappedInputStream &operator=(const MappedInputStream &) = delete;
+
+    /** Returns true if the file was mapped. */
+    bool isValid() { return mBuffer != nullptr; }
+
+    /** Returns the size of the mapped file in bytes. */
+    int32_t getLength() { return mBufferLen; }
+
+    /**
+     * Asks the kernel to start paging in the specified range, e.g. ahead of streaming it.
+     */
+    void willNeed(int32_t pos, int32_t numBytes);
+
+    virtual int32_t read(void *buff, int32_t numBytes);
+
+    virtual int32_t peek(void *buff, int32_t numBytes);
+
+    virtual void advance(int32_t numBytes);
+
+    virtual int32_t getPos();
+
+    virtual void setPos(int32_t pos);
+
+    virtual const uint8_t *peekDirect(int32_t *numBytesAvailable);
+
+private:
+    /** Start of the mapping, or nullptr if the file could not be mapped. */
+    uint8_t *mBuffer;
+
+    /** Total number of bytes in the mapping */
+    int32_t mBufferLen;
+
+    /** The index of the next byte to read */
+    int32_t mPos;
+};
+
+} // namespace parselib
+
+#endif // _IO_STREAM_MAPPEDINPUTSTREAM_H_
@@ -57,4 +57,9 @@ void MemInputStream::setPos(int32_t pos) {
     }
 }
 
+const uint8_t *MemInputStream::peekDirect(int32_t *numBytesAvailable) {
+    *numBytesAvailable = mBufferLen - mPos;
+    return mBuffer + mPos;
+}
+
 } // namespace parselib
@@ -39,6 +39,8 @@ public:
 
     virtual void setPos(int32_t pos);
 
+    virtual const uint8_t *peekDirect(int32_t *numBytesAvailable);
+
 private:
     /** Points to the data buffer to stream from. */
     unsigned char *mBuffer;
@@ -29,6 +29,7 @@ public:
     static const int PCM_IEEEFLOAT = 2;
     static const int PCM_24 = 3;
     static const int PCM_32 = 4;
+    static const int PCM_IEEEFLOAT64 = 5;
 };
 
 } // namespace parselib
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PARSELIB_USE_NEON 1
+#elif defined(__SSE2__)
+// The NDK enables SSSE3 for x86 and x86_64. Other x86 builds need -mssse3 for PCM24.
+#include <emmintrin.h>
+#define PARSELIB_USE_SSE2 1
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define PARSELIB_USE_SSSE3 1
+#endif
+#endif
+
+#include "AudioEncoding.h"
+#include "PcmDecoder.h"
+
+// In every vector loop all of a block is loaded before any of it is stored.
+// That keeps decoding in place safe, see PcmDecoder.h.
+
+namespace parselib {
+
+static constexpr float kInverseScale8 = 1.0f / (float) 0x80;
+static constexpr float kInverseScale16 = 1.0f / (float) 0x8000;
+static constexpr float kInverseScale32 = 1.0f / (float) 0x80000000;
+
+void PcmDecoder::decodePCM8(const uint8_t *src, float *dst, int32_t numSamples) {
+    int32_t i = 0;
+#if PARSELIB_USE_NEON
+    const int16x8_t offset = vdupq_n_s16(0x80);
+    for (; i + 8 <= numSamples; i += 8) {
+        int16x8_t samples = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src + i))), offset);
+        float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(dst + i, vmulq_n_f32(low, kInverseScale8));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(high, kInverseScale8));
+    }
+#elif PARSELIB_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset = _mm_set1_epi16(0x80);
+    const __m128 scale = _mm_set1_ps(kInverseScale8);
+    for (; i + 8 <= numSamples; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        __m128i samples = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), offset);
+        // Sign extend to 32 bits by moving each sample to the top half and shifting back.
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        // PCM8 is unsigned, so we need to make it signed before scaling/converting
+        dst[i] = ((float) src[i] - (float) 0x80) * kInverseScale8;
+    }
+}
+
+void PcmDecoder::decodePCM16(const uint8_t *src, float *dst, int32_t numSamples) {
+    int32_t i = 0;
+#if PARSELIB_USE_NEON
+    for (; i + 8 <= numSamples; i += 8) {
+        int16x8_t samples = vreinterpretq_s16_u8(vld1q_u8(src + (i * 2)));
+        float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(dst + i, vmulq_n_f32(low, kInverseScale16));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(high, kInverseScale16));
+    }
+#elif PARSELIB_USE_SSE2
+    const __m128 scale = _mm_set1_ps(kInverseScale16);
+    for (; i + 8 <= numSamples; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (i * 2)));
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        int16_t sample;
+        memcpy(&sample, src + (i * sizeof(sample)), sizeof(sample));
+        dst[i] = (float) sample * kInverseScale16;
+    }
+}
+
+void PcmDecoder::decodePCM24(const uint8_t *src, float *dst, int32_t numSamples) {
+    int32_t i = 0;
+#if PARSELIB_USE_NEON
+    // De-interleave 8 samples into planes of low, middle and high bytes.
+    // Then assemble them at the top of a 32-bit word so the sign comes for free.
+    for (; i + 8 <= numSamples; i += 8) {
+        uint8x8x3_t bytes = vld3_u8(src + (i * 3));
+        uint16x8_t low16 = vorrq_u16(vmovl_u8(bytes.val[0]), vshll_n_u8(bytes.val[1], 8));
+        uint16x8_t high16 = vmovl_u8(bytes.val[2]);
+        uint32x4_t lowWords = vorrq_u32(vshll_n_u16(vget_low_u16(low16), 8),
+                                        vshlq_n_u32(vshll_n_u16(vget_low_u16(high16), 16), 8));
+        uint32x4_t highWords = vorrq_u32(vshll_n_u16(vget_high_u16(low16), 8),
+                                         vshlq_n_u32(vshll_n_u16(vget_high_u16(high16), 16), 8));
+        float32x4_t low = vcvtq_f32_s32(vreinterpretq_s32_u32(lowWords));
+        float32x4_t high = vcvtq_f32_s32(vreinterpretq_s32_u32(highWords));
+        vst1q_f32(dst + i, vmulq_n_f32(low, kInverseScale32));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(high, kInverseScale32));
+    }
+#elif PARSELIB_USE_SSSE3
+    // Move each 3 byte sample to the top of a 32-bit lane. The load is 16 bytes for 12 bytes
+    // of samples, so stop while there are still 16 bytes left in the source.
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 scale = _mm_set1_ps(kInverseScale32);
+    for (; i + 6 <= numSamples; i += 4) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (i * 3)));
+        __m128i samples = _mm_shuffle_epi8(bytes, shuffle);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        const uint8_t *bytes = src + (i * 3);
+        int32_t sample = (bytes[0] << 8) | (bytes[1] << 16) | (bytes[2] << 24);
+        dst[i] = (float) sample * kInverseScale32;
+    }
+}
+
+void PcmDecoder::decodePCM32(const uint8_t *src, float *dst, int32_t numSamples) {
+    int32_t i = 0;
+#if PARSELIB_USE_NEON
+    for (; i + 4 <= numSamples; i += 4) {
+        int32x4_t samples = vreinterpretq_s32_u8(vld1q_u8(src + (i * 4)));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(samples), kInverseScale32));
+    }
+#elif PARSELIB_USE_SSE2
+    const __m128 scale = _mm_set1_ps(kInverseScale32);
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (i * 4)));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        int32_t sample;
+        memcpy(&sample, src + (i * sizeof(sample)), sizeof(sample));
+        dst[i] = (float) sample * kInverseScale32;
+    }
+}
+
+void PcmDecoder::decodeFloat32(const uint8_t *src, float *dst, int32_t numSamples) {
+    // Turns out that WAV Float32 is just Android floats
+    if (reinterpret_cast<const uint8_t *>(dst) != src) {
+        memmove(dst, src, numSamples * sizeof(float));
+    }
+}
+
+void PcmDecoder::decodeFloat64(const uint8_t *src, float *dst, int32_t numSamples) {
+    int32_t i = 0;
+#if PARSELIB_USE_NEON && defined(__aarch64__)
+    for (; i + 4 <= numSamples; i += 4) {
+        float64x2_t low = vreinterpretq_f64_u8(vld1q_u8(src + (i * 8)));
+        float64x2_t high = vreinterpretq_f64_u8(vld1q_u8(src + (i * 8) + 16));
+        vst1q_f32(dst + i, vcombine_f32(vcvt_f32_f64(low), vcvt_f32_f64(high)));
+    }
+#elif PARSELIB_USE_SSE2
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(reinterpret_cast<const double *>(src + (i * 8))));
+        __m128 high = _mm_cvtpd_ps(
+                _mm_loadu_pd(reinterpret_cast<const double *>(src + (i * 8) + 16)));
+        _mm_storeu_ps(dst + i, _mm_movelh_ps(low, high));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        double sample;
+        memcpy(&sample, src + (i * sizeof(sample)), sizeof(sample));
+        dst[i] = (float) sample;
+    }
+}
+
+PcmDecoder::DecodeFunction PcmDecoder::getDecoder(int encoding) {
+    switch (encoding) {
+        case AudioEncoding::PCM_8:
+            return decodePCM8;
+        case AudioEncoding::PCM_16:
+            return decodePCM16;
+        case AudioEncoding::PCM_24:
+            return decodePCM24;
+        case AudioEncoding::PCM_32:
+            return decodePCM32;
+        case AudioEncoding::PCM_IEEEFLOAT:
+            return decodeFloat32;
+        case AudioEncoding::PCM_IEEEFLOAT64:
+            return decodeFloat64;
+        default:
+            return nullptr;
+    }
+}
+
+int32_t PcmDecoder::getBytesPerSample(int encoding) {
+    switch (encoding) {
+        case AudioEncoding::PCM_8:
+            return 1;
+        case AudioEncoding::PCM_16:
+            return 2;
+        case AudioEncoding::PCM_24:
+            return 3;
+        case AudioEncoding::PCM_32:
+        case AudioEncoding::PCM_IEEEFLOAT:
+            return 4;
+        case AudioEncoding::PCM_IEEEFLOAT64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+} // namespace parselib
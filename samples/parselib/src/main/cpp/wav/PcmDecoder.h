@@ -0,0 +1,68 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _IO_WAV_PCMDECODER_H_
+#define _IO_WAV_PCMDECODER_H_
+
+#include <cstdint>
+
+namespace parselib {
+
+/**
+ * Bulk converters from the sample encodings found in WAV files to float.
+ *
+ * The source need not be aligned. Each converter uses NEON or SSE when available and
+ * handles the remainder with scalar code.
+ *
+ * The source may also be placed at the END of the destination buffer, so that a block can be
+ * read straight into the float buffer and decoded in place. This works for every encoding
+ * whose samples are no larger than a float.
+ */
+class PcmDecoder {
+public:
+    typedef void (*DecodeFunction)(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /** Unsigned 8-bit, offset by 0x80. */
+    static void decodePCM8(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /** Signed 16-bit little endian. */
+    static void decodePCM16(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /** Signed 24-bit little endian, packed in 3 bytes. */
+    static void decodePCM24(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /** Signed 32-bit little endian. Also used for 24-bit samples in a 32-bit container. */
+    static void decodePCM32(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /** IEEE 754 32-bit float. */
+    static void decodeFloat32(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /** IEEE 754 64-bit float. This cannot be decoded in place. */
+    static void decodeFloat64(const uint8_t *src, float *dst, int32_t numSamples);
+
+    /**
+     * Returns the converter for one of the AudioEncoding constants, or nullptr.
+     */
+    static DecodeFunction getDecoder(int encoding);
+
+    /**
+     * Returns the size of one sample for one of the AudioEncoding constants, or 0.
+     */
+    static int32_t getBytesPerSample(int encoding);
+};
+
+} // namespace parselib
+
+#endif // _IO_WAV_PCMDECODER_H_
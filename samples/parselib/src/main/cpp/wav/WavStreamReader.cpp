@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include <algorithm>
+#include <climits>
+#include <memory>
 #include <string.h>
 
 #include <android/log.h>
@@ -21,6 +23,7 @@
 #include "stream/InputStream.h"
 
 #include "AudioEncoding.h"
+#include "PcmDecoder.h"
 #include "WavRIFFChunkHeader.h"
 #include "WavFmtChunkHeader.h"
 #include "WavChunkHeader.h"
@@ -28,7 +31,8 @@
 
 static const char *TAG = "WavStreamReader";
 
-static constexpr int kConversionBufferFrames = 16;
+// Size of the intermediate buffer for encodings that cannot be decoded in place.
+static constexpr int32_t kDecodeBufferBytes = 64 * 1024;
 
 namespace parselib {
 
@@ -61,7 +65,16 @@ int WavStreamReader::getSampleEncoding() {
                 return AudioEncoding::INVALID;
         }
     } else if (mFmtChunk->mEncodingId == WavFmtChunkHeader::ENCODING_IEEE_FLOAT) {
-        return AudioEncoding::PCM_IEEEFLOAT;
+        switch (mFmtChunk->mSampleSize) {
+            case 32:
+                return AudioEncoding::PCM_IEEEFLOAT;
+
+            case 64:
+                return AudioEncoding::PCM_IEEEFLOAT64;
+
+            default:
+                return AudioEncoding::INVALID;
+        }
     }
 
     return AudioEncoding::INVALID;
@@ -114,155 +127,106 @@ void WavStreamReader::positionToAudio() {
     }
 }
 
-/**
- * Read and convert samples in PCM8 format to float
- */
-int WavStreamReader::getDataFloat_PCM8(float *buff, int numFrames) {
-    int numChannels = mFmtChunk->mNumChannels;
-
-    int buffOffset = 0;
-    int totalFramesRead = 0;
-
-    static constexpr int kSampleSize = sizeof(u_int8_t);
-    static constexpr float kSampleFullScale = (float)0x80;
-    static constexpr float kInverseScale = 1.0f / kSampleFullScale;
-
-    u_int8_t readBuff[kConversionBufferFrames * numChannels];
-    int framesLeft = numFrames;
-    while (framesLeft > 0) {
-        int framesThisRead = std::min(framesLeft, kConversionBufferFrames);
-        //__android_log_print(ANDROID_LOG_INFO, TAG, "read(%d)", framesThisRead);
-        int numFramesRead =
-                mStream->read(readBuff, framesThisRead *  kSampleSize * numChannels) /
-                (kSampleSize * numChannels);
-        totalFramesRead += numFramesRead;
-
-        // Convert & Scale
-        for (int offset = 0; offset < numFramesRead * numChannels; offset++) {
-            // PCM8 is unsigned, so we need to make it signed before scaling/converting
-            buff[buffOffset++] = ((float) readBuff[offset] - kSampleFullScale)
-                    * kInverseScale;
-        }
-
-        if (numFramesRead < framesThisRead) {
-            break; // none left
-        }
-
-        framesLeft -= framesThisRead;
+void WavStreamReader::positionToFrame(int32_t frameIndex) {
+    if (mDataChunk != nullptr && mFmtChunk != nullptr) {
+        int32_t bytesPerFrame = (mFmtChunk->mSampleSize / 8) * mFmtChunk->mNumChannels;
+        mStream->setPos((int32_t) mAudioDataStartPos + (frameIndex * bytesPerFrame));
     }
-
-    return totalFramesRead;
 }
 
-/**
- * Read and convert samples in PCM16 format to float
- */
-int WavStreamReader::getDataFloat_PCM16(float *buff, int numFrames) {
-    int numChannels = mFmtChunk->mNumChannels;
-
-    int buffOffset = 0;
-    int totalFramesRead = 0;
-
-    static constexpr int kSampleSize = sizeof(int16_t);
-    static constexpr float kSampleFullScale = (float) 0x8000;
-    static constexpr float kInverseScale = 1.0f / kSampleFullScale;
-
-    int16_t readBuff[kConversionBufferFrames * numChannels];
-    int framesLeft = numFrames;
-    while (framesLeft > 0) {
-        int framesThisRead = std::min(framesLeft, kConversionBufferFrames);
-        //__android_log_print(ANDROID_LOG_INFO, TAG, "read(%d)", framesThisRead);
-        int numFramesRead =
-                mStream->read(readBuff, framesThisRead * kSampleSize * numChannels) /
-                (kSampleSize * numChannels);
-        totalFramesRead += numFramesRead;
-
-        // Convert & Scale
-        for (int offset = 0; offset < numFramesRead * numChannels; offset++) {
-            buff[buffOffset++] = (float) readBuff[offset] * kInverseScale;
-        }
-
-        if (numFramesRead < framesThisRead) {
-            break; // none left
-        }
-
-        framesLeft -= framesThisRead;
+int32_t WavStreamReader::getNumDataBytesLeft() {
+    if (mDataChunk->mChunkSize <= 0) {
+        // Some streaming encoders leave the size unset. Read to the end of the stream.
+        return INT32_MAX;
     }
-
-    return totalFramesRead;
+    int32_t numBytesLeft = (int32_t) (mAudioDataStartPos + mDataChunk->mChunkSize
+            - mStream->getPos());
+    return std::max(0, numBytesLeft);
 }
 
 /**
- * Read and convert samples in PCM24 format to float
+ * Convert samples directly from a memory resident stream, without a copy or a system call.
  */
-int WavStreamReader::getDataFloat_PCM24(float *buff, int numFrames) {
-    int numChannels = mFmtChunk->mNumChannels;
-    int numSamples = numFrames * numChannels;
-
-    static constexpr float kSampleFullScale = (float) 0x80000000;
-    static constexpr float kInverseScale = 1.0f / kSampleFullScale;
-
-    int samplesRead = 0;
-    uint8_t buffer[3];
-    for(int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++) {
-        if (mStream->read(buffer, 3) < 3) {
-            break; // no more data
-        }
-        int32_t sample = (buffer[0] << 8) | (buffer[1] << 16) | (buffer[2] << 24);
-        buff[sampleIndex] = (float)sample * kInverseScale;
-        samplesRead++;
+int WavStreamReader::getDataFloat_Direct(float *buff, int numFrames, int encoding) {
+    int32_t numBytesAvailable;
+    const uint8_t *src = mStream->peekDirect(&numBytesAvailable);
+    if (src == nullptr) {
+        return -1;
     }
 
-    return samplesRead / numChannels;
-}
+    // Do not run past the end of the data chunk into any chunks that follow it.
+    numBytesAvailable = std::min(numBytesAvailable, getNumDataBytesLeft());
 
-/**
- * Read and convert samples in Float32 format to float
- */
-int WavStreamReader::getDataFloat_Float32(float *buff, int numFrames) {
-    // Turns out that WAV Float32 is just Android floats
     int numChannels = mFmtChunk->mNumChannels;
-
-    return mStream->read(buff, numFrames * sizeof(float) * numChannels) /
-           (sizeof(float) * numChannels);
+    int bytesPerFrame = PcmDecoder::getBytesPerSample(encoding) * numChannels;
+    int numFramesRead = std::min(numFrames, numBytesAvailable / bytesPerFrame);
+    PcmDecoder::getDecoder(encoding)(src, buff, numFramesRead * numChannels);
+    mStream->advance(numFramesRead * bytesPerFrame);
+    return numFramesRead;
 }
 
 /**
- * Read and convert samples in PCM32 format to float
+ * Read and convert samples from a stream that must be copied from.
  */
-int WavStreamReader::getDataFloat_PCM32(float *buff, int numFrames) {
+int WavStreamReader::getDataFloat_Stream(float *buff, int numFrames, int encoding) {
+    PcmDecoder::DecodeFunction decode = PcmDecoder::getDecoder(encoding);
     int numChannels = mFmtChunk->mNumChannels;
+    int32_t bytesPerSample = PcmDecoder::getBytesPerSample(encoding);
+    int32_t bytesPerFrame = bytesPerSample * numChannels;
+    int32_t framesLeft = std::min(numFrames, getNumDataBytesLeft() / bytesPerFrame);
+
+    if (bytesPerSample <= (int32_t) sizeof(float)) {
+        // Read the whole block into the end of the caller's buffer with a single read()
+        // and decode it in place. The decoders support this layout, see PcmDecoder.h.
+        int32_t numBytes = framesLeft * bytesPerFrame;
+        uint8_t *blockEnd = reinterpret_cast<uint8_t *>(buff + (framesLeft * numChannels));
+        uint8_t *src = blockEnd - numBytes;
+        int32_t numBytesRead = std::max(0, mStream->read(src, numBytes));
+        int numFramesRead = numBytesRead / bytesPerFrame;
+        if (numFramesRead < framesLeft) {
+            // Short read. Move the data to the end of the smaller block.
+            uint8_t *readEnd = reinterpret_cast<uint8_t *>(buff + (numFramesRead * numChannels));
+            memmove(readEnd - (numFramesRead * bytesPerFrame), src, numFramesRead * bytesPerFrame);
+            src = readEnd - (numFramesRead * bytesPerFrame);
+        }
+        decode(src, buff, numFramesRead * numChannels);
+        return numFramesRead;
+    }
 
-    int buffOffset = 0;
+    // Wider samples are decoded in large chunks through an intermediate buffer.
+    int32_t framesPerChunk = std::max(1, kDecodeBufferBytes / bytesPerFrame);
+    std::unique_ptr<uint8_t[]> readBuff(new uint8_t[framesPerChunk * bytesPerFrame]);
     int totalFramesRead = 0;
-
-    static constexpr int kSampleSize = sizeof(int32_t);
-    static constexpr float kSampleFullScale = (float) 0x80000000;
-    static constexpr float kInverseScale = 1.0f / kSampleFullScale;
-
-    int32_t readBuff[kConversionBufferFrames * numChannels];
-    int framesLeft = numFrames;
     while (framesLeft > 0) {
-        int framesThisRead = std::min(framesLeft, kConversionBufferFrames);
-        //__android_log_print(ANDROID_LOG_INFO, TAG, "read(%d)", framesThisRead);
-        int numFramesRead =
-                mStream->read(readBuff, framesThisRead *  kSampleSize* numChannels) /
-                    (kSampleSize * numChannels);
-        totalFramesRead += numFramesRead;
-
-        // convert & Scale
-        for (int offset = 0; offset < numFramesRead * numChannels; offset++) {
-            buff[buffOffset++] = (float) readBuff[offset] * kInverseScale;
-        }
-
-        if (numFramesRead < framesThisRead) {
+        int32_t framesThisRead = std::min(framesLeft, framesPerChunk);
+        int numFramesRead = mStream->read(readBuff.get(), framesThisRead * bytesPerFrame)
+                / bytesPerFrame;
+        if (numFramesRead <= 0) {
             break; // none left
         }
+        decode(readBuff.get(), buff + (totalFramesRead * numChannels),
+               numFramesRead * numChannels);
+        totalFramesRead += numFramesRead;
+        framesLeft -= numFramesRead;
+    }
+    return totalFramesRead;
+}
 
-        framesLeft -= framesThisRead;
+const void *WavStreamReader::getAudioDataDirect(int32_t *numBytes) {
+    *numBytes = 0;
+    if (mDataChunk == nullptr || mFmtChunk == nullptr) {
+        return nullptr;
     }
 
-    return totalFramesRead;
+    int32_t savedPos = mStream->getPos();
+    mStream->setPos(mAudioDataStartPos);
+    int32_t numBytesAvailable;
+    const uint8_t *data = mStream->peekDirect(&numBytesAvailable);
+    if (data != nullptr) {
+        *numBytes = std::min(numBytesAvailable, getNumDataBytesLeft());
+    }
+    mStream->setPos(savedPos);
+    return data;
 }
 
 int WavStreamReader::getDataFloat(float *buff, int numFrames) {
@@ -272,40 +236,27 @@ int WavStreamReader::getDataFloat(float *buff, int numFrames) {
         return ERR_INVALID_STATE;
     }
 
+    int encoding = getSampleEncoding();
     int numFramesRead = 0;
-    switch (mFmtChunk->mSampleSize) {
-        case 8:
-            numFramesRead = getDataFloat_PCM8(buff, numFrames);
-            break;
-
-        case 16:
-            numFramesRead = getDataFloat_PCM16(buff, numFrames);
-            break;
-
-        case 24:
-            if (mFmtChunk->mEncodingId == WavFmtChunkHeader::ENCODING_PCM) {
-                numFramesRead = getDataFloat_PCM24(buff, numFrames);
-            } else {
-                __android_log_print(ANDROID_LOG_INFO, TAG, "invalid encoding:%d mSampleSize:%d",
-                                    mFmtChunk->mEncodingId, mFmtChunk->mSampleSize);
-            }
-            break;
-
-        case 32:
-            if (mFmtChunk->mEncodingId == WavFmtChunkHeader::ENCODING_PCM) {
-                numFramesRead = getDataFloat_PCM32(buff, numFrames);
-            } else if (mFmtChunk->mEncodingId == WavFmtChunkHeader::ENCODING_IEEE_FLOAT) {
-                numFramesRead = getDataFloat_Float32(buff, numFrames);
-            } else {
-                __android_log_print(ANDROID_LOG_INFO, TAG, "invalid encoding:%d mSampleSize:%d",
-                                    mFmtChunk->mEncodingId, mFmtChunk->mSampleSize);
-            }
-            break;
-
-        default:
-            __android_log_print(ANDROID_LOG_INFO, TAG, "invalid encoding:%d mSampleSize:%d",
-                    mFmtChunk->mEncodingId, mFmtChunk->mSampleSize);
-            return ERR_INVALID_FORMAT;
+    if (PcmDecoder::getDecoder(encoding) == nullptr || mFmtChunk->mNumChannels <= 0) {
+        __android_log_print(ANDROID_LOG_INFO, TAG, "invalid encoding:%d mSampleSize:%d",
+                            mFmtChunk->mEncodingId, mFmtChunk->mSampleSize);
+        switch (mFmtChunk->mSampleSize) {
+            case 8:
+            case 16:
+            case 24:
+            case 32:
+            case 64:
+                break; // Return silence.
+
+            default:
+                return ERR_INVALID_FORMAT;
+        }
+    } else {
+        numFramesRead = getDataFloat_Direct(buff, numFrames, encoding);
+        if (numFramesRead < 0) {
+            numFramesRead = getDataFloat_Stream(buff, numFrames, encoding);
+        }
     }
 
     // Zero out any unread frames
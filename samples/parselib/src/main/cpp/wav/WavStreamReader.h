@@ -17,6 +17,7 @@
 #define _IO_WAV_WAVSTREAMREADER_H_
 
 #include <map>
+#include <memory>
 
 #include "AudioEncoding.h"
 #include "WavRIFFChunkHeader.h"
@@ -58,11 +59,24 @@ public:
     // Data access
     void positionToAudio();
 
+    /**
+     * Positions the stream at the start of the specified sample frame in the data chunk.
+     */
+    void positionToFrame(int32_t frameIndex);
+
     static constexpr int ERR_INVALID_FORMAT    = -1;
     static constexpr int ERR_INVALID_STATE    = -2;
 
     int getDataFloat(float *buff, int numFrames);
 
+    /**
+     * Returns a pointer to the PCM payload of the data chunk without copying it, or nullptr
+     * if the stream is not resident in memory (see InputStream::peekDirect()).
+     * The samples are in the encoding returned by getSampleEncoding() and may not be aligned.
+     * numBytes receives the number of payload bytes that can be accessed through the pointer.
+     */
+    const void *getAudioDataDirect(int32_t *numBytes);
+
     // int getData16(short *buff, int numFramees);
 
 protected:
@@ -77,17 +91,19 @@ protected:
     std::map<RiffID, std::shared_ptr<WavChunkHeader>> mChunkMap;
 
 private:
+    // Number of bytes between the read position and the end of the data chunk.
+    int32_t getNumDataBytesLeft();
+
     /*
-     * Individual Format Readers/Converters
+     * Converts straight from memory if the stream supports peekDirect().
+     * Returns -1 if it does not.
      */
-    int getDataFloat_PCM8(float *buff, int numFrames);
+    int getDataFloat_Direct(float *buff, int numFrames, int encoding);
 
-    int getDataFloat_PCM16(float *buff, int numFrames);
-
-    int getDataFloat_PCM24(float *buff, int numFrames);
-
-    int getDataFloat_Float32(float *buff, int numFrames);
-    int getDataFloat_PCM32(float *buff, int numFrames);
+    /*
+     * Reads a block from the stream and converts it in bulk.
+     */
+    int getDataFloat_Stream(float *buff, int numFrames, int encoding);
 };
 
 } // namespace parselib
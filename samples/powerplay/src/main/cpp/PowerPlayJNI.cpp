@@ -20,6 +20,9 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <memory>
+#include <vector>
+
 #include <android/log.h>
 
 // parselib includes
@@ -27,6 +30,7 @@
 #include <wav/WavStreamReader.h>
 
 #include <player/OneShotSampleSource.h>
+#include <player/SampleBankLoader.h>
 #include "PowerPlayMultiPlayer.h"
 
 static const char *TAG = "PowerPlayJNI";
@@ -159,6 +163,31 @@ JNIEXPORT void JNICALL Java_com_google_oboe_samples_powerplay_engine_PowerPlayAu
     delete[] buf;
 }
 
+/**
+ * Native (JNI) implementation of PowerPlayAudioPlayer.loadAssetsNative()
+ */
+JNIEXPORT void JNICALL Java_com_google_oboe_samples_powerplay_engine_PowerPlayAudioPlayer_loadAssetsNative(
+        JNIEnv *env,
+        jobject,
+        jobjectArray wavBytes) {
+    const jsize numFiles = env->GetArrayLength(wavBytes);
+    std::vector<std::unique_ptr<unsigned char[]>> fileData;
+    SampleBankLoader loader;
+    for (jsize index = 0; index < numFiles; index++) {
+        auto bytearray = static_cast<jbyteArray>(env->GetObjectArrayElement(wavBytes, index));
+        const int32_t len = env->GetArrayLength(bytearray);
+        fileData.emplace_back(new unsigned char[len]);
+        env->GetByteArrayRegion(bytearray, 0, len,
+                                reinterpret_cast<jbyte *>(fileData.back().get()));
+        env->DeleteLocalRef(bytearray);
+        loader.addFile(fileData.back().get(), len);
+    }
+
+    const int32_t numLoaded = player.addSampleBank(loader);
+    __android_log_print(ANDROID_LOG_INFO, TAG, "loadAssetsNative() loaded %d of %d files",
+                        numLoaded, numFiles);
+}
+
 /**
  * Native (JNI) implementation of PowerPlayAudioPlayer.unloadWavAssetsNative()
  */
@@ -117,9 +117,11 @@ void PowerPlayMultiPlayer::triggerUp(int32_t index) {
 
     // Assure previous sample is stopped and the play head is reset to zero, avoiding the
     // currently playing index. Only allow the playback head to reset when the song has changed.
+    // The source is changed by the callback, or right here if the stream has already paused.
     const auto currentlyPlayingIndex = getCurrentlyPlayingIndex();
     if (currentlyPlayingIndex != -1) {
-        mSampleSources[currentlyPlayingIndex]->setStopMode(true);
+        postCommand(iolib::PlayerCommand::Type::Pause, currentlyPlayingIndex, 0.0f,
+                    iolib::PlayerCommand::kImmediate);
     }
 }
 
@@ -143,9 +145,11 @@ void PowerPlayMultiPlayer::triggerDown(int32_t index, oboe::PerformanceMode perf
     // currently playing index. Only allow the playback head to reset when the song has changed.
     const auto currentlyPlayingIndex = getCurrentlyPlayingIndex();
     if (currentlyPlayingIndex != -1 && currentlyPlayingIndex != index) {
-        mSampleSources[currentlyPlayingIndex]->setStopMode(false);
+        postCommand(iolib::PlayerCommand::Type::Stop, currentlyPlayingIndex, 0.0f,
+                    iolib::PlayerCommand::kImmediate);
     }
-    mSampleSources[index]->setPlayMode(false);
+    postCommand(iolib::PlayerCommand::Type::Resume, index, 0.0f,
+                iolib::PlayerCommand::kImmediate);
 
     const auto currentPerformanceMode = mAudioStream->getPerformanceMode();
     const auto isOffloaded = currentPerformanceMode == PerformanceMode::PowerSavingOffloaded;
@@ -334,6 +338,12 @@ bool PowerPlayMultiPlayer::removeSampleSource(int32_t index) {
         return false;
     }
 
+    std::lock_guard<std::mutex> lock(mCommandLock);
+    // Later commands may name an index that is about to move, so apply what is due and drop
+    // the rest.
+    applyDueCommands();
+    mCommands.clear();
+
     if (mSampleSources[index]->isPlaying()) {
         mSampleSources[index]->setStopMode(false);
     }
@@ -346,6 +356,8 @@ bool PowerPlayMultiPlayer::removeSampleSource(int32_t index) {
 
     mSampleSources.erase(mSampleSources.begin() + index);
     mSampleBuffers.erase(mSampleBuffers.begin() + index);
+    mGains.erase(mGains.begin() + index);
+    mPans.erase(mPans.begin() + index);
     mNumSampleBuffers--;
 
     __android_log_print(ANDROID_LOG_INFO, TAG,
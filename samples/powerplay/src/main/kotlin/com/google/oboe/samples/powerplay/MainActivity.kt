@@ -533,8 +533,9 @@ class MainActivity : ComponentActivity() {
             isMMapEnabled.value = player.isMMapEnabled()
             dynamicPlayList.clear()
             dynamicPlayList.addAll(BundledPlayList)
+            val wavInfos = player.loadFiles(assets, BundledPlayList.map { it.fileName })
             BundledPlayList.forEachIndexed { index, song ->
-                val wavInfo = player.loadFile(assets, song.fileName, index)
+                val wavInfo = wavInfos[index]
                 if (wavInfo != null) {
                     dynamicPlayList[index] = song.copy(wavInfo = wavInfo)
                 }
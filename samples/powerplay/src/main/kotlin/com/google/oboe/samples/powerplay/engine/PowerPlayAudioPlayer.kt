@@ -103,6 +103,29 @@ class PowerPlayAudioPlayer() : DefaultLifecycleObserver {
         return wavInfo
     }
 
+    /**
+     * Loads several files from assets and returns their WAV properties, in order.
+     * The files are decoded and resampled on several threads, so this is quicker than
+     * calling loadFile() for each one. The sample sources are added after any that are
+     * already loaded, in the order of filenames.
+     */
+    fun loadFiles(assetMgr: AssetManager, filenames: List<String>): List<WavFileInfo?> {
+        val wavBytes = Array(filenames.size) { index ->
+            val assetFD = assetMgr.openFd(filenames[index])
+            val stream = assetFD.createInputStream()
+            val len = assetFD.getLength().toInt()
+            val bytes = ByteArray(len)
+
+            stream.read(bytes, 0, len)
+            assetFD.close()
+            bytes
+        }
+
+        val wavInfos = wavBytes.map { getWavFileInfo(it) }
+        loadAssetsNative(wavBytes)
+        return wavInfos
+    }
+
     /**
      * Probes a WAV file's audio properties without loading sample data.
      * @param wavBytes The raw bytes of the WAV file
@@ -257,6 +280,7 @@ class PowerPlayAudioPlayer() : DefaultLifecycleObserver {
     private external fun startAudioStreamNative(): Int
     private external fun teardownAudioStreamNative(): Int
     private external fun loadAssetNative(wavBytes: ByteArray, index: Int)
+    private external fun loadAssetsNative(wavBytes: Array<ByteArray>)
     private external fun unloadAssetsNative()
     private external fun getOutputResetNative(): Boolean
     private external fun clearOutputResetNative()
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHARED_MIXKERNELS_H
+#define SHARED_MIXKERNELS_H
+
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIX_KERNELS_USE_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define MIX_KERNELS_USE_SSE 1
+#endif
+
+/**
+ * Vectorized kernels that mix a block of audio into an output buffer, dst += src * gain.
+ *
+ * Each kernel ramps the gain linearly from gainStart to gainEnd across the block, so gain and
+ * pan changes do not cause zipper noise. The gain for frame i is
+ * gainStart + (gainEnd - gainStart) * (i + 1) / numFrames, so the last frame gets gainEnd.
+ * Pass the same value for both to use a constant gain.
+ *
+ * The buffers need not be aligned. NEON or SSE is used when available, with scalar code for
+ * the remainder.
+ */
+class MixKernels {
+public:
+    /**
+     * Mix samples with any number of interleaved channels, all with the same gain.
+     */
+    static void mixGain(float *dst, const float *src, int32_t numSamples,
+                        float gainStart, float gainEnd) {
+        const float increment = (gainEnd - gainStart) / numSamples;
+        int32_t i = 0;
+#if MIX_KERNELS_USE_NEON
+        const float32x4_t laneIncrement = {increment, 2 * increment, 3 * increment,
+                                           4 * increment};
+        for (; i + 4 <= numSamples; i += 4) {
+            float32x4_t gain = vaddq_f32(vdupq_n_f32(gainStart + increment * i), laneIncrement);
+            vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+        }
+#elif MIX_KERNELS_USE_SSE
+        const __m128 laneIncrement = _mm_setr_ps(increment, 2 * increment, 3 * increment,
+                                                 4 * increment);
+        for (; i + 4 <= numSamples; i += 4) {
+            __m128 gain = _mm_add_ps(_mm_set1_ps(gainStart + increment * i), laneIncrement);
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i),
+                                              _mm_mul_ps(_mm_loadu_ps(src + i), gain)));
+        }
+#endif
+        for (; i < numSamples; i++) {
+            dst[i] += src[i] * (gainStart + increment * (i + 1));
+        }
+    }
+
+    static void mixGain(float *dst, const float *src, int32_t numSamples, float gain) {
+        mixGain(dst, src, numSamples, gain, gain);
+    }
+
+    /**
+     * Sum samples with any number of interleaved channels at unity gain.
+     */
+    static void accumulate(float *dst, const float *src, int32_t numSamples) {
+        int32_t i = 0;
+#if MIX_KERNELS_USE_NEON
+        for (; i + 4 <= numSamples; i += 4) {
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+        }
+#elif MIX_KERNELS_USE_SSE
+        for (; i + 4 <= numSamples; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+        }
+#endif
+        for (; i < numSamples; i++) {
+            dst[i] += src[i];
+        }
+    }
+
+    /**
+     * Mix interleaved stereo into interleaved stereo with separate left and right gains.
+     */
+    static void mixStereo(float *dst, const float *src, int32_t numFrames,
+                          float leftStart, float rightStart, float leftEnd, float rightEnd) {
+        const float leftIncrement = (leftEnd - leftStart) / numFrames;
+        const float rightIncrement = (rightEnd - rightStart) / numFrames;
+        int32_t i = 0;
+#if MIX_KERNELS_USE_NEON
+        const float32x4_t start = {leftStart, rightStart, leftStart, rightStart};
+        const float32x4_t increment = {leftIncrement, rightIncrement,
+                                       leftIncrement, rightIncrement};
+        const float32x4_t laneIncrement = {leftIncrement, rightIncrement,
+                                           2 * leftIncrement, 2 * rightIncrement};
+        for (; i + 2 <= numFrames; i += 2) {
+            float32x4_t gain = vaddq_f32(vmlaq_n_f32(start, increment, (float) i), laneIncrement);
+            vst1q_f32(dst + (i * 2), vmlaq_f32(vld1q_f32(dst + (i * 2)),
+                                               vld1q_f32(src + (i * 2)), gain));
+        }
+#elif MIX_KERNELS_USE_SSE
+        const __m128 start = _mm_setr_ps(leftStart, rightStart, leftStart, rightStart);
+        const __m128 increment = _mm_setr_ps(leftIncrement, rightIncrement,
+                                             leftIncrement, rightIncrement);
+        const __m128 laneIncrement = _mm_setr_ps(leftIncrement, rightIncrement,
+                                                 2 * leftIncrement, 2 * rightIncrement);
+        for (; i + 2 <= numFrames; i += 2) {
+            __m128 gain = _mm_add_ps(_mm_add_ps(start, _mm_mul_ps(increment, _mm_set1_ps(i))),
+                                     laneIncrement);
+            _mm_storeu_ps(dst + (i * 2), _mm_add_ps(_mm_loadu_ps(dst + (i * 2)),
+                                                    _mm_mul_ps(_mm_loadu_ps(src + (i * 2)), gain)));
+        }
+#endif
+        for (; i < numFrames; i++) {
+            dst[i * 2] += src[i * 2] * (leftStart + leftIncrement * (i + 1));
+            dst[i * 2 + 1] += src[i * 2 + 1] * (rightStart + rightIncrement * (i + 1));
+        }
+    }
+
+    /**
+     * Mix mono into interleaved stereo, e.g. to pan it.
+     */
+    static void mixMonoToStereo(float *dst, const float *src, int32_t numFrames,
+                                float leftStart, float rightStart, float leftEnd, float rightEnd) {
+        const float leftIncrement = (leftEnd - leftStart) / numFrames;
+        const float rightIncrement = (rightEnd - rightStart) / numFrames;
+        int32_t i = 0;
+#if MIX_KERNELS_USE_NEON
+        const float32x4_t start = {leftStart, rightStart, leftStart, rightStart};
+        const float32x4_t increment = {leftIncrement, rightIncrement,
+                                       leftIncrement, rightIncrement};
+        const float32x4_t laneIncrementLow = {leftIncrement, rightIncrement,
+                                              2 * leftIncrement, 2 * rightIncrement};
+        const float32x4_t laneIncrementHigh = vmlaq_n_f32(laneIncrementLow, increment, 2.0f);
+        for (; i + 4 <= numFrames; i += 4) {
+            float32x4_t base = vmlaq_n_f32(start, increment, (float) i);
+            float32x4_t samples = vld1q_f32(src + i);
+            float32x4x2_t duplicated = vzipq_f32(samples, samples);
+            float *out = dst + (i * 2);
+            vst1q_f32(out, vmlaq_f32(vld1q_f32(out), duplicated.val[0],
+                                     vaddq_f32(base, laneIncrementLow)));
+            vst1q_f32(out + 4, vmlaq_f32(vld1q_f32(out + 4), duplicated.val[1],
+                                         vaddq_f32(base, laneIncrementHigh)));
+        }
+#elif MIX_KERNELS_USE_SSE
+        const __m128 start = _mm_setr_ps(leftStart, rightStart, leftStart, rightStart);
+        const __m128 increment = _mm_setr_ps(leftIncrement, rightIncrement,
+                                             leftIncrement, rightIncrement);
+        const __m128 laneIncrementLow = _mm_setr_ps(leftIncrement, rightIncrement,
+                                                    2 * leftIncrement, 2 * rightIncrement);
+        const __m128 laneIncrementHigh = _mm_add_ps(laneIncrementLow,
+                                                    _mm_mul_ps(increment, _mm_set1_ps(2.0f)));
+        for (; i + 4 <= numFrames; i += 4) {
+            __m128 base = _mm_add_ps(start, _mm_mul_ps(increment, _mm_set1_ps(i)));
+            __m128 samples = _mm_loadu_ps(src + i);
+            float *out = dst + (i * 2);
+            _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out),
+                    _mm_mul_ps(_mm_unpacklo_ps(samples, samples),
+                               _mm_add_ps(base, laneIncrementLow))));
+            _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4),
+                    _mm_mul_ps(_mm_unpackhi_ps(samples, samples),
+                               _mm_add_ps(base, laneIncrementHigh))));
+        }
+#endif
+        for (; i < numFrames; i++) {
+            dst[i * 2] += src[i] * (leftStart + leftIncrement * (i + 1));
+            dst[i * 2 + 1] += src[i] * (rightStart + rightIncrement * (i + 1));
+        }
+    }
+
+    /**
+     * Mix interleaved stereo down to mono, with separate gains for the left and right inputs.
+     */
+    static void mixStereoToMono(float *dst, const float *src, int32_t numFrames,
+                                float leftStart, float rightStart, float leftEnd, float rightEnd) {
+        const float leftIncrement = (leftEnd - leftStart) / numFrames;
+        const float rightIncrement = (rightEnd - rightStart) / numFrames;
+        int32_t i = 0;
+#if MIX_KERNELS_USE_NEON
+        const float32x4_t lanes = {1.0f, 2.0f, 3.0f, 4.0f};
+        for (; i + 4 <= numFrames; i += 4) {
+            float32x4_t leftGain = vmlaq_n_f32(vdupq_n_f32(leftStart + leftIncrement * i),
+                                               lanes, leftIncrement);
+            float32x4_t rightGain = vmlaq_n_f32(vdupq_n_f32(rightStart + rightIncrement * i),
+                                                lanes, rightIncrement);
+            float32x4x2_t frames = vld2q_f32(src + (i * 2));
+            float32x4_t mixed = vmlaq_f32(vmulq_f32(frames.val[0], leftGain),
+                                          frames.val[1], rightGain);
+            vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), mixed));
+        }
+#elif MIX_KERNELS_USE_SSE
+        const __m128 lanes = _mm_setr_ps(1.0f, 2.0f, 3.0f, 4.0f);
+        for (; i + 4 <= numFrames; i += 4) {
+            __m128 leftGain = _mm_add_ps(_mm_set1_ps(leftStart + leftIncrement * i),
+                                         _mm_mul_ps(lanes, _mm_set1_ps(leftIncrement)));
+            __m128 rightGain = _mm_add_ps(_mm_set1_ps(rightStart + rightIncrement * i),
+                                          _mm_mul_ps(lanes, _mm_set1_ps(rightIncrement)));
+            __m128 low = _mm_loadu_ps(src + (i * 2));
+            __m128 high = _mm_loadu_ps(src + (i * 2) + 4);
+            __m128 left = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 mixed = _mm_add_ps(_mm_mul_ps(left, leftGain), _mm_mul_ps(right, rightGain));
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), mixed));
+        }
+#endif
+        for (; i < numFrames; i++) {
+            dst[i] += src[i * 2] * (leftStart + leftIncrement * (i + 1))
+                    + src[i * 2 + 1] * (rightStart + rightIncrement * (i + 1));
+        }
+    }
+};
+
+#endif //SHARED_MIXKERNELS_H
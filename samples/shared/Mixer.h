@@ -19,6 +19,7 @@
 
 #include <array>
 #include "IRenderableAudio.h"
+#include "MixKernels.h"
 
 /**
  * A Mixer object which sums the output from multiple tracks into a single output. The number of
@@ -42,10 +43,7 @@ public:
 
         for (int i = 0; i < mTracks.size(); ++i) {
             mTracks[i]->renderAudio(mMixingBuffer.get(), numFrames);
-
-            for (int j = 0; j < numSamples; ++j) {
-                audioData[j] += mMixingBuffer[j];
-            }
+            MixKernels::accumulate(audioData, mMixingBuffer.get(), numSamples);
         }
     }
 
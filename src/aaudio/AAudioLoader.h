@@ -75,14 +75,14 @@ typedef uint32_t aaudio_channel_mask_t;
 typedef int32_t aaudio_spatialization_behavior_t;
 #endif
 
-#if OBOE_USING_NDK && __NDK_MAJOR__ < 29
+#if defined(OBOE_NO_INCLUDE_AAUDIO) || (OBOE_USING_NDK && __NDK_MAJOR__ < 29)
 // Defined in Android B
 typedef void (*AAudioStream_presentationEndCallback)(
         AAudioStream* stream,
         void* userData);
 #endif
 
-#if OBOE_USING_NDK && __NDK_MAJOR__ < 30
+#if defined(OBOE_NO_INCLUDE_AAUDIO) || (OBOE_USING_NDK && __NDK_MAJOR__ < 30)
 // Defined in Android C
 typedef void (*AAudioStream_routingChangedCallback)(
         AAudioStream* stream,
@@ -91,6 +91,27 @@ typedef void (*AAudioStream_routingChangedCallback)(
         int32_t numDevices);
 #endif
 
+// Normally defined by <android/api-level.h>, which is missing when building for a host.
+#ifndef __ANDROID_API_L__
+#define __ANDROID_API_L__ 21
+#endif
+
+#ifndef __ANDROID_API_M__
+#define __ANDROID_API_M__ 23
+#endif
+
+#ifndef __ANDROID_API_O__
+#define __ANDROID_API_O__ 26
+#endif
+
+#ifndef __ANDROID_API_O_MR1__
+#define __ANDROID_API_O_MR1__ 27
+#endif
+
+#ifndef __ANDROID_API_P__
+#define __ANDROID_API_P__ 28
+#endif
+
 #ifndef __ANDROID_API_Q__
 #define __ANDROID_API_Q__ 29
 #endif
@@ -119,14 +140,14 @@ typedef void (*AAudioStream_routingChangedCallback)(
 #define __ANDROID_API_C__ 37
 #endif
 
-#if OBOE_USING_NDK && __NDK_MAJOR__ < 30
+#if defined(OBOE_NO_INCLUDE_AAUDIO) || (OBOE_USING_NDK && __NDK_MAJOR__ < 30)
 // These were defined in Android B
 typedef int32_t AAudio_DeviceType;
 typedef int32_t aaudio_policy_t;
 #endif
 
 // TODO: find the first NDK version containing the following values
-#if OBOE_USING_NDK && __NDK_MAJOR__ <= 30
+#if defined(OBOE_NO_INCLUDE_AAUDIO) || (OBOE_USING_NDK && __NDK_MAJOR__ <= 30)
 typedef enum AAudio_FallbackMode : int32_t {
     AAUDIO_FALLBACK_MODE_DEFAULT = 0,
     AAUDIO_FALLBACK_MODE_MUTE = 1,
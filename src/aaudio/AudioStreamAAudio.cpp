@@ -14,13 +14,17 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <functional>
 #include <set>
 #include <stdint.h>
 #include <stdlib.h>
 
 #include "aaudio/AAudioLoader.h"
 #include "aaudio/AudioStreamAAudio.h"
+#include "common/CallbackDispatcher.h"
 #include "common/OboeDebug.h"
 #include "oboe/AudioClock.h"
 #include "oboe/Utilities.h"
@@ -164,8 +168,8 @@ static int32_t oboe_aaudio_partial_data_callback_proc(
     }
 }
 
-// This runs in its own thread.
-// Only one of these threads will be launched from internalErrorCallback().
+// This runs on a CallbackDispatcher thread.
+// Only one of these tasks will be posted from internalErrorCallback().
 // It calls app error callbacks from a static function in case the stream gets deleted.
 static void oboe_aaudio_error_thread_proc_common(AudioStreamAAudio *oboeStream,
                                           Result error) {
@@ -257,6 +261,28 @@ static void oboe_aaudio_routing_changed_thread_proc_shared(
     LOGD("%s() - exiting <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<", __func__);
 }
 
+// Run the task on the shared CallbackDispatcher so events for the stream stay in order.
+// If too many events are pending then the event is dropped.
+static void dispatch_callback_task(CallbackDispatcher::OwnerId owner,
+                                   std::function<void()> &&task) {
+    if (!CallbackDispatcher::getInstance().post(owner, std::move(task))) {
+        LOGW("%s() too many pending events, event dropped", __func__);
+    }
+}
+
+// Error tasks may use the reserved part of the queue so they are not lost behind routing events.
+// A task that holds a shared_ptr to the stream is not cancellable so that onErrorAfterClose()
+// is still called if the app closes the stream before the task runs. A task that holds a raw
+// pointer must be cancellable because the app may delete the stream after close().
+static void dispatch_error_task(CallbackDispatcher::OwnerId owner,
+                                std::function<void()> &&task, bool cancellable) {
+    if (!CallbackDispatcher::getInstance().post(owner, std::move(task), cancellable,
+                                                true /* useReserve */)) {
+        // The stream still reports the error from its other methods.
+        LOGE("%s() too many pending events, error callback dropped", __func__);
+    }
+}
+
 namespace oboe {
 
 /*
@@ -269,6 +295,11 @@ AudioStreamAAudio::AudioStreamAAudio(const AudioStreamBuilder &builder)
     mLibLoader = AAudioLoader::getInstance();
 }
 
+AudioStreamAAudio::~AudioStreamAAudio() {
+    // In case the app deletes the stream without closing it.
+    CallbackDispatcher::getInstance().cancel(mCallbackOwnerId);
+}
+
 bool AudioStreamAAudio::isSupported() {
     mLibLoader = AAudioLoader::getInstance();
     int openResult = mLibLoader->open();
@@ -277,7 +308,7 @@ bool AudioStreamAAudio::isSupported() {
 
 // Static method for the error callback.
 // We use a method so we can access protected methods on the stream.
-// Launch a thread to handle the error.
+// Post a task to handle the error.
 // That other thread can safely stop, close and delete the stream.
 void AudioStreamAAudio::internalErrorCallback(
         AAudioStream *stream,
@@ -304,6 +335,8 @@ void AudioStreamAAudio::internalErrorCallback(
     }
 
     oboeStream->mErrorCallbackResult = oboeResult;
+    // The stream is probably disconnected so wake anyone waiting for a state change.
+    oboeStream->notifyStateChange();
 
     // These checks should be enough because we assume that the stream close()
     // will join() any active callback threads and will not allow new callbacks.
@@ -313,13 +346,15 @@ void AudioStreamAAudio::internalErrorCallback(
         LOGW("%s() stream already closed or closing", __func__); // might happen if there are bugs
     } else if (sharedStream) {
         // Handle error on a separate thread using shared pointer.
-        std::thread t(oboe_aaudio_error_thread_proc_shared, sharedStream, sharedParentStream,
-                      oboeResult);
-        t.detach();
+        dispatch_error_task(oboeStream->mCallbackOwnerId,
+                [sharedStream, sharedParentStream, oboeResult]() {
+            oboe_aaudio_error_thread_proc_shared(sharedStream, sharedParentStream, oboeResult);
+        }, false /* cancellable */);
     } else {
-        // Handle error on a separate thread.
-        std::thread t(oboe_aaudio_error_thread_proc, oboeStream, oboeResult);
-        t.detach();
+        // Handle error on a separate thread. This is cancelled by close().
+        dispatch_error_task(oboeStream->mCallbackOwnerId, [oboeStream, oboeResult]() {
+            oboe_aaudio_error_thread_proc(oboeStream, oboeResult);
+        }, true /* cancellable */);
     }
 }
 
@@ -687,6 +722,10 @@ Result AudioStreamAAudio::close() {
     // Always remove the stream from the collection before closing it as after closing, the client
     // will free the resource of the stream.
     AAudioStreamCollection::getInstance().removeStream(this);
+    // Drop any events that have not been delivered yet, including an error event that holds
+    // a raw pointer, because the app may delete the stream as soon as close() returns.
+    // An error event that holds a shared_ptr still runs so the app gets onErrorAfterClose().
+    CallbackDispatcher::getInstance().cancel(mCallbackOwnerId);
 
     // Prevent two threads from closing the stream at the same time and crashing.
     // This could occur, for example, if an application called close() at the same
@@ -709,7 +748,9 @@ Result AudioStreamAAudio::close() {
             requestStop_l(stream);
             sleepBeforeClose();
         }
-        return static_cast<Result>(mLibLoader->stream_close(stream));
+        Result result = static_cast<Result>(mLibLoader->stream_close(stream));
+        notifyStateChange();
+        return result;
     } else {
         return Result::ErrorClosed;
     }
@@ -733,6 +774,11 @@ void AudioStreamAAudio::launchStopThread() {
 DataCallbackResult AudioStreamAAudio::callOnAudioReady(AAudioStream * /*stream*/,
                                                        void *audioData,
                                                        int32_t numFrames) {
+    // The first callback after requestStart() means the stream has started.
+    if (mNotifyOnNextCallback.load(std::memory_order_relaxed)
+            && mNotifyOnNextCallback.exchange(false)) {
+        notifyStateChange();
+    }
     DataCallbackResult result = fireDataCallback(audioData, numFrames);
     if (result == DataCallbackResult::Continue) {
         return result;
@@ -776,7 +822,10 @@ Result AudioStreamAAudio::requestStart() {
         }
         mStopThreadAllowed = true;
         closePerformanceHint();
-        return static_cast<Result>(mLibLoader->stream_requestStart(stream));
+        mNotifyOnNextCallback = anyDataCallbackSpecified();
+        Result result = static_cast<Result>(mLibLoader->stream_requestStart(stream));
+        notifyStateChange();
+        return result;
     } else {
         return Result::ErrorClosed;
     }
@@ -793,7 +842,9 @@ Result AudioStreamAAudio::requestPause() {
                 return Result::OK;
             }
         }
-        return static_cast<Result>(mLibLoader->stream_requestPause(stream));
+        Result result = static_cast<Result>(mLibLoader->stream_requestPause(stream));
+        notifyStateChange();
+        return result;
     } else {
         return Result::ErrorClosed;
     }
@@ -810,7 +861,9 @@ Result AudioStreamAAudio::requestFlush() {
                 return Result::OK;
             }
         }
-        return static_cast<Result>(mLibLoader->stream_requestFlush(stream));
+        Result result = static_cast<Result>(mLibLoader->stream_requestFlush(stream));
+        notifyStateChange();
+        return result;
     } else {
         return Result::ErrorClosed;
     }
@@ -835,7 +888,9 @@ Result AudioStreamAAudio::requestStop_l(AAudioStream *stream) {
             return Result::OK;
         }
     }
-    return static_cast<Result>(mLibLoader->stream_requestStop(stream));
+    Result result = static_cast<Result>(mLibLoader->stream_requestStop(stream));
+    notifyStateChange();
+    return result;
 }
 
 ResultWithValue<int32_t>   AudioStreamAAudio::write(const void *buffer,
@@ -870,18 +925,23 @@ ResultWithValue<int32_t>   AudioStreamAAudio::read(void *buffer,
 // AAudioStream_waitForStateChange() can crash if it is waiting on a stream and that stream
 // is closed from another thread.  We do not want to lock the stream for the duration of the call.
 // So we call AAudioStream_waitForStateChange() with a timeout of zero so that it will not block.
-// Then we can do our own sleep with the lock unlocked.
+// Then we wait on a condition variable with the lock unlocked. It is notified by the request*()
+// methods, close(), the error callback and the first data callback after a start.
+// AAudio does not report every state change so we also poll, with an increasing interval.
 Result AudioStreamAAudio::waitForStateChange(StreamState currentState,
                                         StreamState *nextState,
                                         int64_t timeoutNanoseconds) {
     Result oboeResult = Result::ErrorTimeout;
-    int64_t sleepTimeNanos = 20 * kNanosPerMillisecond; // arbitrary
+    constexpr int64_t kMinPollNanos = 1 * kNanosPerMillisecond; // arbitrary
+    constexpr int64_t kMaxPollNanos = 20 * kNanosPerMillisecond; // arbitrary
+    int64_t pollNanos = kMinPollNanos;
     aaudio_stream_state_t currentAAudioState = static_cast<aaudio_stream_state_t>(currentState);
 
     aaudio_result_t result = AAUDIO_OK;
     int64_t timeLeftNanos = timeoutNanoseconds;
 
-    mLock.lock();
+    std::unique_lock<std::mutex> lock(mLock);
+    mStateWaiterCount++;
     while (true) {
         // Do we still have an AAudio stream? If not then stream must have been closed.
         AAudioStream *stream = mAAudioStream.load();
@@ -924,17 +984,15 @@ Result AudioStreamAAudio::waitForStateChange(StreamState currentState,
             break;
         }
 
-        // No change yet so sleep.
-        mLock.unlock(); // Don't sleep while locked.
-        if (sleepTimeNanos > timeLeftNanos) {
-            sleepTimeNanos = timeLeftNanos; // last little bit
-        }
-        AudioClock::sleepForNanos(sleepTimeNanos);
-        timeLeftNanos -= sleepTimeNanos;
-        mLock.lock();
+        // No change yet so wait for a notification or the next poll. This unlocks mLock.
+        int64_t waitNanos = std::min(pollNanos, timeLeftNanos);
+        int64_t beforeNanos = AudioClock::getNanoseconds();
+        mStateChanged.wait_for(lock, std::chrono::nanoseconds(waitNanos));
+        timeLeftNanos -= AudioClock::getNanoseconds() - beforeNanos;
+        pollNanos = std::min(pollNanos * 2, kMaxPollNanos);
     }
+    mStateWaiterCount--;
 
-    mLock.unlock();
     return oboeResult;
 }
 
@@ -1102,7 +1160,7 @@ bool AudioStreamAAudio::isMMapUsed() {
 // static
 // Static method for the presentation end callback.
 // We use a method so we can access protected methods on the stream.
-// Launch a thread to handle the error.
+// Post a task to handle the event.
 // That other thread can safely stop, close and delete the stream.
 void AudioStreamAAudio::internalPresentationEndCallback(AAudioStream *stream, void *userData) {
     AudioStreamAAudio *oboeStream = reinterpret_cast<AudioStreamAAudio*>(userData);
@@ -1118,14 +1176,15 @@ void AudioStreamAAudio::internalPresentationEndCallback(AAudioStream *stream, vo
     if (stream != oboeStream->getUnderlyingStream()) {
         LOGW("%s() stream already closed or closing", __func__); // might happen if there are bugs
     } else if (sharedStream) {
-        // Handle error on a separate thread using shared pointer.
-        std::thread t(oboe_aaudio_presentation_end_thread_proc_shared, sharedStream,
-                      sharedParentStream);
-        t.detach();
+        // Handle event on a separate thread using shared pointer.
+        dispatch_callback_task(oboeStream->mCallbackOwnerId, [sharedStream, sharedParentStream]() {
+            oboe_aaudio_presentation_end_thread_proc_shared(sharedStream, sharedParentStream);
+        });
     } else {
-        // Handle error on a separate thread.
-        std::thread t(oboe_aaudio_presentation_thread_proc, oboeStream);
-        t.detach();
+        // Handle event on a separate thread.
+        dispatch_callback_task(oboeStream->mCallbackOwnerId, [oboeStream]() {
+            oboe_aaudio_presentation_thread_proc(oboeStream);
+        });
     }
 }
 
@@ -1149,16 +1208,19 @@ void AudioStreamAAudio::internalRoutingChangedCallback(
         oboeStream->onRoutingChanged(deviceIdsCopy);
         if (oboeStream->getRoutingCallback() != nullptr) {
             // Handle routing change on a separate thread using shared pointer.
-            std::thread t(oboe_aaudio_routing_changed_thread_proc_shared, sharedStream,
-                          sharedParentStream, deviceIdsCopy);
-            t.detach();
+            dispatch_callback_task(oboeStream->mCallbackOwnerId,
+                    [sharedStream, sharedParentStream, deviceIdsCopy]() {
+                oboe_aaudio_routing_changed_thread_proc_shared(sharedStream, sharedParentStream,
+                                                               deviceIdsCopy);
+            });
         }
     } else {
         oboeStream->onRoutingChanged(deviceIdsCopy);
         if (oboeStream->getRoutingCallback() != nullptr) {
             // Handle routing change on a separate thread.
-            std::thread t(oboe_aaudio_routing_changed_thread_proc, oboeStream, deviceIdsCopy);
-            t.detach();
+            dispatch_callback_task(oboeStream->mCallbackOwnerId, [oboeStream, deviceIdsCopy]() {
+                oboe_aaudio_routing_changed_thread_proc(oboeStream, deviceIdsCopy);
+            });
         }
     }
 }
@@ -18,11 +18,13 @@
 #define OBOE_STREAM_AAUDIO_H_
 
 #include <atomic>
+#include <condition_variable>
 #include <shared_mutex>
 #include <mutex>
 #include <thread>
 
 #include <common/AdpfWrapper.h>
+#include "common/CallbackDispatcher.h"
 #include "oboe/AudioStreamBuilder.h"
 #include "oboe/AudioStream.h"
 #include "oboe/Definitions.h"
@@ -41,7 +43,7 @@ public:
     AudioStreamAAudio();
     explicit AudioStreamAAudio(const AudioStreamBuilder &builder);
 
-    virtual ~AudioStreamAAudio() = default;
+    virtual ~AudioStreamAAudio();
 
     /**
      *
@@ -104,6 +106,10 @@ public:
         mAdpfOpenAttempted = false;
     }
 
+    bool isPerformanceHintActive() override {
+        return mAdpfWrapper.isOpen();
+    }
+
     oboe::Result reportWorkload(int32_t appWorkload) override {
         if (!isPerformanceHintEnabled()) {
             return oboe::Result::ErrorInvalidState;
@@ -183,6 +189,16 @@ private:
     // Must call under mLock. And stream must NOT be nullptr.
     Result requestStop_l(AAudioStream *stream);
 
+    /**
+     * Wake any threads that are blocked in waitForStateChange() so they check the state.
+     * This does not lock so it may be called from the data callback.
+     */
+    void notifyStateChange() {
+        if (mStateWaiterCount.load() > 0) {
+            mStateChanged.notify_all();
+        }
+    }
+
     /**
      * Launch a thread that will stop the stream.
      */
@@ -195,6 +211,15 @@ private:
     std::atomic<bool>    mCallbackThreadEnabled;
     std::atomic<bool>    mStopThreadAllowed{false};
 
+    // Tags the error, routing and presentation tasks for this stream in the CallbackDispatcher.
+    const CallbackDispatcher::OwnerId mCallbackOwnerId = CallbackDispatcher::newOwnerId();
+
+    // Used with mLock to wake threads in waitForStateChange().
+    std::condition_variable mStateChanged;
+    std::atomic<int32_t> mStateWaiterCount{0};
+    // Set by requestStart() so the first data callback reports that the stream has started.
+    std::atomic<bool>    mNotifyOnNextCallback{false};
+
     // pointer to the underlying 'C' AAudio stream, valid if open, null if closed
     std::atomic<AAudioStream *> mAAudioStream{nullptr};
     std::shared_mutex           mAAudioStreamLock; // to protect mAAudioStream while closing
@@ -25,6 +25,7 @@
 
 #include "oboe/Utilities.h"
 #include "OboeDebug.h"
+#include "ReopenSnapshot.h"
 
 namespace oboe {
 
@@ -39,6 +40,7 @@ AudioStream::AudioStream(const AudioStreamBuilder &builder)
 AudioStream::~AudioStream() {
     // This is to help debug use after free bugs.
     LOGD("Destructor for AudioStream at %p", this);
+    ReopenSnapshotCollection::getInstance().removeStream(this);
 }
 
 Result AudioStream::close() {
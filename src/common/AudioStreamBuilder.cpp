@@ -18,14 +18,12 @@
 
 
 #include "aaudio/AAudioExtensions.h"
-#include "aaudio/AudioStreamAAudio.h"
 #include "OboeDebug.h"
 #include "oboe/Oboe.h"
 #include "oboe/AudioStreamBuilder.h"
-#include "opensles/AudioInputStreamOpenSLES.h"
-#include "opensles/AudioOutputStreamOpenSLES.h"
-#include "opensles/AudioStreamOpenSLES.h"
 #include "QuirksManager.h"
+#include "ReopenSnapshot.h"
+#include "Trace.h"
 
 #ifndef DISABLE_CONVERSION
 #include "FilterAudioStream.h"
@@ -50,39 +48,7 @@ int32_t DefaultStreamValues::ChannelCount = 2; // Stereo
 
 constexpr int knumBurstsForLowLatencyStreams = 2;
 
-#ifndef OBOE_ENABLE_AAUDIO
-// Set OBOE_ENABLE_AAUDIO to 0 if you want to disable the AAudio API.
-// This might be useful if you want to force all the unit tests to use OpenSL ES.
-#define OBOE_ENABLE_AAUDIO 1
-#endif
-
-bool AudioStreamBuilder::isAAudioSupported() {
-    return AudioStreamAAudio::isSupported() && OBOE_ENABLE_AAUDIO;
-}
-
-bool AudioStreamBuilder::isAAudioRecommended() {
-    // See https://github.com/google/oboe/issues/40,
-    // AAudio may not be stable on Android O, depending on how it is used.
-    // To be safe, use AAudio only on O_MR1 and above.
-    return (getSdkVersion() >= __ANDROID_API_O_MR1__) && isAAudioSupported();
-}
-
-AudioStream *AudioStreamBuilder::build() {
-    AudioStream *stream = nullptr;
-    if (isAAudioRecommended() && mAudioApi != AudioApi::OpenSLES) {
-        stream = new AudioStreamAAudio(*this);
-    } else if (isAAudioSupported() && mAudioApi == AudioApi::AAudio) {
-        stream = new AudioStreamAAudio(*this);
-        LOGE("Creating AAudio stream on 8.0 because it was specified. This is error prone.");
-    } else {
-        if (getDirection() == oboe::Direction::Output) {
-            stream = new AudioOutputStreamOpenSLES(*this);
-        } else if (getDirection() == oboe::Direction::Input) {
-            stream = new AudioInputStreamOpenSLES(*this);
-        }
-    }
-    return stream;
-}
+// isAAudioSupported(), isAAudioRecommended() and build() are in AudioStreamBuilderBackend.cpp.
 
 bool AudioStreamBuilder::isCompatible(AudioStreamBase &other) {
     return (getSampleRate() == oboe::Unspecified || getSampleRate() == other.getSampleRate())
@@ -118,44 +84,70 @@ Result AudioStreamBuilder::openStreamInternal(AudioStream **streamPP) {
     }
     *streamPP = nullptr;
 
-    AudioStream *streamP = nullptr;
-
-    // Maybe make a FilterInputStream.
-    AudioStreamBuilder childBuilder(*this);
-
+    auto snapshot = std::make_shared<ReopenSnapshot>(*this);
+    {
+        ScopedTraceSection section("oboe.openStream.quirks");
 #ifndef DISABLE_CONVERSION
-    // Check need for conversion and modify childBuilder for optimal stream.
-    bool conversionNeeded = QuirksManager::getInstance().isConversionNeeded(*this, childBuilder);
-    // Do we need to make a child stream and convert.
-    if (conversionNeeded) {
-        if (isPartialDataCallbackSpecified()) {
+        // Check need for conversion and modify childBuilder for optimal stream.
+        snapshot->conversionNeeded = QuirksManager::getInstance().isConversionNeeded(
+                *this, snapshot->childBuilder);
+        // Do we need to make a child stream and convert.
+        if (snapshot->conversionNeeded && isPartialDataCallbackSpecified()) {
             LOGW("%s(), partial data callback is not supported when data conversion is required",
                  __func__);
             return Result::ErrorIllegalArgument;
         }
+#endif
+
+        // If MMAP has a problem in this case then it will be disabled temporarily.
+        snapshot->mmapSafe = QuirksManager::getInstance().isMMapSafe(snapshot->childBuilder);
+    }
+
+    return openStreamWithSnapshot(snapshot, streamPP);
+}
+
+Result AudioStreamBuilder::openStreamWithSnapshot(std::shared_ptr<ReopenSnapshot> &snapshot,
+                                                  AudioStream **streamPP) {
+    Result result = Result::OK;
+    AudioStreamBuilder &builder = snapshot->builder;
+    AudioStream *streamP = nullptr;
+
+#ifndef DISABLE_CONVERSION
+    // Maybe make a FilterInputStream.
+    if (snapshot->conversionNeeded) {
         AudioStream *tempStream;
-        result = childBuilder.openStreamInternal(&tempStream);
+        {
+            ScopedTraceSection section("oboe.openStream.child");
+            if (snapshot->childSnapshot) {
+                result = openStreamWithSnapshot(snapshot->childSnapshot, &tempStream);
+            } else {
+                result = snapshot->childBuilder.openStreamInternal(&tempStream);
+            }
+        }
         if (result != Result::OK) {
             return result;
         }
+        snapshot->childSnapshot = ReopenSnapshotCollection::getInstance().getSnapshot(tempStream);
 
-        if (isCompatible(*tempStream)) {
+        if (builder.isCompatible(*tempStream)) {
             // The child stream would work as the requested stream so we can just use it directly.
+            // Keep this snapshot so that a reopen will still check for conversion.
+            ReopenSnapshotCollection::getInstance().setSnapshot(tempStream, snapshot);
             *streamPP = tempStream;
             return result;
         } else {
-            AudioStreamBuilder parentBuilder = *this;
+            AudioStreamBuilder parentBuilder = builder;
             // Build a stream that is as close as possible to the childStream.
-            if (getFormat() == oboe::AudioFormat::Unspecified) {
+            if (builder.getFormat() == oboe::AudioFormat::Unspecified) {
                 parentBuilder.setFormat(tempStream->getFormat());
             }
-            if (getChannelCount() == oboe::Unspecified) {
+            if (builder.getChannelCount() == oboe::Unspecified) {
                 parentBuilder.setChannelCount(tempStream->getChannelCount());
             }
-            if (getSampleRate() == oboe::Unspecified) {
+            if (builder.getSampleRate() == oboe::Unspecified) {
                 parentBuilder.setSampleRate(tempStream->getSampleRate());
             }
-            if (getFramesPerDataCallback() == oboe::Unspecified) {
+            if (builder.getFramesPerDataCallback() == oboe::Unspecified) {
                 parentBuilder.setFramesPerCallback(tempStream->getFramesPerDataCallback());
             }
 
@@ -164,12 +156,13 @@ Result AudioStreamBuilder::openStreamInternal(AudioStream **streamPP) {
             std::shared_ptr<AudioStream> childStream(tempStream);
             FilterAudioStream *filterStream = new FilterAudioStream(parentBuilder, childStream);
             childStream->setWeakThis(childStream);
-            result = filterStream->configureFlowGraph();
+            result = filterStream->configureFlowGraph(snapshot->resampler);
             if (result !=  Result::OK) {
                 filterStream->close();
                 delete filterStream;
                 // Just open streamP the old way.
             } else {
+                snapshot->resampler = filterStream->getReusableResampler();
                 streamP = static_cast<AudioStream *>(filterStream);
             }
         }
@@ -177,7 +170,7 @@ Result AudioStreamBuilder::openStreamInternal(AudioStream **streamPP) {
 #endif
 
     if (streamP == nullptr) {
-        streamP = build();
+        streamP = builder.build();
         if (streamP == nullptr) {
             return Result::ErrorNull;
         }
@@ -187,13 +180,15 @@ Result AudioStreamBuilder::openStreamInternal(AudioStream **streamPP) {
     bool wasMMapOriginallyEnabled = AAudioExtensions::getInstance().isMMapEnabled();
     bool wasMMapTemporarilyDisabled = false;
     if (wasMMapOriginallyEnabled) {
-        bool isMMapSafe = QuirksManager::getInstance().isMMapSafe(childBuilder);
-        if (!isMMapSafe) {
+        if (!snapshot->mmapSafe) {
             AAudioExtensions::getInstance().setMMapEnabled(false);
             wasMMapTemporarilyDisabled = true;
         }
     }
-    result = streamP->open();
+    {
+        ScopedTraceSection section("oboe.openStream.open");
+        result = streamP->open();
+    }
     if (wasMMapTemporarilyDisabled) {
         AAudioExtensions::getInstance().setMMapEnabled(wasMMapOriginallyEnabled); // restore original
     }
@@ -221,6 +216,7 @@ Result AudioStreamBuilder::openStreamInternal(AudioStream **streamPP) {
             }
         }
 
+        ReopenSnapshotCollection::getInstance().setSnapshot(streamP, snapshot);
         *streamPP = streamP;
     } else {
         delete streamP;
@@ -228,6 +224,25 @@ Result AudioStreamBuilder::openStreamInternal(AudioStream **streamPP) {
     return result;
 }
 
+Result AudioStreamBuilder::reopenStream(AudioStream &oldStream,
+                                        std::shared_ptr<AudioStream> &sharedStream) {
+    sharedStream.reset();
+    // A closed stream hands its resampler over. An open stream is still using it.
+    auto snapshot = ReopenSnapshotCollection::getInstance().copyForReopen(
+            &oldStream, oldStream.getState() == StreamState::Closed);
+    if (!snapshot) {
+        return Result::ErrorInvalidState;
+    }
+    AudioStream *streamptr;
+    auto result = openStreamWithSnapshot(snapshot, &streamptr);
+    if (result == Result::OK) {
+        sharedStream.reset(streamptr);
+        // Save a weak_ptr in the stream for use with callbacks.
+        streamptr->setWeakThis(sharedStream);
+    }
+    return result;
+}
+
 Result AudioStreamBuilder::openManagedStream(oboe::ManagedStream &stream) {
     LOGW("`openManagedStream` is deprecated. Use openStream(std::shared_ptr<oboe::AudioStream> &stream) instead.");
     stream.reset();
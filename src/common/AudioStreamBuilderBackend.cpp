@@ -0,0 +1,68 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * The parts of AudioStreamBuilder that choose and create the native AAudio or OpenSL ES stream.
+ *
+ * They are kept apart from AudioStreamBuilder.cpp so that the rest of the builder, including
+ * the QuirksManager and data conversion decisions, can be linked with a different backend.
+ * For example tests/benchmark/SimulatedStreamBuilder.cpp creates simulated streams on a host.
+ */
+
+#include "aaudio/AudioStreamAAudio.h"
+#include "OboeDebug.h"
+#include "oboe/AudioStreamBuilder.h"
+#include "oboe/Utilities.h"
+#include "opensles/AudioInputStreamOpenSLES.h"
+#include "opensles/AudioOutputStreamOpenSLES.h"
+
+namespace oboe {
+
+#ifndef OBOE_ENABLE_AAUDIO
+// Set OBOE_ENABLE_AAUDIO to 0 if you want to disable the AAudio API.
+// This might be useful if you want to force all the unit tests to use OpenSL ES.
+#define OBOE_ENABLE_AAUDIO 1
+#endif
+
+bool AudioStreamBuilder::isAAudioSupported() {
+    return AudioStreamAAudio::isSupported() && OBOE_ENABLE_AAUDIO;
+}
+
+bool AudioStreamBuilder::isAAudioRecommended() {
+    // See https://github.com/google/oboe/issues/40,
+    // AAudio may not be stable on Android O, depending on how it is used.
+    // To be safe, use AAudio only on O_MR1 and above.
+    return (getSdkVersion() >= __ANDROID_API_O_MR1__) && isAAudioSupported();
+}
+
+AudioStream *AudioStreamBuilder::build() {
+    AudioStream *stream = nullptr;
+    if (isAAudioRecommended() && mAudioApi != AudioApi::OpenSLES) {
+        stream = new AudioStreamAAudio(*this);
+    } else if (isAAudioSupported() && mAudioApi == AudioApi::AAudio) {
+        stream = new AudioStreamAAudio(*this);
+        LOGE("Creating AAudio stream on 8.0 because it was specified. This is error prone.");
+    } else {
+        if (getDirection() == oboe::Direction::Output) {
+            stream = new AudioOutputStreamOpenSLES(*this);
+        } else if (getDirection() == oboe::Direction::Input) {
+            stream = new AudioInputStreamOpenSLES(*this);
+        }
+    }
+    return stream;
+}
+
+} // namespace oboe
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "common/CallbackDispatcher.h"
+#include "common/OboeDebug.h"
+
+using namespace oboe;
+
+std::atomic<CallbackDispatcher::OwnerId> CallbackDispatcher::mNextOwnerId{1};
+
+CallbackDispatcher &CallbackDispatcher::getInstance() {
+    // Intentionally leaked so that the threads never have to be joined while the process exits.
+    static CallbackDispatcher *instance = new CallbackDispatcher();
+    return *instance;
+}
+
+CallbackDispatcher::OwnerId CallbackDispatcher::newOwnerId() {
+    return mNextOwnerId++;
+}
+
+bool CallbackDispatcher::post(OwnerId owner, std::function<void()> &&task, bool cancellable,
+                              bool useReserve) {
+    std::lock_guard<std::mutex> lock(mLock);
+    const size_t capacity = kMaxPendingTasks + (useReserve ? kNumReservedTasks : 0);
+    if (mTasks.size() >= capacity) {
+        LOGW("%s() %d tasks pending, queue is full", __func__, (int) mTasks.size());
+        return false;
+    }
+    mTasks.push_back({owner, std::move(task), cancellable});
+    // Idle workers will take the runnable tasks. Start another if there are not enough.
+    if (mNumThreads < kMaxThreads && countRunnableOwners_l() > mNumIdleThreads) {
+        std::thread thread(&CallbackDispatcher::run, this);
+        thread.detach();
+        mNumThreads++;
+    }
+    mTaskAvailable.notify_all();
+    return true;
+}
+
+int32_t CallbackDispatcher::cancel(OwnerId owner) {
+    // Destroy the tasks outside the lock because they may hold the last
+    // reference to a stream, whose destructor could call back into cancel().
+    std::deque<Task> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        for (auto it = mTasks.begin(); it != mTasks.end();) {
+            if (it->owner == owner && it->cancellable) {
+                cancelled.push_back(std::move(*it));
+                it = mTasks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (!cancelled.empty()) {
+        LOGD("%s() cancelled %d pending tasks", __func__, (int) cancelled.size());
+    }
+    return static_cast<int32_t>(cancelled.size());
+}
+
+bool CallbackDispatcher::isBusy_l(OwnerId owner) {
+    return std::find(mBusyOwners.begin(), mBusyOwners.end(), owner) != mBusyOwners.end();
+}
+
+std::deque<CallbackDispatcher::Task>::iterator CallbackDispatcher::findRunnable_l() {
+    return std::find_if(mTasks.begin(), mTasks.end(),
+                        [this](const Task &task) { return !isBusy_l(task.owner); });
+}
+
+int32_t CallbackDispatcher::countRunnableOwners_l() {
+    std::vector<OwnerId> owners;
+    for (const Task &task : mTasks) {
+        if (!isBusy_l(task.owner)
+                && std::find(owners.begin(), owners.end(), task.owner) == owners.end()) {
+            owners.push_back(task.owner);
+        }
+    }
+    return static_cast<int32_t>(owners.size());
+}
+
+void CallbackDispatcher::run() {
+    std::unique_lock<std::mutex> lock(mLock);
+    while (true) {
+        mNumIdleThreads++;
+        mTaskAvailable.wait(lock, [this] { return findRunnable_l() != mTasks.end(); });
+        mNumIdleThreads--;
+        auto it = findRunnable_l();
+        OwnerId owner = it->owner;
+        std::function<void()> function = std::move(it->function);
+        mTasks.erase(it);
+        mBusyOwners.push_back(owner);
+
+        // Run without the lock so the task can post or cancel other tasks.
+        lock.unlock();
+        function();
+        // Destroy the task before taking the lock, it may hold the last reference to a stream.
+        function = nullptr;
+        lock.lock();
+
+        mBusyOwners.erase(std::find(mBusyOwners.begin(), mBusyOwners.end(), owner));
+        // Another task for the same owner may be runnable now.
+        mTaskAvailable.notify_all();
+    }
+}
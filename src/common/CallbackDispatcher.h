@@ -0,0 +1,134 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBOE_CALLBACK_DISPATCHER_H
+#define OBOE_CALLBACK_DISPATCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace oboe {
+
+/**
+ * A small pool of persistent worker threads, shared by the whole process, that runs
+ * error, routing and presentation callbacks.
+ *
+ * This avoids creating a new thread for every event, which can happen
+ * many times per second when a device is repeatedly connected and disconnected.
+ *
+ * Events are tagged with an owner, normally a stream. Owners are identified by an OwnerId from
+ * newOwnerId() rather than by address, because the address of a deleted stream may be reused
+ * by a new one while events for the old one are still queued.
+ * Events for one owner run one at a
+ * time in the order they were posted. Events for different owners may run at the same time,
+ * so a slow callback, such as an app reopening its stream in onErrorAfterClose(), only delays
+ * later events for the same stream. A new worker is started when every worker is busy with
+ * another owner, up to kMaxThreads. Workers are kept for later events.
+ */
+class CallbackDispatcher {
+public:
+    static CallbackDispatcher &getInstance();
+
+    CallbackDispatcher(const CallbackDispatcher &) = delete;
+    CallbackDispatcher &operator=(const CallbackDispatcher &) = delete;
+
+    using OwnerId = uint64_t;
+
+    /**
+     * @return an id that has never been returned before, for use with post() and cancel()
+     */
+    static OwnerId newOwnerId();
+
+    /**
+     * Queue a task to be run on a dispatcher thread.
+     *
+     * @param owner used to order and cancel the task
+     * @param task function to run
+     * @param cancellable false if cancel() must not remove the task. Only use this when the
+     *        task keeps what it needs alive, for example by holding a shared_ptr to the stream.
+     * @param useReserve true for an error task, which may also use the kNumReservedTasks
+     *        slots so that it is not lost when routing or presentation events fill the queue
+     * @return true if queued, false if the queue is full, in which case task is not moved
+     */
+    bool post(OwnerId owner, std::function<void()> &&task, bool cancellable = true,
+              bool useReserve = false);
+
+    /**
+     * Remove any cancellable tasks for the owner that have not started running.
+     * A task that is already running is not affected.
+     *
+     * @param owner that was passed to post()
+     * @return number of tasks removed
+     */
+    int32_t cancel(OwnerId owner);
+
+    /**
+     * Maximum number of tasks that may be waiting to run.
+     * This bounds memory use if events arrive faster than the app can handle them.
+     */
+    static constexpr size_t kMaxPendingTasks = 32;
+
+    /**
+     * Extra queue slots that only tasks posted with useReserve can use.
+     * Each stream reports at most one error so this is rarely exhausted.
+     */
+    static constexpr size_t kNumReservedTasks = 8;
+
+    /**
+     * Maximum number of worker threads.
+     * If every worker is blocked then tasks for other owners wait.
+     */
+    static constexpr int32_t kMaxThreads = 4;
+
+private:
+    CallbackDispatcher() = default;
+    ~CallbackDispatcher() = default;
+
+    struct Task {
+        OwnerId                owner;
+        std::function<void()>  function;
+        bool                   cancellable;
+    };
+
+    void run();
+
+    // Find the oldest task whose owner is not running a task. Call under mLock.
+    std::deque<Task>::iterator findRunnable_l();
+
+    // Number of different owners with a task that could start now. Call under mLock.
+    int32_t countRunnableOwners_l();
+
+    bool isBusy_l(OwnerId owner);
+
+    std::mutex               mLock;
+    std::condition_variable  mTaskAvailable;
+    std::deque<Task>         mTasks;
+    std::vector<OwnerId>     mBusyOwners; // owners with a task running now
+    int32_t                  mNumThreads = 0;
+    int32_t                  mNumIdleThreads = 0;
+
+    static std::atomic<OwnerId> mNextOwnerId;
+};
+
+} // namespace oboe
+
+#endif //OBOE_CALLBACK_DISPATCHER_H
@@ -183,12 +183,23 @@ Result DataConversionFlowGraph::configure(AudioStream *sourceStream, AudioStream
 
     // Sample Rate conversion
     if (sourceSampleRate != sinkSampleRate) {
-        // Create a resampler to do the math.
-        mResampler.reset(MultiChannelResampler::make(lastOutput->getSamplesPerFrame(),
-                                                     sourceSampleRate,
-                                                     sinkSampleRate,
-                                                     convertOboeSRQualityToMCR(
-                                                             sourceStream->getSampleRateConversionQuality())));
+        int32_t resamplerChannelCount = lastOutput->getSamplesPerFrame();
+        MultiChannelResampler::Quality quality = convertOboeSRQualityToMCR(
+                sourceStream->getSampleRateConversionQuality());
+        if (mReusableResampler.matches(resamplerChannelCount, sourceSampleRate, sinkSampleRate,
+                                       quality)) {
+            // Reuse the coefficients but start with empty history.
+            mResampler = mReusableResampler.resampler;
+            mResampler->reset();
+        } else {
+            // Create a resampler to do the math.
+            mResampler.reset(MultiChannelResampler::make(resamplerChannelCount,
+                                                         sourceSampleRate,
+                                                         sinkSampleRate,
+                                                         quality));
+        }
+        mReusableResampler = {mResampler, resamplerChannelCount, sourceSampleRate,
+                              sinkSampleRate, quality};
         // Make a flowgraph node that uses the resampler.
         mRateConverter = std::make_unique<SampleRateConverter>(lastOutput->getSamplesPerFrame(),
                                                                *mResampler.get());
@@ -34,6 +34,31 @@ namespace oboe {
 class AudioStream;
 class AudioSourceCaller;
 
+/**
+ * A sample rate converter together with the parameters it was built for.
+ * Building the converter can be expensive because of the filter coefficients,
+ * so it may be handed to a new flowgraph when a stream is reopened.
+ */
+struct ReusableResampler {
+    std::shared_ptr<resampler::MultiChannelResampler> resampler;
+    int32_t channelCount = 0;
+    int32_t inputRate = 0;
+    int32_t outputRate = 0;
+    resampler::MultiChannelResampler::Quality quality =
+            resampler::MultiChannelResampler::Quality::Medium;
+
+    bool matches(int32_t otherChannelCount,
+                 int32_t otherInputRate,
+                 int32_t otherOutputRate,
+                 resampler::MultiChannelResampler::Quality otherQuality) const {
+        return resampler != nullptr
+                && channelCount == otherChannelCount
+                && inputRate == otherInputRate
+                && outputRate == otherOutputRate
+                && quality == otherQuality;
+    }
+};
+
 /**
  * Convert PCM channels, format and sample rate for optimal latency.
  */
@@ -56,6 +81,25 @@ public:
      */
     oboe::Result configure(oboe::AudioStream *sourceStream, oboe::AudioStream *sinkStream);
 
+    /**
+     * Offer a resampler from an earlier flowgraph. It will be reset and used by configure()
+     * if it matches the required conversion. Otherwise a new one will be built.
+     * The resampler must not be in use by another flowgraph.
+     * Call this before configure().
+     *
+     * @param reusableResampler
+     */
+    void setReusableResampler(const ReusableResampler &reusableResampler) {
+        mReusableResampler = reusableResampler;
+    }
+
+    /**
+     * @return the resampler used by this flowgraph, which is empty if no rate conversion is needed
+     */
+    const ReusableResampler &getReusableResampler() const {
+        return mReusableResampler;
+    }
+
     int32_t read(void *buffer, int32_t numFrames, int64_t timeoutNanos);
 
     int32_t write(void *buffer, int32_t numFrames);
@@ -72,10 +116,12 @@ private:
     std::unique_ptr<flowgraph::MonoToMultiConverter>   mMonoToMultiConverter;
     std::unique_ptr<flowgraph::MultiToMonoConverter>   mMultiToMonoConverter;
     std::unique_ptr<flowgraph::ChannelCountConverter>  mChannelCountConverter;
-    std::unique_ptr<resampler::MultiChannelResampler>  mResampler;
+    std::shared_ptr<resampler::MultiChannelResampler>  mResampler;
     std::unique_ptr<flowgraph::SampleRateConverter>    mRateConverter;
     std::unique_ptr<flowgraph::FlowGraphSink>              mSink;
 
+    ReusableResampler                                  mReusableResampler;
+
     FixedBlockWriter                                   mBlockWriter;
     DataCallbackResult                                 mCallbackResult = DataCallbackResult::Continue;
     AudioStream                                       *mFilterStream = nullptr;
@@ -18,6 +18,7 @@
 
 #include "OboeDebug.h"
 #include "FilterAudioStream.h"
+#include "Trace.h"
 
 using namespace oboe;
 using namespace flowgraph;
@@ -41,8 +42,10 @@ using namespace flowgraph;
 //                <== FilterAudioStream::read()
 //                <= app
 
-Result FilterAudioStream::configureFlowGraph() {
+Result FilterAudioStream::configureFlowGraph(const ReusableResampler &reusableResampler) {
+    ScopedTraceSection section("oboe.configureFlowGraph");
     mFlowGraph = std::make_unique<DataConversionFlowGraph>();
+    mFlowGraph->setReusableResampler(reusableResampler);
     bool isOutput = getDirection() == Direction::Output;
 
     AudioStream *sourceStream =  isOutput ? this : mChildStream.get();
@@ -69,7 +69,20 @@ public:
 
     virtual ~FilterAudioStream() = default;
 
-    Result configureFlowGraph();
+    /**
+     * Build the flowgraph that converts between this stream and the child stream.
+     *
+     * @param reusableResampler resampler from an earlier stream that may be reused, or empty
+     * @return OK or a Result::Error
+     */
+    Result configureFlowGraph(const ReusableResampler &reusableResampler = {});
+
+    /**
+     * @return the resampler used by the flowgraph so it can be reused by AudioStream::reopen()
+     */
+    const ReusableResampler &getReusableResampler() const {
+        return mFlowGraph->getReusableResampler();
+    }
 
     // Close child and parent.
     Result close()  override {
@@ -18,12 +18,27 @@
 #ifndef OBOE_DEBUG_H
 #define OBOE_DEBUG_H
 
-#include <android/log.h>
-
 #ifndef MODULE_NAME
 #define MODULE_NAME  "OboeAudio"
 #endif
 
+#ifdef __ANDROID__
+#include <android/log.h>
+#else
+// Log to stderr so the portable parts of Oboe can be built on a host, e.g. for benchmarks.
+#include <cstdio>
+#define ANDROID_LOG_VERBOSE "V"
+#define ANDROID_LOG_DEBUG   "D"
+#define ANDROID_LOG_INFO    "I"
+#define ANDROID_LOG_WARN    "W"
+#define ANDROID_LOG_ERROR   "E"
+#define ANDROID_LOG_FATAL   "F"
+#define __android_log_print(priority, tag, ...) \
+        (fprintf(stderr, "%s/%s: ", priority, tag), \
+         fprintf(stderr, __VA_ARGS__), \
+         fputc('\n', stderr))
+#endif
+
 // Always log INFO and errors.
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, MODULE_NAME, __VA_ARGS__)
 #define LOGW(...) __android_log_print(ANDROID_LOG_WARN, MODULE_NAME, __VA_ARGS__)
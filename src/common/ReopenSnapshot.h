@@ -0,0 +1,156 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBOE_REOPEN_SNAPSHOT_H
+#define OBOE_REOPEN_SNAPSHOT_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "oboe/AudioStreamBuilder.h"
+
+#ifndef DISABLE_CONVERSION
+#include "DataConversionFlowGraph.h"
+#endif
+
+namespace oboe {
+
+/**
+ * The decisions made by AudioStreamBuilder while opening a stream.
+ * These are saved in the ReopenSnapshotCollection so that AudioStream::reopen() can skip them.
+ */
+struct ReopenSnapshot {
+    explicit ReopenSnapshot(const AudioStreamBuilder &requestedBuilder)
+            : builder(requestedBuilder)
+            , childBuilder(requestedBuilder) {}
+
+    /**
+     * Copy the decisions for opening a new stream.
+     *
+     * The resampler is only moved into the copy if takeResampler is true.
+     * Then it is removed from this snapshot so that a second reopen builds a new one
+     * and two live streams never share the filter state.
+     *
+     * @param takeResampler true if the stream that owns this snapshot is closed
+     *
+     * Only call this through ReopenSnapshotCollection::copyForReopen(), which holds a lock,
+     * because the snapshot is shared.
+     */
+    std::shared_ptr<ReopenSnapshot> copyForReopen(bool takeResampler) {
+        auto copy = std::make_shared<ReopenSnapshot>(*this);
+#ifndef DISABLE_CONVERSION
+        copy->resampler = ReusableResampler();
+        if (takeResampler) {
+            std::swap(copy->resampler, resampler);
+        }
+#endif
+        if (childSnapshot) {
+            copy->childSnapshot = childSnapshot->copyForReopen(takeResampler);
+        }
+        return copy;
+    }
+
+    // Settings requested by the app.
+    AudioStreamBuilder builder;
+
+    // Settings for the child stream as modified by QuirksManager::isConversionNeeded().
+    AudioStreamBuilder childBuilder;
+
+    // Result of QuirksManager::isConversionNeeded().
+    bool conversionNeeded = false;
+
+    // Result of QuirksManager::isMMapSafe().
+    bool mmapSafe = true;
+
+    // Snapshot used to open the child stream when conversion is needed.
+    std::shared_ptr<ReopenSnapshot> childSnapshot;
+
+#ifndef DISABLE_CONVERSION
+    // Sample rate converter from the FilterAudioStream, if any.
+    ReusableResampler resampler;
+#endif
+};
+
+/**
+ * The snapshot of each stream opened by AudioStreamBuilder.
+ *
+ * This is kept outside of AudioStream so that the layout of the public class does not change.
+ * A stream is removed when it is deleted, so a new stream at the same address never
+ * finds the snapshot of an old one.
+ */
+class ReopenSnapshotCollection {
+public:
+    static ReopenSnapshotCollection &getInstance() {
+        // Intentionally leaked so that streams deleted while the process exits can still
+        // remove themselves.
+        static ReopenSnapshotCollection *instance = new ReopenSnapshotCollection();
+        return *instance;
+    }
+
+    ReopenSnapshotCollection(const ReopenSnapshotCollection &) = delete;
+    ReopenSnapshotCollection &operator=(const ReopenSnapshotCollection &) = delete;
+
+    void setSnapshot(const AudioStream *stream, std::shared_ptr<ReopenSnapshot> snapshot) {
+        std::lock_guard<std::mutex> lock(mLock);
+        std::swap(mSnapshots[stream], snapshot);
+        // The previous snapshot, if any, is released after the lock.
+    }
+
+    std::shared_ptr<ReopenSnapshot> getSnapshot(const AudioStream *stream) {
+        std::lock_guard<std::mutex> lock(mLock);
+        auto it = mSnapshots.find(stream);
+        return (it == mSnapshots.end()) ? nullptr : it->second;
+    }
+
+    /**
+     * Copy the snapshot of a stream for opening a new stream.
+     * This holds the lock so that only one reopen of a closed stream takes its resampler.
+     *
+     * @param stream the stream being reopened
+     * @param takeResampler true if the stream is closed
+     * @return copy of the snapshot, or nullptr if the stream was not opened by a builder
+     */
+    std::shared_ptr<ReopenSnapshot> copyForReopen(const AudioStream *stream,
+                                                  bool takeResampler) {
+        std::lock_guard<std::mutex> lock(mLock);
+        auto it = mSnapshots.find(stream);
+        return (it == mSnapshots.end()) ? nullptr : it->second->copyForReopen(takeResampler);
+    }
+
+    void removeStream(const AudioStream *stream) {
+        std::shared_ptr<ReopenSnapshot> snapshot; // released after the lock
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            auto it = mSnapshots.find(stream);
+            if (it == mSnapshots.end()) return;
+            snapshot = std::move(it->second);
+            mSnapshots.erase(it);
+        }
+    }
+
+private:
+    ReopenSnapshotCollection() = default;
+    ~ReopenSnapshotCollection() = default;
+
+    std::mutex mLock;
+    std::unordered_map<const AudioStream *, std::shared_ptr<ReopenSnapshot>> mSnapshots;
+};
+
+} // namespace oboe
+
+#endif //OBOE_REOPEN_SNAPSHOT_H
@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 
+#include <unistd.h>
+
+#include "common/AdpfWrapper.h"
+#include "common/OboeDebug.h"
 #include "common/Trace.h"
 #include "oboe/AudioClock.h"
 #include "oboe/StabilizedCallback.h"
@@ -23,6 +27,41 @@ constexpr float kPercentageOfCallbackToUse = 0.8;
 
 using namespace oboe;
 
+/**
+ * Spin the CPU until the deadline has passed.
+ *
+ * @param deadlineTimeNanos time, from AudioClock::getNanoseconds(), at which to stop
+ * @param opsPerNano calibrated number of operations per nanosecond, updated as load is generated
+ */
+static void spinUntil(int64_t deadlineTimeNanos, double &opsPerNano) {
+
+    int64_t currentTimeNanos = AudioClock::getNanoseconds();
+
+    // opsPerStep gives us an estimated number of operations which need to be run to fully utilize
+    // the CPU for a fixed amount of time (specified by kLoadGenerationStepSizeNanos).
+    // After each step the opsPerStep value is re-calculated based on the actual time taken to
+    // execute those operations.
+    auto opsPerStep = (int)(opsPerNano * kLoadGenerationStepSizeNanos);
+    int64_t stepDurationNanos = 0;
+    int64_t previousTimeNanos = 0;
+
+    while (currentTimeNanos <= deadlineTimeNanos){
+
+        for (int i = 0; i < opsPerStep; i++) cpu_relax();
+
+        previousTimeNanos = currentTimeNanos;
+        currentTimeNanos = AudioClock::getNanoseconds();
+        stepDurationNanos = currentTimeNanos - previousTimeNanos;
+
+        // Calculate exponential moving average to smooth out values, this acts as a low pass filter.
+        // @see https://en.wikipedia.org/wiki/Moving_average#Exponential_moving_average
+        static const float kFilterCoefficient = 0.1;
+        auto measuredOpsPerNano = (double) opsPerStep / stepDurationNanos;
+        opsPerNano = kFilterCoefficient * measuredOpsPerNano + (1.0 - kFilterCoefficient) * opsPerNano;
+        opsPerStep = (int) (opsPerNano * kLoadGenerationStepSizeNanos);
+    }
+}
+
 StabilizedCallback::StabilizedCallback(AudioStreamCallback *callback) : mCallback(callback) {
 }
 
@@ -82,31 +121,151 @@ StabilizedCallback::onAudioReady(AudioStream *oboeStream, void *audioData, int32
 }
 
 void StabilizedCallback::generateLoad(int64_t durationNanos) {
+    spinUntil(AudioClock::getNanoseconds() + durationNanos, mOpsPerNano);
+}
 
-    int64_t currentTimeNanos = AudioClock::getNanoseconds();
-    int64_t deadlineTimeNanos = currentTimeNanos + durationNanos;
+EnergyAwareStabilizedCallback::EnergyAwareStabilizedCallback(AudioStreamCallback *callback)
+        : mCallback(callback)
+        , mAdpfWrapper(std::make_unique<AdpfWrapper>()) {
+}
 
-    // opsPerStep gives us an estimated number of operations which need to be run to fully utilize
-    // the CPU for a fixed amount of time (specified by kLoadGenerationStepSizeNanos).
-    // After each step the opsPerStep value is re-calculated based on the actual time taken to
-    // execute those operations.
-    auto opsPerStep = (int)(mOpsPerNano * kLoadGenerationStepSizeNanos);
-    int64_t stepDurationNanos = 0;
-    int64_t previousTimeNanos = 0;
+EnergyAwareStabilizedCallback::~EnergyAwareStabilizedCallback() {
+    mAdpfWrapper->close();
+}
 
-    while (currentTimeNanos <= deadlineTimeNanos){
+/**
+ * An audio callback which reports the actual work to the performance hint session
+ * and only generates synthetic load when the callback timing is unstable.
+ *
+ * @param oboeStream
+ * @param audioData
+ * @param numFrames
+ * @return
+ */
+DataCallbackResult
+EnergyAwareStabilizedCallback::onAudioReady(AudioStream *oboeStream,
+                                            void *audioData,
+                                            int32_t numFrames) {
 
-        for (int i = 0; i < opsPerStep; i++) cpu_relax();
+    int64_t startTimeNanos = AudioClock::getNanoseconds();
+    int32_t sampleRate = oboeStream->getSampleRate();
 
-        previousTimeNanos = currentTimeNanos;
-        currentTimeNanos = AudioClock::getNanoseconds();
-        stepDurationNanos = currentTimeNanos - previousTimeNanos;
+    if (mFrameCount == 0){
+        mEpochTimeNanos = startTimeNanos;
+    }
 
-        // Calculate exponential moving average to smooth out values, this acts as a low pass filter.
-        // @see https://en.wikipedia.org/wiki/Moving_average#Exponential_moving_average
-        static const float kFilterCoefficient = 0.1;
-        auto measuredOpsPerNano = (double) opsPerStep / stepDurationNanos;
-        mOpsPerNano = kFilterCoefficient * measuredOpsPerNano + (1.0 - kFilterCoefficient) * mOpsPerNano;
-        opsPerStep = (int) (mOpsPerNano * kLoadGenerationStepSizeNanos);
+    // See StabilizedCallback::onAudioReady() for how the late start is measured.
+    int64_t idealStartTimeNanos = (mFrameCount * kNanosPerSecond) / sampleRate;
+    int64_t lateStartNanos = (startTimeNanos - mEpochTimeNanos) - idealStartTimeNanos;
+    if (lateStartNanos < 0){
+        mEpochTimeNanos = startTimeNanos;
+        mFrameCount = 0;
+        lateStartNanos = 0;
     }
+
+    // Smooth the late start so a single late callback does not trigger load generation.
+    static const double kJitterFilterCoefficient = 0.1;
+    mLateStartAverageNanos = kJitterFilterCoefficient * lateStartNanos
+            + (1.0 - kJitterFilterCoefficient) * mLateStartAverageNanos;
+
+    int64_t numFramesAsNanos = (numFrames * kNanosPerSecond) / sampleRate;
+    int32_t framesPerBurst = oboeStream->getFramesPerBurst();
+    if (framesPerBurst <= 0) framesPerBurst = numFrames;
+    int64_t burstNanos = (framesPerBurst * kNanosPerSecond) / sampleRate;
+
+    bool streamHintActive = beginPerformanceHint(oboeStream, burstNanos);
+
+    bool traceEnabled = Trace::getInstance().isEnabled();
+    if (traceEnabled) Trace::getInstance().beginSection("Actual load");
+    DataCallbackResult result = mCallback->onAudioReady(oboeStream, audioData, numFrames);
+    if (traceEnabled) Trace::getInstance().endSection();
+
+    int64_t endTimeNanos = AudioClock::getNanoseconds();
+    // Report only the real work so the governor sees the true demand.
+    endPerformanceHint(numFrames, framesPerBurst);
+
+    // The stream's own session measures the whole callback, which would include the load.
+    // Only give up the fallback if that session really opened, not just because it was asked for.
+    bool generatingLoad = !streamHintActive
+            && mLateStartAverageNanos > (mJitterThreshold * numFramesAsNanos);
+    if (generatingLoad) {
+        int64_t deadlineNanos = startTimeNanos
+                + static_cast<int64_t>(numFramesAsNanos * mMinimumWorkBudget)
+                - lateStartNanos;
+        if (deadlineNanos > endTimeNanos) {
+            if (traceEnabled) {
+                Trace::getInstance().beginSection("Stabilized load for %lldns",
+                                                  (long long) (deadlineNanos - endTimeNanos));
+            }
+            mInjectedLoadNanos += generateLoadUntil(deadlineNanos);
+            if (traceEnabled) Trace::getInstance().endSection();
+        }
+    }
+    mGeneratingLoad.store(generatingLoad);
+    mCallbackWorkNanos += endTimeNanos - startTimeNanos;
+    mAudioDurationNanos += numFramesAsNanos;
+
+    mFrameCount += numFrames;
+    return result;
+}
+
+void EnergyAwareStabilizedCallback::onErrorAfterClose(AudioStream *oboeStream, Result error) {
+    // Reset all fields now that the stream has been closed
+    reset();
+    return mCallback->onErrorAfterClose(oboeStream, error);
+}
+
+void EnergyAwareStabilizedCallback::reset() {
+    mAdpfWrapper->close();
+    mAdpfOpenAttempted = false;
+    mFrameCount = 0;
+    mEpochTimeNanos = 0;
+    mOpsPerNano = 1;
+    mLateStartAverageNanos = 0;
+    mGeneratingLoad.store(false);
+    mInjectedLoadNanos.store(0);
+    mCallbackWorkNanos.store(0);
+    mAudioDurationNanos.store(0);
+}
+
+bool EnergyAwareStabilizedCallback::beginPerformanceHint(AudioStream *oboeStream,
+                                                         int64_t burstNanos) {
+    // The stream opens its session before calling us, so this is known by now.
+    if (oboeStream->isPerformanceHintActive()) {
+        // The stream reports to its own session so do not report twice.
+        if (mAdpfOpenAttempted) {
+            mAdpfWrapper->close();
+            mAdpfOpenAttempted = false;
+        }
+        return true;
+    }
+    if (!mAdpfOpenAttempted) {
+        // This has to be called from the callback thread so we get the right TID.
+        int adpfResult = mAdpfWrapper->open(gettid(), burstNanos);
+        if (adpfResult < 0) {
+            LOGW("%s() ADPF not supported, %d, will rely on jitter threshold",
+                 __func__, adpfResult);
+        }
+        mAdpfOpenAttempted = true;
+    }
+    mAdpfWrapper->onBeginCallback();
+    return false;
+}
+
+void EnergyAwareStabilizedCallback::endPerformanceHint(int32_t numFrames,
+                                                       int32_t framesPerBurst) {
+    if (mAdpfWrapper->isOpen()) {
+        // Scale the measured duration so it is normalized to a full burst.
+        double durationScaler = static_cast<double>(framesPerBurst) / numFrames;
+        // Skip very small callbacks, as in AudioStreamAAudio::endPerformanceHintInCallback().
+        if (durationScaler < 2.0) {
+            mAdpfWrapper->onEndCallback(durationScaler);
+        }
+    }
+}
+
+int64_t EnergyAwareStabilizedCallback::generateLoadUntil(int64_t deadlineNanos) {
+    int64_t beginNanos = AudioClock::getNanoseconds();
+    spinUntil(deadlineNanos, mOpsPerNano);
+    return AudioClock::getNanoseconds() - beginNanos;
 }
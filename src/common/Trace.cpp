@@ -15,12 +15,16 @@
  */
 
 #include <dlfcn.h>
+#include <cstdarg>
 #include <cstdio>
 #include "Trace.h"
 #include "OboeDebug.h"
+#include "oboe/AudioClock.h"
 
 using namespace oboe;
 
+std::atomic<Trace::SectionListener> Trace::sSectionListener{nullptr};
+
 typedef void *(*fp_ATrace_beginSection)(const char *sectionName);
 
 typedef void *(*fp_ATrace_endSection)();
@@ -92,3 +96,24 @@ Trace::Trace() {
         }
     }
 }
+
+ScopedTraceSection::ScopedTraceSection(const char *sectionName)
+        : mSectionName(sectionName)
+        , mListener(Trace::getSectionListener())
+        , mTraceEnabled(Trace::getInstance().isEnabled()) {
+    if (mTraceEnabled) {
+        Trace::getInstance().beginSection("%s", sectionName);
+    }
+    if (mListener != nullptr) {
+        mStartNanos = AudioClock::getNanoseconds();
+    }
+}
+
+ScopedTraceSection::~ScopedTraceSection() {
+    if (mListener != nullptr) {
+        mListener(mSectionName, AudioClock::getNanoseconds() - mStartNanos);
+    }
+    if (mTraceEnabled) {
+        Trace::getInstance().endSection();
+    }
+}
@@ -17,6 +17,7 @@
 #ifndef OBOE_TRACE_H
 #define OBOE_TRACE_H
 
+#include <atomic>
 #include <cstdint>
 
 namespace oboe {
@@ -56,7 +57,26 @@ public:
      */
     void setCounter(const char *counterName, int64_t counterValue) const;
 
+    /**
+     * Called with the name and duration of every ScopedTraceSection as it ends.
+     * This lets a benchmark time the phases inside Oboe, even on a host without Perfetto.
+     */
+    using SectionListener = void (*)(const char *sectionName, int64_t durationNanos);
+
+    /**
+     * @param listener function to call from any thread, or nullptr to stop
+     */
+    static void setSectionListener(SectionListener listener) {
+        sSectionListener.store(listener);
+    }
+
+    static SectionListener getSectionListener() {
+        return sSectionListener.load();
+    }
+
 private:
+    static std::atomic<SectionListener> sSectionListener;
+
     Trace();
 // Tracing functions
     void *(*ATrace_beginSection)(const char *sectionName) = nullptr;
@@ -68,5 +88,27 @@ private:
     bool *(*ATrace_isEnabled)(void) = nullptr;
 };
 
+/**
+ * Trace a section of code until the end of the scope, and report its duration
+ * to the Trace::SectionListener if there is one.
+ * This is meant for infrequent operations, such as opening a stream.
+ */
+class ScopedTraceSection {
+public:
+    // @param sectionName must stay valid until the end of the scope, normally a literal
+    explicit ScopedTraceSection(const char *sectionName);
+
+    ~ScopedTraceSection();
+
+    ScopedTraceSection(const ScopedTraceSection &) = delete;
+    ScopedTraceSection &operator=(const ScopedTraceSection &) = delete;
+
+private:
+    const char              *mSectionName;
+    Trace::SectionListener   mListener;
+    bool                     mTraceEnabled;
+    int64_t                  mStartNanos = 0;
+};
+
 }
 #endif //OBOE_TRACE_H
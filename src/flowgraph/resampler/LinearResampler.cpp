@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include "LinearResampler.h"
 
 using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
@@ -24,6 +27,12 @@ LinearResampler::LinearResampler(const MultiChannelResampler::Builder &builder)
     mCurrentFrame = std::make_unique<float[]>(getChannelCount());
 }
 
+void LinearResampler::reset() {
+    MultiChannelResampler::reset();
+    std::fill(mPreviousFrame.get(), mPreviousFrame.get() + getChannelCount(), 0.0f);
+    std::fill(mCurrentFrame.get(), mCurrentFrame.get() + getChannelCount(), 0.0f);
+}
+
 void LinearResampler::writeFrame(const float *frame) {
     memcpy(mPreviousFrame.get(), mCurrentFrame.get(), sizeof(float) * getChannelCount());
     memcpy(mCurrentFrame.get(), frame, sizeof(float) * getChannelCount());
@@ -37,6 +37,8 @@ public:
 
     void readFrame(float *frame) override;
 
+    void reset() override;
+
 private:
     std::unique_ptr<float[]> mPreviousFrame;
     std::unique_ptr<float[]> mCurrentFrame;
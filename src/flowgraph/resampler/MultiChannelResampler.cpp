@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <math.h>
 
 #include "IntegerRatio.h"
@@ -106,6 +107,12 @@ MultiChannelResampler *MultiChannelResampler::Builder::build() {
     }
 }
 
+void MultiChannelResampler::reset() {
+    std::fill(mX.begin(), mX.end(), 0.0f);
+    mCursor = 0;
+    mIntegerPhase = mDenominator; // so we start with a write needed
+}
+
 void MultiChannelResampler::writeFrame(const float *frame) {
     // Move cursor before write so that cursor points to last written frame in read.
     if (--mCursor < 0) {
@@ -194,6 +194,12 @@ public:
         return mNumTaps;
     }
 
+    /**
+     * Clear the input history and phase so the resampler can be reused for a new stream.
+     * The filter coefficients are kept, which avoids calculating them again.
+     */
+    virtual void reset();
+
     int getChannelCount() const {
         return mChannelCount;
     }
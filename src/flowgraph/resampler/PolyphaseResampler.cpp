@@ -37,6 +37,11 @@ PolyphaseResampler::PolyphaseResampler(const MultiChannelResampler::Builder &bui
                          builder.getNormalizedCutoff());
 }
 
+void PolyphaseResampler::reset() {
+    MultiChannelResampler::reset();
+    mCoefficientCursor = 0;
+}
+
 void PolyphaseResampler::readFrame(float *frame) {
     // Clear accumulator for mixing.
     std::fill(mSingleFrame.begin(), mSingleFrame.end(), 0.0);
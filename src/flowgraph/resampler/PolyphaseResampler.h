@@ -42,6 +42,8 @@ public:
 
     void readFrame(float *frame) override;
 
+    void reset() override;
+
 protected:
 
     int32_t                mCoefficientCursor = 0;
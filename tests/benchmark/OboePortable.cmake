@@ -0,0 +1,67 @@
+# Builds the parts of Oboe that do not depend on AAudio or OpenSL ES as oboe_portable,
+# so that code above the native APIs can run on a Linux host.
+# AudioStreamBuilder is included without its backend. Link SimulatedStreamBuilder.cpp
+# to provide one.
+# Set OBOE_DIR before including this file.
+
+add_library(oboe_portable STATIC
+    ${OBOE_DIR}/src/aaudio/AAudioLoader.cpp
+    ${OBOE_DIR}/src/common/AdpfWrapper.cpp
+    ${OBOE_DIR}/src/common/AudioSourceCaller.cpp
+    ${OBOE_DIR}/src/common/AudioStream.cpp
+    ${OBOE_DIR}/src/common/AudioStreamBuilder.cpp
+    ${OBOE_DIR}/src/common/DataConversionFlowGraph.cpp
+    ${OBOE_DIR}/src/common/FilterAudioStream.cpp
+    ${OBOE_DIR}/src/common/FixedBlockAdapter.cpp
+    ${OBOE_DIR}/src/common/FixedBlockReader.cpp
+    ${OBOE_DIR}/src/common/FixedBlockWriter.cpp
+    ${OBOE_DIR}/src/common/OboeExtensions.cpp
+    ${OBOE_DIR}/src/common/QuirksManager.cpp
+    ${OBOE_DIR}/src/common/SourceFloatCaller.cpp
+    ${OBOE_DIR}/src/common/SourceI16Caller.cpp
+    ${OBOE_DIR}/src/common/SourceI24Caller.cpp
+    ${OBOE_DIR}/src/common/SourceI32Caller.cpp
+    ${OBOE_DIR}/src/common/Trace.cpp
+    ${OBOE_DIR}/src/common/Utilities.cpp
+    ${OBOE_DIR}/src/common/Version.cpp
+    ${OBOE_DIR}/src/flowgraph/FlowGraphNode.cpp
+    ${OBOE_DIR}/src/flowgraph/ChannelCountConverter.cpp
+    ${OBOE_DIR}/src/flowgraph/ClipToRange.cpp
+    ${OBOE_DIR}/src/flowgraph/Limiter.cpp
+    ${OBOE_DIR}/src/flowgraph/ManyToMultiConverter.cpp
+    ${OBOE_DIR}/src/flowgraph/MonoBlend.cpp
+    ${OBOE_DIR}/src/flowgraph/MonoToMultiConverter.cpp
+    ${OBOE_DIR}/src/flowgraph/MultiToManyConverter.cpp
+    ${OBOE_DIR}/src/flowgraph/MultiToMonoConverter.cpp
+    ${OBOE_DIR}/src/flowgraph/RampLinear.cpp
+    ${OBOE_DIR}/src/flowgraph/SampleRateConverter.cpp
+    ${OBOE_DIR}/src/flowgraph/SinkFloat.cpp
+    ${OBOE_DIR}/src/flowgraph/SinkI16.cpp
+    ${OBOE_DIR}/src/flowgraph/SinkI24.cpp
+    ${OBOE_DIR}/src/flowgraph/SinkI32.cpp
+    ${OBOE_DIR}/src/flowgraph/SinkI8_24.cpp
+    ${OBOE_DIR}/src/flowgraph/SourceFloat.cpp
+    ${OBOE_DIR}/src/flowgraph/SourceI16.cpp
+    ${OBOE_DIR}/src/flowgraph/SourceI24.cpp
+    ${OBOE_DIR}/src/flowgraph/SourceI32.cpp
+    ${OBOE_DIR}/src/flowgraph/SourceI8_24.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/IntegerRatio.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/LinearResampler.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/MultiChannelResampler.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/PolyphaseResampler.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/PolyphaseResamplerMono.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/PolyphaseResamplerStereo.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/SincResampler.cpp
+    ${OBOE_DIR}/src/flowgraph/resampler/SincResamplerStereo.cpp
+    )
+# Selects the oboe namespace for the flowgraph, as in the NDK build.
+# There are no AAudio headers on a host. libaaudio.so is not found at run time,
+# so AAudio is reported as unsupported.
+target_compile_definitions(oboe_portable PUBLIC __ANDROID_NDK__ OBOE_NO_INCLUDE_AAUDIO)
+target_include_directories(oboe_portable PUBLIC
+    ${OBOE_DIR}/include
+    ${OBOE_DIR}/src
+    ${OBOE_DIR}/src/flowgraph
+    )
+find_package(Threads REQUIRED)
+target_link_libraries(oboe_portable PUBLIC Threads::Threads ${CMAKE_DL_LIBS})
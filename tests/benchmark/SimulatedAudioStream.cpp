@@ -0,0 +1,415 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "common/OboeDebug.h"
+#include "SimulatedAudioStream.h"
+
+using namespace oboe;
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+SimulatedAudioStream::SimulatedAudioStream(const AudioStreamBuilder &builder,
+                                           const SimulatedDevice &device)
+        : AudioStream(builder)
+        , mDevice(device) {
+}
+
+SimulatedAudioStream::~SimulatedAudioStream() {
+    if (getState() != StreamState::Closed && getState() != StreamState::Uninitialized) {
+        close();
+    }
+}
+
+Result SimulatedAudioStream::open() {
+    if (getState() != StreamState::Uninitialized) {
+        return Result::ErrorInvalidState;
+    }
+    // Like AAudio, honor explicit requests and fill the rest from the device.
+    if (mSampleRate == kUnspecified) {
+        mSampleRate = mDevice.sampleRate;
+    }
+    if (mChannelCount == kUnspecified) {
+        mChannelCount = mDevice.channelCount;
+    }
+    if (mFormat == AudioFormat::Unspecified) {
+        mFormat = mDevice.format;
+    }
+    mFramesPerBurst = mDevice.framesPerBurst;
+    mBufferCapacityInFrames = mDevice.framesPerBurst * mDevice.burstsPerCapacity;
+    mBufferSizeInFrames = mDevice.framesPerBurst * mDevice.burstsPerBuffer;
+    mHardwareSampleRate = mDevice.sampleRate;
+    mHardwareChannelCount = mDevice.channelCount;
+    mHardwareFormat = mDevice.format;
+
+    const int32_t framesPerCallback = (mFramesPerCallback > 0)
+            ? mFramesPerCallback : mFramesPerBurst;
+    mCallbackBuffer = std::make_unique<uint8_t[]>(framesPerCallback * getBytesPerFrame());
+
+    if (mDevice.openDelayNanos > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(mDevice.openDelayNanos));
+    }
+
+    std::lock_guard<std::mutex> lock(mStateLock);
+    setState(StreamState::Open);
+    return AudioStream::open();
+}
+
+Result SimulatedAudioStream::close() {
+    std::lock_guard<std::mutex> lock(mLock);
+    {
+        std::lock_guard<std::mutex> stateLock(mStateLock);
+        StreamState state = getState();
+        if (state == StreamState::Closed) {
+            return Result::ErrorClosed;
+        }
+        if (state == StreamState::Starting || state == StreamState::Started) {
+            setState(StreamState::Stopping);
+        }
+    }
+    joinServiceThread();
+    {
+        std::lock_guard<std::mutex> stateLock(mStateLock);
+        setState(StreamState::Closed);
+    }
+    return AudioStream::close();
+}
+
+Result SimulatedAudioStream::requestStart() {
+    std::lock_guard<std::mutex> lock(mLock);
+    {
+        std::lock_guard<std::mutex> stateLock(mStateLock);
+        switch (getState()) {
+            case StreamState::Closed:
+                return Result::ErrorClosed;
+            case StreamState::Uninitialized:
+            case StreamState::Disconnected:
+                return Result::ErrorInvalidState;
+            case StreamState::Starting:
+            case StreamState::Started:
+                return Result::OK;
+            default:
+                break;
+        }
+    }
+    // The previous service thread exits once it has completed the stop or pause.
+    joinServiceThread();
+    if (isDataCallbackSpecified()) {
+        setDataCallbackEnabled(true);
+    }
+    {
+        std::lock_guard<std::mutex> stateLock(mStateLock);
+        setState(StreamState::Starting);
+    }
+    mServiceThread = std::thread(&SimulatedAudioStream::runService, this);
+    return Result::OK;
+}
+
+Result SimulatedAudioStream::requestPause() {
+    return requestTransition(StreamState::Pausing);
+}
+
+Result SimulatedAudioStream::requestFlush() {
+    std::lock_guard<std::mutex> stateLock(mStateLock);
+    switch (getState()) {
+        case StreamState::Closed:
+            return Result::ErrorClosed;
+        case StreamState::Open:
+        case StreamState::Paused:
+        case StreamState::Stopped:
+        case StreamState::Flushed:
+            break;
+        default:
+            return Result::ErrorInvalidState;
+    }
+    setState(StreamState::Flushing);
+    if (getDirection() == Direction::Output) {
+        mFramesWritten = mFramesRead.load();
+    }
+    setState(StreamState::Flushed);
+    return Result::OK;
+}
+
+Result SimulatedAudioStream::requestStop() {
+    return requestTransition(StreamState::Stopping);
+}
+
+Result SimulatedAudioStream::requestTransition(StreamState transientState) {
+    const StreamState finalState = (transientState == StreamState::Pausing)
+            ? StreamState::Paused : StreamState::Stopped;
+    std::lock_guard<std::mutex> stateLock(mStateLock);
+    switch (getState()) {
+        case StreamState::Closed:
+            return Result::ErrorClosed;
+        case StreamState::Uninitialized:
+        case StreamState::Disconnected:
+            return Result::ErrorInvalidState;
+        case StreamState::Starting:
+        case StreamState::Started:
+            // The service thread completes the transition at its next wakeup.
+            setState(transientState);
+            break;
+        case StreamState::Pausing:
+        case StreamState::Stopping:
+            // Already on the way. Stopping wins over pausing.
+            if (transientState == StreamState::Stopping) {
+                setState(transientState);
+            }
+            break;
+        default:
+            setState(finalState);
+            break;
+    }
+    return Result::OK;
+}
+
+Result SimulatedAudioStream::waitForStateChange(StreamState inputState,
+                                                StreamState *nextState,
+                                                int64_t timeoutNanoseconds) {
+    std::unique_lock<std::mutex> stateLock(mStateLock);
+    mStateChanged.wait_for(stateLock, std::chrono::nanoseconds(timeoutNanoseconds),
+                           [&] { return getState() != inputState; });
+    const StreamState state = getState();
+    if (nextState != nullptr) {
+        *nextState = state;
+    }
+    if (state == inputState) {
+        return Result::ErrorTimeout;
+    }
+    return (state == StreamState::Closed) ? Result::ErrorClosed : Result::OK;
+}
+
+ResultWithValue<int32_t> SimulatedAudioStream::setBufferSizeInFrames(int32_t requestedFrames) {
+    if (getState() == StreamState::Closed) {
+        return ResultWithValue<int32_t>(Result::ErrorClosed);
+    }
+    mBufferSizeInFrames = std::max(mFramesPerBurst,
+                                   std::min(requestedFrames, mBufferCapacityInFrames));
+    return ResultWithValue<int32_t>(mBufferSizeInFrames);
+}
+
+ResultWithValue<int32_t> SimulatedAudioStream::write(const void * /* buffer */,
+                                                     int32_t numFrames,
+                                                     int64_t timeoutNanoseconds) {
+    if (getDirection() != Direction::Output || isDataCallbackSpecified()) {
+        return ResultWithValue<int32_t>(Result::ErrorInvalidState);
+    }
+    const int64_t deadline = nowNanos() + timeoutNanoseconds;
+    int32_t framesLeft = numFrames;
+    while (framesLeft > 0) {
+        StreamState state = getState();
+        if (state == StreamState::Closed) {
+            return ResultWithValue<int32_t>(Result::ErrorClosed);
+        }
+        updateFramesRead();
+        const int64_t room = mBufferSizeInFrames - (mFramesWritten - mFramesRead);
+        if (room > 0) {
+            const int32_t framesToWrite = static_cast<int32_t>(
+                    std::min<int64_t>(room, framesLeft));
+            mFramesWritten += framesToWrite;
+            framesLeft -= framesToWrite;
+        } else if (state != StreamState::Started || nowNanos() >= deadline) {
+            break; // The device will not make room before the timeout.
+        } else {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(
+                    std::min(nanosPerBurst(), deadline - nowNanos())));
+        }
+    }
+    return ResultWithValue<int32_t>(numFrames - framesLeft);
+}
+
+ResultWithValue<int32_t> SimulatedAudioStream::read(void *buffer,
+                                                    int32_t numFrames,
+                                                    int64_t timeoutNanoseconds) {
+    if (getDirection() != Direction::Input || isDataCallbackSpecified()) {
+        return ResultWithValue<int32_t>(Result::ErrorInvalidState);
+    }
+    const int64_t deadline = nowNanos() + timeoutNanoseconds;
+    uint8_t *destination = static_cast<uint8_t *>(buffer);
+    int32_t framesLeft = numFrames;
+    while (framesLeft > 0) {
+        StreamState state = getState();
+        if (state == StreamState::Closed) {
+            return ResultWithValue<int32_t>(Result::ErrorClosed);
+        }
+        updateFramesWritten();
+        const int64_t available = mFramesWritten - mFramesRead;
+        if (available > 0) {
+            const int32_t framesToRead = static_cast<int32_t>(
+                    std::min<int64_t>(available, framesLeft));
+            // The simulated microphone records silence.
+            memset(destination, 0, framesToRead * getBytesPerFrame());
+            destination += framesToRead * getBytesPerFrame();
+            mFramesRead += framesToRead;
+            framesLeft -= framesToRead;
+        } else if (state != StreamState::Started || nowNanos() >= deadline) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(
+                    std::min(nanosPerBurst(), deadline - nowNanos())));
+        }
+    }
+    return ResultWithValue<int32_t>(numFrames - framesLeft);
+}
+
+void SimulatedAudioStream::updateFramesWritten() {
+    // Callback streams are advanced by the service thread.
+    if (getDirection() == Direction::Input && !isDataCallbackSpecified()
+            && getState() == StreamState::Started) {
+        syncBlockingPosition();
+    }
+}
+
+void SimulatedAudioStream::updateFramesRead() {
+    if (getDirection() == Direction::Output && !isDataCallbackSpecified()
+            && getState() == StreamState::Started) {
+        syncBlockingPosition();
+    }
+}
+
+void SimulatedAudioStream::syncBlockingPosition() {
+    const int64_t position = getDevicePosition();
+    if (getDirection() == Direction::Output) {
+        if (position > mFramesWritten) {
+            // Underrun. The device played silence.
+            mXRunCount++;
+            mFramesWritten = position;
+        }
+        mFramesRead = position;
+    } else {
+        if (position - mFramesRead > mBufferCapacityInFrames) {
+            // Overrun. The oldest frames are lost.
+            mXRunCount++;
+            mFramesRead = position - mBufferCapacityInFrames;
+        }
+        mFramesWritten = position;
+    }
+}
+
+int64_t SimulatedAudioStream::getDevicePosition() const {
+    const int64_t elapsedNanos = nowNanos() - mStartNanos;
+    return mFramesAtStart + (elapsedNanos * mSampleRate) / kNanosPerSecond;
+}
+
+int64_t SimulatedAudioStream::nanosPerBurst() const {
+    return (static_cast<int64_t>(mFramesPerBurst) * kNanosPerSecond) / mSampleRate;
+}
+
+void SimulatedAudioStream::setState(StreamState state) {
+    mState.store(state);
+    mStateChanged.notify_all();
+}
+
+void SimulatedAudioStream::joinServiceThread() {
+    if (!mServiceThread.joinable()) {
+        return;
+    }
+    if (mServiceThread.get_id() == std::this_thread::get_id()) {
+        // Called from a data callback. The thread exits on its own.
+        mServiceThread.detach();
+    } else {
+        mServiceThread.join();
+    }
+}
+
+void SimulatedAudioStream::runService() {
+    if (mDevice.startDelayNanos > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(mDevice.startDelayNanos));
+    }
+    const bool isOutput = getDirection() == Direction::Output;
+    const bool useCallback = isDataCallbackSpecified();
+    const int32_t framesPerCallback = (mFramesPerCallback > 0)
+            ? mFramesPerCallback : mFramesPerBurst;
+    const auto period = std::chrono::nanoseconds(
+            (static_cast<int64_t>(framesPerCallback) * kNanosPerSecond) / mSampleRate);
+    {
+        std::lock_guard<std::mutex> stateLock(mStateLock);
+        if (getState() != StreamState::Starting) {
+            return; // Stopped, paused or closed before the device started.
+        }
+        mFramesAtStart = isOutput ? mFramesRead.load() : mFramesWritten.load();
+        mStartNanos = nowNanos();
+        setState(StreamState::Started);
+    }
+
+    auto wakeup = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> stateLock(mStateLock);
+    while (true) {
+        wakeup += period;
+        const bool stateChanged = mStateChanged.wait_until(stateLock, wakeup,
+                [this] { return getState() != StreamState::Started; });
+        if (stateChanged) {
+            break;
+        }
+        if (!useCallback) {
+            continue; // Blocking streams are paced in read() and write().
+        }
+        stateLock.unlock();
+
+        if (!isOutput) {
+            memset(mCallbackBuffer.get(), 0, framesPerCallback * getBytesPerFrame());
+        }
+        DataCallbackResult result = fireDataCallback(mCallbackBuffer.get(), framesPerCallback);
+        mFramesRead += framesPerCallback;
+        mFramesWritten += framesPerCallback;
+
+        // The device needs these frames once it has played the rest of the buffer.
+        const auto headroom = std::chrono::nanoseconds(
+                (static_cast<int64_t>(std::max(0, mBufferSizeInFrames - framesPerCallback))
+                        * kNanosPerSecond) / mSampleRate);
+        const auto now = std::chrono::steady_clock::now();
+        if (now - wakeup > period + headroom) {
+            // The callback finished too late so the device ran dry.
+            mXRunCount++;
+            wakeup = now;
+        }
+
+        stateLock.lock();
+        if (result != DataCallbackResult::Continue && getState() == StreamState::Started) {
+            setState(StreamState::Stopping);
+        }
+    }
+
+    // Complete the transition requested by stop(), pause() or the callback.
+    if (!useCallback) {
+        syncBlockingPosition();
+    }
+    switch (getState()) {
+        case StreamState::Pausing:
+            setState(StreamState::Paused);
+            break;
+        case StreamState::Stopping:
+            setState(StreamState::Stopped);
+            break;
+        default:
+            break;
+    }
+}
+
+SimulatedDevice &oboe::getDefaultSimulatedDevice() {
+    static SimulatedDevice device;
+    return device;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBOE_SIMULATED_AUDIO_STREAM_H
+#define OBOE_SIMULATED_AUDIO_STREAM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "oboe/AudioStream.h"
+#include "oboe/AudioStreamBuilder.h"
+
+namespace oboe {
+
+/**
+ * Properties of the fake device behind a SimulatedAudioStream.
+ * Any stream property left unspecified by the builder is taken from here.
+ */
+struct SimulatedDevice {
+    int32_t     sampleRate = 48000;
+    int32_t     channelCount = ChannelCount::Stereo;
+    AudioFormat format = AudioFormat::Float;
+    int32_t     framesPerBurst = 192;
+    int32_t     burstsPerBuffer = 2;
+    int32_t     burstsPerCapacity = 8;
+    // Simulated round trip to the audio service for open() and requestStart().
+    int64_t     openDelayNanos = 0;
+    int64_t     startDelayNanos = 0;
+};
+
+/**
+ * An AudioStream that runs without any audio hardware.
+ *
+ * A callback stream is serviced by a thread that wakes once per burst period,
+ * like a FAST mixer would. A callback that finishes after the device has played
+ * the rest of the buffer counts as an xrun, so the buffer size matters as it would
+ * on a device. Blocking streams are paced against the same clock.
+ * This lets the parts of Oboe above the native API, and apps built on top of it,
+ * be measured on a Linux host.
+ */
+class SimulatedAudioStream : public AudioStream {
+public:
+    explicit SimulatedAudioStream(const AudioStreamBuilder &builder,
+                                  const SimulatedDevice &device = SimulatedDevice());
+
+    virtual ~SimulatedAudioStream();
+
+    Result open() override;
+
+    Result close() override;
+
+    Result requestStart() override;
+
+    Result requestPause() override;
+
+    Result requestFlush() override;
+
+    Result requestStop() override;
+
+    StreamState getState() override {
+        return mState.load();
+    }
+
+    Result waitForStateChange(StreamState inputState,
+                              StreamState *nextState,
+                              int64_t timeoutNanoseconds) override;
+
+    ResultWithValue<int32_t> setBufferSizeInFrames(int32_t requestedFrames) override;
+
+    ResultWithValue<int32_t> getXRunCount() override {
+        return ResultWithValue<int32_t>(mXRunCount.load());
+    }
+
+    bool isXRunCountSupported() const override {
+        return true;
+    }
+
+    ResultWithValue<int32_t> write(const void *buffer,
+                                   int32_t numFrames,
+                                   int64_t timeoutNanoseconds) override;
+
+    ResultWithValue<int32_t> read(void *buffer,
+                                  int32_t numFrames,
+                                  int64_t timeoutNanoseconds) override;
+
+    AudioApi getAudioApi() const override {
+        return AudioApi::Unspecified;
+    }
+
+    void updateFramesWritten() override;
+
+    void updateFramesRead() override;
+
+    const SimulatedDevice &getDevice() const {
+        return mDevice;
+    }
+
+private:
+
+    void setState(StreamState state);
+
+    // Move to the requested transient state and let the service thread finish the transition.
+    Result requestTransition(StreamState transientState);
+
+    void joinServiceThread();
+
+    void runService();
+
+    // Advance the counters of a blocking stream to the device position.
+    void syncBlockingPosition();
+
+    // Frames consumed (output) or produced (input) by the device since start.
+    int64_t getDevicePosition() const;
+
+    int64_t nanosPerBurst() const;
+
+    const SimulatedDevice       mDevice;
+
+    std::atomic<StreamState>    mState{StreamState::Uninitialized};
+    std::mutex                  mStateLock;
+    std::condition_variable     mStateChanged;
+
+    std::thread                 mServiceThread;
+    std::unique_ptr<uint8_t[]>  mCallbackBuffer;
+
+    std::atomic<int32_t>        mXRunCount{0};
+    std::atomic<int64_t>        mStartNanos{0};
+    std::atomic<int64_t>        mFramesAtStart{0};
+};
+
+/**
+ * The device that AudioStreamBuilder::openStream() simulates when SimulatedStreamBuilder.cpp
+ * is linked in place of AudioStreamBuilderBackend.cpp.
+ * Change it before opening a stream.
+ */
+SimulatedDevice &getDefaultSimulatedDevice();
+
+} // namespace oboe
+
+#endif //OBOE_SIMULATED_AUDIO_STREAM_H
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * A simulated backend for AudioStreamBuilder, linked in place of
+ * src/common/AudioStreamBuilderBackend.cpp on a Linux host.
+ *
+ * AudioStreamBuilder::openStream() still runs as it does on a device: the QuirksManager
+ * decides whether conversion is needed, a FilterAudioStream is added when the child stream
+ * does not match, and the snapshot used by reopen() is recorded. Only the native stream at
+ * the bottom is replaced by a SimulatedAudioStream.
+ */
+
+#include "aaudio/AudioStreamAAudio.h"
+#include "oboe/AudioStreamBuilder.h"
+#include "SimulatedAudioStream.h"
+
+namespace oboe {
+
+bool AudioStreamBuilder::isAAudioSupported() {
+    return false;
+}
+
+bool AudioStreamBuilder::isAAudioRecommended() {
+    return false;
+}
+
+AudioStream *AudioStreamBuilder::build() {
+    return new SimulatedAudioStream(*this, getDefaultSimulatedDevice());
+}
+
+// No AudioStreamAAudio is created on a host but QuirksManager::isMMapUsed() refers to it.
+bool AudioStreamAAudio::isMMapUsed() {
+    return false;
+}
+
+} // namespace oboe
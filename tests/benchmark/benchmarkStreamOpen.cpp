@@ -0,0 +1,268 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measure how long it takes to open, start, stop and close a stream, split by the
+ * phases of AudioStreamBuilder::openStream().
+ *
+ * The phases are the ScopedTraceSections inside openStream(), reported through
+ * Trace::setSectionListener(), so they are measured in the real open:
+ *   open.quirks     QuirksManager decisions, for the stream and for the child stream
+ *   open.child      opening the child stream of a FilterAudioStream, including its quirks and open
+ *   open.flowgraph  FilterAudioStream::configureFlowGraph(), mostly building the resampler
+ *   open.native     AudioStream::open() of the native stream and of the FilterAudioStream
+ *
+ * Streams are opened with the real AudioStreamBuilder. On a Linux host SimulatedStreamBuilder.cpp
+ * replaces the native backend with a SimulatedAudioStream so the cost of Oboe itself can be
+ * tracked before release. On Android the same phases are measured through AAudio or OpenSL ES.
+ * The --open-delay-us and --start-delay-us options only apply to the simulated device.
+ *
+ * Usage: benchmarkStreamOpen [--iterations N] [--open-delay-us N] [--start-delay-us N] [--csv]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "oboe/Oboe.h"
+#include "common/FilterAudioStream.h"
+#include "common/Trace.h"
+#include "SimulatedAudioStream.h"
+
+using namespace oboe;
+
+namespace {
+
+constexpr int64_t kStartStopTimeoutNanos = 2 * kNanosPerSecond;
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class SilenceCallback : public AudioStreamDataCallback {
+public:
+    DataCallbackResult onAudioReady(AudioStream *stream, void *audioData,
+                                    int32_t numFrames) override {
+        memset(audioData, 0, numFrames * stream->getBytesPerFrame());
+        return DataCallbackResult::Continue;
+    }
+};
+
+struct BenchmarkConfig {
+    Direction                   direction;
+    int32_t                     sampleRate;
+    int32_t                     channelCount;
+    AudioFormat                 format;
+    SampleRateConversionQuality quality;
+
+    std::string getName() const {
+        char text[96];
+        snprintf(text, sizeof(text), "%s_%dHz_%dch_%s_%s",
+                 direction == Direction::Output ? "out" : "in",
+                 sampleRate, channelCount, convertToText(format), convertToText(quality));
+        return text;
+    }
+};
+
+/**
+ * Collects the duration of each phase over all iterations of one configuration.
+ * Phases are reported in the order they were first recorded.
+ */
+class PhaseTimes {
+public:
+    void add(const char *phase, int64_t nanos) {
+        auto it = mSamples.find(phase);
+        if (it == mSamples.end()) {
+            mOrder.push_back(phase);
+            it = mSamples.emplace(phase, std::vector<int64_t>()).first;
+        }
+        it->second.push_back(nanos);
+    }
+
+    void report(const std::string &configName, bool csv) {
+        for (const std::string &phase : mOrder) {
+            std::vector<int64_t> &samples = mSamples[phase];
+            std::sort(samples.begin(), samples.end());
+            double sum = 0.0;
+            for (int64_t sample : samples) sum += sample;
+            const double medianMicros = samples[samples.size() / 2] * 0.001;
+            const double meanMicros = sum * 0.001 / samples.size();
+            const double maxMicros = samples.back() * 0.001;
+            if (csv) {
+                printf("%s,%s,%zu,%.1f,%.1f,%.1f\n", configName.c_str(), phase.c_str(),
+                       samples.size(), medianMicros, meanMicros, maxMicros);
+            } else {
+                printf("  %-18s n=%-4zu median=%9.1f us  mean=%9.1f us  max=%9.1f us\n",
+                       phase.c_str(), samples.size(), medianMicros, meanMicros, maxMicros);
+            }
+        }
+    }
+
+private:
+    std::vector<std::string> mOrder;
+    std::map<std::string, std::vector<int64_t>> mSamples;
+};
+
+// Sections recorded by Oboe during one open, in nanoseconds.
+// Streams are opened on the main thread only so this is not locked.
+std::map<std::string, int64_t> sSectionNanos;
+
+void onSectionEnd(const char *sectionName, int64_t durationNanos) {
+    sSectionNanos[sectionName] += durationNanos;
+}
+
+/**
+ * Open, start, stop and close one stream through AudioStreamBuilder::openStream(),
+ * timing each phase. The open is reported as "open.filter" when the builder added a
+ * FilterAudioStream for data conversion and as "open.direct" when it did not.
+ */
+void runIteration(const BenchmarkConfig &config,
+                  AudioStreamDataCallback *callback,
+                  PhaseTimes &times) {
+    AudioStreamBuilder builder;
+    builder.setDirection(config.direction)
+            ->setPerformanceMode(PerformanceMode::LowLatency)
+            ->setSharingMode(SharingMode::Exclusive)
+            ->setSampleRate(config.sampleRate)
+            ->setChannelCount(config.channelCount)
+            ->setFormat(config.format)
+            ->setFormatConversionAllowed(true)
+            ->setChannelConversionAllowed(true)
+            ->setSampleRateConversionQuality(config.quality)
+            ->setDataCallback(callback);
+
+    std::shared_ptr<AudioStream> stream;
+    sSectionNanos.clear();
+    int64_t startNanos = nowNanos();
+    if (builder.openStream(stream) != Result::OK) {
+#ifdef __ANDROID__
+        return; // For example, input without the RECORD_AUDIO permission.
+#else
+        fprintf(stderr, "ERROR: could not open %s\n", config.getName().c_str());
+        exit(EXIT_FAILURE);
+#endif
+    }
+    const bool isFiltered = dynamic_cast<FilterAudioStream *>(stream.get()) != nullptr;
+    times.add(isFiltered ? "open.filter" : "open.direct", nowNanos() - startNanos);
+    const std::pair<const char *, const char *> phases[] = {
+            {"oboe.openStream.quirks", "open.quirks"},
+            {"oboe.openStream.child", "open.child"},
+            {"oboe.configureFlowGraph", "open.flowgraph"},
+            {"oboe.openStream.open", "open.native"},
+    };
+    for (const auto &[sectionName, phase] : phases) {
+        auto it = sSectionNanos.find(sectionName);
+        if (it != sSectionNanos.end()) {
+            times.add(phase, it->second);
+        }
+    }
+
+    startNanos = nowNanos();
+    if (stream->start(kStartStopTimeoutNanos) != Result::OK) {
+        fprintf(stderr, "ERROR: could not start %s\n", config.getName().c_str());
+        exit(EXIT_FAILURE);
+    }
+    times.add("start", nowNanos() - startNanos);
+
+    startNanos = nowNanos();
+    stream->stop(kStartStopTimeoutNanos);
+    times.add("stop", nowNanos() - startNanos);
+
+    startNanos = nowNanos();
+    stream->close();
+    times.add("close", nowNanos() - startNanos);
+}
+
+void usage() {
+    printf("usage: benchmarkStreamOpen [--iterations N] [--open-delay-us N]"
+           " [--start-delay-us N] [--csv]\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+    int32_t iterations = 50;
+    bool csv = false;
+    SimulatedDevice &device = getDefaultSimulatedDevice();
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--csv") == 0) {
+            csv = true;
+        } else if (i + 1 < argc && strcmp(arg, "--iterations") == 0) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (i + 1 < argc && strcmp(arg, "--open-delay-us") == 0) {
+            device.openDelayNanos = atoll(argv[++i]) * kNanosPerMicrosecond;
+        } else if (i + 1 < argc && strcmp(arg, "--start-delay-us") == 0) {
+            device.startDelayNanos = atoll(argv[++i]) * kNanosPerMicrosecond;
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<BenchmarkConfig> configs;
+    for (Direction direction : {Direction::Output, Direction::Input}) {
+        for (int32_t sampleRate : {44100, 48000, 96000}) {
+            for (int32_t channelCount : {1, 2}) {
+                for (AudioFormat format : {AudioFormat::Float, AudioFormat::I16}) {
+                    configs.push_back({direction, sampleRate, channelCount, format,
+                                       SampleRateConversionQuality::Medium});
+                }
+            }
+        }
+        // Resampler quality only matters when the rate is converted.
+        for (auto quality : {SampleRateConversionQuality::Fastest,
+                             SampleRateConversionQuality::Low,
+                             SampleRateConversionQuality::High,
+                             SampleRateConversionQuality::Best}) {
+            configs.push_back({direction, 44100, 2, AudioFormat::Float, quality});
+        }
+    }
+
+#ifndef __ANDROID__
+    // The SDK version is unknown on a host, so every workaround for old devices would apply.
+    OboeGlobals::setWorkaroundsEnabled(false);
+#endif
+
+    SilenceCallback callback;
+    Trace::setSectionListener(onSectionEnd);
+    if (csv) {
+        printf("config,phase,iterations,median_us,mean_us,max_us\n");
+    } else {
+        printf("benchmarkStreamOpen: Oboe %s, %d iterations, device %d Hz, burst %d\n",
+               getVersionText(), iterations, device.sampleRate, device.framesPerBurst);
+    }
+    for (const BenchmarkConfig &config : configs) {
+        PhaseTimes times;
+        for (int32_t i = 0; i < iterations; i++) {
+            runIteration(config, &callback, times);
+        }
+        if (!csv) {
+            printf("%s\n", config.getName().c_str());
+        }
+        times.report(config.getName(), csv);
+    }
+    Trace::setSectionListener(nullptr);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test CallbackDispatcher
+ */
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/CallbackDispatcher.h"
+
+using namespace oboe;
+
+constexpr auto kTimeout = std::chrono::seconds(2);
+
+TEST(test_callback_dispatcher, runs_tasks_in_order) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId owner = CallbackDispatcher::newOwnerId();
+    std::mutex lock;
+    std::vector<int> order;
+    std::promise<void> done;
+    constexpr int kNumTasks = 10;
+    for (int i = 0; i < kNumTasks; i++) {
+        ASSERT_TRUE(dispatcher.post(owner, [i, &lock, &order, &done]() {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(i);
+            if (i == kNumTasks - 1) done.set_value();
+        }));
+    }
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(kTimeout));
+    std::lock_guard<std::mutex> guard(lock);
+    ASSERT_EQ(kNumTasks, (int) order.size());
+    for (int i = 0; i < kNumTasks; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(test_callback_dispatcher, runs_one_task_per_owner_at_a_time) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId owner = CallbackDispatcher::newOwnerId();
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    std::promise<void> done;
+    constexpr int kNumTasks = 10;
+    for (int i = 0; i < kNumTasks; i++) {
+        ASSERT_TRUE(dispatcher.post(owner, [i, &running, &overlapped, &done]() {
+            if (running++ > 0) overlapped = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            running--;
+            if (i == kNumTasks - 1) done.set_value();
+        }));
+    }
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(kTimeout));
+    EXPECT_FALSE(overlapped.load());
+}
+
+TEST(test_callback_dispatcher, slow_owner_does_not_block_others) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId slowOwner = CallbackDispatcher::newOwnerId();
+    const CallbackDispatcher::OwnerId otherOwner = CallbackDispatcher::newOwnerId();
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    std::promise<void> otherDone;
+
+    // Like an app that reopens its stream in onErrorAfterClose().
+    ASSERT_TRUE(dispatcher.post(slowOwner, [&started, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+    }));
+    ASSERT_EQ(std::future_status::ready, started.get_future().wait_for(kTimeout));
+
+    ASSERT_TRUE(dispatcher.post(otherOwner, [&otherDone]() { otherDone.set_value(); }));
+    EXPECT_EQ(std::future_status::ready, otherDone.get_future().wait_for(kTimeout));
+    release.set_value();
+}
+
+TEST(test_callback_dispatcher, cancel_pending_tasks) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId blockingOwner = CallbackDispatcher::newOwnerId();
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    std::promise<void> done;
+    std::atomic<int> cancelledRuns{0};
+
+    // Block the owner so the following tasks stay pending.
+    ASSERT_TRUE(dispatcher.post(blockingOwner, [&started, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+    }));
+    ASSERT_EQ(std::future_status::ready, started.get_future().wait_for(kTimeout));
+
+    // Tasks for the same owner wait behind the running one.
+    ASSERT_TRUE(dispatcher.post(blockingOwner, [&cancelledRuns]() { cancelledRuns++; }));
+    ASSERT_TRUE(dispatcher.post(blockingOwner, [&cancelledRuns]() { cancelledRuns++; }));
+    ASSERT_TRUE(dispatcher.post(blockingOwner, [&done]() { done.set_value(); }, false));
+
+    EXPECT_EQ(2, dispatcher.cancel(blockingOwner));
+    release.set_value();
+    ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(kTimeout));
+    EXPECT_EQ(0, cancelledRuns.load());
+}
+
+TEST(test_callback_dispatcher, owner_ids_are_unique) {
+    const CallbackDispatcher::OwnerId first = CallbackDispatcher::newOwnerId();
+    const CallbackDispatcher::OwnerId second = CallbackDispatcher::newOwnerId();
+    EXPECT_NE(first, second);
+}
+
+TEST(test_callback_dispatcher, shared_error_tasks_are_not_cancelled) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId owner = CallbackDispatcher::newOwnerId();
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    std::promise<void> errorDelivered;
+
+    ASSERT_TRUE(dispatcher.post(owner, [&started, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+    }));
+    ASSERT_EQ(std::future_status::ready, started.get_future().wait_for(kTimeout));
+    // Like an error task that holds a shared_ptr to the stream.
+    ASSERT_TRUE(dispatcher.post(owner, [&errorDelivered]() { errorDelivered.set_value(); },
+                                false /* cancellable */, true /* useReserve */));
+
+    // As if the stream was closed before its error was delivered.
+    EXPECT_EQ(0, dispatcher.cancel(owner));
+    release.set_value();
+    EXPECT_EQ(std::future_status::ready, errorDelivered.get_future().wait_for(kTimeout));
+}
+
+TEST(test_callback_dispatcher, queue_is_bounded) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId owner = CallbackDispatcher::newOwnerId();
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+
+    ASSERT_TRUE(dispatcher.post(owner, [&started, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+    }));
+    ASSERT_EQ(std::future_status::ready, started.get_future().wait_for(kTimeout));
+
+    for (size_t i = 0; i < CallbackDispatcher::kMaxPendingTasks; i++) {
+        ASSERT_TRUE(dispatcher.post(owner, []() {}));
+    }
+    std::function<void()> overflow = []() {};
+    EXPECT_FALSE(dispatcher.post(owner, std::move(overflow)));
+    // The task is left intact so the caller can run it some other way.
+    EXPECT_TRUE(static_cast<bool>(overflow));
+
+    EXPECT_EQ((int32_t) CallbackDispatcher::kMaxPendingTasks, dispatcher.cancel(owner));
+    release.set_value();
+}
+
+TEST(test_callback_dispatcher, error_tasks_use_reserve) {
+    CallbackDispatcher &dispatcher = CallbackDispatcher::getInstance();
+    const CallbackDispatcher::OwnerId owner = CallbackDispatcher::newOwnerId();
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    std::atomic<int> errorRuns{0};
+
+    ASSERT_TRUE(dispatcher.post(owner, [&started, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+    }));
+    ASSERT_EQ(std::future_status::ready, started.get_future().wait_for(kTimeout));
+
+    // Events fill the normal part of the queue.
+    for (size_t i = 0; i < CallbackDispatcher::kMaxPendingTasks; i++) {
+        ASSERT_TRUE(dispatcher.post(owner, []() {}));
+    }
+    EXPECT_FALSE(dispatcher.post(owner, []() {}));
+
+    // Error tasks can still be queued, up to the size of the reserve.
+    for (size_t i = 0; i < CallbackDispatcher::kNumReservedTasks; i++) {
+        ASSERT_TRUE(dispatcher.post(owner, [&errorRuns]() { errorRuns++; },
+                                    true /* cancellable */, true /* useReserve */));
+    }
+    EXPECT_FALSE(dispatcher.post(owner, [&errorRuns]() { errorRuns++; },
+                                 true /* cancellable */, true /* useReserve */));
+
+    // Error tasks that hold a raw stream pointer are removed when the stream is closed.
+    EXPECT_EQ((int32_t) (CallbackDispatcher::kMaxPendingTasks
+                         + CallbackDispatcher::kNumReservedTasks),
+              dispatcher.cancel(owner));
+    release.set_value();
+    EXPECT_EQ(0, errorRuns.load());
+}
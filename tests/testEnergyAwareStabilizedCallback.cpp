@@ -0,0 +1,180 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test the load budget of EnergyAwareStabilizedCallback
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <oboe/Oboe.h>
+#include <oboe/StabilizedCallback.h>
+
+using namespace oboe;
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int32_t kFramesPerCallback = 480;
+constexpr int64_t kCallbackNanos = (kFramesPerCallback * kNanosPerSecond) / kSampleRate;
+constexpr int64_t kWorkNanos = kCallbackNanos / 20;
+// Every other callback starts this late, which is well over the default jitter threshold.
+constexpr int64_t kJitterNanos = kCallbackNanos * 4 / 10;
+constexpr int kNumCallbacks = 100;
+// The test thread can be preempted, so the timing checks are on totals with some margin.
+constexpr double kMarginFraction = 0.05;
+
+static void spinUntil(int64_t deadlineNanos) {
+    while (AudioClock::getNanoseconds() < deadlineNanos) {}
+}
+
+/**
+ * A stream that is only used to pass its properties to the callback.
+ */
+class CallbackTestStream : public AudioStream {
+public:
+    explicit CallbackTestStream(const AudioStreamBuilder &builder) : AudioStream(builder) {
+        mSampleRate = kSampleRate;
+        mFramesPerBurst = kFramesPerCallback;
+    }
+
+    Result requestStart() override { return Result::OK; }
+    Result requestPause() override { return Result::OK; }
+    Result requestFlush() override { return Result::OK; }
+    Result requestStop() override { return Result::OK; }
+    StreamState getState() override { return StreamState::Started; }
+    Result waitForStateChange(StreamState, StreamState *nextState, int64_t) override {
+        if (nextState != nullptr) *nextState = StreamState::Started;
+        return Result::OK;
+    }
+    bool isXRunCountSupported() const override { return false; }
+    AudioApi getAudioApi() const override { return AudioApi::Unspecified; }
+    void updateFramesWritten() override {}
+    void updateFramesRead() override {}
+
+    bool isPerformanceHintActive() override { return mHintActive; }
+
+    bool mHintActive = false;
+};
+
+/**
+ * Does a fixed amount of work in each callback.
+ */
+class WorkCallback : public AudioStreamCallback {
+public:
+    DataCallbackResult onAudioReady(AudioStream *, void *, int32_t) override {
+        spinUntil(AudioClock::getNanoseconds() + kWorkNanos);
+        return DataCallbackResult::Continue;
+    }
+};
+
+class EnergyAwareStabilizedCallbackTest : public ::testing::Test {
+
+protected:
+
+    void SetUp() override {
+        mStream = std::make_unique<CallbackTestStream>(AudioStreamBuilder());
+    }
+
+    /**
+     * Calls the callback on a schedule of one callback per kCallbackNanos.
+     * If jitter is set then every other callback starts kJitterNanos late.
+     */
+    void runCallbacks(EnergyAwareStabilizedCallback &callback, bool jitter) {
+        const int64_t epochNanos = AudioClock::getNanoseconds();
+        for (int i = 0; i < kNumCallbacks; i++) {
+            int64_t lateNanos = (jitter && (i % 2 == 1)) ? kJitterNanos : 0;
+            spinUntil(epochNanos + (i * kCallbackNanos) + lateNanos);
+            callback.onAudioReady(mStream.get(), nullptr, kFramesPerCallback);
+        }
+    }
+
+    // An allowance for preemption, as a duration.
+    static int64_t margin(const EnergyAwareStabilizedCallback &callback) {
+        return static_cast<int64_t>(kMarginFraction * callback.getAudioDurationNanos());
+    }
+
+    WorkCallback mWorkCallback;
+    std::unique_ptr<CallbackTestStream> mStream;
+};
+
+TEST_F(EnergyAwareStabilizedCallbackTest, NoLoadWithoutJitter) {
+    EnergyAwareStabilizedCallback callback(&mWorkCallback);
+    runCallbacks(callback, false);
+
+    // A preempted callback can raise the average late start for a few callbacks.
+    EXPECT_LT(callback.getInjectedLoadNanos(), margin(callback));
+    EXPECT_EQ(kNumCallbacks * kCallbackNanos, callback.getAudioDurationNanos());
+    EXPECT_GE(callback.getCallbackWorkNanos(), kNumCallbacks * kWorkNanos);
+}
+
+TEST_F(EnergyAwareStabilizedCallbackTest, JitterGeneratesLoadWithinBudget) {
+    constexpr double kBudget = 0.3;
+    EnergyAwareStabilizedCallback callback(&mWorkCallback);
+    callback.setMinimumWorkBudget(kBudget);
+    runCallbacks(callback, true);
+
+    EXPECT_TRUE(callback.isGeneratingLoad());
+    EXPECT_GT(callback.getInjectedLoadNanos(), 0);
+    // The load and the work together stay within the budget of the whole audio duration.
+    // StabilizedCallback would use 0.8 of it.
+    int64_t totalNanos = callback.getInjectedLoadNanos() + callback.getCallbackWorkNanos();
+    EXPECT_LE(totalNanos, static_cast<int64_t>(kBudget * callback.getAudioDurationNanos())
+            + margin(callback));
+}
+
+TEST_F(EnergyAwareStabilizedCallbackTest, LargerBudgetInjectsMoreLoad) {
+    EnergyAwareStabilizedCallback smallCallback(&mWorkCallback);
+    smallCallback.setMinimumWorkBudget(0.2);
+    runCallbacks(smallCallback, true);
+
+    EnergyAwareStabilizedCallback largeCallback(&mWorkCallback);
+    largeCallback.setMinimumWorkBudget(0.5);
+    runCallbacks(largeCallback, true);
+
+    EXPECT_GT(largeCallback.getInjectedLoadNanos(), smallCallback.getInjectedLoadNanos());
+}
+
+TEST_F(EnergyAwareStabilizedCallbackTest, StreamHintSessionDisablesLoad) {
+    mStream->mHintActive = true;
+    EnergyAwareStabilizedCallback callback(&mWorkCallback);
+    runCallbacks(callback, true);
+
+    EXPECT_FALSE(callback.isGeneratingLoad());
+    EXPECT_EQ(0, callback.getInjectedLoadNanos());
+}
+
+TEST_F(EnergyAwareStabilizedCallbackTest, HintEnabledWithoutSessionFallsBack) {
+    // Hints were asked for but the stream could not open a session.
+    mStream->setPerformanceHintEnabled(true);
+    mStream->mHintActive = false;
+    EnergyAwareStabilizedCallback callback(&mWorkCallback);
+    runCallbacks(callback, true);
+
+    EXPECT_TRUE(callback.isGeneratingLoad());
+    EXPECT_GT(callback.getInjectedLoadNanos(), 0);
+}
+
+TEST_F(EnergyAwareStabilizedCallbackTest, ErrorResetsCounters) {
+    EnergyAwareStabilizedCallback callback(&mWorkCallback);
+    runCallbacks(callback, true);
+    ASSERT_GT(callback.getInjectedLoadNanos(), 0);
+
+    callback.onErrorAfterClose(mStream.get(), Result::ErrorDisconnected);
+    EXPECT_FALSE(callback.isGeneratingLoad());
+    EXPECT_EQ(0, callback.getInjectedLoadNanos());
+    EXPECT_EQ(0, callback.getCallbackWorkNanos());
+    EXPECT_EQ(0, callback.getAudioDurationNanos());
+}
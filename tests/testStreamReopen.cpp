@@ -0,0 +1,170 @@
+/*
+ * Copyright 2025 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oboe/Oboe.h>
+
+#include "common/FilterAudioStream.h"
+
+using namespace oboe;
+
+// The sample rate converter of a stream, or nullptr if it does not convert the rate.
+static const resampler::MultiChannelResampler *getResampler(AudioStream *stream) {
+    auto filterStream = dynamic_cast<FilterAudioStream *>(stream);
+    return (filterStream == nullptr) ? nullptr
+            : filterStream->getReusableResampler().resampler.get();
+}
+
+class ReopenCallback : public AudioStreamDataCallback {
+public:
+    DataCallbackResult onAudioReady(AudioStream *oboeStream, void *audioData,
+                                    int32_t numFrames) override {
+        callbackCount++;
+        return DataCallbackResult::Continue;
+    }
+
+    std::atomic<int32_t> callbackCount{0};
+};
+
+class StreamReopen : public ::testing::Test {
+
+protected:
+
+    void checkReopen(Direction direction, int32_t sampleRate) {
+        mBuilder.setDirection(direction);
+        mBuilder.setDataCallback(&mCallback);
+        mBuilder.setPerformanceMode(PerformanceMode::LowLatency);
+        mBuilder.setFormat(AudioFormat::Float);
+        mBuilder.setChannelCount(2);
+        mBuilder.setSampleRate(sampleRate);
+        mBuilder.setSampleRateConversionQuality(SampleRateConversionQuality::Medium);
+
+        std::shared_ptr<AudioStream> stream;
+        ASSERT_EQ(Result::OK, mBuilder.openStream(stream));
+        const resampler::MultiChannelResampler *resampler = getResampler(stream.get());
+        ASSERT_EQ(Result::OK, stream->close());
+
+        std::shared_ptr<AudioStream> reopened;
+        ASSERT_EQ(Result::OK, stream->reopen(reopened));
+        ASSERT_NE(nullptr, reopened);
+        if (resampler != nullptr) {
+            // The closed stream handed its resampler to the new stream.
+            EXPECT_EQ(resampler, getResampler(reopened.get()));
+
+            // A second reopen of the same closed stream must not share it.
+            std::shared_ptr<AudioStream> second;
+            ASSERT_EQ(Result::OK, stream->reopen(second));
+            EXPECT_NE(nullptr, getResampler(second.get()));
+            EXPECT_NE(resampler, getResampler(second.get()));
+            ASSERT_EQ(Result::OK, second->close());
+        }
+        EXPECT_EQ(stream->getDirection(), reopened->getDirection());
+        EXPECT_EQ(stream->getAudioApi(), reopened->getAudioApi());
+        EXPECT_EQ(stream->getFormat(), reopened->getFormat());
+        EXPECT_EQ(stream->getChannelCount(), reopened->getChannelCount());
+        EXPECT_EQ(sampleRate, reopened->getSampleRate());
+
+        ASSERT_EQ(Result::OK, reopened->requestStart());
+        int timeout = 20;
+        while (mCallback.callbackCount == 0 && timeout > 0) {
+            usleep(50 * 1000);
+            timeout--;
+        }
+        EXPECT_GT(mCallback.callbackCount, 0);
+        ASSERT_EQ(Result::OK, reopened->requestStop());
+
+        // A reopened stream can be reopened again.
+        ASSERT_EQ(Result::OK, reopened->close());
+        std::shared_ptr<AudioStream> reopenedAgain;
+        ASSERT_EQ(Result::OK, reopened->reopen(reopenedAgain));
+        EXPECT_EQ(sampleRate, reopenedAgain->getSampleRate());
+        ASSERT_EQ(Result::OK, reopenedAgain->close());
+    }
+
+    AudioStreamBuilder mBuilder;
+    ReopenCallback     mCallback;
+};
+
+TEST_F(StreamReopen, ReopenOutput) {
+    checkReopen(Direction::Output, 48000);
+}
+
+TEST_F(StreamReopen, ReopenInput) {
+    checkReopen(Direction::Input, 48000);
+}
+
+// 44100 usually needs sample rate conversion, so the resampler will be reused.
+TEST_F(StreamReopen, ReopenOutputWithRateConversion) {
+    checkReopen(Direction::Output, 44100);
+}
+
+TEST_F(StreamReopen, ReopenInputWithRateConversion) {
+    checkReopen(Direction::Input, 44100);
+}
+
+TEST_F(StreamReopen, ReopenWhileOpen) {
+    mBuilder.setSampleRate(44100);
+    std::shared_ptr<AudioStream> stream;
+    ASSERT_EQ(Result::OK, mBuilder.openStream(stream));
+    // The resampler is still in use so a new one must be built.
+    std::shared_ptr<AudioStream> reopened;
+    ASSERT_EQ(Result::OK, stream->reopen(reopened));
+    EXPECT_EQ(44100, reopened->getSampleRate());
+    if (getResampler(stream.get()) != nullptr) {
+        EXPECT_NE(getResampler(stream.get()), getResampler(reopened.get()));
+    }
+    ASSERT_EQ(Result::OK, reopened->close());
+    ASSERT_EQ(Result::OK, stream->close());
+}
+
+TEST_F(StreamReopen, ConcurrentReopenTakesResamplerOnce) {
+    mBuilder.setDataCallback(&mCallback);
+    mBuilder.setPerformanceMode(PerformanceMode::LowLatency);
+    mBuilder.setFormat(AudioFormat::Float);
+    mBuilder.setChannelCount(2);
+    mBuilder.setSampleRate(44100);
+    mBuilder.setSampleRateConversionQuality(SampleRateConversionQuality::Medium);
+    std::shared_ptr<AudioStream> stream;
+    ASSERT_EQ(Result::OK, mBuilder.openStream(stream));
+    const resampler::MultiChannelResampler *resampler = getResampler(stream.get());
+    ASSERT_EQ(Result::OK, stream->close());
+
+    constexpr int kNumThreads = 4;
+    std::vector<std::shared_ptr<AudioStream>> reopened(kNumThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+        threads.emplace_back([&stream, &reopened, i]() {
+            stream->reopen(reopened[i]);
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    int numSharing = 0;
+    for (auto &newStream : reopened) {
+        ASSERT_NE(nullptr, newStream);
+        if (resampler != nullptr && getResampler(newStream.get()) == resampler) {
+            numSharing++;
+        }
+        ASSERT_EQ(Result::OK, newStream->close());
+    }
+    // Only one of the new streams may take over the resampler of the closed stream.
+    EXPECT_LE(numSharing, 1);
+}